@@ -610,7 +610,7 @@ print_rmgr_heap2(XLogRecPtr cur, XLogRecord *record, uint8 info)
 #endif
 	char buf[1024];
 
-	switch (info)
+	switch (info & XLOG_HEAP_OPMASK)
 	{
 		case XLOG_HEAP2_FREEZE:
 		{
@@ -666,6 +666,23 @@ print_rmgr_heap2(XLogRecPtr cur, XLogRecord *record, uint8 info)
 		}
 		break;
 
+#if PG_VERSION_NUM < 90000
+		case XLOG_HEAP2_MULTI_INSERT:
+		{
+			xl_heap_multi_insert xlrec;
+
+			memcpy(&xlrec, XLogRecGetData(record), SizeOfHeapMultiInsert);
+			snprintf(buf, sizeof(buf), "multi_insert%s: ts %d db %d rel %d block %u ntuples %u",
+				(info & XLOG_HEAP_INIT_PAGE) ? "(init)" : "",
+				xlrec.heapnode.node.spcNode,
+				xlrec.heapnode.node.dbNode,
+				xlrec.heapnode.node.relNode,
+				xlrec.blkno, xlrec.ntuples
+			);
+		}
+		break;
+#endif
+
 #if PG_VERSION_NUM >= 90000
 		case XLOG_HEAP2_CLEANUP_INFO:
 		{
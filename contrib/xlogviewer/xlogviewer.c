@@ -81,7 +81,7 @@ xlogviewer(PG_FUNCTION_ARGS)
 		"MXACT",					/* 6 */
 		"RM  7",					/* 7 */
 		"RM  8",					/* 8 */
-		"RM  9",					/* 9 */
+		"HEAP2",					/* 9 */
 		"HEAP ",					/* 10 */
 		"BTREE",					/* 11 */
 		"HASH ",					/* 12 */
@@ -542,6 +542,31 @@ getXactName (RmgrId rmid, uint8 info)
 				}
 			}
 			break;
+		case RM_HEAP2_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP2_FREEZE:
+				{
+					return "freeze";
+					break;
+				}
+				case XLOG_HEAP2_CLEAN:
+				{
+					return "clean";
+					break;
+				}
+				case XLOG_HEAP2_CLEAN_MOVE:
+				{
+					return "clean_move";
+					break;
+				}
+				case XLOG_HEAP2_MULTI_INSERT:
+				{
+					return "multi_insert";
+					break;
+				}
+			}
+			break;
 		case RM_HEAP_ID:
 			switch (info & XLOG_HEAP_OPMASK)
 			{
@@ -370,6 +370,7 @@ class GpInjectFaultProgram:
 			      "dtm_broadcast_commit_prepared (inject fault after commit broadcast), " \
 			      "dtm_broadcast_abort_prepared (inject fault after abort broadcast), " \
 			      "dtm_xlog_distributed_commit (inject fault after distributed commit was inserted in xlog), " \
+			      "dtm_qe_onephase_commit (inject fault on a segment after a one-phase commit, before it is acknowledged), " \
 			      "fault_before_pending_delete_relation_entry (inject fault before putting pending delete relation entry, " \
 			      "fault_before_pending_delete_database_entry (inject fault before putting pending delete database entry, " \
 			      "fault_before_pending_delete_tablespace_entry (inject fault before putting pending delete tablespace entry, " \
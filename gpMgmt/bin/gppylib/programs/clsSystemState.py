@@ -55,6 +55,7 @@ CATEGORY__MIRRORING_INFO = "Mirroring Info"
 VALUE__CURRENT_ROLE = FieldDefinition("Current role", "role", "text") # can't use current_role as name -- it's a reserved word
 VALUE__PREFERRED_ROLE = FieldDefinition("Preferred role", "preferred_role", "text")
 VALUE__MIRROR_STATUS = FieldDefinition("Mirror status", "mirror_status", "text")
+VALUE__MIRROR_DATA_SENT = FieldDefinition("Data sent to mirror", "mirror_data_sent_str", "text", "Data sent to mirror")
 
 CATEGORY__ERROR_GETTING_SEGMENT_STATUS = "Error Getting Segment Status"
 VALUE__ERROR_GETTING_SEGMENT_STATUS = FieldDefinition("Error Getting Segment Status", "error_getting_status", "text")
@@ -70,6 +71,7 @@ VALUE__RESYNC_EST_PROGRESS_WITH_MIRROR = FieldDefinition("Estimated resync progr
 VALUE__TOTAL_RESYNC_OBJECT_COUNT = FieldDefinition("Total resync objects", "totalResyncObjectCount", "text", "Total resync objects")
 VALUE__RESYNC_OBJECT_COUNT = FieldDefinition("Objects to resync", "curResyncObjectCount", "text", "Objects to resync")
 VALUE__RESYNC_EST_COMPLETION_TIME = FieldDefinition("Estimated resync end time", "est_resync_end_time_str", "text", "Est. resync end time")
+VALUE__RESYNC_THROUGHPUT = FieldDefinition("Resync throughput", "resync_throughput_str", "text", "Resync throughput")
 
 CATEGORY__STATUS = "Status"
 VALUE__MASTER_REPORTS_STATUS = FieldDefinition("Configuration reports status as", "status_in_config", "text", "Config status")
@@ -137,7 +139,8 @@ class GpStateData:
         self.__entriesByCategory[CATEGORY__MIRRORING_INFO] = \
                 [VALUE__CURRENT_ROLE,
                 VALUE__PREFERRED_ROLE,
-                VALUE__MIRROR_STATUS]
+                VALUE__MIRROR_STATUS,
+                VALUE__MIRROR_DATA_SENT]
 
         self.__entriesByCategory[CATEGORY__ERROR_GETTING_SEGMENT_STATUS] = \
                 [VALUE__ERROR_GETTING_SEGMENT_STATUS]
@@ -152,6 +155,7 @@ class GpStateData:
                 VALUE__RESYNC_EST_PROGRESS_WITH_MIRROR,
                 VALUE__TOTAL_RESYNC_OBJECT_COUNT,
                 VALUE__RESYNC_OBJECT_COUNT,
+                VALUE__RESYNC_THROUGHPUT,
                 VALUE__RESYNC_EST_COMPLETION_TIME]
 
         self.__entriesByCategory[CATEGORY__STATUS] = \
@@ -676,7 +680,7 @@ class GpSystemStateProgram:
             logger.info("Segment Pairs in Resynchronization")
             logSegments(primariesInResync, logAsPairs=True, additionalFieldsToLog=[VALUE__RESYNC_MODE, \
                         VALUE__RESYNC_EST_PROGRESS_WITH_MIRROR, VALUE__TOTAL_RESYNC_OBJECT_COUNT, VALUE__RESYNC_OBJECT_COUNT, VALUE__RESYNC_DATA_SYNCHRONIZED, \
-                        VALUE__RESYNC_EST_TOTAL_DATA, VALUE__RESYNC_EST_COMPLETION_TIME, VALUE__CHANGE_TRACKING_DATA_SIZE])
+                        VALUE__RESYNC_EST_TOTAL_DATA, VALUE__RESYNC_THROUGHPUT, VALUE__RESYNC_EST_COMPLETION_TIME, VALUE__CHANGE_TRACKING_DATA_SIZE])
             exitCode = 1
         else:
             pass # logger.info( "No segment pairs are in resynchronization")
@@ -911,6 +915,14 @@ class GpSystemStateProgram:
 
         mirrorData = primarySegmentData[gp.SEGMENT_STATUS__GET_MIRROR_STATUS]
 
+        #
+        # populate mirroring traffic, as sent and as put on the wire (less when compressed)
+        #
+        if not isMirror and mirrorData is not None and "mirrorBytesSent" in mirrorData:
+            data.addValue(VALUE__MIRROR_DATA_SENT, "%s (%s on the wire)" %
+                    (self.__abbreviateBytes(mirrorData["mirrorBytesSent"]),
+                     self.__abbreviateBytes(mirrorData["mirrorWireBytesSent"])))
+
         #
         # populate change tracking fields
         #
@@ -1001,6 +1013,12 @@ class GpSystemStateProgram:
                 data.addValue(VALUE__RESYNC_OBJECT_COUNT, resyncObjectCountStr)
                 data.addValue(VALUE__RESYNC_OBJECT_COUNT_INT, resyncObjectCount)
 
+                if mirrorData.get("resyncNumCompletedPerSecond", 0) == 0:
+                    resyncThroughputStr = "Not Available"
+                else:
+                    resyncThroughputStr = "%s/s" % self.__abbreviateBytes( mirrorData["resyncNumCompletedPerSecond"] * 32L * 1024 )
+                data.addValue(VALUE__RESYNC_THROUGHPUT, resyncThroughputStr)
+
                 data.addValue(VALUE__RESYNC_EST_COMPLETION_TIME, estimatedEndTimeStr)
                 data.addValue(VALUE__RESYNC_EST_COMPLETION_TIME_TIMESTAMP, estimatedEndTimeTimestamp)
 
@@ -126,6 +126,16 @@ class GpSegStatusProgram:
                 logger.warn("Invalid integer value %s from str %s" % (value, str))
                 return None
 
+        # optional, not reported by older segments
+        for toConvert in ["resyncNumCompletedPerSecond", "mirrorBytesSent", "mirrorWireBytesSent"]:
+            if toConvert not in data:
+                continue
+            try:
+                data[toConvert] = long(data[toConvert])
+            except ValueError:
+                logger.warn("Invalid integer value %s from str %s" % (data[toConvert], str))
+                return None
+
         # convert some to booleans
         for toConvert in ["isFullResync"]:
             if data[toConvert] != "1" and data[toConvert] != "0":
@@ -289,6 +289,7 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	AOTupleId *aoTupleId;
 	int64 tupleCount = 0;
 	int64 tuplePerPage = INT_MAX;
+	int64 eof;
 
 	Assert (Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
 	Assert(RelationIsAoCols(aorel));
@@ -311,6 +312,14 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 			LOG, "Compact AO segfile %d, relation %sd", 
 			compact_segno, relname);
 
+	eof = 0;
+	for (i = 0; i < fsinfo->vpinfo.nEntry; i++)
+	{
+		eof += fsinfo->vpinfo.entry[i].eof;
+	}
+	AppendOnlyCompaction_ReportStart(aorel, compact_segno,
+			fsinfo->total_tupcount, eof);
+
 	proj = palloc0(sizeof(bool) * RelationGetNumberOfAttributes(aorel));
 	for(i=0; i< RelationGetNumberOfAttributes(aorel); ++i)
 	{
@@ -352,6 +361,7 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 				resultRelInfo,
 				estate);
 			movedTupleCount++;
+			AppendOnlyCompaction_ReportTuple(true);
 		}
 		else
 		{
@@ -361,6 +371,7 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 							tuple,
 							slot,
 							mt_bind);
+			AppendOnlyCompaction_ReportTuple(false);
 		}
 
 		/* 
@@ -395,6 +406,8 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		"Finished compaction: "
 		"AO segfile %d, relation %s, moved tuple count " INT64_FORMAT, 
 		compact_segno, relname, movedTupleCount);
+
+	AppendOnlyCompaction_ReportDone();
  
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
@@ -12,6 +12,13 @@
  * the compacted segment files are dropped and the eof/tupcount/varblock
  * information in pg_aoseg_<oid> are reset to 0.
  *
+ * Compaction works on whole segment files, one at a time on each segment:
+ * a file is only rewritten if its share of hidden tuples is above
+ * gp_appendonly_compaction_threshold, and then all of it is. Each backend
+ * publishes the progress of the segment file it compacts (or compacted
+ * last) in a shared array, shown by pg_appendonly_compaction_progress().
+ * That is reporting only; it does not change what is compacted or when.
+ *
  * Copyright (c) 2013, Pivotal.
  *
  *------------------------------------------------------------------------------
@@ -29,6 +36,7 @@
 #include "catalog/catalog.h"
 #include "catalog/indexing.h"
 #include "catalog/pg_appendonly_fn.h"
+#include "catalog/pg_type.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbpersistentfilesysobj.h"
 #include "cdb/cdbmirroredfilesysobj.h"
@@ -36,15 +44,246 @@
 #include "cdb/cdbvars.h"
 #include "commands/vacuum.h"
 #include "executor/executor.h"
+#include "funcapi.h"
 #include "nodes/execnodes.h"
+#include "storage/backendid.h"
+#include "storage/ipc.h"
 #include "storage/procarray.h"
 #include "storage/lmgr.h"
+#include "storage/shmem.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/relcache.h"
 #include "utils/guc.h"
 #include "miscadmin.h"
 
+/*
+ * Progress of the compaction of a segment file by a backend.
+ *
+ * Only the owning backend writes its slot, without locking, so a reader
+ * may see a slightly inconsistent set of counters.
+ */
+typedef struct AppendOnlyCompactionProgress
+{
+	int		pid;			/* 0 if the slot is unused */
+	Oid		relid;
+	int		segno;
+	bool	finished;		/* done with the segment file? */
+	int64	totalTupcount;	/* tuples in the segment file, including
+							 * hidden ones */
+	int64	scannedTupcount;
+	int64	movedTupcount;
+	int64	removedTupcount;
+	int64	eof;			/* bytes in the segment file */
+} AppendOnlyCompactionProgress;
+
+/* One slot per backend, indexed by MyBackendId - 1 */
+static AppendOnlyCompactionProgress *CompactionProgressArray = NULL;
+
+static volatile AppendOnlyCompactionProgress *MyCompactionProgress = NULL;
+
+/*
+ * Report shared-memory space needed by AppendOnlyCompactionShmemInit.
+ */
+Size
+AppendOnlyCompactionShmemSize(void)
+{
+	return mul_size(MaxBackends, sizeof(AppendOnlyCompactionProgress));
+}
+
+/*
+ * Initialize the shared compaction progress array.
+ */
+void
+AppendOnlyCompactionShmemInit(void)
+{
+	bool found;
+
+	CompactionProgressArray = (AppendOnlyCompactionProgress *)
+		ShmemInitStruct("Append-Only Compaction Progress",
+						AppendOnlyCompactionShmemSize(), &found);
+	if (!found)
+	{
+		MemSet(CompactionProgressArray, 0, AppendOnlyCompactionShmemSize());
+	}
+}
+
+static void
+AppendOnlyCompaction_ProgressExit(int code, Datum arg)
+{
+	MyCompactionProgress->pid = 0;
+	MyCompactionProgress = NULL;
+}
+
+/*
+ * Starts reporting the progress of the compaction of a segment file.
+ */
+void
+AppendOnlyCompaction_ReportStart(Relation aorel,
+		int segno,
+		int64 totalTupcount,
+		int64 eof)
+{
+	volatile AppendOnlyCompactionProgress *progress;
+
+	if (CompactionProgressArray == NULL ||
+		MyBackendId <= 0 || MyBackendId > MaxBackends)
+	{
+		return;
+	}
+
+	if (MyCompactionProgress == NULL)
+	{
+		MyCompactionProgress = &CompactionProgressArray[MyBackendId - 1];
+		on_shmem_exit(AppendOnlyCompaction_ProgressExit, 0);
+	}
+	progress = MyCompactionProgress;
+
+	progress->pid = 0;
+	progress->relid = RelationGetRelid(aorel);
+	progress->segno = segno;
+	progress->finished = false;
+	progress->totalTupcount = totalTupcount;
+	progress->scannedTupcount = 0;
+	progress->movedTupcount = 0;
+	progress->removedTupcount = 0;
+	progress->eof = eof;
+	progress->pid = MyProcPid;
+}
+
+/*
+ * Counts a tuple of the segment file being compacted, moved to the insert
+ * segment file or thrown away.
+ */
+void
+AppendOnlyCompaction_ReportTuple(bool moved)
+{
+	volatile AppendOnlyCompactionProgress *progress = MyCompactionProgress;
+
+	if (progress == NULL)
+		return;
+
+	progress->scannedTupcount++;
+	if (moved)
+		progress->movedTupcount++;
+	else
+		progress->removedTupcount++;
+}
+
+/*
+ * Marks the compaction of the segment file as done.
+ */
+void
+AppendOnlyCompaction_ReportDone(void)
+{
+	if (MyCompactionProgress == NULL)
+		return;
+
+	MyCompactionProgress->finished = true;
+}
+
+/* Number of columns produced by pg_appendonly_compaction_progress() */
+#define PG_APPENDONLY_COMPACTION_PROGRESS_COLUMNS 10
+
+/*
+ * pg_appendonly_compaction_progress - produce a view with one row per
+ * backend of this node that compacts, or has compacted, an append-only
+ * segment file.
+ *
+ * The bytes reclaimed are estimated from the share of the tuples thrown
+ * away so far; the space is only given back when the segment file is
+ * dropped, after the compaction transaction.
+ */
+Datum
+pg_appendonly_compaction_progress(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	AppendOnlyCompactionProgress *slots;
+	MemoryContext oldcontext;
+	HeapTuple tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc tupledesc;
+		int i;
+		int n = 0;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch context when allocating stuff to be used in later calls */
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupledesc = CreateTemplateTupleDesc(PG_APPENDONLY_COMPACTION_PROGRESS_COLUMNS, false);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 1, "pid", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 2, "relid", OIDOID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 3, "segno", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 4, "finished", BOOLOID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 5, "total_tupcount", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 6, "scanned_tupcount", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 7, "moved_tupcount", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 8, "removed_tupcount", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 9, "eof", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 10, "reclaimed_bytes", INT8OID, -1, 0);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupledesc);
+
+		slots = (AppendOnlyCompactionProgress *)
+			palloc(sizeof(AppendOnlyCompactionProgress) * MaxBackends);
+		if (CompactionProgressArray != NULL)
+		{
+			for (i = 0; i < MaxBackends; i++)
+			{
+				volatile AppendOnlyCompactionProgress *progress = &CompactionProgressArray[i];
+
+				if (progress->pid != 0)
+					slots[n++] = *((AppendOnlyCompactionProgress *) progress);
+			}
+		}
+
+		funcctx->user_fctx = slots;
+		funcctx->max_calls = n;
+
+		/* Return to original context when allocating transient memory */
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	/* Get the saved state. */
+	slots = (AppendOnlyCompactionProgress *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		AppendOnlyCompactionProgress *slot = &slots[funcctx->call_cntr];
+		Datum values[PG_APPENDONLY_COMPACTION_PROGRESS_COLUMNS];
+		bool nulls[PG_APPENDONLY_COMPACTION_PROGRESS_COLUMNS];
+		int64 reclaimed = 0;
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		if (slot->totalTupcount > 0)
+			reclaimed = (int64) ((double) slot->eof *
+								 slot->removedTupcount / slot->totalTupcount);
+
+		values[0] = Int32GetDatum(slot->pid);
+		values[1] = ObjectIdGetDatum(slot->relid);
+		values[2] = Int32GetDatum(slot->segno);
+		values[3] = BoolGetDatum(slot->finished);
+		values[4] = Int64GetDatum(slot->totalTupcount);
+		values[5] = Int64GetDatum(slot->scannedTupcount);
+		values[6] = Int64GetDatum(slot->movedTupcount);
+		values[7] = Int64GetDatum(slot->removedTupcount);
+		values[8] = Int64GetDatum(slot->eof);
+		values[9] = Int64GetDatum(reclaimed);
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
 /*
  * Drops a segment file.
  *
@@ -363,6 +602,9 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 			LOG, "Compact AO segno %d, relation %s, insert segno %d", 
 			compact_segno, relname, insertDesc->storageWrite.segmentFileNum);
 
+	AppendOnlyCompaction_ReportStart(aorel, compact_segno,
+			fsinfo->total_tupcount, fsinfo->eof);
+
 	/*
 	 * Todo: We need to limit the scan to one file and we need to avoid to
 	 * lock the file again.
@@ -409,6 +651,7 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 							resultRelInfo,
 							estate);
 			movedTupleCount++;
+			AppendOnlyCompaction_ReportTuple(true);
 		}
 		else
 		{
@@ -417,6 +660,7 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 							tuple,
 							slot,
 							mt_bind);
+			AppendOnlyCompaction_ReportTuple(false);
 		}
 
 		/* 
@@ -447,6 +691,8 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		   "AO segfile %d, relation %s, moved tuple count " INT64_FORMAT,
 		   compact_segno, relname, movedTupleCount);
 
+	AppendOnlyCompaction_ReportDone();
+
 	AppendOnlyVisimap_Finish(&visiMap, NoLock);
 
 	ExecCloseIndices(resultRelInfo);
@@ -14,6 +14,10 @@
 #include "access/appendonlytid.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
 #include "access/hash.h"
+#include "access/genam.h"
+#include "catalog/aovisimap.h"
+#include "miscadmin.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 
@@ -71,6 +75,11 @@ static void AppendOnlyVisimap_Find(
 		AppendOnlyVisimap *visiMap,
 		AOTupleId *tupleId);
 
+static bool AppendOnlyVisimap_FindEntry(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum,
+		int64 firstRowNum);
+
 /*
  * Finishes the visimap operations.
  * No other function should be called with the given
@@ -88,6 +97,8 @@ AppendOnlyVisimap_Finish(
 
 	AppendOnlyVisimapStore_Finish(&visiMap->visimapStore, lockmode);
 	AppendOnlyVisimapEntry_Finish(&visiMap->visimapEntry);
+	visiMap->cache.segments = NULL;
+	visiMap->cache.current = NULL;
 
 	MemoryContextDelete(visiMap->memoryContext);
 	visiMap->memoryContext = NULL;
@@ -133,9 +144,365 @@ AppendOnlyVisimap_Init(
 			appendOnlyMetaDataSnapshot,
 			visiMap->memoryContext);
 
+	visiMap->cache.segments = NULL;
+	visiMap->cache.current = NULL;
+	visiMap->cache.size = 0;
+	visiMap->cache.memoryContext = AllocSetContextCreate(
+			visiMap->memoryContext,
+			"VisiMapCacheContext",
+			ALLOCSET_DEFAULT_MINSIZE,
+			ALLOCSET_DEFAULT_INITSIZE,
+			ALLOCSET_DEFAULT_MAXSIZE);
+
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Drops the cached entries of the given segment file, e.g. because
+ * one of its entries has been stored.
+ */
+static void
+AppendOnlyVisimapCache_Invalidate(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum)
+{
+	AppendOnlyVisimapCache *cache = &visiMap->cache;
+	AppendOnlyVisimapSegmentCache *segmentCache;
+
+	if (cache->segments == NULL)
+		return;
+
+	segmentCache = hash_search(cache->segments, &segmentFileNum,
+			HASH_FIND, NULL);
+	if (segmentCache == NULL)
+		return;
+
+	if (segmentCache->memoryContext != NULL)
+		MemoryContextDelete(segmentCache->memoryContext);
+	cache->size -= segmentCache->size;
+	if (cache->current == segmentCache)
+		cache->current = NULL;
+
+	hash_search(cache->segments, &segmentFileNum, HASH_REMOVE, NULL);
+}
+
+/*
+ * Drops the cached entries of all segment files but the given one,
+ * to make room for it within work_mem.
+ */
+static void
+AppendOnlyVisimapCache_InvalidateOthers(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum)
+{
+	AppendOnlyVisimapCache *cache = &visiMap->cache;
+	AppendOnlyVisimapSegmentCache *segmentCache;
+	HASH_SEQ_STATUS status;
+
+	hash_seq_init(&status, cache->segments);
+	while ((segmentCache = hash_seq_search(&status)) != NULL)
+	{
+		if (segmentCache->segmentFileNum != segmentFileNum &&
+			segmentCache->memoryContext != NULL)
+		{
+			/* Removing the current element of a seq scan is allowed */
+			AppendOnlyVisimapCache_Invalidate(visiMap,
+					segmentCache->segmentFileNum);
+		}
+	}
+}
+
+/*
+ * Loads all visibility map entries of the given segment file into
+ * the cache, in their compressed form.
+ *
+ * The entries of all segment files are limited to work_mem. If the
+ * entries of the segment file do not fit, the other segment files
+ * are dropped from the cache. If they still do not fit, the cache of
+ * the segment file is left incomplete and its entries are looked up
+ * one by one.
+ */
+static void
+AppendOnlyVisimapCache_Load(
+		AppendOnlyVisimap *visiMap,
+		AppendOnlyVisimapSegmentCache *segmentCache)
+{
+	AppendOnlyVisimapCache *cache = &visiMap->cache;
+	AppendOnlyVisimapStore *visiMapStore = &visiMap->visimapStore;
+	int32 segmentFileNum = segmentCache->segmentFileNum;
+	TupleDesc tupleDesc;
+	ScanKeyData scanKey;
+	IndexScanDesc indexScan;
+	HeapTuple tuple;
+	MemoryContext oldContext;
+	int maxEntryCount = 16;
+
+	elogif(Debug_appendonly_print_visimap, LOG,
+			"Append-only visi map: Load entries of segment file %d into cache",
+			segmentFileNum);
+
+	segmentCache->memoryContext = AllocSetContextCreate(
+			cache->memoryContext,
+			"VisiMapSegmentCacheContext",
+			ALLOCSET_SMALL_MINSIZE,
+			ALLOCSET_SMALL_INITSIZE,
+			ALLOCSET_DEFAULT_MAXSIZE);
+	oldContext = MemoryContextSwitchTo(segmentCache->memoryContext);
+
+	segmentCache->complete = true;
+	segmentCache->entryCount = 0;
+	segmentCache->size = 0;
+	segmentCache->entries = palloc(maxEntryCount * sizeof(AppendOnlyVisimapCacheEntry));
+
+	tupleDesc = RelationGetDescr(visiMapStore->visimapRelation);
+	ScanKeyInit(&scanKey,
+			Anum_pg_aovisimap_segno, /* segno */
+			BTEqualStrategyNumber,
+			F_INT4EQ,
+			Int32GetDatum(segmentFileNum));
+
+	indexScan = AppendOnlyVisimapStore_BeginScan(visiMapStore, 1, &scanKey);
+	while ((tuple = index_getnext(indexScan, ForwardScanDirection)) != NULL)
+	{
+		AppendOnlyVisimapCacheEntry *cacheEntry;
+		Datum d;
+		bool isNull;
+		long entrySize = sizeof(AppendOnlyVisimapCacheEntry);
+
+		if (segmentCache->entryCount == maxEntryCount)
+		{
+			maxEntryCount *= 2;
+			segmentCache->entries = repalloc(segmentCache->entries,
+					maxEntryCount * sizeof(AppendOnlyVisimapCacheEntry));
+		}
+		cacheEntry = &segmentCache->entries[segmentCache->entryCount];
+
+		d = heap_getattr(tuple, Anum_pg_aovisimap_firstrownum, tupleDesc, &isNull);
+		Assert(!isNull);
+		cacheEntry->firstRowNum = DatumGetInt64(d);
+		Assert(segmentCache->entryCount == 0 ||
+			   segmentCache->entries[segmentCache->entryCount - 1].firstRowNum < cacheEntry->firstRowNum);
+		ItemPointerCopy(&tuple->t_self, &cacheEntry->tupleTid);
+
+		d = heap_getattr(tuple, Anum_pg_aovisimap_visimap, tupleDesc, &isNull);
+		if (isNull)
+		{
+			cacheEntry->data = NULL;
+		}
+		else
+		{
+			struct varlena *value = (struct varlena *) DatumGetPointer(d);
+			struct varlena *detoast_value = pg_detoast_datum(value);
+
+			Assert(APPENDONLY_VISIMAP_DATA_BUFFER_SIZE >= VARSIZE(detoast_value));
+			cacheEntry->data = palloc(VARSIZE(detoast_value));
+			memcpy(cacheEntry->data, detoast_value, VARSIZE(detoast_value));
+			entrySize += VARSIZE(detoast_value);
+
+			if (detoast_value != value)
+				pfree(detoast_value);
+		}
+		segmentCache->entryCount++;
+		segmentCache->size += entrySize;
+		cache->size += entrySize;
+
+		if (cache->size > work_mem * 1024L &&
+			cache->size > segmentCache->size)
+		{
+			AppendOnlyVisimapCache_InvalidateOthers(visiMap, segmentFileNum);
+		}
+		if (cache->size > work_mem * 1024L)
+		{
+			elogif(Debug_appendonly_print_visimap, LOG,
+					"Append-only visi map: Entries of segment file %d "
+					"do not fit into the cache", segmentFileNum);
+			segmentCache->complete = false;
+			break;
+		}
+	}
+	AppendOnlyVisimapStore_EndScan(visiMapStore, indexScan);
+
+	MemoryContextSwitchTo(oldContext);
+
+	if (!segmentCache->complete)
+	{
+		/* Keep the incomplete entry, so that the load is not repeated */
+		MemoryContextDelete(segmentCache->memoryContext);
+		segmentCache->memoryContext = NULL;
+		segmentCache->entries = NULL;
+		segmentCache->entryCount = 0;
+		cache->size -= segmentCache->size;
+		segmentCache->size = 0;
+	}
+}
+
+/*
+ * Returns the index of the first cached entry with a first row number
+ * greater than or equal to the given one; entryCount if there is none.
+ */
+static int
+AppendOnlyVisimapCache_Search(
+		AppendOnlyVisimapSegmentCache *segmentCache,
+		int64 firstRowNum)
+{
+	int low = 0;
+	int high = segmentCache->entryCount;
+
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+
+		if (segmentCache->entries[middle].firstRowNum < firstRowNum)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+/*
+ * Returns the cached entries of the given segment file, loading them
+ * if they are not cached yet. Returns NULL if they could not be cached.
+ */
+static AppendOnlyVisimapSegmentCache *
+AppendOnlyVisimapCache_Prepare(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum)
+{
+	AppendOnlyVisimapCache *cache = &visiMap->cache;
+	AppendOnlyVisimapSegmentCache *segmentCache = cache->current;
+	bool found;
+
+	if (segmentCache == NULL || segmentCache->segmentFileNum != segmentFileNum)
+	{
+		if (cache->segments == NULL)
+		{
+			HASHCTL hash_ctl;
+
+			MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+			hash_ctl.keysize = sizeof(int32);
+			hash_ctl.entrysize = sizeof(AppendOnlyVisimapSegmentCache);
+			hash_ctl.hash = tag_hash;
+			hash_ctl.hcxt = cache->memoryContext;
+			cache->segments = hash_create("VisimapSegmentCache",
+				4, /* start small and extend */
+				&hash_ctl,
+				HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+		}
+
+		segmentCache = hash_search(cache->segments, &segmentFileNum,
+				HASH_ENTER, &found);
+		if (!found)
+		{
+			segmentCache->memoryContext = NULL;
+			segmentCache->size = 0;
+			AppendOnlyVisimapCache_Load(visiMap, segmentCache);
+		}
+		cache->current = segmentCache;
+	}
+	return segmentCache->complete ? segmentCache : NULL;
+}
+
+/*
+ * Positions the visibility map entry on the stored entry with the given
+ * segment file and first row number, taking it from the cache if
+ * possible.
+ *
+ * Returns false if there is no such entry.
+ */
+static bool
+AppendOnlyVisimap_FindEntry(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum,
+		int64 firstRowNum)
+{
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	AppendOnlyVisimapSegmentCache *segmentCache;
+	AppendOnlyVisimapCacheEntry *cacheEntry;
+	MemoryContext oldContext;
+	int i;
+
+	segmentCache = AppendOnlyVisimapCache_Prepare(visiMap, segmentFileNum);
+	if (segmentCache == NULL)
+	{
+		return AppendOnlyVisimapStore_Find(&visiMap->visimapStore,
+				segmentFileNum,
+				firstRowNum,
+				visiMapEntry);
+	}
+
+	i = AppendOnlyVisimapCache_Search(segmentCache, firstRowNum);
+	if (i == segmentCache->entryCount ||
+		segmentCache->entries[i].firstRowNum != firstRowNum)
+	{
+		return false;
+	}
+	cacheEntry = &segmentCache->entries[i];
+
+	Assert(!visiMapEntry->dirty);
+	visiMapEntry->segmentFileNum = segmentFileNum;
+	visiMapEntry->firstRowNum = firstRowNum;
+	ItemPointerCopy(&cacheEntry->tupleTid, &visiMapEntry->tupleTid);
+
+	if (cacheEntry->data == NULL)
+	{
+		bms_free(visiMapEntry->bitmap);
+		visiMapEntry->bitmap = NULL;
+	}
+	else
+	{
+		memcpy(visiMapEntry->data, cacheEntry->data, VARSIZE(cacheEntry->data));
+
+		oldContext = MemoryContextSwitchTo(visiMapEntry->memoryContext);
+		AppendOnlyVisiMapEnty_ReadData(visiMapEntry,
+				VARSIZE(cacheEntry->data) - offsetof(AppendOnlyVisimapData, data));
+		MemoryContextSwitchTo(oldContext);
+	}
+	return true;
+}
+
+/*
+ * Checks if all rows in the given range of a segment file are visible
+ * according to the visibility map, so that the rows need not be
+ * checked one by one.
+ *
+ * A false result only means that some rows of the range may be hidden.
+ */
+bool
+AppendOnlyVisimap_IsRangeVisible(
+		AppendOnlyVisimap *visiMap,
+		int32 segmentFileNum,
+		int64 firstRowNum,
+		int64 rowCount)
+{
+	AppendOnlyVisimapSegmentCache *segmentCache;
+	int64 lastRowNum = firstRowNum + rowCount - 1;
+	int i;
+
+	Assert(visiMap);
+
+	if (rowCount <= 0)
+		return true;
+
+	/* The current entry may have changes not in the cache */
+	if (AppendOnlyVisimapEntry_HasChanged(&visiMap->visimapEntry))
+		return false;
+
+	segmentCache = AppendOnlyVisimapCache_Prepare(visiMap, segmentFileNum);
+	if (segmentCache == NULL)
+		return false;
+
+	i = AppendOnlyVisimapCache_Search(segmentCache,
+			(firstRowNum / APPENDONLY_VISIMAP_MAX_RANGE) * APPENDONLY_VISIMAP_MAX_RANGE);
+	for (; i < segmentCache->entryCount &&
+			segmentCache->entries[i].firstRowNum <= lastRowNum; i++)
+	{
+		if (segmentCache->entries[i].data != NULL)
+			return false;
+	}
+	return true;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -159,11 +526,10 @@ AppendOnlyVisimap_Find(
 			"(tupleId) = %s", 
 			AOTupleIdToString(aoTupleId)); 
 
-	if (!AppendOnlyVisimapStore_Find(&visiMap->visimapStore,
+	if (!AppendOnlyVisimap_FindEntry(visiMap,
 				AOTupleIdGet_segmentFileNum(aoTupleId),
 				AppendOnlyVisimapEntry_GetFirstRowNum(
-					&visiMap->visimapEntry, aoTupleId),
-				&visiMap->visimapEntry))
+					&visiMap->visimapEntry, aoTupleId)))
 	{
 		/*
 		 * There is no entry that covers the given tuple id.
@@ -227,7 +593,10 @@ AppendOnlyVisimap_Store(
 	Assert(AppendOnlyVisimapEntry_IsValid(&visiMap->visimapEntry));
 
 	AppendOnlyVisimapStore_Store(&visiMap->visimapStore, &visiMap->visimapEntry);
-	
+
+	/* The cached entries of the segment file are stale now */
+	AppendOnlyVisimapCache_Invalidate(visiMap,
+			visiMap->visimapEntry.segmentFileNum);
 }
 
 /*
@@ -245,6 +614,7 @@ AppendOnlyVisimap_DeleteSegmentFile(
 
 	AppendOnlyVisimapStore_DeleteSegmentFile(&visiMap->visimapStore,
 			segno);
+	AppendOnlyVisimapCache_Invalidate(visiMap, segno);
 }
 
 /*
@@ -579,11 +949,10 @@ AppendOnlyVisimapDelete_Find(
 	}
 	else
 	{
-		if (!AppendOnlyVisimapStore_Find(&visiMap->visimapStore,
+		if (!AppendOnlyVisimap_FindEntry(visiMap,
 					AOTupleIdGet_segmentFileNum(aoTupleId),
 					AppendOnlyVisimapEntry_GetFirstRowNum(
-						&visiMap->visimapEntry, aoTupleId),
-					&visiMap->visimapEntry))
+						&visiMap->visimapEntry, aoTupleId)))
 		{
 			/*
 			 * There is no entry that covers the given tuple id.
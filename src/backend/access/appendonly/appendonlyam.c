@@ -201,6 +201,7 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 	Relation		reln = scan->aos_rd;
 	int				segno = -1;
 	int64			eof = 0;
+	int64			startOffset = 0;
 	bool			finished_all_files = true; /* assume */
 	int32			fileSegNo;
 
@@ -277,9 +278,15 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 		FileSegInfo *fsinfo = scan->aos_segfile_arr[scan->aos_segfiles_processed];
 		segno = fsinfo->segno;
 		eof = (int64)fsinfo->eof;
+		startOffset = (scan->aos_segfile_startoffset != NULL ?
+					   scan->aos_segfile_startoffset[scan->aos_segfiles_processed] : 0);
 
 		scan->aos_segfiles_processed++;
 
+		/* Nothing was appended after the offset we were asked to start at */
+		if (startOffset >= eof)
+			continue;
+
 		/*
 		 * special case: we are the QD reading from an AO table in utility mode
 		 * (gp_dump). We see entries in the aoseg table but no files or data
@@ -346,6 +353,17 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 						scan->aos_filenamepath,
 						eof);
 
+	/*
+	 * The start offset is the EOF of an earlier transaction, hence the
+	 * beginning of a block. The blocks carry their first row numbers, so
+	 * the visibility map still works for the rows after it.
+	 */
+	if (startOffset > 0)
+		AppendOnlyStorageRead_SetTemporaryRange(
+							&scan->storageRead,
+							startOffset,
+							eof);
+
 	AppendOnlyExecutionReadBlock_SetSegmentFileNum(
 								&scan->executorReadBlock,
 								segno);
@@ -1271,6 +1289,17 @@ getNextBlock(
 	AppendOnlyExecutorReadBlock_GetContents(
 									&scan->executorReadBlock);
 
+	/*
+	 * Most blocks have no deleted rows; then don't check the rows of the
+	 * block one by one.
+	 */
+	scan->blockAllVisible =
+		(scan->snapshot == SnapshotAny ||
+		 AppendOnlyVisimap_IsRangeVisible(&scan->visibilityMap,
+										  scan->executorReadBlock.segmentFileNum,
+										  scan->executorReadBlock.blockFirstRowNum,
+										  scan->executorReadBlock.rowCount));
+
 	return true;
 }
 
@@ -1331,7 +1360,8 @@ appendonlygettup(AppendOnlyScanDesc scan,
 			 * Need to get the Block Directory entry that covers the TID.
 			 */
 			AOTupleId *aoTupleId = (AOTupleId*)slot_get_ctid(slot);
-			if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
+			if (!isSnapshotAny && !scan->blockAllVisible &&
+				!AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
 			{
 				/*
 				 * The tuple is invisible.
@@ -1711,6 +1741,38 @@ appendonly_beginscan(Relation relation,
 		keys);
 }
 
+/*
+ * appendonly_beginscan_from_offsets
+ *
+ * Begins a scan of the rows stored after the given offset of each segment
+ * file, e.g. the rows appended since an earlier EOF was recorded. The
+ * offsets are aligned with seginfo, and must be EOFs of earlier
+ * transactions.
+ *
+ * The ownership of the seginfos and offsets is transferred to the scan
+ * descriptor.
+ */
+AppendOnlyScanDesc
+appendonly_beginscan_from_offsets(Relation relation,
+		Snapshot snapshot,
+		Snapshot appendOnlyMetaDataSnapshot,
+		FileSegInfo **seginfo, int segfile_count,
+		int64 *startOffsets)
+{
+	AppendOnlyScanDesc scan;
+
+	scan = appendonly_beginrangescan_internal(relation,
+		snapshot,
+		appendOnlyMetaDataSnapshot,
+		seginfo,
+		segfile_count,
+		0,
+		NULL);
+	scan->aos_segfile_startoffset = startOffsets;
+
+	return scan;
+}
+
 /* ----------------
  *		appendonly_rescan		- restart a relation scan
  *
@@ -1764,6 +1826,9 @@ appendonly_endscan(AppendOnlyScanDesc scan)
 		pfree(scan->aos_segfile_arr);
 	}
 
+	if (scan->aos_segfile_startoffset)
+		pfree(scan->aos_segfile_startoffset);
+
 	CloseScannedFileSeg(scan);
 
 	AppendOnlyStorageRead_FinishSession(&scan->storageRead);
@@ -19,6 +19,7 @@ test__AppendOnlyVisimapDelete_Finish_outoforder(void **state)
 	AppendOnlyVisimap visiMap;
 	bool found;
 	visiMapDelete.visiMap = &visiMap;
+	visiMap.cache.segments = NULL;
 	visiMap.visimapEntry.segmentFileNum = 2;
 	visiMap.visimapEntry.firstRowNum = 32768;
 	visiMap.visimapEntry.dirty = true;
@@ -64,6 +65,88 @@ test__AppendOnlyVisimapDelete_Finish_outoforder(void **state)
 	assert_int_equal(val.workFileOffset, INT64_MAX);
 }
 
+/*
+ * Tests that a range of rows is only reported as all visible if no
+ * cached visimap entry covering it has hidden rows.
+ */
+void
+test__AppendOnlyVisimap_IsRangeVisible(void **state)
+{
+	AppendOnlyVisimap visiMap;
+	AppendOnlyVisimapData data;
+	AppendOnlyVisimapCacheEntry entries[3] = {
+		{0, NULL},
+		{32768, &data},
+		{3 * 32768, NULL}
+	};
+	AppendOnlyVisimapSegmentCache segmentCache;
+
+	segmentCache.segmentFileNum = 1;
+	segmentCache.complete = true;
+	segmentCache.entries = entries;
+	segmentCache.entryCount = 3;
+	visiMap.cache.current = &segmentCache;
+
+	expect_value_count(AppendOnlyVisimapEntry_HasChanged, visiMapEntry,
+					   &visiMap.visimapEntry, 5);
+	will_return_count(AppendOnlyVisimapEntry_HasChanged, false, 5);
+
+	/* Entry without hidden rows */
+	assert_true(AppendOnlyVisimap_IsRangeVisible(&visiMap, 1, 100, 100));
+	/* Overlaps the entry with hidden rows */
+	assert_false(AppendOnlyVisimap_IsRangeVisible(&visiMap, 1, 32000, 1000));
+	assert_false(AppendOnlyVisimap_IsRangeVisible(&visiMap, 1, 40000, 10));
+	/* No entry at all */
+	assert_true(AppendOnlyVisimap_IsRangeVisible(&visiMap, 1, 2 * 32768, 32768));
+	assert_true(AppendOnlyVisimap_IsRangeVisible(&visiMap, 1, 5 * 32768, 100));
+}
+
+/*
+ * Tests that storing an entry only drops the cached entries of its
+ * own segment file.
+ */
+void
+test__AppendOnlyVisimap_Store_InvalidatesSegmentFile(void **state)
+{
+	AppendOnlyVisimap visiMap;
+	AppendOnlyVisimapSegmentCache segmentCache;
+	int dummy;
+	HTAB *segments = (HTAB *) &dummy;
+
+	segmentCache.segmentFileNum = 1;
+	segmentCache.complete = true;
+	segmentCache.entries = NULL;
+	segmentCache.entryCount = 0;
+	segmentCache.size = 100;
+	segmentCache.memoryContext = NULL;
+	visiMap.cache.segments = segments;
+	visiMap.cache.current = &segmentCache;
+	visiMap.cache.size = 300;
+	visiMap.visimapEntry.segmentFileNum = 2;
+
+#ifdef USE_ASSERT_CHECKING
+	expect_any(AppendOnlyVisimapEntry_IsValid, visiMapEntry);
+	will_return(AppendOnlyVisimapEntry_IsValid, true);
+#endif
+
+	expect_any(AppendOnlyVisimapStore_Store, visiMapStore);
+	expect_any(AppendOnlyVisimapStore_Store, visiMapEntry);
+	will_be_called(AppendOnlyVisimapStore_Store);
+
+	/* Only segment file 2 is looked up and removed */
+	expect_value(hash_search, hashp, segments);
+	expect_memory(hash_search, keyPtr, &visiMap.visimapEntry.segmentFileNum,
+				  sizeof(int32));
+	expect_value(hash_search, action, HASH_FIND);
+	expect_any(hash_search, foundPtr);
+	will_return(hash_search, NULL);
+
+	AppendOnlyVisimap_Store(&visiMap);
+
+	/* The cache of segment file 1 is kept */
+	assert_true(visiMap.cache.current == &segmentCache);
+	assert_int_equal(visiMap.cache.size, 300);
+}
 
 int 
 main(int argc, char* argv[]) 
@@ -71,7 +154,9 @@ main(int argc, char* argv[])
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-			unit_test(test__AppendOnlyVisimapDelete_Finish_outoforder)
+			unit_test(test__AppendOnlyVisimapDelete_Finish_outoforder),
+			unit_test(test__AppendOnlyVisimap_IsRangeVisible),
+			unit_test(test__AppendOnlyVisimap_Store_InvalidatesSegmentFile)
 	};
 
 	MemoryContextInit();
@@ -588,7 +588,7 @@ MarkAsPreparing(TransactionId xid,
 	gxact->proc.serializableIsoLevel = false;
 	gxact->proc.inDropTransaction = false;
 	gxact->proc.lwWaiting = false;
-	gxact->proc.lwExclusive = false;
+	gxact->proc.lwWaitMode = 0;
 	gxact->proc.lwWaitLink = NULL;
 	gxact->proc.waitLock = NULL;
 	gxact->proc.waitProcLock = NULL;
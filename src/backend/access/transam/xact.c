@@ -54,6 +54,7 @@
 #include "utils/inval.h"
 #include "utils/memutils.h"
 #include "utils/relcache.h"
+#include "utils/resgroup.h"
 #include "utils/resscheduler.h"
 #include "utils/sharedsnapshot.h"
 #include "access/distributedlog.h"
@@ -1042,6 +1043,7 @@ RecordTransactionCommit(void)
 	int			nchildren;
 	TransactionId *children;
 	bool		isDtxPrepared = 0;
+	bool		isOnePhaseCommit;
 	bool		omitCommitRecordForDirtyQEReader;
 	TMGXACT_LOG gxact_log;
 	XLogRecPtr	recptr = {0,0};
@@ -1071,6 +1073,7 @@ RecordTransactionCommit(void)
 	nchildren = xactGetCommittedChildren(&children);
 
 	isDtxPrepared = isPreparedDtxTransaction();
+	isOnePhaseCommit = isQEOnePhaseCommit();
 	omitCommitRecordForDirtyQEReader = false;
 	if (markXidCommitted)
 	{
@@ -1200,9 +1203,12 @@ RecordTransactionCommit(void)
 			lastrdata = 2;
 		}
 		/* add global transaction information */
-		if (isDtxPrepared)
+		if (isDtxPrepared || isOnePhaseCommit)
 		{
-			getDtxLogInfo(&gxact_log);
+			if (isDtxPrepared)
+				getDtxLogInfo(&gxact_log);
+			else
+				getQEOnePhaseCommitLogInfo(&gxact_log);
 
 			rdata[lastrdata].next = &(rdata[3]);
 			rdata[3].data = (char *) &gxact_log;
@@ -1220,6 +1226,14 @@ RecordTransactionCommit(void)
 
 			insertedDistributedCommitted();
 		}
+		else if (isOnePhaseCommit)
+		{
+			/*
+			 * Like a distributed commit record, it carries the gxid, so that
+			 * redo puts the transaction back in the distributed log.
+			 */
+			recptr = XLogInsert(RM_XACT_ID, XLOG_XACT_ONEPHASE_COMMIT, rdata);
+		}
 		else
 		{
 			recptr = XLogInsert(RM_XACT_ID, XLOG_XACT_COMMIT, rdata);
@@ -1253,25 +1267,19 @@ RecordTransactionCommit(void)
 	 * the files before the COMMIT record is flushed to disk.  We do allow
 	 * asynchronous commit if all to-be-deleted tables are temporary though,
 	 * since they are lost anyway if we crash.)
+	 *
+	 * A QE committing a distributed transaction in one phase stands in for
+	 * COMMIT PREPARED, so it must not be asynchronous either: the QD reports
+	 * the commit as soon as we acknowledge it.
 	 */
-	if (XactSyncCommit || forceSyncCommit || haveNonTemp)
+	if (XactSyncCommit || forceSyncCommit || haveNonTemp || isOnePhaseCommit)
 	{
 		/*
 		 * Synchronous commit case.
 		 *
-		 * Sleep before flush! So we can flush more than one commit records
-		 * per single fsync.  (The idea is some other backend may do the
-		 * XLogFlush while we're sleeping.  This needs work still, because on
-		 * most Unixen, the minimum select() delay is 10msec or more, which is
-		 * way too long.)
-		 *
-		 * We do not sleep if enableFsync is not turned on, nor if there are
-		 * fewer than CommitSiblings other backends with active transactions.
+		 * XLogFlush batches our commit record with those of the concurrent
+		 * committers into one fsync (group commit).
 		 */
-		if (CommitDelay > 0 && enableFsync &&
-			CountActiveBackends() >= CommitSiblings)
-			pg_usleep(CommitDelay);
-
 		XLogFlush(recptr);
 
 #ifdef FAULT_INJECTOR
@@ -1312,6 +1320,12 @@ RecordTransactionCommit(void)
 										getDtxStartTime(),
 										getDistributedTransactionId(),
 										/* isRedo */ false);
+			else if (isOnePhaseCommit)
+				DistributedLog_SetCommitted(
+										xid,
+										MyProc->localDistribXactData.distribTimeStamp,
+										MyProc->localDistribXactData.distribXid,
+										/* isRedo */ false);
 
 			TransactionIdCommit(xid);
 			/* to avoid race conditions, the parent must commit first */
@@ -3353,6 +3367,9 @@ CommitTransaction(void)
 	if (Gp_role == GP_ROLE_DISPATCH && ResourceScheduler)
 		AtCommit_ResScheduler();
 
+	/* Leave the resource group of this transaction */
+	AtEOXact_ResGroup();
+
 	/* Perform any AO table commit processing */
 	AtCommit_AppendOnly();
 
@@ -3676,6 +3693,9 @@ PrepareTransaction(void)
 
 	AtEOXact_SharedSnapshot();
 
+	/* Leave the resource group of this transaction */
+	AtEOXact_ResGroup();
+
 	/*
 	 * Let ON COMMIT management do its thing (must happen after closing
 	 * cursors, to avoid dangling-reference problems)
@@ -3979,6 +3999,9 @@ AbortTransaction(void)
 	/* Perform any Resource Scheduler abort procesing. */
 	if (Gp_role == GP_ROLE_DISPATCH && ResourceScheduler)
 		AtAbort_ResScheduler();
+
+	/* Leave the resource group of this transaction */
+	AtEOXact_ResGroup();
 		
 	/* Perform any AO table abort processing */
 	AtAbort_AppendOnly();
@@ -5956,6 +5979,16 @@ ExecutorMarkTransactionUsesSequences(void)
 	ForceSyncCommit();
 }
 
+/*
+ * Has the current transaction written any XLOG here, directly or through
+ * the sequence server?
+ */
+bool
+TransactionDidWriteXLog(void)
+{
+	return XactLastRecEnd.xrecoff != 0 || seqXlogWrite;
+}
+
 void 
 ExecutorMarkTransactionDoesWrites(void)
 {
@@ -6673,8 +6706,12 @@ xact_redo_commit(xl_xact_commit *xlrec, TransactionId xid)
 	}
 }
 
+/*
+ * Redo a distributed commit record, or the one-phase commit record of a
+ * segment.  Both carry the gxid; only the former has a gxact to restore.
+ */
 static void
-xact_redo_distributed_commit(xl_xact_commit *xlrec, TransactionId xid)
+xact_redo_distributed_commit(xl_xact_commit *xlrec, TransactionId xid, bool isOnePhase)
 {
 	TMGXACT_LOG *gxact_log;
 	
@@ -6777,7 +6814,8 @@ xact_redo_distributed_commit(xl_xact_commit *xlrec, TransactionId xid)
 	/*
 	 * End copy of xact_redo_commit logic.
 	 */
-	redoDistributedCommitRecord(gxact_log);
+	if (!isOnePhase)
+		redoDistributedCommitRecord(gxact_log);
 }
 
 static void
@@ -6869,7 +6907,13 @@ xact_redo(XLogRecPtr beginLoc __attribute__((unused)), XLogRecPtr lsn __attribut
 	{
 		xl_xact_commit *xlrec = (xl_xact_commit *) XLogRecGetData(record);
 
-		xact_redo_distributed_commit(xlrec, record->xl_xid);
+		xact_redo_distributed_commit(xlrec, record->xl_xid, /* isOnePhase */ false);
+	}
+	else if (info == XLOG_XACT_ONEPHASE_COMMIT)
+	{
+		xl_xact_commit *xlrec = (xl_xact_commit *) XLogRecGetData(record);
+
+		xact_redo_distributed_commit(xlrec, record->xl_xid, /* isOnePhase */ true);
 	}
 	else if (info == XLOG_XACT_DISTRIBUTED_FORGET)
 	{
@@ -7001,7 +7045,8 @@ xact_redo_get_info(
 		*infoKind = XACT_INFOKIND_ABORT;
 		*xid = xlrec->xid;
 	}
-	else if (info == XLOG_XACT_DISTRIBUTED_COMMIT)
+	else if (info == XLOG_XACT_DISTRIBUTED_COMMIT ||
+			 info == XLOG_XACT_ONEPHASE_COMMIT)
 	{
 		xl_xact_commit *xlrec = (xl_xact_commit *) XLogRecGetData(record);
 
@@ -7206,6 +7251,13 @@ xact_desc(StringInfo buf, XLogRecPtr beginLoc, XLogRecord *record)
 		appendStringInfo(buf, "distributed commit ");
 		xact_desc_distributed_commit(buf, xlrec);
 	}
+	else if (info == XLOG_XACT_ONEPHASE_COMMIT)
+	{
+		xl_xact_commit *xlrec = (xl_xact_commit *) rec;
+
+		appendStringInfo(buf, "one-phase commit ");
+		xact_desc_distributed_commit(buf, xlrec);
+	}
 	else if (info == XLOG_XACT_DISTRIBUTED_FORGET)
 	{
 		xl_xact_distributed_forget *xlrec = (xl_xact_distributed_forget *) rec;
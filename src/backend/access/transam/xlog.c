@@ -375,6 +375,15 @@ typedef struct XLogCtlData
 	uint32		lastRemovedLog; /* latest removed/recycled XLOG segment */
 	uint32		lastRemovedSeg;
 
+	/*
+	 * Group commit statistics.  flushRequests counts the XLogFlush calls that
+	 * had to wait for a flush, and flushes the fsyncs done for them, so
+	 * flushRequests / flushes is the average batch size.
+	 */
+	uint64		flushRequests;
+	uint64		flushes;
+	uint64		flushedBytes;
+
 	/* Protected by WALWriteLock: */
 	XLogCtlWrite Write;
 
@@ -2221,6 +2230,7 @@ XLogFlush(XLogRecPtr record)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
+	bool		counted = false;
 
 	/* Disabled during REDO */
 	if (InRedo)
@@ -2257,51 +2267,105 @@ XLogFlush(XLogRecPtr record)
 	/* initialize to given target; may increase below */
 	WriteRqstPtr = record;
 
-	/* read LogwrtResult and update local state */
+	/*
+	 * Now wait until we get the write lock, or someone else does the flush
+	 * for us.
+	 */
+	for (;;)
 	{
-		/* use volatile pointer to prevent code rearrangement */
-		volatile XLogCtlData *xlogctl = XLogCtl;
+		XLogRecPtr	startFlush;
 
-		SpinLockAcquire(&xlogctl->info_lck);
-		if (XLByteLT(WriteRqstPtr, xlogctl->LogwrtRqst.Write))
-			WriteRqstPtr = xlogctl->LogwrtRqst.Write;
-		LogwrtResult = xlogctl->LogwrtResult;
-		SpinLockRelease(&xlogctl->info_lck);
-	}
+		/* read LogwrtResult and update local state */
+		{
+			/* use volatile pointer to prevent code rearrangement */
+			volatile XLogCtlData *xlogctl = XLogCtl;
 
-	/* done already? */
-	if (!XLByteLE(record, LogwrtResult.Flush))
-	{
-		/* now wait for the write lock */
-		LWLockAcquire(WALWriteLock, LW_EXCLUSIVE);
+			SpinLockAcquire(&xlogctl->info_lck);
+			if (XLByteLT(WriteRqstPtr, xlogctl->LogwrtRqst.Write))
+				WriteRqstPtr = xlogctl->LogwrtRqst.Write;
+			LogwrtResult = xlogctl->LogwrtResult;
+			if (!counted && !XLByteLE(record, LogwrtResult.Flush))
+			{
+				xlogctl->flushRequests++;
+				counted = true;
+			}
+			SpinLockRelease(&xlogctl->info_lck);
+		}
+
+		/* done already? */
+		if (XLByteLE(record, LogwrtResult.Flush))
+			break;
+
+		/*
+		 * Try to get the write lock. If we can't get it immediately, wait
+		 * until it's released, and recheck if we still need to do the flush
+		 * or if the backend that held the lock did it for us already.  This
+		 * is what batches the commit records of concurrent committers into
+		 * one fsync, when the system is bottlenecked by the speed of fsync.
+		 */
+		if (!LWLockAcquireOrWait(WALWriteLock, LW_EXCLUSIVE))
+			continue;
+
+		/* Got the lock; recheck whether request is satisfied */
 		LogwrtResult = XLogCtl->Write.LogwrtResult;
-		if (!XLByteLE(record, LogwrtResult.Flush))
+		if (XLByteLE(record, LogwrtResult.Flush))
 		{
-			/* try to write/flush later additions to XLOG as well */
-			if (LWLockConditionalAcquire(WALInsertLock, LW_EXCLUSIVE))
-			{
-				XLogCtlInsert *Insert = &XLogCtl->Insert;
-				uint32		freespace = INSERT_FREESPACE(Insert);
+			LWLockRelease(WALWriteLock);
+			break;
+		}
 
-				if (freespace < SizeOfXLogRecord)		/* buffer is full */
-					WriteRqstPtr = XLogCtl->xlblocks[Insert->curridx];
-				else
-				{
-					WriteRqstPtr = XLogCtl->xlblocks[Insert->curridx];
-					WriteRqstPtr.xrecoff -= freespace;
-				}
-				LWLockRelease(WALInsertLock);
-				WriteRqst.Write = WriteRqstPtr;
-				WriteRqst.Flush = WriteRqstPtr;
-			}
+		/*
+		 * Sleep before flush!  By adding a delay here, we may give further
+		 * backends the opportunity to join the backlog of group commit
+		 * followers; this can improve transaction throughput, at the risk of
+		 * increasing transaction latency.
+		 *
+		 * We do not sleep if enableFsync is not turned on, nor if there are
+		 * fewer than CommitSiblings other backends with active transactions.
+		 */
+		if (CommitDelay > 0 && enableFsync &&
+			CountActiveBackends() >= CommitSiblings)
+			pg_usleep(CommitDelay);
+
+		/* try to write/flush later additions to XLOG as well */
+		if (LWLockConditionalAcquire(WALInsertLock, LW_EXCLUSIVE))
+		{
+			XLogCtlInsert *Insert = &XLogCtl->Insert;
+			uint32		freespace = INSERT_FREESPACE(Insert);
+
+			if (freespace < SizeOfXLogRecord)		/* buffer is full */
+				WriteRqstPtr = XLogCtl->xlblocks[Insert->curridx];
 			else
 			{
-				WriteRqst.Write = WriteRqstPtr;
-				WriteRqst.Flush = record;
+				WriteRqstPtr = XLogCtl->xlblocks[Insert->curridx];
+				WriteRqstPtr.xrecoff -= freespace;
 			}
-			XLogWrite(WriteRqst, false, false);
+			LWLockRelease(WALInsertLock);
+			WriteRqst.Write = WriteRqstPtr;
+			WriteRqst.Flush = WriteRqstPtr;
+		}
+		else
+		{
+			WriteRqst.Write = WriteRqstPtr;
+			WriteRqst.Flush = record;
+		}
+		startFlush = LogwrtResult.Flush;
+		XLogWrite(WriteRqst, false, false);
+
+		{
+			/* use volatile pointer to prevent code rearrangement */
+			volatile XLogCtlData *xlogctl = XLogCtl;
+
+			SpinLockAcquire(&xlogctl->info_lck);
+			xlogctl->flushes++;
+			xlogctl->flushedBytes += XLogRecPtrToBytePos(LogwrtResult.Flush) -
+				XLogRecPtrToBytePos(startFlush);
+			SpinLockRelease(&xlogctl->info_lck);
 		}
+
 		LWLockRelease(WALWriteLock);
+		/* done */
+		break;
 	}
 
 	END_CRIT_SECTION();
@@ -10578,6 +10642,52 @@ pg_current_xlog_location(PG_FUNCTION_ARGS __attribute__((unused)) )
 	PG_RETURN_TEXT_P(result);
 }
 
+/*
+ * Report the group commit statistics of XLogFlush: the flush requests that
+ * had to wait, the flushes done for them, and the bytes flushed.
+ */
+Datum
+pg_stat_get_xlog_flush(PG_FUNCTION_ARGS __attribute__((unused)) )
+{
+	/* use volatile pointer to prevent code rearrangement */
+	volatile XLogCtlData *xlogctl = XLogCtl;
+	uint64		flushRequests;
+	uint64		flushes;
+	uint64		flushedBytes;
+	Datum		values[3];
+	bool		isnull[3];
+	TupleDesc	resultTupleDesc;
+	HeapTuple	resultHeapTuple;
+
+	SpinLockAcquire(&xlogctl->info_lck);
+	flushRequests = xlogctl->flushRequests;
+	flushes = xlogctl->flushes;
+	flushedBytes = xlogctl->flushedBytes;
+	SpinLockRelease(&xlogctl->info_lck);
+
+	/*
+	 * Construct a tuple descriptor for the result row.  This must match this
+	 * function's pg_proc entry!
+	 */
+	resultTupleDesc = CreateTemplateTupleDesc(3, false);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 1, "flush_requests",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 2, "flushes",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(resultTupleDesc, (AttrNumber) 3, "flushed_bytes",
+					   INT8OID, -1, 0);
+	resultTupleDesc = BlessTupleDesc(resultTupleDesc);
+
+	values[0] = Int64GetDatum((int64) flushRequests);
+	values[1] = Int64GetDatum((int64) flushes);
+	values[2] = Int64GetDatum((int64) flushedBytes);
+	MemSet(isnull, false, sizeof(isnull));
+
+	resultHeapTuple = heap_form_tuple(resultTupleDesc, values, isnull);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(resultHeapTuple));
+}
+
 /*
  * Report the current WAL insert location (same format as pg_start_backup etc)
  *
@@ -194,7 +194,8 @@ static void recomputeNamespacePath(void);
 static void InitTempTableNamespace(void);
 static void RemoveTempRelations(Oid tempNamespaceId);
 static void RemoveTempRelationsCallback(int code, Datum arg);
-static void NamespaceCallback(Datum arg, int cacheid, ItemPointer tuplePtr);
+static void NamespaceCallback(Datum arg, int cacheid, ItemPointer tuplePtr,
+				  uint32 hashValue);
 static bool TempNamespaceValid(bool error_if_removed);
 
 /* These don't really need to appear in any header file */
@@ -3547,7 +3548,8 @@ InitializeSearchPath(void)
  *		Syscache inval callback function
  */
 static void
-NamespaceCallback(Datum arg, int cacheid, ItemPointer tuplePtr)
+NamespaceCallback(Datum arg, int cacheid, ItemPointer tuplePtr,
+				  uint32 hashValue)
 {
 	/* Force search path to be recomputed on next use */
 	baseSearchPathValid = false;
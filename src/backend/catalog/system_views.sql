@@ -383,7 +383,10 @@ CREATE VIEW pg_stat_replication AS
             W.flush_location,
             W.replay_location,
             W.sync_priority,
-            W.sync_state
+            W.sync_state,
+            W.sent_bytes,
+            W.sent_wire_bytes,
+            W.replay_lag_bytes
     FROM pg_stat_get_activity(NULL) AS S, pg_authid U,
             pg_stat_get_wal_senders() AS W
     WHERE S.usesysid = U.oid AND
@@ -435,6 +438,79 @@ CREATE VIEW pg_resqueue_status AS
 				queuewaiters int4,
 				queueholders int4)
 			ON (s.queueid = q.oid);
+
+CREATE VIEW pg_resqueue_admission AS
+	SELECT
+			q.rsqname,
+			s.admitted AS rsqadmitted,
+			s.admitted_after_wait AS rsqadmittedafterwait,
+			s.admitted_short AS rsqadmittedshort,
+			s.admitted_out_of_order AS rsqadmittedoutoforder,
+			s.total_wait_secs AS rsqtotalwait,
+			s.max_wait_secs AS rsqmaxwait,
+			CASE WHEN s.admitted_after_wait > 0
+				THEN s.total_wait_secs / s.admitted_after_wait
+				ELSE 0 END AS rsqavgwait
+	FROM pg_resqueue AS q
+			INNER JOIN pg_resqueue_admission_stats() AS s
+			(	queueid oid,
+				admitted int8,
+				admitted_after_wait int8,
+				admitted_short int8,
+				admitted_out_of_order int8,
+				total_wait_secs float8,
+				max_wait_secs float8)
+			ON (s.queueid = q.oid);
+
+CREATE VIEW pg_resgroup_status AS
+	SELECT
+			q.rsqname,
+			s.num_running AS rsgnumrunning,
+			s.cpu_shares AS rsgcpushares,
+			s.cpu_rate_limit AS rsgcpuratelimit,
+			s.cpu_usage_secs AS rsgcpuusage,
+			s.cgroup_cpu_usage_secs AS rsgcgroupcpuusage,
+			s.memory_used_mb AS rsgmemoryused,
+			s.memory_limit_mb AS rsgmemorylimit
+	FROM pg_resqueue AS q
+			INNER JOIN pg_resgroup_get_status() AS s
+			(	groupid oid,
+				num_running int4,
+				cpu_shares int4,
+				cpu_rate_limit int4,
+				cpu_usage_secs float8,
+				cgroup_cpu_usage_secs float8,
+				memory_used_mb int4,
+				memory_limit_mb int4)
+			ON (s.groupid = q.oid);
+
+CREATE VIEW pg_stat_appendonly_compaction AS
+	SELECT
+			s.pid,
+			s.relid,
+			n.nspname AS schemaname,
+			c.relname,
+			s.segno,
+			s.finished,
+			s.total_tupcount,
+			s.scanned_tupcount,
+			s.moved_tupcount,
+			s.removed_tupcount,
+			s.eof,
+			s.reclaimed_bytes
+	FROM pg_appendonly_compaction_progress() AS s
+			(	pid int4,
+				relid oid,
+				segno int4,
+				finished bool,
+				total_tupcount int8,
+				scanned_tupcount int8,
+				moved_tupcount int8,
+				removed_tupcount int8,
+				eof int8,
+				reclaimed_bytes int8)
+			LEFT JOIN pg_class c ON (s.relid = c.oid)
+			LEFT JOIN pg_namespace n ON (n.oid = c.relnamespace);
 			
 -- External table views
 
@@ -867,6 +943,47 @@ CREATE VIEW pg_stat_bgwriter AS
         pg_stat_get_buf_written_backend() AS buffers_backend,
         pg_stat_get_buf_alloc() AS buffers_alloc;
 
+CREATE VIEW pg_stat_xlog_flush AS
+    SELECT
+        s.flush_requests,
+        s.flushes,
+        s.flushed_bytes,
+        CASE WHEN s.flushes > 0
+             THEN round(s.flush_requests::numeric / s.flushes, 2)
+        END AS avg_flush_batch
+    FROM pg_stat_get_xlog_flush() AS s;
+
+CREATE VIEW pg_stat_optimizer_mdcache AS
+    SELECT
+        s.optimizations,
+        s.entries_loaded,
+        CASE WHEN s.optimizations > 0
+             THEN round(s.entries_loaded::numeric / s.optimizations, 2)
+        END AS loads_per_optimization,
+        s.entries_invalidated,
+        s.full_resets,
+        s.invalidation_messages,
+        s.tracked_entries,
+        s.part_metadata_built,
+        s.part_metadata_reused
+    FROM gp_opt_mdcache_stats() AS s;
+
+CREATE VIEW pg_stat_optimizer_plan_cache AS
+    SELECT
+        s.lookups,
+        s.hits,
+        CASE WHEN s.lookups > 0
+             THEN round(s.hits::numeric / s.lookups, 4)
+        END AS hit_ratio,
+        s.inserts,
+        s.evictions,
+        s.invalidations,
+        s.entries,
+        s.used_bytes,
+        s.size_bytes,
+        s.saved_time_ms
+    FROM gp_opt_plan_cache_stats() AS s;
+
 -- Tsearch debug function.  Defined here because it'd be pretty unwieldy
 -- to put it into pg_proc.h
 
@@ -626,3 +626,50 @@ cdbCopyEnd(CdbCopy *c)
 
 	return total_rows_rejected;
 }
+
+/*
+ * Run a COPY ... ON SEGMENT command. Unlike the regular COPY, no data flows
+ * through the dispatcher: each segment reads or writes its own local file,
+ * and we just wait for all of them to finish.
+ *
+ * Returns the total number of rows the segments processed. The number of
+ * rows rejected by single row error handling is returned in *rows_rejected,
+ * and for partitioned AO tables c->aotupcounts is filled in like cdbCopyEnd
+ * does.
+ */
+uint64
+cdbCopyOnSegment(CdbCopy *c, CopyStmt *stmt, int *rows_rejected)
+{
+	CdbPgResults cdb_pgresults = {NULL, 0};
+	uint64		processed = 0;
+	int			i;
+
+	stmt->partitions = c->partitions;
+	stmt->ao_segnos = c->ao_segnos;
+	stmt->skip_ext_partition = c->skip_ext_partition;
+
+	CdbDispatchUtilityStatement((Node *) stmt,
+								DF_CANCEL_ON_ERROR |
+								(c->copy_in ? DF_NEED_TWO_PHASE | DF_WITH_SNAPSHOT : DF_WITH_SNAPSHOT),
+								&cdb_pgresults);
+
+	*rows_rejected = 0;
+
+	for (i = 0; i < cdb_pgresults.numResults; i++)
+	{
+		PGresult   *res = cdb_pgresults.pg_results[i];
+		char	   *ntuples = PQcmdTuples(res);
+
+		if (ntuples[0] != '\0')
+			processed += strtoull(ntuples, NULL, 10);
+
+		*rows_rejected += res->numRejected;
+
+		c->aotupcounts = PQprocessAoTupCounts(c->partitions, c->aotupcounts,
+											  res->aotupcounts, res->naotupcounts);
+	}
+
+	cdbdisp_clearCdbPgResults(&cdb_pgresults);
+
+	return processed;
+}
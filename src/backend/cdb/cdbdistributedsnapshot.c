@@ -12,9 +12,99 @@
 #include "access/distributedlog.h"
 #include "miscadmin.h"
 #include "access/transam.h"
+#include "access/xlog.h"
 #include "cdb/cdbvars.h"
 #include "utils/tqual.h"
 
+/*
+ * DistributedSnapshotWithLocalMapping_FindInProgress
+ *		Binary search the in-progress array, which is sorted by distribXid.
+ *
+ * Returns the index of the entry, or -1 if distribXid is not in progress.
+ */
+static int
+DistributedSnapshotWithLocalMapping_FindInProgress(
+	DistributedSnapshotWithLocalMapping		*dslm,
+	DistributedTransactionId				distribXid)
+{
+	DistributedSnapshotMapEntry *inProgressEntryArray = dslm->inProgressEntryArray;
+	int							low = 0;
+	int							high = dslm->header.count - 1;
+
+	while (low <= high)
+	{
+		int			mid = (low + high) / 2;
+
+		if (inProgressEntryArray[mid].distribXid == distribXid)
+			return mid;
+		else if (inProgressEntryArray[mid].distribXid < distribXid)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return -1;
+}
+
+/*
+ * Widen the range of known local xids to include localXid.
+ */
+static void
+DistributedSnapshotWithLocalMapping_AddLocalXid(
+	DistributedSnapshotWithLocalMapping		*dslm,
+	TransactionId							localXid)
+{
+	if (!TransactionIdIsValid(dslm->minCachedLocalXid))
+	{
+		dslm->minCachedLocalXid = localXid;
+		dslm->maxCachedLocalXid = localXid;
+	}
+	else if (TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
+		dslm->minCachedLocalXid = localXid;
+	else if (TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
+		dslm->maxCachedLocalXid = localXid;
+}
+
+/*
+ * DistributedSnapshotWithLocalMapping_SetLocalXidRange
+ *		Compute the range of the local xids known in the in-progress array.
+ *
+ * Must be called whenever the array is filled in.
+ */
+void
+DistributedSnapshotWithLocalMapping_SetLocalXidRange(
+	DistributedSnapshotWithLocalMapping		*dslm)
+{
+	int			i;
+
+	dslm->minCachedLocalXid = InvalidTransactionId;
+	dslm->maxCachedLocalXid = InvalidTransactionId;
+	dslm->epochXid = InvalidTransactionId;
+
+	for (i = 0; i < dslm->header.count; i++)
+	{
+		if (TransactionIdIsValid(dslm->inProgressEntryArray[i].localXid))
+			DistributedSnapshotWithLocalMapping_AddLocalXid(
+										dslm,
+										dslm->inProgressEntryArray[i].localXid);
+	}
+}
+
+/*
+ * The epoch of localXid, for the shared commit cache.  The next xid and its
+ * epoch are read on first use only, and kept with the snapshot.
+ */
+static uint32
+DistributedSnapshotWithLocalMapping_XidEpoch(
+	DistributedSnapshotWithLocalMapping		*dslm,
+	TransactionId							localXid)
+{
+	if (!TransactionIdIsValid(dslm->epochXid))
+		GetNextXidAndEpoch(&dslm->epochXid, &dslm->epoch);
+
+	return SharedDistribXactCache_XidEpoch(localXid, dslm->epochXid, dslm->epoch);
+}
+
 /*
  * DistributedSnapshotWithLocalMapping_CommittedTest
  *		Is the given XID still-in-progress according to the
@@ -33,30 +123,53 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 	DistributedSnapshotHeader *header = &dslm->header;
 	DistributedSnapshotMapEntry *inProgressEntryArray = dslm->inProgressEntryArray;
 	int32							count;
-	uint32							i;
+	int32							i;
 	bool							found;
 	DistributedTransactionId		distribXid = InvalidDistributedTransactionId;
+	uint32							localXidEpoch = 0;
 
 	count = header->count;
 
 	/*
 	 * Checking the distributed committed log can be expensive, so
 	 * make a scan through our distributed snapshot looking for a
-	 * possible corresponding local xid...
+	 * possible corresponding local xid...  Most xids are outside the
+	 * range of the local xids we know, and need no scan at all.
 	 */
-	for (i = 0; i < count; i++)
+	if (TransactionIdIsValid(dslm->minCachedLocalXid) &&
+		TransactionIdFollowsOrEquals(localXid, dslm->minCachedLocalXid) &&
+		TransactionIdPrecedesOrEquals(localXid, dslm->maxCachedLocalXid))
 	{
-		if (localXid == inProgressEntryArray[i].localXid)
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+		for (i = 0; i < count; i++)
+		{
+			if (localXid == inProgressEntryArray[i].localXid)
+				return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+		}
 	}
 
 	/*
-	 * Is this local xid in a process-local cache we maintain?
+	 * Is this local xid in a process-local cache we maintain?  If not, in
+	 * the cache shared by all backends?
 	 */
 	found = LocalDistribXactCache_CommittedFind(localXid,
 												dslm->header.distribTransactionTimeStamp,
 												&distribXid);
 
+	if (!found && SharedDistribXactCache_IsEnabled())
+		localXidEpoch = DistributedSnapshotWithLocalMapping_XidEpoch(dslm, localXid);
+
+	if (!found &&
+		SharedDistribXactCache_CommittedFind(localXid,
+											 localXidEpoch,
+											 dslm->header.distribTransactionTimeStamp,
+											 &distribXid))
+	{
+		LocalDistribXactCache_AddCommitted(localXid,
+										   dslm->header.distribTransactionTimeStamp,
+										   distribXid);
+		found = true;
+	}
+
 	if (found)
 	{
 		/*
@@ -103,6 +216,10 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 			LocalDistribXactCache_AddCommitted(localXid,
 											   dslm->header.distribTransactionTimeStamp,
 											   /* distribXid */ InvalidDistributedTransactionId);
+			SharedDistribXactCache_AddCommitted(localXid,
+												localXidEpoch,
+												dslm->header.distribTransactionTimeStamp,
+												/* distribXid */ InvalidDistributedTransactionId);
 
 			return DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE;
 		}
@@ -114,13 +231,20 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 	Assert(distribXid != InvalidDistributedTransactionId);
 
 	/*
-	 * If we did not find it in our cache, add it.
+	 * If we did not find it in our caches, add it.
 	 */
 	if (!found)
+	{
 		LocalDistribXactCache_AddCommitted(
 										localXid, 
 										dslm->header.distribTransactionTimeStamp,
 										distribXid);
+		SharedDistribXactCache_AddCommitted(
+										localXid,
+										localXidEpoch,
+										dslm->header.distribTransactionTimeStamp,
+										distribXid);
+	}
 
 	if (header->xminAllDistributedSnapshots != InvalidDistributedTransactionId)
 	{
@@ -149,19 +273,20 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
-	for (i = 0; i < count; i++)
+	i = DistributedSnapshotWithLocalMapping_FindInProgress(dslm, distribXid);
+	if (i >= 0)
 	{
-		if (distribXid == inProgressEntryArray[i].distribXid)
+		/*
+		 * Save the relationship to the local xid so we may avoid
+		 * checking the distributed committed log in a subsequent check.
+		 */
+		if (inProgressEntryArray[i].localXid == InvalidTransactionId)
 		{
-			/*
-			 * Save the relationship to the local xid so we may avoid
-			 * checking the distributed committed log in a subsequent check.
-			 */
-			if (inProgressEntryArray[i].localXid == InvalidTransactionId)
-				inProgressEntryArray[i].localXid = localXid;
-			
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+			inProgressEntryArray[i].localXid = localXid;
+			DistributedSnapshotWithLocalMapping_AddLocalXid(dslm, localXid);
 		}
+
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
 	/*
@@ -449,6 +449,24 @@ int file_rep_min_data_before_flush = 128 * 1024;
  */
 int file_rep_socket_timeout = 10;
 
+/*
+ * GUC parameter
+ *			file_rep_resync_workers
+ *
+ * Number of resync worker processes started with the resync manager. Each
+ * worker resynchronizes one segment file at a time, so they copy different
+ * files to the mirror in parallel.
+ */
+int file_rep_resync_workers = 4;
+
+/*
+ * GUC parameter
+ *			file_rep_compression
+ *
+ * Compress the messages the primary sends to the mirror.
+ */
+bool file_rep_compression = false;
+
 FileRepShmem_s	*fileRepShmemArray[FILEREP_SHMEM_MAX_SLOTS];
 FileRepShmem_s	*fileRepAckShmemArray[FILEREP_ACKSHMEM_MAX_SLOTS];
 
@@ -753,6 +771,10 @@ static FileRepShmem_s *FileRep_ShmemInitOneBuffer(const char *bufferLabel, int s
 
 	result->consumeCount = 0;
 
+	result->messageBytesSent = 0;
+
+	result->wireBytesSent = 0;
+
 	result->state = FileRepStateNotInitialized;
 
 	/*
@@ -857,6 +879,10 @@ FileRep_ShmemInitArray(
 
 		array[ii]->consumeCount = 0;
 
+		array[ii]->messageBytesSent = 0;
+
+		array[ii]->wireBytesSent = 0;
+
 		array[ii]->state = FileRepStateNotInitialized;
 
 		if (initIpcArrayIndex)
@@ -920,6 +946,10 @@ FileRep_ShmemReInitOneBuffer(FileRepShmem_s *result, int shmemSize, int bufSize)
 
 	result->consumeCount = 0;
 
+	result->messageBytesSent = 0;
+
+	result->wireBytesSent = 0;
+
 	result->state = FileRepStateNotInitialized;
 
 	/*
@@ -3401,6 +3431,8 @@ void FileRep_Main(void)
 
 	int		status = STATUS_OK;
 
+	int		i;
+
 	char title[100];
 
 	sigjmp_buf		local_sigjmp_buf;
@@ -3582,22 +3614,15 @@ void FileRep_Main(void)
 					status = STATUS_ERROR;
 					break;
 				}
-				if (FileRep_StartChildProcess(FileRepProcessTypeResyncWorker1) < 0) {
-					status = STATUS_ERROR;
-					break;
-				}
-				if (FileRep_StartChildProcess(FileRepProcessTypeResyncWorker2) < 0) {
-					status = STATUS_ERROR;
-					break;
-				}
-				if (FileRep_StartChildProcess(FileRepProcessTypeResyncWorker3) < 0) {
-					status = STATUS_ERROR;
-					break;
+				for (i = 0; i < file_rep_resync_workers; i++)
+				{
+					if (FileRep_StartChildProcess(FileRepProcessTypeResyncWorker1 + i) < 0) {
+						status = STATUS_ERROR;
+						break;
+					}
 				}
-				if (FileRep_StartChildProcess(FileRepProcessTypeResyncWorker4) < 0) {
-					status = STATUS_ERROR;
+				if (status != STATUS_OK)
 					break;
-				}
 
 			}
 
@@ -22,8 +22,13 @@
 #include "gp-libpq-int.h"
 #include "pqexpbuffer.h"
 #include "cdb/cdbfilerepservice.h"
+#include "storage/bfz.h"
+#include "utils/memutils.h"
 
 static PGconn	*conn = NULL;
+
+/* Buffer for compressed messages, allocated when first needed */
+static char		*compressBuffer = NULL;
 /*
  *
  */
@@ -98,46 +103,45 @@ FileRepConnClient_CloseConnection(void)
 }
 
 /*
- *
- *
- * Control Message has msg_type='C'.
- * Control Message is consumed by Receiver thread on mirror side.
- *
- * Data Message has msg_type='M'.
- * Data Message is inserted in Shared memory and consumed by Consumer
- * thread on mirror side.
+ * Returns the message type byte for messages of the given type, or 0 if
+ * they cannot be sent. Compressed messages use lower case letters.
  */
-bool
-FileRepConnClient_SendMessage(
-	FileRepConsumerProcIndex_e	messageType, 
-	bool	messageSynchronous,
-	char*	message, 
-	uint32	messageLength)
+static char
+FileRepConnClient_MessageType(
+	FileRepConsumerProcIndex_e	messageType,
+	bool	compressed)
 {
-	char msgType = 0;
-	int status = STATUS_OK;
-
-#ifdef USE_ASSERT_CHECKING
-	int prevOutCount = conn->outCount;
-#endif // USE_ASSERT_CHECKING
-
 	switch(messageType)
 	{
 		case FileRepMessageTypeXLog:
-			msgType = '1';
-			break;
+			return compressed ? 'x' : '1';
 		case FileRepMessageTypeAO01:
-			msgType = '2';
-			break;
+			return compressed ? 'a' : '2';
 		case FileRepMessageTypeWriter:
-			msgType = '3';
-			break;
+			return compressed ? 'w' : '3';
 		case FileRepMessageTypeShutdown:
-			msgType = 'S';
-			break;
+			return compressed ? 0 : 'S';
 		default:
-			return false;
+			return 0;
 	}
+}
+
+/*
+ * Queue the message on the connection, and flush it if it is synchronous
+ * or enough data is buffered.
+ */
+static bool
+FileRepConnClient_PutMessage(
+	char	msgType,
+	bool	messageSynchronous,
+	char*	message,
+	uint32	messageLength)
+{
+	int status = STATUS_OK;
+
+#ifdef USE_ASSERT_CHECKING
+	int prevOutCount = conn->outCount;
+#endif // USE_ASSERT_CHECKING
 
 	/**
 	 * Note that pqPutMsgStart and pqPutnchar both may grow the connection's internal buffer, and do not
@@ -207,3 +211,76 @@ FileRepConnClient_SendMessage(
 
 	return true;
 }
+
+/*
+ *
+ *
+ * Control Message has msg_type='C'.
+ * Control Message is consumed by Receiver thread on mirror side.
+ *
+ * Data Message has msg_type='M'.
+ * Data Message is inserted in Shared memory and consumed by Consumer
+ * thread on mirror side.
+ */
+bool
+FileRepConnClient_SendMessage(
+	FileRepConsumerProcIndex_e	messageType, 
+	bool	messageSynchronous,
+	char*	message, 
+	uint32	messageLength)
+{
+	char msgType = FileRepConnClient_MessageType(messageType, false);
+
+	if (msgType == 0)
+	{
+		return false;
+	}
+
+	return FileRepConnClient_PutMessage(msgType, messageSynchronous, message, messageLength);
+}
+
+/*
+ * Same as FileRepConnClient_SendMessage(), but the message is compressed
+ * with the "lz" codec if that makes it smaller. The compressed message is
+ * the uncompressed length, in network byte order, followed by the
+ * compressed data.
+ *
+ * *sentLength is set to the number of bytes put on the connection for the
+ * message.
+ */
+bool
+FileRepConnClient_SendCompressedMessage(
+	FileRepConsumerProcIndex_e	messageType,
+	bool	messageSynchronous,
+	char*	message,
+	uint32	messageLength,
+	uint32	*sentLength)
+{
+	char	msgType = FileRepConnClient_MessageType(messageType, true);
+	uint32	rawLength;
+	int		zlen = -1;
+
+	if (msgType != 0 && messageLength <= sizeof(FileRepMessage_s))
+	{
+		if (compressBuffer == NULL)
+			compressBuffer = MemoryContextAlloc(TopMemoryContext,
+												sizeof(uint32) + LZ_COMPRESS_BOUND(sizeof(FileRepMessage_s)));
+
+		zlen = bfz_lz_compress(message,
+							   messageLength,
+							   compressBuffer + sizeof(uint32),
+							   LZ_COMPRESS_BOUND(sizeof(FileRepMessage_s)));
+	}
+
+	if (zlen < 0 || sizeof(uint32) + zlen >= messageLength)
+	{
+		*sentLength = messageLength;
+		return FileRepConnClient_SendMessage(messageType, messageSynchronous, message, messageLength);
+	}
+
+	rawLength = htonl(messageLength);
+	memcpy(compressBuffer, &rawLength, sizeof(uint32));
+
+	*sentLength = sizeof(uint32) + zlen;
+	return FileRepConnClient_PutMessage(msgType, messageSynchronous, compressBuffer, *sentLength);
+}
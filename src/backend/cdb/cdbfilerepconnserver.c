@@ -24,10 +24,21 @@
 #include "libpq/libpq.h"
 #include "libpq/auth.h"
 #include "libpq/pqformat.h"
+#include "storage/bfz.h"
+#include "utils/memutils.h"
 
 static Port	*port;
 static void ConnFree(void);
 
+/*
+ * Set when the message being received is compressed, see
+ * FileRepConnClient_SendCompressedMessage(). compressedLength is the
+ * length of its compressed data.
+ */
+static bool		messageCompressed = false;
+static uint32	compressedLength = 0;
+static char		*compressedBuffer = NULL;
+
 static 	int	listenSocket[FILEREP_MAX_LISTEN];
 
 /*
@@ -202,6 +213,8 @@ FileRepConnServer_ReceiveStartupPacket(void)
 	
 	pq_init(); 
 
+	messageCompressed = false;
+
 	status = FileRepConnServer_ReceiveMessageLength(&length);
 	if (status != STATUS_OK) {
 		goto exit;
@@ -298,17 +311,27 @@ FileRepConnServer_ReceiveMessageType(
 	
 	messageType = pq_getbyte();		
 					 
+	messageCompressed = false;
 
 	 switch (messageType) {
 
+		 case 'x':
+			 messageCompressed = true;
+			 /* fall through */
 		 case '1':
 			 *fileRepMessageType = FileRepMessageTypeXLog;
 			 break;
 
+		 case 'a':
+			 messageCompressed = true;
+			 /* fall through */
 		 case '2':
 			 *fileRepMessageType = FileRepMessageTypeAO01;
 			 break;
 
+		case 'w':
+			 messageCompressed = true;
+			 /* fall through */
 		case '3':
 			 *fileRepMessageType = FileRepMessageTypeWriter;
 			 break;
@@ -371,6 +394,33 @@ FileRepConnServer_ReceiveMessageLength(uint32 *len)
 	
 	length -= 4;
 	
+	/*
+	 * A compressed message starts with its uncompressed length, which is
+	 * what the caller has to make room for.
+	 */
+	if (messageCompressed) {
+		uint32	rawLength;
+
+		if (length < 4 || pq_getbytes((char*) &rawLength, 4) == EOF) {
+			ereport(WARNING,
+					(errcode_for_socket_access(),
+					 errmsg("receive EOF on connection: %m")));
+
+			return STATUS_ERROR;
+		}
+
+		rawLength = ntohl(rawLength);
+		compressedLength = length - 4;
+
+		if (rawLength > sizeof(FileRepMessage_s) || compressedLength >= rawLength) {
+			ereport(WARNING,
+					 (errmsg("receive unexpected message length on connection")));
+			return STATUS_ERROR;
+		}
+
+		length = rawLength;
+	}
+
 	*len = length;
 
 	return STATUS_OK;
@@ -385,6 +435,31 @@ FileRepConnServer_ReceiveMessageLength(uint32 *len)
 			char		*data,
 			uint32		length)
  {
+	 if (messageCompressed)
+	 {
+		 if (compressedBuffer == NULL)
+			 compressedBuffer = MemoryContextAlloc(TopMemoryContext,
+												   sizeof(FileRepMessage_s));
+
+		 if (pq_getbytes(compressedBuffer, compressedLength) == EOF)
+		 {
+			 ereport(WARNING,
+					 (errcode_for_socket_access(),
+					  errmsg("receive EOF on connection: %m")));
+
+			 return STATUS_ERROR;
+		 }
+
+		 if (bfz_lz_decompress(compressedBuffer, compressedLength, data, length) != (int) length)
+		 {
+			 ereport(WARNING,
+					 (errmsg("receive corrupt compressed message on connection")));
+
+			 return STATUS_ERROR;
+		 }
+
+		 return STATUS_OK;
+	 }
 
 	 if (pq_getbytes(data, length) == EOF) 
 	 {
@@ -60,10 +60,8 @@ bool
 FileRepPrimary_IsResyncWorker(void)
 {
 	return(
-		fileRepProcessType == FileRepProcessTypeResyncWorker1 ||
-		fileRepProcessType == FileRepProcessTypeResyncWorker2 ||
-		fileRepProcessType == FileRepProcessTypeResyncWorker3 ||
-		fileRepProcessType == FileRepProcessTypeResyncWorker4);
+		fileRepProcessType >= FileRepProcessTypeResyncWorker1 &&
+		fileRepProcessType <= FileRepProcessTypeResyncWorker4);
 }
 
 bool
@@ -71,10 +69,7 @@ FileRepPrimary_IsResyncManagerOrWorker(void)
 {		
 	return(
 		   fileRepProcessType == FileRepProcessTypeResyncManager ||
-		   fileRepProcessType == FileRepProcessTypeResyncWorker1 ||
-		   fileRepProcessType == FileRepProcessTypeResyncWorker2 ||
-		   fileRepProcessType == FileRepProcessTypeResyncWorker3 ||
-		   fileRepProcessType == FileRepProcessTypeResyncWorker4);
+		   FileRepPrimary_IsResyncWorker());
 }
 
 MirrorDataLossTrackingState 
@@ -1490,6 +1485,26 @@ FileRepPrimary_GetMirrorStatus(void)
 	return FileRepAckPrimary_GetMirrorErrno();
 }
 
+/*
+ * Bytes of messages sent to the mirror, and bytes put on the connection
+ * for them, since mirroring was last started.
+ */
+void
+FileRepPrimary_GetBytesSent(int64 *messageBytesSent, int64 *wireBytesSent)
+{
+	FileRepShmem_s	*fileRepShmem = fileRepShmemArray[0];
+
+	if (fileRepShmem == NULL)
+	{
+		*messageBytesSent = 0;
+		*wireBytesSent = 0;
+		return;
+	}
+
+	*messageBytesSent = fileRepShmem->messageBytesSent;
+	*wireBytesSent = fileRepShmem->wireBytesSent;
+}
+
 /****************************************************************
  * FILEREP SUB-PROCESS (FileRep Primary SENDER Process)
  ****************************************************************/
@@ -1619,6 +1634,8 @@ FileRepPrimary_RunSender(void)
 	FileRepMessageHeader_s		*fileRepMessageHeader;
 	FileRepShmem_s				*fileRepShmem = fileRepShmemArray[fileRepProcIndex];
 	FileRepConsumerProcIndex_e	messageType = FileRepMessageTypeUndefined;
+	bool						sent;
+	uint32						wireLength;
 	
 	FileRep_InsertConfigLogEntry("run sender");
 	
@@ -1765,11 +1782,26 @@ FileRepPrimary_RunSender(void)
 				break;
 		}
 		
-		if (! FileRepConnClient_SendMessage(
-					messageType, 
+		if (file_rep_compression)
+		{
+			sent = FileRepConnClient_SendCompressedMessage(
+					messageType,
+					fileRepShmemMessageDescr->messageSync,
+					fileRepMessage,
+					fileRepShmemMessageDescr->messageLength,
+					&wireLength);
+		}
+		else
+		{
+			sent = FileRepConnClient_SendMessage(
+					messageType,
 					fileRepShmemMessageDescr->messageSync,
 					fileRepMessage,
-					fileRepShmemMessageDescr->messageLength)) {
+					fileRepShmemMessageDescr->messageLength);
+			wireLength = fileRepShmemMessageDescr->messageLength;
+		}
+
+		if (! sent) {
 			
 			if (! primaryMirrorIsIOSuspended())
 			{
@@ -1792,6 +1824,9 @@ FileRepPrimary_RunSender(void)
 			break;
 		}
 
+		fileRepShmem->messageBytesSent += fileRepShmemMessageDescr->messageLength;
+		fileRepShmem->wireBytesSent += wireLength;
+
 		movePositionConsume = TRUE;
 	} // while(1)
 	
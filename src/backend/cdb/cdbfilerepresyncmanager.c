@@ -404,6 +404,30 @@ FileRepResync_AddToTotalBlocksToSynchronize(int64 moreBlocksToSynchronize)
 	fileRepResyncShmem->totalBlocksToSynchronize += moreBlocksToSynchronize;
 }
 
+/*
+ * Average number of blocks synchronized per second since resync started.
+ */
+int64
+FileRepResync_GetBlocksSynchronizedPerSecond(void)
+{
+	struct timeval	currentResyncTime;
+	int64			blocksSynchronized;
+	int64			elapsed;
+
+	if (fileRepResyncShmem == NULL)
+		return 0;
+
+	blocksSynchronized = fileRepResyncShmem->blocksSynchronized;
+
+	gettimeofday(&currentResyncTime, NULL);
+	elapsed = currentResyncTime.tv_sec - fileRepResyncShmem->startResyncTime.tv_sec;
+
+	if (elapsed <= 0)
+		return 0;
+
+	return blocksSynchronized / elapsed;
+}
+
 struct timeval
 FileRepResync_GetEstimateResyncCompletionTime(void)
 {
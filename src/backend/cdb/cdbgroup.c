@@ -43,6 +43,7 @@
 #include "parser/parse_expr.h"
 #include "parser/parse_oper.h"
 #include "parser/parse_relation.h"
+#include "utils/hyperloglog.h"
 #include "utils/lsyscache.h"
 #include "utils/selfuncs.h"
 #include "utils/syscache.h"
@@ -444,6 +445,8 @@ static Plan *plan_within_agg_persort(PlannerInfo *root, GroupContext *group_cont
  */
 static Plan *add_motion_to_dqa_child(Plan *plan, PlannerInfo *root, bool *motion_added);
 
+static bool approximate_count_distinct_walker(Node *node, void *context);
+
 /*
  * Function: cdb_grouping_planner
  *
@@ -7000,3 +7003,61 @@ Plan *add_motion_to_dqa_child(Plan *plan, PlannerInfo *root, bool *motion_added)
 	return result;
 }
 
+/*
+ * approximate_count_distinct
+ *
+ * Replace each count(DISTINCT x) of the query level in the given expression
+ * by gp_approx_count_distinct(x).  The Aggref nodes are changed in place, so
+ * this must be done before the aggregates are counted and the subplan target
+ * list is built.
+ *
+ * count(DISTINCT x) can only be computed exactly by bringing equal values of
+ * x together, which means redistributing the input on x (2-phase DQA plan)
+ * or deduplicating it and joining the coplans (3-phase DQA plan).  The
+ * HyperLogLog sketch behind gp_approx_count_distinct has a preliminary
+ * function, so the replacement plans like sum() or count(): each segment
+ * builds the sketch of its own rows and the final stage merges them, along
+ * with the states of the other aggregates of the query.  Arguments whose
+ * type has no hash opclass can't be sketched, and stay exact.
+ *
+ * Returns true if anything was replaced.
+ */
+bool
+approximate_count_distinct(Node *node)
+{
+	bool		replaced = false;
+
+	approximate_count_distinct_walker(node, &replaced);
+
+	return replaced;
+}
+
+static bool
+approximate_count_distinct_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *aggref = (Aggref *) node;
+
+		if (aggref->aggfnoid == AGGFNOID_COUNT_ANY &&
+			aggref->aggdistinct &&
+			aggref->agglevelsup == 0 &&
+			aggref->aggorder == NULL &&
+			list_length(aggref->args) == 1 &&
+			OidIsValid(hll_hash_proc(exprType(linitial(aggref->args)))))
+		{
+			aggref->aggfnoid = AGGFNOID_APPROX_COUNT_DISTINCT;
+			aggref->aggdistinct = false;
+			*(bool *) context = true;
+		}
+
+		/* Aggregates don't nest */
+		return false;
+	}
+
+	return expression_tree_walker(node, approximate_count_distinct_walker,
+								  context);
+}
@@ -7,7 +7,8 @@
  *
  * Also support a cache of recently seen committed transactions found by the
  * visibility routines for better performance.  Used to avoid reading the
- * distributed log SLRU files too frequently.
+ * distributed log SLRU files too frequently.  Each backend has its own
+ * cache, backed by one in shared memory.
  *
  * Copyright (c) 2007-2008, Greenplum inc
  *
@@ -21,6 +22,8 @@
 #include "cdb/cdblocaldistribxact.h"
 #include "cdb/cdbvars.h"
 #include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
 #include "cdb/cdbshareddoublylinked.h"
 #include "utils/hsearch.h"
 #include "miscadmin.h"
@@ -272,8 +275,9 @@ static struct LocalDistribXactCache
 	int64		totalCount;
 	int64		addCount;
 	int64		removeCount;
+	int64		sharedHitCount;
 
-}	LocalDistribXactCache = {0,{NULL,NULL},0,0,0,0};
+}	LocalDistribXactCache = {0,{NULL,NULL},0,0,0,0,0};
 
 
 bool
@@ -423,10 +427,200 @@ void
 LocalDistribXactCache_ShowStats(char *nameStr)
 {
 		elog(LOG, "%s: Local-distributed cache counts "
-			 "(hits " INT64_FORMAT ", total " INT64_FORMAT ", adds " INT64_FORMAT ", removes " INT64_FORMAT ")",
+			 "(hits " INT64_FORMAT ", total " INT64_FORMAT ", adds " INT64_FORMAT ", removes " INT64_FORMAT
+			 ", shared hits " INT64_FORMAT ")",
 			 nameStr,
 			 LocalDistribXactCache.hitCount,
 			 LocalDistribXactCache.totalCount,
 			 LocalDistribXactCache.addCount,
-			 LocalDistribXactCache.removeCount);
+			 LocalDistribXactCache.removeCount,
+			 LocalDistribXactCache.sharedHitCount);
+}
+
+// *****************************************************************************
+
+/*
+ * The shared local-distributed cache.
+ *
+ * A direct-mapped table of committed local-distributed pairs, filled by
+ * every backend from the distributed log.  The pair of a committed xid
+ * never changes, so an entry stays good until it is overwritten by another
+ * xid mapping to the same slot.  Entries also carry the xid epoch, so an
+ * entry left over from before a wraparound is never taken for the xid of
+ * the same number now.
+ *
+ * The table is split in partitions with a spinlock each, so concurrent
+ * scans rarely wait on each other.
+ */
+#define SHARED_DISTRIB_CACHE_PARTITIONS		16
+
+typedef struct SharedDistribXactCacheEntry
+{
+	TransactionId 					localXid;
+	uint32							epoch;
+
+	DistributedTransactionTimeStamp	distribTimeStamp;
+	DistributedTransactionId 		distribXid;
+										/*
+										 * InvalidDistributedTransactionId
+										 * for a local-only transaction.
+										 */
+}	SharedDistribXactCacheEntry;
+
+typedef struct SharedDistribXactCachePartition
+{
+	slock_t			mutex;
+
+	int64			hitCount;
+	int64			addCount;
+}	SharedDistribXactCachePartition;
+
+typedef struct SharedDistribXactCacheData
+{
+	SharedDistribXactCachePartition	partitions[SHARED_DISTRIB_CACHE_PARTITIONS];
+
+	int32							slotsPerPartition;
+
+	SharedDistribXactCacheEntry		slots[1];	/* VARIABLE LENGTH ARRAY */
+}	SharedDistribXactCacheData;
+
+static SharedDistribXactCacheData *SharedDistribXactCache = NULL;
+
+static int
+SharedDistribXactCache_SlotsPerPartition(void)
+{
+	return (gp_max_shared_distributed_cache + SHARED_DISTRIB_CACHE_PARTITIONS - 1) /
+		SHARED_DISTRIB_CACHE_PARTITIONS;
+}
+
+Size
+SharedDistribXactCache_ShmemSize(void)
+{
+	Size		size;
+
+	if (gp_max_shared_distributed_cache == 0)
+		return 0;
+
+	size = offsetof(SharedDistribXactCacheData, slots);
+	size = add_size(size, mul_size(sizeof(SharedDistribXactCacheEntry),
+								   mul_size(SHARED_DISTRIB_CACHE_PARTITIONS,
+											SharedDistribXactCache_SlotsPerPartition())));
+
+	return size;
+}
+
+void
+SharedDistribXactCache_ShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	if (gp_max_shared_distributed_cache == 0)
+		return;
+
+	SharedDistribXactCache = (SharedDistribXactCacheData *)
+		ShmemInitStruct("Shared local-distributed commit cache",
+						SharedDistribXactCache_ShmemSize(),
+						&found);
+	if (found)
+		return;
+
+	MemSet(SharedDistribXactCache, 0, SharedDistribXactCache_ShmemSize());
+	SharedDistribXactCache->slotsPerPartition = SharedDistribXactCache_SlotsPerPartition();
+	for (i = 0; i < SHARED_DISTRIB_CACHE_PARTITIONS; i++)
+		SpinLockInit(&SharedDistribXactCache->partitions[i].mutex);
+}
+
+bool
+SharedDistribXactCache_IsEnabled(void)
+{
+	return SharedDistribXactCache != NULL;
+}
+
+/*
+ * The epoch of localXid, given that of a nearby xid such as the next xid
+ * when the snapshot was taken.  The caller reads that once, so that
+ * XidGenLock is not taken on every cache lookup.
+ */
+uint32
+SharedDistribXactCache_XidEpoch(TransactionId localXid,
+								TransactionId epochXid,
+								uint32 epoch)
+{
+	if (localXid > epochXid && TransactionIdPrecedes(localXid, epochXid))
+		epoch--;
+	else if (localXid < epochXid && TransactionIdFollows(localXid, epochXid))
+		epoch++;
+
+	return epoch;
+}
+
+static volatile SharedDistribXactCacheEntry *
+SharedDistribXactCache_Slot(TransactionId localXid,
+							volatile SharedDistribXactCachePartition **partition)
+{
+	int			partitionNo = localXid % SHARED_DISTRIB_CACHE_PARTITIONS;
+	int			slotNo = (localXid / SHARED_DISTRIB_CACHE_PARTITIONS) %
+		SharedDistribXactCache->slotsPerPartition;
+
+	*partition = &SharedDistribXactCache->partitions[partitionNo];
+
+	return &SharedDistribXactCache->slots[partitionNo * SharedDistribXactCache->slotsPerPartition + slotNo];
+}
+
+bool
+SharedDistribXactCache_CommittedFind(
+	TransactionId						localXid,
+	uint32								localXidEpoch,
+	DistributedTransactionTimeStamp		distribTransactionTimeStamp,
+	DistributedTransactionId			*distribXid)
+{
+	volatile SharedDistribXactCachePartition *partition;
+	volatile SharedDistribXactCacheEntry *slot;
+	bool		found;
+
+	if (SharedDistribXactCache == NULL)
+		return false;
+
+	slot = SharedDistribXactCache_Slot(localXid, &partition);
+
+	SpinLockAcquire(&partition->mutex);
+	found = (slot->localXid == localXid &&
+			 slot->epoch == localXidEpoch &&
+			 slot->distribTimeStamp == distribTransactionTimeStamp);
+	if (found)
+	{
+		*distribXid = slot->distribXid;
+		partition->hitCount++;
+	}
+	SpinLockRelease(&partition->mutex);
+
+	if (found)
+		LocalDistribXactCache.sharedHitCount++;
+
+	return found;
+}
+
+void
+SharedDistribXactCache_AddCommitted(
+	TransactionId						localXid,
+	uint32								localXidEpoch,
+	DistributedTransactionTimeStamp		distribTransactionTimeStamp,
+	DistributedTransactionId			distribXid)
+{
+	volatile SharedDistribXactCachePartition *partition;
+	volatile SharedDistribXactCacheEntry *slot;
+
+	if (SharedDistribXactCache == NULL)
+		return;
+
+	slot = SharedDistribXactCache_Slot(localXid, &partition);
+
+	SpinLockAcquire(&partition->mutex);
+	slot->localXid = localXid;
+	slot->epoch = localXidEpoch;
+	slot->distribTimeStamp = distribTransactionTimeStamp;
+	slot->distribXid = distribXid;
+	partition->addCount++;
+	SpinLockRelease(&partition->mutex);
 }
@@ -95,7 +95,8 @@ static void getPartitionIndexNode(Oid rootOid, int2 level,
 					bool isDefault, List *defaultLevels);
 static void indexParts(PartitionIndexNode **np, bool isDefault);
 static void dumpPartsIndexInfo(PartitionIndexNode *n, int level);
-static LogicalIndexes * createPartsIndexResult(Oid root);
+static LogicalIndexes *buildLogicalIndexInfo(Oid relid, bool withPartCons);
+static LogicalIndexes * createPartsIndexResult(Oid root, bool withPartCons);
 static bool collapseIndexes(PartitionIndexNode **partitionIndexNode,
 					LogicalIndexInfoHashEntry **entry);
 static void createIndexHashTables(void);
@@ -209,6 +210,26 @@ key_string_copy(void *dest, const void *src, Size keysize)
  */
 LogicalIndexes *
 BuildLogicalIndexInfo(Oid relid)
+{
+	return buildLogicalIndexInfo(relid, true);
+}
+
+/*
+ * BuildLogicalIndexOids
+ *   Like BuildLogicalIndexInfo, but skips step 5, and leaves the partCons
+ *   of the logical indexes of non-default parts NULL. Fetching and OR'ing
+ *   the constraints of every part is the expensive step on tables with
+ *   thousands of partitions, and callers that only need to know which
+ *   logical indexes exist can do without it.
+ */
+LogicalIndexes *
+BuildLogicalIndexOids(Oid relid)
+{
+	return buildLogicalIndexInfo(relid, false);
+}
+
+static LogicalIndexes *
+buildLogicalIndexInfo(Oid relid, bool withPartCons)
 {
 	MemoryContext   callerContext = NULL;
 	MemoryContext   partContext = NULL;
@@ -239,7 +260,11 @@ BuildLogicalIndexInfo(Oid relid)
 	getPartitionIndexNode(relid, 0, InvalidOid, &n, false, NIL);
 
 	if (!n)
+	{
+		MemoryContextSwitchTo(callerContext);
+		MemoryContextDelete(partContext);
 		return NULL;
+	}
 
 	/* create the hash tables to hold the logical index info */
 	createIndexHashTables();
@@ -271,7 +296,7 @@ BuildLogicalIndexInfo(Oid relid)
 
 	/* generate output rows */
 	if ((numLogicalIndexes+numIndexesOnDefaultParts) > 0)
-		partsLogicalIndexes = createPartsIndexResult(relid);
+		partsLogicalIndexes = createPartsIndexResult(relid, withPartCons);
 
 	hash_destroy(LogicalIndexInfoHash);
 
@@ -1008,7 +1033,8 @@ generateLogicalIndexPred(LogicalIndexes *li,
 				int *curIdx,
 				LogicalIndexInfoHashEntry *entry,
 				Oid root,
-				int *numLogicalIndexes)
+				int *numLogicalIndexes,
+				bool withPartCons)
 {
 	Node            *conList;
 	ListCell *lc; 
@@ -1034,7 +1060,7 @@ generateLogicalIndexPred(LogicalIndexes *li,
 		{
 			Oid partOid = lfirst_oid(lc);
 	
-			if (partOid != root)
+			if (withPartCons && partOid != root)
 			{	 
 				/* fetch part constraint mapped to root */
 				conList = getPartConstraints(partOid, root, NIL /*partKey*/);
@@ -1098,7 +1124,7 @@ generateLogicalIndexPred(LogicalIndexes *li,
  *  by a call to generateLogicalIndexPred.
  */
 static LogicalIndexes *
-createPartsIndexResult(Oid root)
+createPartsIndexResult(Oid root, bool withPartCons)
 {
 	HASH_SEQ_STATUS hash_seq;
 	int numResultRows = 0;
@@ -1130,7 +1156,7 @@ createPartsIndexResult(Oid root)
 	/* for each logical index, get the part constraints as partial index predicates */
 	while ((entry = hash_seq_search(&hash_seq)))
 	{
-		generateLogicalIndexPred(li, &curIdx, entry, root, &li->numLogicalIndexes);
+		generateLogicalIndexPred(li, &curIdx, entry, root, &li->numLogicalIndexes, withPartCons);
 	}
 
 	return li;
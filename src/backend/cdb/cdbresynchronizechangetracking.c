@@ -632,6 +632,20 @@ void ChangeTracking_GetRelationChangeInfoFromXlog(
 													   xlrec->heapnode.persistentSerialNum);
 					break;
 				}
+				case XLOG_HEAP2_MULTI_INSERT:
+				{
+					xl_heap_multi_insert *xlrec = (xl_heap_multi_insert *) data;
+
+					ChangeTracking_AddRelationChangeInfo(
+													   relationChangeInfoArray,
+													   relationChangeInfoArrayCount,
+													   relationChangeInfoMaxSize,
+													   &(xlrec->heapnode.node),
+													   xlrec->blkno,
+													   &xlrec->heapnode.persistentTid,
+													   xlrec->heapnode.persistentSerialNum);
+					break;
+				}
 				default:
 					elog(ERROR, "internal error: unsupported RM_HEAP2_ID op (%u) in ChangeTracking_GetRelationChangeInfoFromXlog", info);
 			}
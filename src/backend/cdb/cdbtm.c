@@ -36,6 +36,7 @@
 #include "access/twophase.h"
 #include "access/distributedlog.h"
 #include "postmaster/postmaster.h"
+#include "storage/lmgr.h"
 #include "storage/procarray.h"
 #include "cdb/cdbpersistentrecovery.h"
 #include "cdb/cdbpersistentcheck.h"
@@ -93,6 +94,12 @@ static int	max_tm_gxacts = 100;
 static int	redoFileFD = -1;
 static int  redoFileOffset;
 
+/**
+ * On the QE, the gid of the distributed transaction being committed in one
+ * phase, or NULL.
+ */
+static const char *qeOnePhaseCommitGid = NULL;
+
 typedef struct InDoubtDtx
 {
 	char		gid[TMGIDSIZE];
@@ -144,6 +151,7 @@ static bool doDispatchDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 										 bool *badGangs, bool raiseError, CdbDispatchDirectDesc *direct,
 										 char *serializedDtxContextInfo, int serializedDtxContextInfoLen);
 static void doPrepareTransaction(void);
+static void doOnePhaseCommitTransaction(void);
 static void doInsertForgetCommitted(void);
 static void doNotifyingCommitPrepared(void);
 static void doNotifyingAbort(void);
@@ -318,6 +326,35 @@ isPreparedDtxTransaction(void)
 	return (currentGxact->state == DTX_STATE_PREPARED);
 }
 
+/*
+ * Is this QE committing its distributed transaction in one phase?  If so,
+ * RecordTransactionCommit does what COMMIT PREPARED would have done.
+ */
+bool
+isQEOnePhaseCommit(void)
+{
+	return qeOnePhaseCommitGid != NULL;
+}
+
+/*
+ * The distributed transaction information for the commit record of a
+ * one-phase commit on the QE.
+ */
+void
+getQEOnePhaseCommitLogInfo(TMGXACT_LOG *gxact_log)
+{
+	DistributedTransactionTimeStamp distribTimeStamp;
+
+	Assert(qeOnePhaseCommitGid != NULL);
+
+	if (strlen(qeOnePhaseCommitGid) >= TMGIDSIZE)
+		elog(PANIC, "Distribute transaction identifier too long (%d)",
+			 (int)strlen(qeOnePhaseCommitGid));
+	MemSet(gxact_log->gid, 0, TMGIDSIZE);
+	strcpy(gxact_log->gid, qeOnePhaseCommitGid);
+	dtxCrackOpenGid(qeOnePhaseCommitGid, &distribTimeStamp, &gxact_log->gxid);
+}
+
 void
 getDtxLogInfo(TMGXACT_LOG *gxact_log)
 {
@@ -696,6 +733,76 @@ doPrepareTransaction(void)
 	elog(DTM_DEBUG5, "doPrepareTransaction leaving in state = %s", DtxStateToString(currentGxact->state));
 }
 
+/*
+ * Commit a distributed transaction that only ever ran on one segment, and
+ * wrote nothing here, in a single round trip.
+ *
+ * The segment marks its local transaction committed in the distributed log
+ * under our gxid, just as COMMIT PREPARED would.  We keep the gxact, and so
+ * the gxid in the in-progress list of new distributed snapshots, until the
+ * segment acknowledges the commit; only then is it released.  There is no
+ * in-doubt state to recover, so nothing is written to our log.
+ *
+ * If the segment reports an error, the transaction aborted there, and the
+ * error aborts it here too.  If we lose the connection instead, the segment
+ * may well have committed: the command is sent again on a new gang, and the
+ * segment answers from its distributed log.
+ */
+static void
+doOnePhaseCommitTransaction(void)
+{
+	bool succeeded;
+	bool badGangs;
+	CdbDispatchDirectDesc direct=default_dispatch_direct_desc;
+
+	CHECK_FOR_INTERRUPTS();
+
+	elog(DTM_DEBUG5, "doOnePhaseCommitTransaction entering in state = %s",
+	     DtxStateToString(currentGxact->state));
+
+	Assert(currentGxact->state == DTX_STATE_ACTIVE_DISTRIBUTED);
+	Assert(currentGxact->directTransaction);
+
+	/* Don't allow a cancel while we're dispatching our commit. */
+	HOLD_INTERRUPTS();
+
+	copyDirectDispatchFromTransaction(&direct);
+
+	succeeded = doDispatchDtxProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE, /* flags */ 0,
+											 currentGxact->gid, currentGxact->gxid,
+											 &badGangs, /* raiseError */ false, &direct, NULL, 0);
+
+	if (!succeeded && badGangs)
+	{
+		elog(WARNING, "The distributed transaction 'Commit (One-Phase)' lost its connection to segment %d for gid = %s, asking again.",
+			 currentGxact->directTransactionContentId, currentGxact->gid);
+
+		disconnectAndDestroyAllGangs(true);
+		CheckForResetSession();
+
+		succeeded = doDispatchDtxProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE, /* flags */ 0,
+												 currentGxact->gid, currentGxact->gxid,
+												 &badGangs, /* raiseError */ false, &direct, NULL, 0);
+	}
+
+	RESUME_INTERRUPTS();
+
+	if (!succeeded && badGangs)
+		ereport(ERROR,
+				(errcode(ERRCODE_TRANSACTION_RESOLUTION_UNKNOWN),
+				 errmsg("the distributed transaction 'Commit (One-Phase)' could not be confirmed by segment %d for gid = %s",
+						currentGxact->directTransactionContentId, currentGxact->gid),
+				 errdetail("The transaction may have been committed.")));
+	if (!succeeded)
+		elog(ERROR, "The distributed transaction 'Commit (One-Phase)' failed on segment %d for gid = %s.",
+			 currentGxact->directTransactionContentId, currentGxact->gid);
+
+	elog(DTM_DEBUG5, "The distributed transaction 'Commit (One-Phase)' succeeded on segment %d for gid = %s.",
+		 currentGxact->directTransactionContentId, currentGxact->gid);
+
+	releaseGxact();
+}
+
 /*
  * Insert FORGET COMMITTED into the xlog.
  * Call with both ProcArrayLock and DTM lock already held.
@@ -1182,6 +1289,18 @@ prepareDtxTransaction(void)
 
 	Assert(currentGxact->state == DTX_STATE_ACTIVE_DISTRIBUTED);
 
+	/*
+	 * A transaction directed at a single segment, that wrote nothing here,
+	 * has only one participant and can skip the prepare.
+	 */
+	if (gp_enable_onephase_commit &&
+		currentGxact->directTransaction &&
+		!TransactionDidWriteXLog())
+	{
+		doOnePhaseCommitTransaction();
+		return;
+	}
+
 	/*
 	 * Broadcast PREPARE TRANSACTION to segments.
 	 */
@@ -2568,7 +2687,8 @@ createDtxSnapshot(
 
 	/*
 	 * Sort the entry {distribXid, localXid}
-	 * to support the QEs doing culls on their DisribToLocalXact sorted lists.
+	 * to support the QEs doing culls on their DisribToLocalXact sorted lists,
+	 * and the binary search of the visibility checks.
 	 */
 	qsort(
 		inProgressEntryArray,
@@ -2586,6 +2706,7 @@ createDtxSnapshot(
 	distribSnapshotWithLocalMapping->header.xmin = xmin;
 	distribSnapshotWithLocalMapping->header.xmax = xmax;
 	distribSnapshotWithLocalMapping->header.count = count;
+	DistributedSnapshotWithLocalMapping_SetLocalXidRange(distribSnapshotWithLocalMapping);
 
 	if (xmin < currentGxact->xminDistributedSnapshot)
 		currentGxact->xminDistributedSnapshot = xmin;
@@ -3996,6 +4117,104 @@ performDtxProtocolPrepare(const char *gid)
 	setDistributedTransactionContext( DTX_CONTEXT_QE_PREPARED );
 }
 
+/**
+ * On the QE, run the one-phase Commit operation.
+ */
+static void
+performDtxProtocolCommitOnePhase(const char *gid)
+{
+	StartTransactionCommand();
+
+	elog(DTM_DEBUG5, "performDtxProtocolCommand going to call EndTransactionBlock for distributed transaction (id = '%s')", gid);
+	if (!EndTransactionBlock())
+	{
+		elog(ERROR, "One-phase commit of distributed transaction %s failed", gid);
+		return;
+	}
+
+	/*
+	 * Calling CommitTransactionCommand will cause the actual COMMIT work to
+	 * be performed.  RecordTransactionCommit checks qeOnePhaseCommitGid.
+	 */
+	qeOnePhaseCommitGid = gid;
+	PG_TRY();
+	{
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		qeOnePhaseCommitGid = NULL;
+		finishDistributedTransactionContext("performDtxProtocolCommitOnePhase -- Commit (error case)", true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	qeOnePhaseCommitGid = NULL;
+
+	SIMPLE_FAULT_INJECTOR(DtmQEOnePhaseCommit);
+
+	finishDistributedTransactionContext("performDtxProtocolCommitOnePhase -- Commit", false);
+
+	elog(DTM_DEBUG5, "One-phase commit of distributed transaction succeeded (id = '%s')", gid);
+}
+
+/**
+ * On the QE, find out whether a distributed transaction was committed here
+ * in one phase, for a QD that lost the acknowledgement.
+ *
+ * The backend that ran it may still be committing it, so wait for that
+ * first; after that, the transaction committed if and only if it is in the
+ * distributed log, which crash recovery restores from the commit record.
+ *
+ * If the backend is still around, its xid is the only place to look.
+ * Otherwise the distributed log is scanned backward, but not past the
+ * transactions of an earlier incarnation of the QD: those all got their
+ * local xids before any transaction of the current one did, so a gid that
+ * never committed costs a scan of the current QD's transactions only.
+ */
+static bool
+isDtxCommittedOnePhase(const char *gid)
+{
+	DistributedTransactionTimeStamp distribTimeStamp;
+	DistributedTransactionId distribXid;
+	DistributedTransactionTimeStamp logTimeStamp;
+	DistributedTransactionId logXid;
+	TransactionId indexXid;
+	TransactionId xid;
+	bool		committed = false;
+
+	dtxCrackOpenGid(gid, &distribTimeStamp, &distribXid);
+
+	StartTransactionCommand();
+
+	xid = DistributedXidGetBackendXid(distribTimeStamp, distribXid);
+	if (TransactionIdIsValid(xid))
+	{
+		XactLockTableWait(xid);
+
+		if (DistributedLog_CommittedCheck(xid, &logTimeStamp, &logXid))
+			committed = (logTimeStamp == distribTimeStamp && logXid == distribXid);
+	}
+	else
+	{
+		indexXid = ReadNewTransactionId();
+		while (DistributedLog_ScanForPrevCommitted(&indexXid, &logTimeStamp, &logXid))
+		{
+			if (logTimeStamp < distribTimeStamp)
+				break;
+
+			if (logTimeStamp == distribTimeStamp && logXid == distribXid)
+			{
+				committed = true;
+				break;
+			}
+		}
+	}
+
+	CommitTransactionCommand();
+
+	return committed;
+}
+
 /**
  * On the QD, run the Commit Prepared operation.
  */
@@ -4146,6 +4365,44 @@ performDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 			}
 			break;
 
+		case DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE:
+			/*
+			 * The QD has directed us to commit a distributed transaction
+			 * that has no other participants.
+			 */
+			switch (DistributedTransactionContext)
+			{
+				case DTX_CONTEXT_LOCAL_ONLY:
+					/*
+					 * A retry by a QD that lost our acknowledgement, or the
+					 * transaction spontaneously aborted while we were back
+					 * at the QD.
+					 */
+					if (!isDtxCommittedOnePhase(gid))
+						elog(ERROR, "Distributed transaction %s not found", gid);
+					break;
+
+				case DTX_CONTEXT_QE_TWO_PHASE_EXPLICIT_WRITER:
+				case DTX_CONTEXT_QE_TWO_PHASE_IMPLICIT_WRITER:
+					performDtxProtocolCommitOnePhase(gid);
+					break;
+
+				case DTX_CONTEXT_QD_DISTRIBUTED_CAPABLE:
+				case DTX_CONTEXT_QD_RETRY_PHASE_2:
+				case DTX_CONTEXT_QE_PREPARED:
+				case DTX_CONTEXT_QE_FINISH_PREPARED:
+				case DTX_CONTEXT_QE_ENTRY_DB_SINGLETON:
+				case DTX_CONTEXT_QE_READER:
+					elog(FATAL, "Unexpected segment distribute transaction context: '%s'",
+						 DtxContextToString(DistributedTransactionContext));
+
+				default:
+					elog(PANIC, "Unexpected segment distribute transaction context value: %d",
+						 (int) DistributedTransactionContext);
+					break;
+			}
+			break;
+
 		case DTX_PROTOCOL_COMMAND_ABORT_SOME_PREPARED:
 			switch (DistributedTransactionContext)
 			{
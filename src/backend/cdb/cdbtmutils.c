@@ -99,6 +99,7 @@ char* DtxProtocolCommandToString(DtxProtocolCommand command)
 		case DTX_PROTOCOL_COMMAND_SUBTRANSACTION_BEGIN_INTERNAL: return " Begin Internal Subtransaction";
 		case DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL: return "Release Current Subtransaction";
 		case DTX_PROTOCOL_COMMAND_SUBTRANSACTION_ROLLBACK_INTERNAL: return "Rollback Current Subtransaction";
+		case DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE: return "Distributed Commit (One-Phase)";
 	}
 
 	return "Unknown";
@@ -302,6 +302,8 @@ int		gp_hashagg_compress_spill_files = 0;
 
 int gp_workfile_compress_algorithm = 0;
 bool gp_workfile_checksumming = false;
+/* Write workfile blocks from a helper thread */
+bool gp_workfile_write_behind = false;
 int gp_workfile_caching_loglevel = DEBUG1;
 int gp_sessionstate_loglevel = DEBUG1;
 /* Maximum disk space to use for workfiles on a segment, in kilobytes */
@@ -327,6 +329,9 @@ bool		gp_enable_fast_sri=true;
 /* Enable single-mirror pair dispatch. */
 bool		gp_enable_direct_dispatch=true;
 
+/* Commit single-segment direct dispatch transactions in one phase. */
+bool		gp_enable_onephase_commit=false;
+
 /* Disable logging while creating mapreduce objects */
 bool        gp_mapreduce_define=false;
 
@@ -23,6 +23,7 @@
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/faultinjector.h"
+#include "utils/resscheduler.h"
 #include "miscadmin.h"
 
 #include "cdb/cdbdisp.h"
@@ -945,6 +946,7 @@ buildGpQueryString(struct CdbDispatcherState *ds,
 	Oid	sessionUserId = GetSessionUserId();
 	Oid	outerUserId = GetOuterUserId();
 	Oid	currentUserId = GetUserId();
+	Oid	resQueueId = ResourceScheduler ? GetResQueueId() : InvalidOid;
 	bool sessionUserIsSuper = superuser_arg(GetSessionUserId());
 	bool outerUserIsSuper = superuser_arg(GetSessionUserId());
 
@@ -962,6 +964,7 @@ buildGpQueryString(struct CdbDispatcherState *ds,
 		sizeof(sessionUserId) + 1 /* sessionUserIsSuper */	+
 		sizeof(outerUserId) + 1 /* outerUserIsSuper */	+
 		sizeof(currentUserId) +
+		sizeof(resQueueId) +
 		sizeof(rootIdx) +
 		sizeof(n32) * 2 /* currentStatementStartTimestamp */  +
 		sizeof(command_len) +
@@ -1025,6 +1028,11 @@ buildGpQueryString(struct CdbDispatcherState *ds,
 	memcpy(pos, &tmp, sizeof(currentUserId));
 	pos += sizeof(currentUserId);
 
+	/* The QEs join the resource group of the statement's queue */
+	tmp = htonl(resQueueId);
+	memcpy(pos, &tmp, sizeof(resQueueId));
+	pos += sizeof(resQueueId);
+
 	tmp = htonl(rootIdx);
 	memcpy(pos, &tmp, sizeof(rootIdx));
 	pos += sizeof(rootIdx);
@@ -341,8 +341,17 @@ struct SendBufferPool
 
 	/* The free buffer list at the sender side. */
 	ICBufferList freeList;
+
+	/* Slab context the buffers are allocated from. */
+	MemoryContext cxt;
 };
 
+/*
+ * Number of send buffers carved out of each block of the send buffer
+ * pool's slab context.
+ */
+#define SND_BUFFER_POOL_BLOCK_BUFFERS 8
+
 /*
  * The sender side buffer pool.
  */
@@ -1458,6 +1467,9 @@ CleanupMotionUDPIFC(void)
 
 	MemoryContextDelete(ic_control_info.memContext);
 
+	/* The send buffer pool's context was a child of it */
+	snd_buffer_pool.cxt = NULL;
+
 #ifdef USE_ASSERT_CHECKING
 	/*
 	 * Check malloc times, in Interconnect part, memory are carefully released in tear down
@@ -2495,9 +2507,20 @@ computeExpirationPeriod(MotionConn *conn, uint32 retry)
 static void
 initSndBufferPool(SendBufferPool *p)
 {
+	Size		bufSize = Gp_max_packet_size + sizeof(ICBuffer);
+
 	icBufferListInit(&p->freeList, ICBufferListType_Primary);
 	p->count = 0;
 	p->maxCount = (Gp_interconnect_snd_queue_depth == 1 ? 1 : 0);
+
+	/* A previous statement may have errored out before cleaning up */
+	if (p->cxt != NULL)
+		MemoryContextDelete(p->cxt);
+
+	p->cxt = SlabContextCreate(ic_control_info.memContext,
+							   "SendBufferPool",
+							   SlabBlockSizeFor(bufSize, SND_BUFFER_POOL_BLOCK_BUFFERS),
+							   bufSize);
 }
 
 /*
@@ -2510,6 +2533,10 @@ cleanSndBufferPool(SendBufferPool *p)
     icBufferListFree(&p->freeList);
 	p->count = 0;
 	p->maxCount = 0;
+
+	if (p->cxt != NULL)
+		MemoryContextDelete(p->cxt);
+	p->cxt = NULL;
 }
 
 /*
@@ -2546,7 +2573,8 @@ getSndBuffer(MotionConn *conn)
 	{
 		if (snd_buffer_pool.count < snd_buffer_pool.maxCount)
 		{
-			ret = (ICBuffer *) palloc0(Gp_max_packet_size + sizeof(ICBuffer));
+			ret = (ICBuffer *) MemoryContextAllocZero(snd_buffer_pool.cxt,
+													  Gp_max_packet_size + sizeof(ICBuffer));
 			snd_buffer_pool.count++;
 			ret->conn = NULL;
 			ret->nRetry = 0;
@@ -0,0 +1,191 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../cdbdistributedsnapshot.c"
+#include "utils/memutils.h"
+
+#define TEST_TIMESTAMP	1234
+
+/*
+ * Sets up a distributed snapshot with the given in-progress distributed
+ * xids, and local xids (or InvalidTransactionId) for them.
+ */
+static void
+InitTestSnapshot(DistributedSnapshotWithLocalMapping *dslm,
+				 DistributedSnapshotMapEntry *entries, int count,
+				 DistributedTransactionId xmin, DistributedTransactionId xmax)
+{
+	MemSet(dslm, 0, sizeof(*dslm));
+	dslm->header.distribTransactionTimeStamp = TEST_TIMESTAMP;
+	dslm->header.distribSnapshotId = 1;
+	dslm->header.xmin = xmin;
+	dslm->header.xmax = xmax;
+	dslm->header.count = count;
+	dslm->header.maxCount = count;
+	dslm->inProgressEntryArray = entries;
+
+	DistributedSnapshotWithLocalMapping_SetLocalXidRange(dslm);
+}
+
+/*
+ * Records a committed local-distributed pair, as the distributed log would
+ * give it, in the backend-local cache.
+ */
+static void
+AddTestCommitted(TransactionId localXid, DistributedTransactionId distribXid)
+{
+	DistributedTransactionId unused;
+
+	/* The first lookup creates the cache */
+	LocalDistribXactCache_CommittedFind(localXid, TEST_TIMESTAMP, &unused);
+	LocalDistribXactCache_AddCommitted(localXid, TEST_TIMESTAMP, distribXid);
+}
+
+/* ==================== DistributedSnapshotWithLocalMapping_FindInProgress ==================== */
+
+/*
+ * Tests the binary search of the in-progress array.
+ */
+void
+test__DistributedSnapshotWithLocalMapping_FindInProgress__BinarySearch(void **state)
+{
+	DistributedSnapshotWithLocalMapping dslm;
+	DistributedSnapshotMapEntry entries[5] = {
+		{10, InvalidTransactionId},
+		{12, InvalidTransactionId},
+		{15, InvalidTransactionId},
+		{20, InvalidTransactionId},
+		{31, InvalidTransactionId}
+	};
+	int			i;
+
+	InitTestSnapshot(&dslm, entries, 5, 10, 40);
+
+	for (i = 0; i < 5; i++)
+		assert_int_equal(DistributedSnapshotWithLocalMapping_FindInProgress(&dslm, entries[i].distribXid), i);
+
+	assert_int_equal(DistributedSnapshotWithLocalMapping_FindInProgress(&dslm, 9), -1);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_FindInProgress(&dslm, 13), -1);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_FindInProgress(&dslm, 40), -1);
+
+	dslm.header.count = 0;
+	assert_int_equal(DistributedSnapshotWithLocalMapping_FindInProgress(&dslm, 10), -1);
+}
+
+/* ==================== DistributedSnapshotWithLocalMapping_CommittedTest ==================== */
+
+/*
+ * Tests that a local xid known to be in progress is found, and that the
+ * local xid of an in-progress distributed xid is learnt.
+ */
+void
+test__DistributedSnapshotWithLocalMapping_CommittedTest__InProgress(void **state)
+{
+	DistributedSnapshotWithLocalMapping dslm;
+	DistributedSnapshotMapEntry entries[3] = {
+		{10, 300},
+		{12, InvalidTransactionId},
+		{15, 310}
+	};
+
+	InitTestSnapshot(&dslm, entries, 3, 10, 20);
+	assert_int_equal(dslm.minCachedLocalXid, 300);
+	assert_int_equal(dslm.maxCachedLocalXid, 310);
+
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 310, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS);
+
+	AddTestCommitted(320, 12);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 320, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS);
+	assert_int_equal(entries[1].localXid, 320);
+	assert_int_equal(dslm.maxCachedLocalXid, 320);
+
+	/* Committed after the snapshot was taken */
+	AddTestCommitted(330, 25);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 330, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS);
+}
+
+/*
+ * Tests committed distributed transactions that are visible, and the ones
+ * that can be ignored by all distributed snapshots from now on.
+ */
+void
+test__DistributedSnapshotWithLocalMapping_CommittedTest__VisibleAndIgnore(void **state)
+{
+	DistributedSnapshotWithLocalMapping dslm;
+	DistributedSnapshotMapEntry entries[2] = {
+		{50, InvalidTransactionId},
+		{55, InvalidTransactionId}
+	};
+
+	InitTestSnapshot(&dslm, entries, 2, 50, 60);
+	assert_int_equal(dslm.minCachedLocalXid, InvalidTransactionId);
+
+	/* Below xmin, and between the in-progress ones */
+	AddTestCommitted(400, 45);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 400, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE);
+	AddTestCommitted(410, 52);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 410, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE);
+
+	/* Older than all distributed snapshots */
+	dslm.header.xminAllDistributedSnapshots = 48;
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 400, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 410, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE);
+
+	/* Local-only */
+	AddTestCommitted(420, InvalidDistributedTransactionId);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 420, false),
+					 DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE);
+}
+
+/* ==================== DistributedSnapshotWithLocalMapping_XidEpoch ==================== */
+
+/*
+ * Tests that the epoch of a local xid is derived from the next xid kept with
+ * the snapshot, on either side of a wraparound.
+ */
+void
+test__DistributedSnapshotWithLocalMapping_XidEpoch__AroundWraparound(void **state)
+{
+	DistributedSnapshotWithLocalMapping dslm;
+
+	InitTestSnapshot(&dslm, NULL, 0, 50, 60);
+	assert_int_equal(dslm.epochXid, InvalidTransactionId);
+
+	/* As if read on first use, which the stored value saves */
+	dslm.epochXid = 1000;
+	dslm.epoch = 5;
+	assert_int_equal(DistributedSnapshotWithLocalMapping_XidEpoch(&dslm, 900), 5);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_XidEpoch(&dslm, 1100), 5);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_XidEpoch(&dslm, 0xFFFFFF00), 4);
+
+	dslm.epochXid = 0xFFFFFF00;
+	assert_int_equal(DistributedSnapshotWithLocalMapping_XidEpoch(&dslm, 0xFFFFF000), 5);
+	assert_int_equal(DistributedSnapshotWithLocalMapping_XidEpoch(&dslm, 100), 6);
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__DistributedSnapshotWithLocalMapping_FindInProgress__BinarySearch),
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest__InProgress),
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest__VisibleAndIgnore),
+		unit_test(test__DistributedSnapshotWithLocalMapping_XidEpoch__AroundWraparound)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
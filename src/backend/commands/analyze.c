@@ -44,6 +44,7 @@
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/guc.h"
+#include "utils/hyperloglog.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/pg_rusage.h"
@@ -72,6 +73,20 @@ typedef struct AnlIndexData
 } AnlIndexData;
 
 
+/*
+ * Statistics of the rows of an append-only table after a watermark,
+ * collected from all the segments, see collect_ao_appended_stats().
+ */
+typedef struct AOAppendedTotals
+{
+	double		rowcount;
+	int64	   *nullcounts;		/* per column */
+	int64	   *widthsums;		/* per column */
+	HLLSketch **sketches;		/* per column */
+	AOStatsWatermark *watermark;	/* the new watermark */
+} AOAppendedTotals;
+
+
 /* Default statistics target (GUC parameter) */
 int			default_statistics_target = 10;
 
@@ -96,6 +111,22 @@ static int acquire_sample_rows(Relation onerel, HeapTuple *rows,
 					int targrows, double *totalrows, double *totaldeadrows);
 static int acquire_sample_rows_by_query(Relation onerel, int nattrs, VacAttrStats **attrstats, HeapTuple **rows,
 										int targrows, double *totalrows, double *totaldeadrows, BlockNumber *totalpages);
+static bool hll_attr_hashable(VacAttrStats *stats);
+static void compute_hll_stats(Relation onerel, int nattrs, VacAttrStats **attrstats,
+							  double totalrows);
+static bool merge_leaf_hll_sketches(Relation onerel, int nattrs, VacAttrStats **attrstats,
+									HLLSketch **sketches);
+static double acquire_hll_sketches_by_query(Relation onerel, int nattrs, VacAttrStats **attrstats,
+											HLLSketch **sketches);
+static bool ao_incremental_analyze_supported(Relation onerel);
+static AOAppendedTotals *collect_ao_appended_stats(Relation onerel, int nattrs,
+												   VacAttrStats **attrstats,
+												   AOStatsWatermark *watermark);
+static bool analyze_ao_incremental(Relation onerel, int nattrs, VacAttrStats **attrstats,
+								   double *totalrows, BlockNumber *totalpages);
+static void update_attstats_incremental(Oid relid, int natts, VacAttrStats **vacattrstats,
+										HLLSketch **sketches, double oldrows,
+										AOAppendedTotals *appended);
 static double random_fract(void);
 static double init_selection_state(int n);
 static double get_next_S(double t, int n, double *stateptr);
@@ -387,10 +418,19 @@ analyze_rel(Oid relid, VacuumStmt *vacstmt,
 	}
 
 	/*
-	 * Acquire the sample rows
+	 * Acquire the sample rows, unless the statistics of an append-only
+	 * table can be brought up to date from its new rows alone.
 	 */
-	numrows = acquire_sample_rows_by_query(onerel, attr_cnt, vacattrstats, &rows, targrows,
-										   &totalrows, &totaldeadrows, &totalpages);
+	if (gp_statistics_use_hll && !vacstmt->vacuum &&
+		analyze_ao_incremental(onerel, attr_cnt, vacattrstats,
+							   &totalrows, &totalpages))
+	{
+		numrows = 0;
+		totaldeadrows = 0;
+	}
+	else
+		numrows = acquire_sample_rows_by_query(onerel, attr_cnt, vacattrstats, &rows, targrows,
+											   &totalrows, &totaldeadrows, &totalpages);
 
 	/*
 	 * Compute the statistics.	Temporary results during the calculations for
@@ -432,6 +472,13 @@ analyze_rel(Oid relid, VacuumStmt *vacstmt,
 		MemoryContextSwitchTo(old_context);
 		MemoryContextDelete(col_context);
 
+		/*
+		 * The sample can badly underestimate the number of distinct values
+		 * of a large table. If asked to, count them from all the rows.
+		 */
+		if (gp_statistics_use_hll)
+			compute_hll_stats(onerel, attr_cnt, vacattrstats, totalrows);
+
 		/*
 		 * Emit the completed stats rows into pg_statistic, replacing any
 		 * previous statistics for the target columns.	(If there are stats in
@@ -1502,6 +1549,716 @@ acquire_sample_rows_by_query(Relation onerel, int nattrs, VacAttrStats **attrsta
 }
 
 
+/*
+ * hll_attr_hashable
+ *		Can the values of a column be added to a sketch?
+ *
+ * Only types with a default hash opclass can, see hll_hash_proc(). The
+ * other columns keep the ndistinct estimated from the sample.
+ */
+static bool
+hll_attr_hashable(VacAttrStats *stats)
+{
+	return OidIsValid(hll_hash_proc(stats->attr->atttypid));
+}
+
+/*
+ * hll_stadistinct
+ *		Turns the sketch of a column into a stadistinct, with the same
+ *		conventions as compute_scalar_stats().
+ */
+static float4
+hll_stadistinct(HLLSketch *sketch, double rowcount, float4 nullfrac)
+{
+	double		nonnullrows = rowcount * (1.0 - nullfrac);
+	double		ndistinct;
+
+	ndistinct = floor(hll_estimate(sketch) + 0.5);
+
+	/* An empty sketch means the column is all nulls; see compute_scalar_stats() */
+	if (nonnullrows < 1.0 || ndistinct < 1.0)
+		return 0.0;
+
+	if (ndistinct > nonnullrows)
+		ndistinct = nonnullrows;
+
+	if (ndistinct > 0.1 * rowcount)
+		return -(ndistinct / rowcount);
+	else
+		return ndistinct;
+}
+
+/*
+ * set_hll_slot
+ *		Stores the sketch of a column, and the watermark it was built up to
+ *		if any, in the first free slot of its statistics.
+ */
+static void
+set_hll_slot(VacAttrStats *stats, HLLSketch *sketch, AOStatsWatermark *watermark)
+{
+	int			k;
+
+	for (k = 0; k < STATISTIC_NUM_SLOTS; k++)
+	{
+		if (stats->stakind[k] == 0)
+			break;
+	}
+	if (k >= STATISTIC_NUM_SLOTS)
+		return;
+
+	stats->stakind[k] = STATISTIC_KIND_HLL;
+	stats->staop[k] = InvalidOid;
+	stats->numvalues[k] = (watermark != NULL ? 2 : 1);
+	stats->stavalues[k] = (Datum *) palloc(2 * sizeof(Datum));
+	stats->stavalues[k][0] = PointerGetDatum(sketch);
+	stats->stavalues[k][1] = PointerGetDatum(watermark);
+	stats->statypid[k] = BYTEAOID;
+	stats->statyplen[k] = -1;
+	stats->statypbyval[k] = false;
+	stats->statypalign[k] = 'i';
+}
+
+/*
+ * compute_hll_stats
+ *		Replaces the sample-based stadistinct of the columns with an estimate
+ *		counted from all the rows, using HyperLogLog sketches.
+ *
+ * The sketches are built on the segments by the gp_hll_sketch aggregate,
+ * so only one small sketch per column and segment travels to the master.
+ * For a root or interior partition, the sketches kept by its leaf
+ * partitions are merged instead, if all of them have one; the table is then
+ * not scanned at all. Leaf partitions store their sketches in pg_statistic
+ * for that purpose. So do append-only tables, together with the watermark
+ * that lets the next ANALYZE look at the new rows only, see
+ * analyze_ao_incremental().
+ *
+ * Anything else, heap tables and leaf partitions in particular, is read in
+ * full on every ANALYZE, on top of the sample. That is the price of an
+ * ndistinct over all the rows, and the reason gp_statistics_use_hll is off
+ * by default.
+ *
+ * The MCV list and histogram still come from the sample.
+ */
+static void
+compute_hll_stats(Relation onerel, int nattrs, VacAttrStats **attrstats,
+				  double totalrows)
+{
+	PartStatus	ps = rel_part_status(RelationGetRelid(onerel));
+	HLLSketch **sketches;
+	AOStatsWatermark *watermark = NULL;
+	double		rowcount = totalrows;
+	int			i;
+
+	if (nattrs <= 0)
+		return;
+
+	sketches = (HLLSketch **) palloc0(nattrs * sizeof(HLLSketch *));
+
+	if (!((ps == PART_STATUS_ROOT || ps == PART_STATUS_INTERIOR) &&
+		  merge_leaf_hll_sketches(onerel, nattrs, attrstats, sketches)))
+	{
+		MemSet(sketches, 0, nattrs * sizeof(HLLSketch *));
+
+		if (ao_incremental_analyze_supported(onerel))
+		{
+			AOAppendedTotals *totals;
+
+			/* Everything is appended after an empty watermark */
+			totals = collect_ao_appended_stats(onerel, nattrs, attrstats, NULL);
+			Assert(totals != NULL);
+
+			rowcount = totals->rowcount;
+			sketches = totals->sketches;
+			watermark = totals->watermark;
+			watermark->rowcount = (int64) rowcount;
+		}
+		else
+			rowcount = acquire_hll_sketches_by_query(onerel, nattrs, attrstats, sketches);
+	}
+
+	for (i = 0; i < nattrs; i++)
+	{
+		VacAttrStats *stats = attrstats[i];
+
+		if (!stats->stats_valid || sketches[i] == NULL ||
+			!hll_attr_hashable(stats))
+			continue;
+
+		stats->stadistinct = hll_stadistinct(sketches[i], rowcount,
+											 stats->stanullfrac);
+
+		if (ps == PART_STATUS_LEAF || watermark != NULL)
+			set_hll_slot(stats, sketches[i], watermark);
+	}
+}
+
+/*
+ * merge_leaf_hll_sketches
+ *		Merges the sketches stored for the leaf partitions below onerel.
+ *
+ * Returns false, leaving the caller to scan the table, if a leaf partition
+ * with rows has no sketch for one of the hashable columns. Empty and
+ * external leaf partitions are skipped, as acquire_sample_rows_by_query does.
+ */
+static bool
+merge_leaf_hll_sketches(Relation onerel, int nattrs, VacAttrStats **attrstats,
+						HLLSketch **sketches)
+{
+	List	   *leaves = rel_get_leaf_children_relids(RelationGetRelid(onerel));
+	ListCell   *lc;
+	int			i;
+
+	for (i = 0; i < nattrs; i++)
+		sketches[i] = hll_create();
+
+	foreach(lc, leaves)
+	{
+		Oid			leafOid = lfirst_oid(lc);
+		HeapTuple	classtup;
+		float4		reltuples;
+
+		if (get_rel_relstorage(leafOid) == RELSTORAGE_EXTERNAL)
+			continue;
+
+		classtup = SearchSysCache(RELOID, ObjectIdGetDatum(leafOid), 0, 0, 0);
+		if (!HeapTupleIsValid(classtup))
+			elog(ERROR, "cache lookup failed for relation %u", leafOid);
+		reltuples = ((Form_pg_class) GETSTRUCT(classtup))->reltuples;
+		ReleaseSysCache(classtup);
+
+		if (reltuples == 0)
+			continue;
+
+		for (i = 0; i < nattrs; i++)
+		{
+			AttrNumber	leafAttnum;
+			HeapTuple	statstup;
+			Datum	   *values;
+			int			nvalues;
+			bool		found = false;
+
+			if (!hll_attr_hashable(attrstats[i]))
+				continue;
+
+			leafAttnum = get_attnum(leafOid, NameStr(attrstats[i]->attr->attname));
+			if (leafAttnum == InvalidAttrNumber)
+				return false;
+
+			statstup = SearchSysCache(STATRELATT,
+									  ObjectIdGetDatum(leafOid),
+									  Int16GetDatum(leafAttnum),
+									  0, 0);
+			if (!HeapTupleIsValid(statstup))
+				return false;
+
+			if (get_attstatsslot(statstup, BYTEAOID, -1,
+								 STATISTIC_KIND_HLL, InvalidOid,
+								 &values, &nvalues,
+								 NULL, NULL))
+			{
+				if (nvalues >= 1)
+				{
+					HLLSketch  *leafSketch = (HLLSketch *) DatumGetByteaP(values[0]);
+
+					if (hll_is_valid(leafSketch))
+					{
+						hll_merge(sketches[i], leafSketch);
+						found = true;
+					}
+				}
+				free_attstatsslot(BYTEAOID, values, nvalues, NULL, 0);
+			}
+			ReleaseSysCache(statstup);
+
+			if (!found)
+				return false;
+		}
+	}
+
+	elog(elevel, "merged HyperLogLog sketches of %d leaf partitions of \"%s\"",
+		 list_length(leaves), RelationGetRelationName(onerel));
+
+	return true;
+}
+
+/*
+ * acquire_hll_sketches_by_query
+ *		Builds the sketch of each column over all the rows of onerel.
+ *
+ * Returns the number of rows counted. The sketches are allocated in the
+ * caller's memory context; a column with no non-null values gets an empty
+ * one. This reads the whole table, on every ANALYZE.
+ */
+static double
+acquire_hll_sketches_by_query(Relation onerel, int nattrs, VacAttrStats **attrstats,
+							  HLLSketch **sketches)
+{
+	StringInfoData str;
+	StringInfoData columnStr;
+	StringInfoData sketchStr;
+	const char *schemaName;
+	int			i;
+	int			ret;
+	double		rowcount;
+	Datum		d;
+	bool		isNull;
+	MemoryContext oldcxt;
+
+	schemaName = get_namespace_name(RelationGetNamespace(onerel));
+
+	initStringInfo(&columnStr);
+	initStringInfo(&sketchStr);
+	for (i = 0; i < nattrs; i++)
+	{
+		const char *attname = quote_identifier(NameStr(attrstats[i]->attr->attname));
+
+		if (i != 0)
+			appendStringInfo(&columnStr, ", ");
+		appendStringInfo(&columnStr, "Ta.%s", attname);
+		if (hll_attr_hashable(attrstats[i]))
+			appendStringInfo(&sketchStr, ", pg_catalog.gp_hll_sketch(Ta.%s)", attname);
+		else
+			appendStringInfo(&sketchStr, ", NULL::pg_catalog.bytea");
+	}
+
+	/* As in acquire_sample_rows_by_query, external partitions are skipped */
+	initStringInfo(&str);
+	appendStringInfo(&str, "select pg_catalog.count(*)%s from ", sketchStr.data);
+	if (rel_has_external_partition(RelationGetRelid(onerel)))
+	{
+		PartitionNode *pn = get_parts(RelationGetRelid(onerel), 0 /*level*/ ,
+								0 /*parent*/, false /* inctemplate */, false /*includesubparts*/);
+		ListCell   *lc;
+		bool		isFirst = true;
+
+		appendStringInfo(&str, "(");
+		foreach(lc, pn->rules)
+		{
+			PartitionRule *rule = lfirst(lc);
+
+			if (get_rel_relstorage(rule->parchildrelid) == RELSTORAGE_EXTERNAL)
+				continue;
+
+			if (!isFirst)
+				appendStringInfo(&str, " UNION ALL ");
+			isFirst = false;
+
+			appendStringInfo(&str, "select %s from %s.%s as Ta",
+							 columnStr.data,
+							 quote_identifier(schemaName),
+							 quote_identifier(get_rel_name(rule->parchildrelid)));
+		}
+		appendStringInfo(&str, ") as Ta");
+
+		/* Nothing but external partitions */
+		if (isFirst)
+			return 0;
+	}
+	else
+		appendStringInfo(&str, "%s.%s as Ta",
+						 quote_identifier(schemaName),
+						 quote_identifier(RelationGetRelationName(onerel)));
+
+	oldcxt = CurrentMemoryContext;
+
+	if (SPI_OK_CONNECT != SPI_connect())
+		ereport(ERROR, (errcode(ERRCODE_CDB_INTERNAL_ERROR),
+						errmsg("Unable to connect to execute internal query.")));
+
+	elog(elevel, "Executing SQL: %s", str.data);
+
+	/* See acquire_sample_rows_by_query about disabling ORCA */
+	{
+		bool		optimizerBackup = optimizer;
+
+		optimizer = false;
+
+		PG_TRY();
+		{
+			ret = SPI_execute(str.data, false, 0);
+			Assert(ret > 0);
+
+			optimizer = optimizerBackup;
+		}
+		PG_CATCH();
+		{
+			optimizer = optimizerBackup;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+	}
+
+	Assert(SPI_processed == 1);
+
+	d = heap_getattr(SPI_tuptable->vals[0], 1, SPI_tuptable->tupdesc, &isNull);
+	rowcount = isNull ? 0 : (double) DatumGetInt64(d);
+
+	MemoryContextSwitchTo(oldcxt);
+	for (i = 0; i < nattrs; i++)
+	{
+		HLLSketch  *sketch = NULL;
+
+		d = heap_getattr(SPI_tuptable->vals[0], i + 2, SPI_tuptable->tupdesc, &isNull);
+		if (!isNull)
+			sketch = (HLLSketch *) DatumGetByteaPCopy(d);
+
+		/* Keep an empty sketch for all-null columns, so that parents can merge it */
+		sketches[i] = (hll_is_valid(sketch) ? sketch : hll_create());
+	}
+
+	SPI_finish();
+
+	return rowcount;
+}
+
+/*
+ * ao_incremental_analyze_supported
+ *		Can the statistics of onerel be maintained incrementally?
+ *
+ * Only row-oriented append-only tables spread over the segments qualify,
+ * and not partitioned ones: their rows are in the leaf partitions.
+ */
+static bool
+ao_incremental_analyze_supported(Relation onerel)
+{
+	PartStatus	ps = rel_part_status(RelationGetRelid(onerel));
+
+	return gp_statistics_incremental_threshold > 0 &&
+		RelationIsAoRows(onerel) &&
+		(ps == PART_STATUS_NONE || ps == PART_STATUS_LEAF) &&
+		GpPolicyFetch(CurrentMemoryContext, RelationGetRelid(onerel))->ptype != POLICYTYPE_ENTRY;
+}
+
+/*
+ * collect_ao_appended_stats
+ *		Collects the statistics of the rows of an append-only table after
+ *		a watermark, from all the segments.
+ *
+ * Only the data after the watermark is read. A NULL watermark reads the
+ * whole table. Returns NULL if the table was changed other than by appends
+ * since the watermark. The new watermark is returned with its rowcount
+ * left for the caller to fill in.
+ */
+static AOAppendedTotals *
+collect_ao_appended_stats(Relation onerel, int nattrs, VacAttrStats **attrstats,
+						  AOStatsWatermark *watermark)
+{
+	StringInfoData str;
+	StringInfoData attnumStr;
+	Oid			argtypes[1] = {BYTEAOID};
+	Datum		args[1];
+	AOAppendedTotals *totals;
+	AOAppendedStats **segstats;
+	int			nsegstats;
+	int			nentries = 0;
+	int			ret;
+	int			i,
+				j;
+	MemoryContext oldcxt;
+
+	initStringInfo(&attnumStr);
+	for (i = 0; i < nattrs; i++)
+		appendStringInfo(&attnumStr, "%s%d", (i == 0 ? "" : ","),
+						 attrstats[i]->tupattnum);
+
+	initStringInfo(&str);
+	appendStringInfo(&str, "select pg_catalog.gp_statistics_ao_appended_stats_oid(c.oid, '{%s}'::int2[], $1) "
+					 "from gp_dist_random('pg_class') c where c.oid = %u",
+					 attnumStr.data, RelationGetRelid(onerel));
+
+	if (watermark != NULL)
+		args[0] = PointerGetDatum(watermark);
+	else
+	{
+		bytea	   *empty = (bytea *) palloc(VARHDRSZ);
+
+		SET_VARSIZE(empty, VARHDRSZ);
+		args[0] = PointerGetDatum(empty);
+	}
+
+	oldcxt = CurrentMemoryContext;
+
+	if (SPI_OK_CONNECT != SPI_connect())
+		ereport(ERROR, (errcode(ERRCODE_CDB_INTERNAL_ERROR),
+						errmsg("Unable to connect to execute internal query.")));
+
+	elog(elevel, "Executing SQL: %s", str.data);
+
+	/* See acquire_sample_rows_by_query about disabling ORCA */
+	{
+		bool		optimizerBackup = optimizer;
+
+		optimizer = false;
+
+		PG_TRY();
+		{
+			ret = SPI_execute_with_args(str.data, 1, argtypes, args, NULL, false, 0);
+			Assert(ret > 0);
+
+			optimizer = optimizerBackup;
+		}
+		PG_CATCH();
+		{
+			optimizer = optimizerBackup;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	nsegstats = SPI_processed;
+	segstats = (AOAppendedStats **) palloc(Max(nsegstats, 1) * sizeof(AOAppendedStats *));
+	for (i = 0; i < nsegstats; i++)
+	{
+		Datum		d;
+		bool		isNull;
+
+		d = heap_getattr(SPI_tuptable->vals[i], 1, SPI_tuptable->tupdesc, &isNull);
+		if (isNull)
+		{
+			SPI_finish();
+			return NULL;
+		}
+
+		segstats[i] = (AOAppendedStats *) DatumGetByteaPCopy(d);
+		if (segstats[i]->natts != nattrs ||
+			VARSIZE(segstats[i]) != AOAppendedStatsSize(nattrs, segstats[i]->nentries))
+			ereport(ERROR,
+					(errcode(ERRCODE_CDB_INTERNAL_ERROR),
+					 errmsg("invalid append-only statistics received from segment")));
+		nentries += segstats[i]->nentries;
+	}
+
+	SPI_finish();
+
+	totals = (AOAppendedTotals *) palloc0(sizeof(AOAppendedTotals));
+	totals->nullcounts = (int64 *) palloc0(nattrs * sizeof(int64));
+	totals->widthsums = (int64 *) palloc0(nattrs * sizeof(int64));
+	totals->sketches = (HLLSketch **) palloc(nattrs * sizeof(HLLSketch *));
+	for (j = 0; j < nattrs; j++)
+		totals->sketches[j] = hll_create();
+
+	totals->watermark = (AOStatsWatermark *) palloc0(AOStatsWatermarkSize(nentries));
+	SET_VARSIZE(totals->watermark, AOStatsWatermarkSize(nentries));
+	totals->watermark->relfilenode = onerel->rd_rel->relfilenode;
+
+	nentries = 0;
+	for (i = 0; i < nsegstats; i++)
+	{
+		totals->rowcount += segstats[i]->rowcount;
+
+		for (j = 0; j < nattrs; j++)
+		{
+			AOAppendedColumnStats *col = AOAppendedStatsColumn(segstats[i], j);
+
+			totals->nullcounts[j] += col->nullcount;
+			totals->widthsums[j] += col->widthsum;
+			hll_merge(totals->sketches[j], (HLLSketch *) col->sketch);
+		}
+
+		memcpy(&totals->watermark->entries[nentries],
+			   AOAppendedStatsEntries(segstats[i]),
+			   segstats[i]->nentries * sizeof(AOStatsWatermarkEntry));
+		nentries += segstats[i]->nentries;
+
+		pfree(segstats[i]);
+	}
+	pfree(segstats);
+
+	return totals;
+}
+
+/*
+ * analyze_ao_incremental
+ *		Brings the statistics of an append-only table up to date by looking
+ *		only at the rows appended since the last ANALYZE.
+ *
+ * That is possible if every column has a sketch and a watermark stored by
+ * compute_hll_stats(), all with the same watermark, and the table has only
+ * been appended to since, by at most gp_statistics_incremental_threshold of
+ * its rows. The number of distinct values, null fraction and width then
+ * take the new rows into account; the MCV list, histogram and correlation
+ * are kept as they were. Returns false if a full ANALYZE is needed.
+ */
+static bool
+analyze_ao_incremental(Relation onerel, int nattrs, VacAttrStats **attrstats,
+					   double *totalrows, BlockNumber *totalpages)
+{
+	Oid			relid = RelationGetRelid(onerel);
+	AOStatsWatermark *watermark = NULL;
+	HLLSketch **sketches;
+	AOAppendedTotals *appended;
+	float4		relTuples;
+	float4		relPages;
+	int			i;
+
+	if (nattrs <= 0 || !ao_incremental_analyze_supported(onerel))
+		return false;
+
+	sketches = (HLLSketch **) palloc0(nattrs * sizeof(HLLSketch *));
+
+	for (i = 0; i < nattrs; i++)
+	{
+		AOStatsWatermark *thisWatermark = NULL;
+		HeapTuple	statstup;
+		Datum	   *values;
+		int			nvalues;
+
+		statstup = SearchSysCache(STATRELATT,
+								  ObjectIdGetDatum(relid),
+								  Int16GetDatum(attrstats[i]->attr->attnum),
+								  0, 0);
+		if (!HeapTupleIsValid(statstup))
+			return false;
+
+		if (get_attstatsslot(statstup, BYTEAOID, -1,
+							 STATISTIC_KIND_HLL, InvalidOid,
+							 &values, &nvalues,
+							 NULL, NULL))
+		{
+			if (nvalues == 2)
+			{
+				sketches[i] = (HLLSketch *) DatumGetByteaPCopy(values[0]);
+				thisWatermark = (AOStatsWatermark *) DatumGetByteaPCopy(values[1]);
+			}
+			free_attstatsslot(BYTEAOID, values, nvalues, NULL, 0);
+		}
+		ReleaseSysCache(statstup);
+
+		if (thisWatermark == NULL || !hll_is_valid(sketches[i]))
+			return false;
+
+		if (watermark == NULL)
+			watermark = thisWatermark;
+		else if (VARSIZE(thisWatermark) != VARSIZE(watermark) ||
+				 memcmp(thisWatermark, watermark, VARSIZE(watermark)) != 0)
+			return false;
+	}
+
+	if (watermark->relfilenode != onerel->rd_rel->relfilenode)
+		return false;
+
+	appended = collect_ao_appended_stats(onerel, nattrs, attrstats, watermark);
+	if (appended == NULL)
+	{
+		elog(elevel, "\"%s\" was changed other than by appends since it was last analyzed",
+			 RelationGetRelationName(onerel));
+		return false;
+	}
+
+	if (appended->rowcount > gp_statistics_incremental_threshold * watermark->rowcount)
+	{
+		elog(elevel, "%.0f rows were appended to \"%s\" since it was last analyzed, too many to analyze incrementally",
+			 appended->rowcount, RelationGetRelationName(onerel));
+		return false;
+	}
+
+	elog(elevel, "analyzing \"%s\" incrementally, %.0f rows were appended since it was last analyzed",
+		 RelationGetRelationName(onerel), appended->rowcount);
+
+	appended->watermark->rowcount = watermark->rowcount + (int64) appended->rowcount;
+	update_attstats_incremental(relid, nattrs, attrstats, sketches,
+								(double) watermark->rowcount, appended);
+
+	analyzeEstimateReltuplesRelpages(relid, &relTuples, &relPages, false);
+	*totalrows = (double) appended->watermark->rowcount;
+	*totalpages = relPages;
+
+	return true;
+}
+
+/*
+ * update_attstats_incremental
+ *		Merges the statistics of appended rows into the pg_statistic rows of
+ *		the columns, for analyze_ao_incremental().
+ *
+ * sketches are those stored for the oldrows rows up to the old watermark.
+ */
+static void
+update_attstats_incremental(Oid relid, int natts, VacAttrStats **vacattrstats,
+							HLLSketch **sketches, double oldrows,
+							AOAppendedTotals *appended)
+{
+	Relation	sd;
+	double		rowcount = oldrows + appended->rowcount;
+	int			i;
+
+	sd = heap_open(StatisticRelationId, RowExclusiveLock);
+
+	for (i = 0; i < natts; i++)
+	{
+		Form_pg_statistic form;
+		HeapTuple	oldtup,
+					stup;
+		Datum		values[Natts_pg_statistic];
+		bool		nulls[Natts_pg_statistic];
+		char		replaces[Natts_pg_statistic];
+		Datum		slotvalues[2];
+		double		oldnulls;
+		double		nonnullrows;
+		float4		nullfrac;
+		int32		width;
+		int			k;
+
+		oldtup = SearchSysCache(STATRELATT,
+								ObjectIdGetDatum(relid),
+								Int16GetDatum(vacattrstats[i]->attr->attnum),
+								0, 0);
+		if (!HeapTupleIsValid(oldtup))
+			elog(ERROR, "cache lookup failed for statistics of attribute %d of relation %u",
+				 vacattrstats[i]->attr->attnum, relid);
+		form = (Form_pg_statistic) GETSTRUCT(oldtup);
+
+		for (k = 0; k < STATISTIC_NUM_SLOTS; k++)
+		{
+			if ((&form->stakind1)[k] == STATISTIC_KIND_HLL)
+				break;
+		}
+		Assert(k < STATISTIC_NUM_SLOTS);
+
+		oldnulls = oldrows * form->stanullfrac;
+		nullfrac = (rowcount > 0 ?
+					(oldnulls + appended->nullcounts[i]) / rowcount : 0.0);
+		nonnullrows = rowcount - oldnulls - appended->nullcounts[i];
+		if (nonnullrows >= 1.0)
+			width = (int32) ((form->stawidth * (oldrows - oldnulls) +
+							  appended->widthsums[i]) / nonnullrows);
+		else
+			width = form->stawidth;
+
+		hll_merge(sketches[i], appended->sketches[i]);
+
+		MemSet(nulls, false, sizeof(nulls));
+		MemSet(replaces, ' ', sizeof(replaces));
+
+		values[Anum_pg_statistic_stanullfrac - 1] = Float4GetDatum(nullfrac);
+		replaces[Anum_pg_statistic_stanullfrac - 1] = 'r';
+		values[Anum_pg_statistic_stawidth - 1] = Int32GetDatum(width);
+		replaces[Anum_pg_statistic_stawidth - 1] = 'r';
+		values[Anum_pg_statistic_stadistinct - 1] =
+			Float4GetDatum(hll_stadistinct(sketches[i], rowcount, nullfrac));
+		replaces[Anum_pg_statistic_stadistinct - 1] = 'r';
+
+		slotvalues[0] = PointerGetDatum(sketches[i]);
+		slotvalues[1] = PointerGetDatum(appended->watermark);
+		values[Anum_pg_statistic_stavalues1 - 1 + k] =
+			PointerGetDatum(construct_array(slotvalues, 2, BYTEAOID, -1, false, 'i'));
+		replaces[Anum_pg_statistic_stavalues1 - 1 + k] = 'r';
+
+		stup = heap_modify_tuple(oldtup, RelationGetDescr(sd), values, nulls, replaces);
+		ReleaseSysCache(oldtup);
+		simple_heap_update(sd, &stup->t_self, stup);
+
+		/* update indexes too */
+		CatalogUpdateIndexes(sd, stup);
+
+		heap_freetuple(stup);
+	}
+
+	heap_close(sd, RowExclusiveLock);
+}
+
 /**
  * This method estimates reltuples/relpages for a relation. To do this, it employs
  * the built-in function 'gp_statistics_estimate_reltuples_relpages'. If the table to be
@@ -1759,12 +2516,20 @@ update_attstats(Oid relid, int natts, VacAttrStats **vacattrstats)
 			{
 				ArrayType  *arry;
 
-				arry = construct_array(stats->stavalues[k],
-									   stats->numvalues[k],
-									   stats->attr->atttypid,
-									   stats->attrtype->typlen,
-									   stats->attrtype->typbyval,
-									   stats->attrtype->typalign);
+				if (OidIsValid(stats->statypid[k]))
+					arry = construct_array(stats->stavalues[k],
+										   stats->numvalues[k],
+										   stats->statypid[k],
+										   stats->statyplen[k],
+										   stats->statypbyval[k],
+										   stats->statypalign[k]);
+				else
+					arry = construct_array(stats->stavalues[k],
+										   stats->numvalues[k],
+										   stats->attr->atttypid,
+										   stats->attrtype->typlen,
+										   stats->attrtype->typbyval,
+										   stats->attrtype->typalign);
 				values[i++] = PointerGetDatum(arry);	/* stavaluesN */
 			}
 			else
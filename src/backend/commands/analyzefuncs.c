@@ -1,12 +1,19 @@
 #include "postgres.h"
 
 #include "access/aocssegfiles.h"
+#include "access/appendonly_visimap.h"
+#include "access/tuptoaster.h"
 #include "catalog/pg_appendonly_fn.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbfilerepprimary.h"
 #include "cdb/cdbvars.h"
+#include "commands/vacuum.h"
+#include "executor/executor.h"
 #include "storage/bufmgr.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
+#include "utils/hyperloglog.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "miscadmin.h"
 
@@ -20,6 +27,8 @@ bool			gp_statistics_use_fkeys = FALSE;
 int				gp_statistics_blocks_target = 25;
 double			gp_statistics_ndistinct_scaling_ratio_threshold = 0.10;
 double			gp_statistics_sampling_threshold = 10000;
+bool			gp_statistics_use_hll = FALSE;
+double			gp_statistics_incremental_threshold = 0.10;
 
 /**
  * This method estimates the number of tuples and pages in a heaptable relation. Getting the number of blocks is straightforward.
@@ -370,3 +379,247 @@ gp_statistics_estimate_reltuples_relpages_oid(PG_FUNCTION_ARGS)
 
 	PG_RETURN_ARRAYTYPE_P(result);
 }
+
+/*
+ * Does watermark entry e still describe the segment file fsinfo, with data
+ * at most appended to it since?
+ *
+ * On a segment, the modcount of a segment file only moves when rows are
+ * written to it, by an insert or by compaction. So it must not have moved
+ * unless the file grew, and a file that did not grow must be exactly as it
+ * was. Deletes and updates show up in the hidden tuple count instead.
+ */
+static bool
+ao_watermark_entry_still_valid(AOStatsWatermarkEntry *e, FileSegInfo *fsinfo,
+							   int64 hiddentupcount)
+{
+	if (fsinfo->state == AOSEG_STATE_AWAITING_DROP ||
+		hiddentupcount != e->hiddentupcount ||
+		fsinfo->modcount < e->modcount)
+		return false;
+
+	if (fsinfo->modcount == e->modcount)
+		return fsinfo->eof == e->eof;
+
+	return fsinfo->eof > e->eof;
+}
+
+/**
+ * Collects the statistics of the rows appended to an append-only table
+ * after a watermark, see AOStatsWatermark. Like
+ * gp_statistics_estimate_reltuples_relpages_oid, this only looks at local
+ * information, and is run on every segment by ANALYZE.
+ *
+ * Only the part of each segment file after the EOF in the watermark is
+ * read. An empty watermark reads the whole table.
+ * Input:
+ * 	relationoid
+ * 	attnums - columns to collect statistics of
+ * 	watermark - the watermark of all the segments
+ * Output:
+ * 	AOAppendedStats, or NULL if rows were deleted or updated, or segment
+ * 	files compacted, since the watermark.
+ */
+Datum
+gp_statistics_ao_appended_stats_oid(PG_FUNCTION_ARGS)
+{
+	Oid			relOid = PG_GETARG_OID(0);
+	ArrayType  *attnumArray = PG_GETARG_ARRAYTYPE_P(1);
+	bytea	   *watermarkBytes = PG_GETARG_BYTEA_P_COPY(2);
+	AOStatsWatermark *watermark = NULL;
+	int			nwatermark = 0;
+	Datum	   *attnumDatums;
+	int			natts;
+	Relation	rel;
+	TupleDesc	tupdesc;
+	FmgrInfo   *hashprocs;
+	FileSegInfo **seginfo;
+	int			segfile_count;
+	int64	   *startOffsets;
+	int64	   *hiddentupcounts;
+	AppendOnlyVisimap visimap;
+	AOAppendedStats *result;
+	AOStatsWatermarkEntry *entries;
+	AppendOnlyScanDesc scan;
+	TupleTableSlot *slot;
+	MemoryContext tupleContext;
+	MemoryContext oldcxt;
+	int			nentries;
+	int			i,
+				j;
+
+	deconstruct_array(attnumArray, INT2OID, sizeof(int16), true, 's',
+					  &attnumDatums, NULL, &natts);
+
+	if (VARSIZE(watermarkBytes) > VARHDRSZ)
+	{
+		watermark = (AOStatsWatermark *) watermarkBytes;
+		if (VARSIZE(watermark) < AOStatsWatermarkSize(0) ||
+			(VARSIZE(watermark) - AOStatsWatermarkSize(0)) % sizeof(AOStatsWatermarkEntry) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("invalid append-only statistics watermark")));
+		nwatermark = AOStatsWatermarkNumEntries(watermark);
+	}
+
+	rel = heap_open(relOid, AccessShareLock);
+	if (!RelationIsAoRows(rel))
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not an append-only row-oriented table",
+						RelationGetRelationName(rel))));
+	tupdesc = RelationGetDescr(rel);
+
+	/* Columns whose type has no hash function are left with an empty sketch */
+	hashprocs = (FmgrInfo *) palloc0(Max(natts, 1) * sizeof(FmgrInfo));
+	for (i = 0; i < natts; i++)
+	{
+		AttrNumber	attnum = DatumGetInt16(attnumDatums[i]);
+		Oid			procid;
+
+		if (attnum <= 0 || attnum > tupdesc->natts ||
+			tupdesc->attrs[attnum - 1]->attisdropped)
+			elog(ERROR, "invalid column number %d for relation \"%s\"",
+				 attnum, RelationGetRelationName(rel));
+
+		procid = hll_hash_proc(tupdesc->attrs[attnum - 1]->atttypid);
+		if (OidIsValid(procid))
+			fmgr_info(procid, &hashprocs[i]);
+	}
+
+	seginfo = GetAllFileSegInfo(rel, ActiveSnapshot, &segfile_count);
+	startOffsets = (int64 *) palloc0(Max(segfile_count, 1) * sizeof(int64));
+	hiddentupcounts = (int64 *) palloc0(Max(segfile_count, 1) * sizeof(int64));
+
+	AppendOnlyVisimap_Init(&visimap,
+						   rel->rd_appendonly->visimaprelid,
+						   rel->rd_appendonly->visimapidxid,
+						   AccessShareLock,
+						   ActiveSnapshot);
+	for (j = 0; j < segfile_count; j++)
+		hiddentupcounts[j] =
+			AppendOnlyVisimap_GetSegmentFileHiddenTupleCount(&visimap, seginfo[j]->segno);
+	AppendOnlyVisimap_Finish(&visimap, AccessShareLock);
+
+	/*
+	 * Start each segment file at its EOF in the watermark, after checking
+	 * that it has only been appended to since.
+	 */
+	for (i = 0; i < nwatermark; i++)
+	{
+		AOStatsWatermarkEntry *e = &watermark->entries[i];
+		bool		valid = false;
+
+		if (e->contentid != GpIdentity.segindex)
+			continue;
+
+		for (j = 0; j < segfile_count; j++)
+		{
+			if (seginfo[j]->segno == e->segno)
+			{
+				valid = ao_watermark_entry_still_valid(e, seginfo[j], hiddentupcounts[j]);
+				startOffsets[j] = e->eof;
+				break;
+			}
+		}
+
+		if (!valid)
+		{
+			FreeAllSegFileInfo(seginfo, segfile_count);
+			pfree(seginfo);
+			heap_close(rel, AccessShareLock);
+			PG_RETURN_NULL();
+		}
+	}
+
+	nentries = 0;
+	for (j = 0; j < segfile_count; j++)
+	{
+		if (seginfo[j]->eof > 0 && seginfo[j]->state != AOSEG_STATE_AWAITING_DROP)
+			nentries++;
+	}
+
+	result = (AOAppendedStats *) palloc0(AOAppendedStatsSize(natts, nentries));
+	SET_VARSIZE(result, AOAppendedStatsSize(natts, nentries));
+	result->natts = natts;
+	result->nentries = nentries;
+
+	for (i = 0; i < natts; i++)
+	{
+		HLLSketch  *sketch = (HLLSketch *) AOAppendedStatsColumn(result, i)->sketch;
+
+		SET_VARSIZE(sketch, HLL_SKETCH_SIZE);
+		sketch->precision = HLL_PRECISION;
+	}
+
+	entries = AOAppendedStatsEntries(result);
+	nentries = 0;
+	for (j = 0; j < segfile_count; j++)
+	{
+		if (seginfo[j]->eof > 0 && seginfo[j]->state != AOSEG_STATE_AWAITING_DROP)
+		{
+			entries[nentries].contentid = GpIdentity.segindex;
+			entries[nentries].segno = seginfo[j]->segno;
+			entries[nentries].eof = seginfo[j]->eof;
+			entries[nentries].hiddentupcount = hiddentupcounts[j];
+			entries[nentries].modcount = seginfo[j]->modcount;
+			nentries++;
+		}
+	}
+
+	/* The scan takes over seginfo and startOffsets */
+	scan = appendonly_beginscan_from_offsets(rel, ActiveSnapshot, ActiveSnapshot,
+											 seginfo, segfile_count,
+											 startOffsets);
+	slot = MakeSingleTupleTableSlot(tupdesc);
+	tupleContext = AllocSetContextCreate(CurrentMemoryContext,
+										 "AO appended stats",
+										 ALLOCSET_DEFAULT_MINSIZE,
+										 ALLOCSET_DEFAULT_INITSIZE,
+										 ALLOCSET_DEFAULT_MAXSIZE);
+
+	while (appendonly_getnext(scan, ForwardScanDirection, slot) != NULL)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		result->rowcount++;
+
+		oldcxt = MemoryContextSwitchTo(tupleContext);
+		for (i = 0; i < natts; i++)
+		{
+			AOAppendedColumnStats *col = AOAppendedStatsColumn(result, i);
+			AttrNumber	attnum = DatumGetInt16(attnumDatums[i]);
+			Form_pg_attribute attr = tupdesc->attrs[attnum - 1];
+			Datum		value;
+			bool		isnull;
+
+			value = slot_getattr(slot, attnum, &isnull);
+			if (isnull)
+			{
+				col->nullcount++;
+				continue;
+			}
+
+			/* Same widths as compute_scalar_stats() */
+			if (attr->attlen > 0)
+				col->widthsum += attr->attlen;
+			else if (attr->attlen == -1)
+				col->widthsum += toast_raw_datum_size(value);
+			else
+				col->widthsum += strlen(DatumGetCString(value)) + 1;
+
+			if (OidIsValid(hashprocs[i].fn_oid))
+				hll_add_hash((HLLSketch *) col->sketch,
+							 hll_hash_datum(&hashprocs[i], value));
+		}
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextReset(tupleContext);
+	}
+
+	MemoryContextDelete(tupleContext);
+	ExecDropSingleTupleTableSlot(slot);
+	appendonly_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	PG_RETURN_BYTEA_P(result);
+}
@@ -69,6 +69,7 @@
 #include "commands/vacuum.h"
 #include "utils/lsyscache.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/clauses.h"
 #include "postmaster/autostats.h"
 
 /* DestReceiver for COPY (SELECT) TO */
@@ -78,12 +79,26 @@ typedef struct
 	CopyState	cstate;			/* CopyStateData for the command */
 } DR_copy;
 
+/* replaced by the segment's content id in COPY ... ON SEGMENT file names */
+#define COPY_SEGID_PLACEHOLDER "<SEGID>"
+
 /* non-export function prototypes */
 static void DoCopyTo(CopyState cstate);
 extern void CopyToDispatch(CopyState cstate);
 static void CopyTo(CopyState cstate);
 extern void CopyFromDispatch(CopyState cstate);
 static void CopyFrom(CopyState cstate);
+typedef struct CopyAoInsertDescPool CopyAoInsertDescPool;
+static void CopyPartitionAoInsertDesc(CopyAoInsertDescPool *pool,
+						  EState *estate, ResultRelInfo *resultRelInfo,
+						  char relstorage, List *ao_segnos);
+static void CopyFromInsertBatch(CopyState cstate, EState *estate,
+					CommandId mycid, bool use_wal, bool use_fsm,
+					ResultRelInfo *resultRelInfo, TupleTableSlot *baseSlot,
+					HeapTuple *bufferedTuples, int64 *bufferedLinenos,
+					int nBufferedTuples);
+static void CopyOnSegmentDispatch(CopyState cstate, const CopyStmt *stmt);
+static char *CopyOnSegmentFileName(const char *filename);
 static char *CopyReadOidAttr(CopyState cstate, bool *isnull);
 static void CopyAttributeOutText(CopyState cstate, char *string);
 static void CopyAttributeOutCSV(CopyState cstate, char *string,
@@ -207,10 +222,10 @@ else \
 	}\
 	else\
 	{\
-		if (Gp_role == GP_ROLE_EXECUTE)\
+		if (cstate->err_loc_type == ROWNUM_EMBEDDED)\
 		{\
 			/* if line has embedded rownum, update the cursor to the pos right after */ \
-			Insist(cstate->err_loc_type == ROWNUM_EMBEDDED);\
+			Insist(Gp_role == GP_ROLE_EXECUTE);\
 			cstate->line_buf.cursor = 0;\
 			if(!cstate->md_error) \
 				CopyExtractRowMetaData(cstate); \
@@ -893,7 +908,7 @@ uint64
 DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 {
 	bool		is_from = stmt->is_from;
-	bool		pipe = (stmt->filename == NULL || Gp_role == GP_ROLE_EXECUTE);
+	bool		pipe;
 	List	   *attnamelist = stmt->attlist;
 	List	   *force_quote = NIL;
 	List	   *force_notnull = NIL;
@@ -903,7 +918,7 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 	TupleDesc   tupDesc;
 	int         num_phys_attrs;
 	uint64      processed;
-	bool        qe_copy_from = (is_from && (Gp_role == GP_ROLE_EXECUTE));
+	bool        qe_copy_from;
     /* save relationOid for auto-stats */
 	Oid         relationOid = InvalidOid;
 
@@ -1016,11 +1031,48 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 						 errmsg("conflicting or redundant options")));
 			cstate->eol_str = strVal(defel->arg);
 		}
+		else if (strcmp(defel->defname, "on_segment") == 0)
+		{
+			if (cstate->on_segment)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			cstate->on_segment = intVal(defel->arg);
+		}
 		else
 			elog(ERROR, "option \"%s\" not recognized",
 				 defel->defname);
 	}
 
+	/*
+	 * COPY ON SEGMENT: every segment reads or writes its own file, named
+	 * after the given path with <SEGID> replaced by the segment's content
+	 * id. The dispatcher itself touches no file at all.
+	 */
+	if (cstate->on_segment)
+	{
+		if (stmt->filename == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("COPY ON SEGMENT requires a file name")));
+
+		if (strstr(stmt->filename, COPY_SEGID_PLACEHOLDER) == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("file name for COPY ON SEGMENT must contain the string \"%s\"",
+							COPY_SEGID_PLACEHOLDER)));
+
+		if (stmt->query)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY (SELECT) ON SEGMENT is not supported")));
+	}
+
+	/* QE COPY always uses STDIN/STDOUT, unless it was asked to work ON SEGMENT */
+	pipe = (stmt->filename == NULL ||
+			(Gp_role == GP_ROLE_EXECUTE && !cstate->on_segment));
+	qe_copy_from = (is_from && Gp_role == GP_ROLE_EXECUTE && !cstate->on_segment);
+
 	/* Set defaults */
 
 	cstate->err_loc_type = ROWNUM_ORIGINAL;
@@ -1124,7 +1176,11 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 						 "psql's \\copy command also works for anyone.")));
 
 	cstate->copy_dest = COPY_FILE;		/* default */
-	cstate->filename = (Gp_role == GP_ROLE_EXECUTE ? NULL : stmt->filename); /* QE COPY always uses STDIN */
+	if (cstate->on_segment)
+		cstate->filename = (Gp_role == GP_ROLE_DISPATCH ? NULL :
+							CopyOnSegmentFileName(stmt->filename));
+	else
+		cstate->filename = (Gp_role == GP_ROLE_EXECUTE ? NULL : stmt->filename); /* QE COPY always uses STDIN */
 	cstate->copy_file = NULL;
 	cstate->fe_msgbuf = NULL;
 	cstate->fe_eof = false;
@@ -1132,7 +1188,11 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 	
 	if(!is_from)
 	{
-		if (pipe)
+		if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
+		{
+			/* the segments write their own files, nothing to open here */
+		}
+		else if (pipe)
 		{
 			if (whereToSendOutput == DestRemote)
 				cstate->fe_copy = true;
@@ -1216,6 +1276,19 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 		/* Update error log info */
 		if (cstate->cdbsreh)
 			cstate->cdbsreh->relid = RelationGetRelid(cstate->rel);
+
+		if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH &&
+			cstate->rel->rd_cdbpolicy == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY ON SEGMENT is only supported for distributed tables")));
+
+		/* the QD told us which columns the rows are distributed by */
+		if (stmt->dist_attrs)
+		{
+			Assert(Gp_role == GP_ROLE_EXECUTE && cstate->on_segment);
+			cstate->dist_attrs = stmt->dist_attrs;
+		}
 	}
 	else
 	{
@@ -1376,7 +1449,7 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 		  pg_database_encoding_max_length() > 1) && !qe_copy_from);
 
 	cstate->encoding_embeds_ascii = (qe_copy_from ? false : PG_ENCODING_IS_CLIENT_ONLY(cstate->client_encoding));
-	cstate->line_buf_converted = (Gp_role == GP_ROLE_EXECUTE ? true : false);
+	cstate->line_buf_converted = (Gp_role == GP_ROLE_EXECUTE && !cstate->on_segment);
 	setEncodingConversionProc(cstate, pg_get_client_encoding(), !is_from);
 
 	/*
@@ -1424,7 +1497,11 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 					(errcode(ERRCODE_GP_FEATURE_NOT_SUPPORTED),
 					 errmsg("COPY single row error handling only available for distributed user tables")));
 
-		if (pipe)
+		if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
+		{
+			/* the segments read their own files, nothing to receive here */
+		}
+		else if (pipe)
 		{
 			if (whereToSendOutput == DestRemote)
 				ReceiveCopyBegin(cstate);
@@ -1511,7 +1588,12 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 		/*
 		 * Set up is done. Get to work!
 		 */
-		if (shouldDispatch)
+		if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
+		{
+			/* every segment loads its own file */
+			CopyOnSegmentDispatch(cstate, stmt);
+		}
+		else if (shouldDispatch)
 		{
 			/* data needs to get dispatched to segment databases */
 			CopyFromDispatch(cstate);
@@ -1531,6 +1613,8 @@ DoCopyInternal(const CopyStmt *stmt, const char *queryString, CopyState cstate)
 								cstate->filename)));
 		}
 	}
+	else if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
+		CopyOnSegmentDispatch(cstate, stmt);	/* every segment unloads to its own file */
 	else
 		DoCopyTo(cstate);		/* copy from database to file */
 
@@ -1611,6 +1695,122 @@ DoCopy(const CopyStmt *stmt, const char *queryString)
 	return result;
 }
 
+/*
+ * CopyOnSegmentFileName
+ *
+ * Name of this segment's file for COPY ... ON SEGMENT: the user supplied
+ * path with every <SEGID> replaced by our content id.
+ */
+static char *
+CopyOnSegmentFileName(const char *filename)
+{
+	StringInfoData buf;
+	const char *p = filename;
+	const char *match;
+
+	initStringInfo(&buf);
+
+	while ((match = strstr(p, COPY_SEGID_PLACEHOLDER)) != NULL)
+	{
+		appendBinaryStringInfo(&buf, p, match - p);
+		appendStringInfo(&buf, "%d", GpIdentity.segindex);
+		p = match + strlen(COPY_SEGID_PLACEHOLDER);
+	}
+	appendStringInfoString(&buf, p);
+
+	return buf.data;
+}
+
+/*
+ * CopyOnSegmentDispatch
+ *
+ * COPY ... ON SEGMENT on the dispatcher. Instead of pushing every row
+ * through the master, dispatch the statement itself and let each segment
+ * parse and load (or unload) its own local file in parallel. All we do
+ * here is add up the row counts the segments report back.
+ *
+ * For COPY FROM the segments also get the distribution key, so that they
+ * can verify that every row in their file really belongs to them.
+ */
+static void
+CopyOnSegmentDispatch(CopyState cstate, const CopyStmt *stmt)
+{
+	GpPolicy   *policy = cstate->rel->rd_cdbpolicy;
+	CopyStmt   *dispatchStmt;
+	CdbCopy    *cdbCopy;
+	int			rejected = 0;
+	ListCell   *lc;
+
+	Assert(Gp_role == GP_ROLE_DISPATCH);
+	Assert(policy != NULL);
+
+	cdbCopy = makeCdbCopy(stmt->is_from);
+	cdbCopy->partitions = RelationBuildPartitionDesc(cstate->rel, false);
+	cdbCopy->ao_segnos = cstate->ao_segnos;
+	cdbCopy->skip_ext_partition = cstate->skip_ext_partition;
+
+	dispatchStmt = (CopyStmt *) copyObject((Node *) stmt);
+
+	if (stmt->is_from && policy->nattrs > 0)
+	{
+		int			i;
+
+		if (cdbCopy->partitions &&
+			!partition_policies_equal(policy, cdbCopy->partitions))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY FROM ON SEGMENT is not supported for partitioned tables with differently distributed parts")));
+
+		for (i = 0; i < policy->nattrs; i++)
+			dispatchStmt->dist_attrs = lappend_int(dispatchStmt->dist_attrs,
+												   policy->attrs[i]);
+	}
+
+	cstate->processed = cdbCopyOnSegment(cdbCopy, dispatchStmt, &rejected);
+
+	/* segments count rejected rows as processed, like in CopyFromDispatch */
+	if (cstate->cdbsreh)
+	{
+		cstate->processed -= rejected;
+		ReportSrehResults(cstate->cdbsreh, rejected);
+	}
+
+	/* bring the master's view of the AO segment files up to date */
+	foreach(lc, cstate->ao_segnos)
+	{
+		SegfileMapNode *n = (SegfileMapNode *) lfirst(lc);
+		int64		tupcount;
+		Relation	rel;
+
+		if (cdbCopy->partitions)
+		{
+			struct {
+				Oid relid;
+				int64 tupcount;
+			} *ao;
+			bool		found;
+
+			if (!cdbCopy->aotupcounts)
+				break;
+
+			ao = hash_search(cdbCopy->aotupcounts, &n->relid, HASH_FIND, &found);
+			if (!found)
+				continue;
+			tupcount = ao->tupcount;
+		}
+		else if (n->relid == RelationGetRelid(cstate->rel))
+			tupcount = cstate->processed;
+		else
+			continue;
+
+		rel = heap_open(n->relid, NoLock);
+		UpdateMasterAosegTotals(rel, n->segno, tupcount, 1);
+		heap_close(rel, NoLock);
+	}
+
+	pfree(cdbCopy);
+}
+
 /*
  * This intermediate routine exists mainly to localize the effects of setjmp
  * so we don't need to plaster a lot of variables with "volatile".
@@ -2057,8 +2257,8 @@ CopyTo(CopyState cstate)
 	/* if a header has been requested send the line */
 	if (cstate->header_line)
 	{
-		/* header should not be printed in execute mode. */
-		if (Gp_role != GP_ROLE_EXECUTE)
+		/* header should not be printed in execute mode, unless ON SEGMENT */
+		if (Gp_role != GP_ROLE_EXECUTE || cstate->on_segment)
 		{
 			bool		hdr_delim = false;
 
@@ -3646,8 +3846,191 @@ CopyFromDispatch(CopyState cstate)
 	FreeExecutorState(estate);
 }
 
+/*
+ * COPY FROM into a partitioned append-only table needs an insert descriptor
+ * for every leaf partition it writes to, and each of those holds block
+ * buffers and compression state (for column-oriented tables, per column).
+ * Rather than keep them all until the end, the descriptors are kept in an
+ * LRU list and the least recently used ones are closed once together they
+ * take more than gp_copy_insert_desc_memory.  A closed descriptor is
+ * simply opened again, on the same segment file, when a later row needs it.
+ */
+typedef struct CopyAoInsertDesc
+{
+	int			relIndex;		/* offset in es_result_relations */
+	MemoryContext context;		/* holds the descriptor */
+	Size		size;			/* memory the descriptor took */
+} CopyAoInsertDesc;
+
+struct CopyAoInsertDescPool
+{
+	List	   *lru;			/* CopyAoInsertDesc, most recently used first */
+	Size		totalSize;		/* sum of their sizes */
+	int			maxOpen;		/* most descriptors open at once */
+	int			nClosed;		/* descriptors closed to stay in budget */
+};
+
+/*
+ * Finish the insert descriptor of one partition and free its memory.
+ */
+static void
+CopyCloseAoInsertDesc(EState *estate, CopyAoInsertDesc *entry)
+{
+	ResultRelInfo *resultRelInfo = estate->es_result_relations + entry->relIndex;
+
+	if (resultRelInfo->ri_aoInsertDesc)
+	{
+		appendonly_insert_finish(resultRelInfo->ri_aoInsertDesc);
+		resultRelInfo->ri_aoInsertDesc = NULL;
+	}
+	if (resultRelInfo->ri_aocsInsertDesc)
+	{
+		aocs_insert_finish(resultRelInfo->ri_aocsInsertDesc);
+		resultRelInfo->ri_aocsInsertDesc = NULL;
+	}
+
+	MemoryContextDelete(entry->context);
+
+	/*
+	 * The new end of the segment file went into pg_aoseg.  Make it visible,
+	 * so that reopening the descriptor continues from there; without it,
+	 * the reopened descriptor would read the old EOF through SnapshotNow and
+	 * write over the rows just appended, and its own pg_aoseg update would
+	 * fail on the tuple already updated in this command.
+	 *
+	 * Doing this in the middle of COPY is safe on a QE too.  COPY FROM runs
+	 * in the writer gang only, and later statements on this segment take
+	 * their command ID from the writer (readers copy it from the shared
+	 * snapshot), not from the QD, so they see these pg_aoseg rows.  Heap
+	 * partitions keep being stamped with the command ID COPY started with.
+	 * The invalidation messages that this accepts would also be accepted
+	 * when COPY locks the next partition it opens.
+	 */
+	CommandCounterIncrement();
+}
+
+/*
+ * Make sure the partition in resultRelInfo has an open append-only insert
+ * descriptor, closing others if that takes the pool over its budget.
+ */
+static void
+CopyPartitionAoInsertDesc(CopyAoInsertDescPool *pool, EState *estate,
+						  ResultRelInfo *resultRelInfo, char relstorage,
+						  List *ao_segnos)
+{
+	int			relIndex = resultRelInfo - estate->es_result_relations;
+	Size		limit = (Size) gp_copy_insert_desc_memory * 1024;
+	CopyAoInsertDesc *entry;
+	MemoryContext oldcontext;
+	ListCell   *lc;
+
+	if (resultRelInfo->ri_aoInsertDesc != NULL ||
+		resultRelInfo->ri_aocsInsertDesc != NULL)
+	{
+		/* Already open; move it to the front, unless it is there already */
+		entry = (CopyAoInsertDesc *) linitial(pool->lru);
+		if (entry->relIndex == relIndex)
+			return;
+
+		foreach(lc, pool->lru)
+		{
+			entry = (CopyAoInsertDesc *) lfirst(lc);
+			if (entry->relIndex == relIndex)
+				break;
+		}
+		Assert(lc != NULL);
+		pool->lru = list_delete_ptr(pool->lru, entry);
+		pool->lru = lcons(entry, pool->lru);
+		return;
+	}
+
+	entry = (CopyAoInsertDesc *) palloc(sizeof(CopyAoInsertDesc));
+	entry->relIndex = relIndex;
+	entry->context = AllocSetContextCreate(CurrentMemoryContext,
+										   "COPY append-only insert descriptor",
+										   ALLOCSET_DEFAULT_MINSIZE,
+										   ALLOCSET_DEFAULT_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+
+	oldcontext = MemoryContextSwitchTo(entry->context);
+	ResultRelInfoSetSegno(resultRelInfo, ao_segnos);
+	if (relstorage == RELSTORAGE_AOROWS)
+		resultRelInfo->ri_aoInsertDesc =
+			appendonly_insert_init(resultRelInfo->ri_RelationDesc,
+								   resultRelInfo->ri_aosegno, false);
+	else
+		resultRelInfo->ri_aocsInsertDesc =
+			aocs_insert_init(resultRelInfo->ri_RelationDesc,
+							 resultRelInfo->ri_aosegno, false);
+	MemoryContextSwitchTo(oldcontext);
+
+	entry->size = MemoryContextGetCurrentSpace(entry->context);
+	pool->totalSize += entry->size;
+	pool->lru = lcons(entry, pool->lru);
+	pool->maxOpen = Max(pool->maxOpen, list_length(pool->lru));
+
+	/* Close the least recently used ones, but never the one just opened */
+	while (limit > 0 && pool->totalSize > limit && list_length(pool->lru) > 1)
+	{
+		CopyAoInsertDesc *victim = (CopyAoInsertDesc *) llast(pool->lru);
+
+		pool->lru = list_delete_ptr(pool->lru, victim);
+		pool->totalSize -= victim->size;
+		pool->nClosed++;
+
+		CopyCloseAoInsertDesc(estate, victim);
+		pfree(victim);
+	}
+}
+
+/*
+ * Write the rows buffered by CopyFrom() for one target relation with a
+ * single heap_multi_insert() call, then make their index entries.
+ */
+static void
+CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
+					bool use_wal, bool use_fsm, ResultRelInfo *resultRelInfo,
+					TupleTableSlot *baseSlot, HeapTuple *bufferedTuples,
+					int64 *bufferedLinenos, int nBufferedTuples)
+{
+	ResultRelInfo *saveRelInfo = estate->es_result_relation_info;
+	int64		save_cur_lineno = cstate->cur_lineno;
+	TupleTableSlot *slot;
+	int			i;
+
+	heap_multi_insert(resultRelInfo->ri_RelationDesc, bufferedTuples,
+					  nBufferedTuples, mycid, use_wal, use_fsm);
+
+	if (resultRelInfo->ri_NumIndices == 0)
+		return;
+
+	/*
+	 * ExecInsertIndexTuples() works on es_result_relation_info, which is
+	 * the current row's partition rather than the one these rows belong to.
+	 */
+	estate->es_result_relation_info = resultRelInfo;
+	slot = resultRelInfo->ri_partSlot ? resultRelInfo->ri_partSlot : baseSlot;
+
+	cstate->flushing_batch = true;
+	for (i = 0; i < nBufferedTuples; i++)
+	{
+		cstate->cur_lineno = bufferedLinenos[i];
+		ExecStoreGenericTuple(bufferedTuples[i], slot, false);
+		ExecInsertIndexTuples(slot, &(bufferedTuples[i]->t_self), estate, false);
+	}
+	ExecClearTuple(slot);
+	cstate->flushing_batch = false;
+
+	cstate->cur_lineno = save_cur_lineno;
+	estate->es_result_relation_info = saveRelInfo;
+}
+
 /*
  * Copy FROM file to relation.
+ *
+ * Rows headed for a heap table without row-level INSERT triggers are
+ * buffered and written a page at a time with heap_multi_insert(), see
+ * CopyFromInsertBatch().
  */
 static void
 CopyFrom(CopyState cstate)
@@ -3689,6 +4072,15 @@ CopyFrom(CopyState cstate)
 	bool		cur_row_rejected = false;
 	int			original_lineno_for_qe = 0; /* keep compiler happy (var referenced by macro) */
 	CdbCopy    *cdbCopy = NULL; /* never used... for compiling COPY_HANDLE_ERROR */
+	CdbHash    *segHash = NULL; /* ON SEGMENT: verifies rows belong to us */
+	bool		volatile_defexprs = false;
+	MemoryContext batchcontext;
+	HeapTuple  *bufferedTuples;
+	int64	   *bufferedLinenos;
+	int			nBufferedTuples = 0;
+	Size		bufferedTuplesSize = 0;
+	int			bufferedRelIndex = -1;	/* es_result_relations offset */
+	CopyAoInsertDescPool aoDescPool;
 	tupDesc = RelationGetDescr(cstate->rel);
 	attr = tupDesc->attrs;
 	num_phys_attrs = tupDesc->natts;
@@ -3795,11 +4187,34 @@ CopyFrom(CopyState cstate)
 														 estate);
 				defmap[num_defaults] = attnum - 1;
 				num_defaults++;
+
+				/*
+				 * A volatile default might look at the table, and expect to
+				 * see the rows loaded before this one, which is not the case
+				 * if they are still sitting in the batch buffer.
+				 */
+				if (contain_volatile_functions(defexpr))
+					volatile_defexprs = true;
 			}
 		}
 
 	}
 
+	/*
+	 * Rows going into heap tables are collected here and written in batches
+	 * by CopyFromInsertBatch().  The tuples are copied into batchcontext,
+	 * since the per-tuple context is reset for every input line.
+	 */
+	batchcontext = AllocSetContextCreate(CurrentMemoryContext,
+										 "COPY FROM batch",
+										 ALLOCSET_DEFAULT_MINSIZE,
+										 ALLOCSET_DEFAULT_INITSIZE,
+										 ALLOCSET_DEFAULT_MAXSIZE);
+	bufferedTuples = (HeapTuple *) palloc(HEAP_MULTI_INSERT_MAX_TUPLES * sizeof(HeapTuple));
+	bufferedLinenos = (int64 *) palloc(HEAP_MULTI_INSERT_MAX_TUPLES * sizeof(int64));
+
+	MemSet(&aoDescPool, 0, sizeof(aoDescPool));
+
 	/*
 	 * Prepare to catch AFTER triggers.
 	 */
@@ -3829,11 +4244,14 @@ CopyFrom(CopyState cstate)
 	errcontext.previous = error_context_stack;
 	error_context_stack = &errcontext;
 
-	if (Gp_role == GP_ROLE_EXECUTE)
+	if (Gp_role == GP_ROLE_EXECUTE && !cstate->on_segment)
 		cstate->err_loc_type = ROWNUM_EMBEDDED; /* get original row num from QD COPY */
 	else
 		cstate->err_loc_type = ROWNUM_ORIGINAL; /* we can count rows by ourselves */
 
+	if (cstate->dist_attrs)
+		segHash = makeCdbHash(getgpsegmentCount());
+
 	CopyInitDataParser(cstate);
 
 	do
@@ -4047,6 +4465,34 @@ CopyFrom(CopyState cstate)
 						if (!isnull)
 							baseNulls[defmap[i]] = false;
 					}
+
+					/*
+					 * COPY ON SEGMENT: a row in our local file that hashes
+					 * to another segment would be lost to any query relying
+					 * on the distribution, so treat it as a data error.
+					 */
+					if (segHash)
+					{
+						unsigned int target_seg;
+
+						cdbhashinit(segHash);
+						foreach(cur, cstate->dist_attrs)
+						{
+							int			m = lfirst_int(cur) - 1;
+
+							if (baseNulls[m])
+								cdbhashnull(segHash);
+							else
+								cdbhash(segHash, baseValues[m], attr[m]->atttypid);
+						}
+						target_seg = cdbhashreduce(segHash);
+
+						if (target_seg != GpIdentity.segindex)
+							ereport(ERROR,
+									(errcode(ERRCODE_DATA_EXCEPTION),
+									 errmsg("row belongs to segment %u, not to segment %d",
+											target_seg, GpIdentity.segindex)));
+					}
 				}
 				PG_CATCH();
 				{
@@ -4088,7 +4534,13 @@ CopyFrom(CopyState cstate)
 				}
 
 				relstorage = RelinfoGetStorage(resultRelInfo);
-				if (relstorage == RELSTORAGE_AOROWS &&
+				if (estate->es_result_partitions &&
+					(relstorage == RELSTORAGE_AOROWS || relstorage == RELSTORAGE_AOCOLS))
+				{
+					CopyPartitionAoInsertDesc(&aoDescPool, estate, resultRelInfo,
+											  relstorage, cstate->ao_segnos);
+				}
+				else if (relstorage == RELSTORAGE_AOROWS &&
 					resultRelInfo->ri_aoInsertDesc == NULL)
 				{
 					ResultRelInfoSetSegno(resultRelInfo, cstate->ao_segnos);
@@ -4257,6 +4709,46 @@ CopyFrom(CopyState cstate)
 					{
 						external_insert(resultRelInfo->ri_extInsertDesc, tuple);
 					}
+					else if (gp_enable_heap_multi_insert && !volatile_defexprs &&
+							 !(resultRelInfo->ri_TrigDesc &&
+							   (resultRelInfo->ri_TrigDesc->n_before_row[TRIGGER_EVENT_INSERT] > 0 ||
+								resultRelInfo->ri_TrigDesc->n_after_row[TRIGGER_EVENT_INSERT] > 0)))
+					{
+						int			relIndex = resultRelInfo - estate->es_result_relations;
+						HeapTuple	htup;
+
+						/* Rows buffered for another partition go in first */
+						if (nBufferedTuples > 0 && relIndex != bufferedRelIndex)
+						{
+							CopyFromInsertBatch(cstate, estate, mycid, use_wal, use_fsm,
+												estate->es_result_relations + bufferedRelIndex,
+												baseSlot, bufferedTuples, bufferedLinenos,
+												nBufferedTuples);
+							nBufferedTuples = 0;
+							bufferedTuplesSize = 0;
+							MemoryContextReset(batchcontext);
+						}
+
+						MemoryContextSwitchTo(batchcontext);
+						htup = heap_copytuple((HeapTuple) tuple);
+						MemoryContextSwitchTo(estate->es_query_cxt);
+
+						bufferedRelIndex = relIndex;
+						bufferedLinenos[nBufferedTuples] = cstate->cur_lineno;
+						bufferedTuples[nBufferedTuples++] = htup;
+						bufferedTuplesSize += htup->t_len;
+
+						if (nBufferedTuples == HEAP_MULTI_INSERT_MAX_TUPLES ||
+							bufferedTuplesSize > HEAP_MULTI_INSERT_MAX_BYTES)
+						{
+							CopyFromInsertBatch(cstate, estate, mycid, use_wal, use_fsm,
+												resultRelInfo, baseSlot, bufferedTuples,
+												bufferedLinenos, nBufferedTuples);
+							nBufferedTuples = 0;
+							bufferedTuplesSize = 0;
+							MemoryContextReset(batchcontext);
+						}
+					}
 					else
 					{
 						heap_insert(resultRelInfo->ri_RelationDesc, tuple, mycid, use_wal, use_fsm, GetCurrentTransactionId());
@@ -4294,12 +4786,25 @@ CopyFrom(CopyState cstate)
 	} while (!no_more_data);
 
 
+	/* Write out any remaining buffered rows */
+	MemoryContextSwitchTo(estate->es_query_cxt);
+	if (nBufferedTuples > 0)
+		CopyFromInsertBatch(cstate, estate, mycid, use_wal, use_fsm,
+							estate->es_result_relations + bufferedRelIndex,
+							baseSlot, bufferedTuples, bufferedLinenos,
+							nBufferedTuples);
+	MemoryContextDelete(batchcontext);
+
 	/*
 	 * Done, clean up
 	 */
 	error_context_stack = errcontext.previous;
 
-	MemoryContextSwitchTo(estate->es_query_cxt);
+	if (aoDescPool.nClosed > 0)
+		ereport(LOG,
+				(errmsg("COPY closed append-only partition insert descriptors %d times "
+						"to stay within gp_copy_insert_desc_memory, with at most %d open at once",
+						aoDescPool.nClosed, aoDescPool.maxOpen)));
 
 	/*
 	 * Execute AFTER STATEMENT insertion triggers
@@ -6187,7 +6692,17 @@ copy_in_error_callback(void *arg)
 	if (cstate->error_on_executor)
 		return;
 
-	if (cstate->cur_attname)
+	if (cstate->flushing_batch)
+	{
+		/*
+		 * Error while making index entries for buffered rows; line_buf holds
+		 * a later line, so report just the line number.
+		 */
+		errcontext("COPY %s, line %s",
+				   cstate->cur_relname,
+				   linenumber_atoi(buffer, cstate->cur_lineno));
+	}
+	else if (cstate->cur_attname)
 	{
 		/* error is relevant to a particular column */
 		char	   *att_buf;
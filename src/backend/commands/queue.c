@@ -156,6 +156,21 @@ bool ValidMemoryLimit(char			*pResSetting)
 }
 
 
+/**
+ * Validate cpu rate limit setting: a percentage of the host's cpu, or -1
+ * for no limit.
+ */
+static 
+bool ValidCpuRateLimit(char			*pResSetting)
+{
+	int percent;
+
+	if (!parse_int(pResSetting, &percent, 0, NULL))
+		return false;
+
+	return percent == -1 || (percent >= 1 && percent <= 100);
+}
+
 /* ValidateResqueueCapabilityEntry
  *
  * Validate the resource setting for a pg_resqueuecapability entry.
@@ -190,6 +205,11 @@ void ValidateResqueueCapabilityEntry(int			 resTypeInt,
 						
 			break;
 
+		case PG_RESRCTYPE_CPU_RATE_LIMIT:	/* resgroup.c: cgroup cpu cap */
+			bValid = ValidCpuRateLimit(pResSetting);
+			restyp = "CPU_RATE_LIMIT";
+			break;
+
 		default:
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -1690,7 +1710,7 @@ char *GetResqueuePriority(Oid queueId)
 static char *GetResqueueCapability(Oid queueOid, int capabilityIndex)
 {
 	/* Update this assert if we add more capabilities */
-	Assert(capabilityIndex <= PG_RESRCTYPE_MEMORY_LIMIT);
+	Assert(capabilityIndex <= PG_RESRCTYPE_CPU_RATE_LIMIT);
 	Assert(queueOid != InvalidOid);
 
 	ListCell *le = NULL;
@@ -1402,6 +1402,22 @@ get_rel_oids(List *relids, const RangeVar *vacrel, const char *stmttype,
 			pn = get_parts(relid, 0, 0, false, true /*includesubparts*/);
 
 			prels = all_partition_relids(pn);
+
+			/*
+			 * all_partition_relids() lists parents before their children.
+			 * With HyperLogLog statistics, process the children first, so
+			 * that the parents can merge their sketches instead of scanning.
+			 * The table itself goes last, below.
+			 */
+			if (gp_statistics_use_hll)
+			{
+				List	   *reversed = NIL;
+				ListCell   *lc;
+
+				foreach(lc, prels)
+					reversed = lcons_oid(lfirst_oid(lc), reversed);
+				prels = reversed;
+			}
 		}
 		else if (rel_is_child_partition(relid))
 		{
@@ -1411,8 +1427,16 @@ get_rel_oids(List *relids, const RangeVar *vacrel, const char *stmttype,
 
 		/* Make a relation list entry for this guy */
 		oldcontext = MemoryContextSwitchTo(vac_context);
-		oid_list = lappend_oid(oid_list, relid);
-		oid_list = list_concat_unique_oid(oid_list, prels);
+		if (gp_statistics_use_hll)
+		{
+			oid_list = list_concat_unique_oid(oid_list, prels);
+			oid_list = list_append_unique_oid(oid_list, relid);
+		}
+		else
+		{
+			oid_list = lappend_oid(oid_list, relid);
+			oid_list = list_concat_unique_oid(oid_list, prels);
+		}
 		MemoryContextSwitchTo(oldcontext);
 	}
 	else
@@ -866,3 +866,86 @@ DynamicScan_GetTableOid(ScanState *scanState)
 
 	return iterator->curRelOid;
 }
+
+/*
+ * DynamicScan_CreatePartitionCache
+ *		Creates the table of partitions a dynamic scan keeps open. The
+ *		table lives in the current (per-query) memory context.
+ */
+HTAB *
+DynamicScan_CreatePartitionCache(const char *name)
+{
+	HASHCTL		hashCtl;
+
+	MemSet(&hashCtl, 0, sizeof(HASHCTL));
+	hashCtl.keysize = sizeof(Oid);
+	hashCtl.entrysize = sizeof(DynamicScanPartitionEntry);
+	hashCtl.hash = oid_hash;
+	hashCtl.hcxt = CurrentMemoryContext;
+
+	return hash_create(name, 16, &hashCtl,
+					   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+}
+
+/*
+ * DynamicScan_LookupPartition
+ *		Returns the cache entry of the given partition, opening the
+ *		partition the first time it is seen.
+ *
+ *		The relation is locked with AccessShareLock, like
+ *		OpenScanRelationByOid does, and stays open until
+ *		DynamicScan_DestroyPartitionCache.
+ */
+DynamicScanPartitionEntry *
+DynamicScan_LookupPartition(HTAB *partitionCache, Oid partOid)
+{
+	bool		found = false;
+
+	Assert(NULL != partitionCache);
+	Assert(OidIsValid(partOid));
+
+	DynamicScanPartitionEntry *entry = (DynamicScanPartitionEntry *)
+		hash_search(partitionCache, &partOid, HASH_ENTER, &found);
+
+	if (!found)
+	{
+		entry->relation = NULL;
+		entry->indexRelation = NULL;
+		entry->relation = OpenScanRelationByOid(partOid);
+	}
+
+	Assert(NULL != entry->relation);
+	return entry;
+}
+
+/*
+ * DynamicScan_DestroyPartitionCache
+ *		Closes every relation in the partition cache and frees it. Locks
+ *		are kept until the end of the transaction.
+ */
+void
+DynamicScan_DestroyPartitionCache(HTAB *partitionCache)
+{
+	HASH_SEQ_STATUS status;
+	DynamicScanPartitionEntry *entry;
+
+	if (NULL == partitionCache)
+	{
+		return;
+	}
+
+	hash_seq_init(&status, partitionCache);
+	while ((entry = (DynamicScanPartitionEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (NULL != entry->indexRelation)
+		{
+			index_close(entry->indexRelation, NoLock);
+		}
+		if (NULL != entry->relation)
+		{
+			ExecCloseScanRelation(entry->relation);
+		}
+	}
+
+	hash_destroy(partitionCache);
+}
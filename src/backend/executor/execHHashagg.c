@@ -52,8 +52,8 @@ struct BatchFileInfo
 };
 
 #define BATCHFILE_METADATA \
-    (sizeof(BatchFileInfo) + sizeof(bfz_t) + sizeof(struct bfz_freeable_stuff))
-#define FREEABLE_BATCHFILE_METADATA (sizeof(struct bfz_freeable_stuff))
+    (sizeof(BatchFileInfo) + sizeof(bfz_t) + bfz_append_buffer_size())
+#define FREEABLE_BATCHFILE_METADATA (bfz_append_buffer_size())
 
 /* Used for padding */
 static char padding_dummy[MAXIMUM_ALIGNOF];
@@ -50,6 +50,7 @@
 #include "catalog/aovisimap.h"
 #include "catalog/catalog.h"
 #include "catalog/pg_attribute_encoding.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "cdb/cdbpartition.h"
 #include "commands/tablecmds.h" /* XXX: temp for get_parts() */
@@ -64,6 +65,8 @@
 #include "miscadmin.h"
 #include "nodes/makefuncs.h" /* temporary */
 #include "optimizer/clauses.h"
+#include "optimizer/planmain.h"
+#include "optimizer/walkers.h"
 #include "parser/parse_clause.h"
 #include "parser/parse_expr.h"
 #include "parser/parse_relation.h"
@@ -114,8 +117,38 @@ typedef struct evalPlanQual
 	struct evalPlanQual *free;	/* list of free PlanQual plans */
 } evalPlanQual;
 
+/*
+ * Heap tuples waiting to be written out a page at a time by
+ * heap_multi_insert().  INSERT keeps one per result relation, in
+ * ResultRelInfo->ri_heapInsertBuffer; SELECT INTO keeps one in its
+ * DestReceiver.
+ */
+typedef struct HeapInsertBuffer
+{
+	MemoryContext context;		/* holds the buffered tuples */
+	int			ntuples;
+	Size		nbytes;
+	uint64		lastUsed;		/* es_heap_insert_clock at the last row */
+	HeapTuple	tuples[HEAP_MULTI_INSERT_MAX_TUPLES];
+} HeapInsertBuffer;
+
+/*
+ * An INSERT into a partitioned table keeps a buffer per partition.  When
+ * they use more memory than this altogether, the least recently used ones
+ * are written out and freed.
+ */
+#define HEAP_INSERT_BUFFERS_MAX_BYTES	(16 * HEAP_MULTI_INSERT_MAX_BYTES)
+
 /* decls for local routines only used within this module */
 static void InitPlan(QueryDesc *queryDesc, int eflags);
+static HeapInsertBuffer *makeHeapInsertBuffer(EState *estate);
+static bool heapInsertBufferAdd(HeapInsertBuffer *buffer, HeapTuple tuple);
+static void heapInsertBufferReset(HeapInsertBuffer *buffer);
+static void ExecFlushHeapInsertBuffer(ResultRelInfo *resultRelInfo,
+						  EState *estate);
+static void ExecTrimHeapInsertBuffers(ResultRelInfo *current, EState *estate);
+static void ExecFlushHeapInserts(EState *estate);
+static bool plan_has_volatile_functions_walker(Node *node, void *context);
 static void initResultRelInfo(ResultRelInfo *resultRelInfo,
 				  Relation resultRelationDesc,
 				  Index resultRelationIndex,
@@ -1767,6 +1800,24 @@ InitPlan(QueryDesc *queryDesc, int eflags)
 		estate->es_into_oids = interpretOidsOption(plannedstmt->intoClause->options);
 	}
 
+	/*
+	 * Rows inserted into heap tables may be buffered and written out a page
+	 * at a time, unless the query calls volatile functions: those could
+	 * look at the target table, and must see every row inserted before
+	 * them, as COPY does for volatile column defaults.
+	 */
+	estate->es_heap_insert_batch = false;
+	if (gp_enable_heap_multi_insert &&
+		(operation == CMD_INSERT || estate->es_select_into))
+	{
+		plan_tree_base_prefix base;
+
+		exec_init_plan_tree_base(&base, plannedstmt);
+		estate->es_heap_insert_batch =
+			!plan_has_volatile_functions_walker((Node *) plannedstmt->planTree,
+												&base);
+	}
+
 	/*
 	 * Have to lock relations selected FOR UPDATE/FOR SHARE before we
 	 * initialize the plan tree, else we'd be doing a lock upgrade. While we
@@ -3003,6 +3054,12 @@ lnext:	;
 			break;
 	}
 
+	/*
+	 * Write out the rows ExecInsert() has buffered, before anything that
+	 * might expect to see them.
+	 */
+	ExecFlushHeapInserts(estate);
+
 	/*
 	 * Process AFTER EACH STATEMENT triggers
 	 */
@@ -3266,6 +3323,49 @@ ExecInsert(TupleTableSlot *slot,
 
 		newId = external_insert(resultRelInfo->ri_extInsertDesc, tuple);
 	}
+	else if (estate->es_heap_insert_batch && !isUpdate &&
+			 !resultRelationDesc->rd_rel->relhasoids &&
+			 !IsSystemRelation(resultRelationDesc) &&
+			 (planGen != PLANGEN_PLANNER ||
+			  !(resultRelInfo->ri_TrigDesc &&
+				(resultRelInfo->ri_TrigDesc->n_before_row[TRIGGER_EVENT_INSERT] > 0 ||
+				 resultRelInfo->ri_TrigDesc->n_after_row[TRIGGER_EVENT_INSERT] > 0))))
+	{
+		/*
+		 * No row triggers and no OIDs to hand back, so nothing needs the
+		 * row to be in the table yet.  Buffer it, and write it out with the
+		 * others that fit on the same page; index entries are made then,
+		 * too.
+		 */
+		HeapInsertBuffer *buffer;
+		Size		nbytes;
+		bool		full;
+
+		Insist(rel_is_heap);
+
+		if (resultRelInfo->ri_heapInsertBuffer == NULL)
+		{
+			resultRelInfo->ri_heapInsertBuffer = makeHeapInsertBuffer(estate);
+			estate->es_heap_insert_bytes += sizeof(HeapInsertBuffer);
+		}
+		buffer = resultRelInfo->ri_heapInsertBuffer;
+
+		nbytes = buffer->nbytes;
+		full = heapInsertBufferAdd(buffer, (HeapTuple) tuple);
+		buffer->lastUsed = ++estate->es_heap_insert_clock;
+		estate->es_heap_insert_bytes += buffer->nbytes - nbytes;
+
+		if (full)
+			ExecFlushHeapInsertBuffer(resultRelInfo, estate);
+		else if (estate->es_heap_insert_bytes > HEAP_INSERT_BUFFERS_MAX_BYTES)
+			ExecTrimHeapInsertBuffers(resultRelInfo, estate);
+
+		IncrAppended();
+		(estate->es_processed)++;
+		(resultRelInfo->ri_aoprocessed)++;
+		estate->es_lastoid = InvalidOid;
+		return;
+	}
 	else
 	{
 		Insist(rel_is_heap);
@@ -3313,6 +3413,203 @@ ExecInsert(TupleTableSlot *slot,
 	}
 }
 
+/*
+ * Create an empty HeapInsertBuffer in the per-query memory context.
+ */
+static HeapInsertBuffer *
+makeHeapInsertBuffer(EState *estate)
+{
+	HeapInsertBuffer *buffer;
+
+	buffer = (HeapInsertBuffer *)
+		MemoryContextAlloc(estate->es_query_cxt, sizeof(HeapInsertBuffer));
+	buffer->context = AllocSetContextCreate(estate->es_query_cxt,
+											"HeapInsertBuffer",
+											ALLOCSET_DEFAULT_MINSIZE,
+											ALLOCSET_DEFAULT_INITSIZE,
+											ALLOCSET_DEFAULT_MAXSIZE);
+	buffer->ntuples = 0;
+	buffer->nbytes = 0;
+	buffer->lastUsed = 0;
+
+	return buffer;
+}
+
+/*
+ * Add a copy of 'tuple' to the buffer.  Returns true if the buffer is now
+ * full and should be flushed.
+ */
+static bool
+heapInsertBufferAdd(HeapInsertBuffer *buffer, HeapTuple tuple)
+{
+	MemoryContext oldcontext;
+	HeapTuple	copy;
+
+	Assert(buffer->ntuples < HEAP_MULTI_INSERT_MAX_TUPLES);
+
+	oldcontext = MemoryContextSwitchTo(buffer->context);
+	copy = heap_copytuple(tuple);
+	MemoryContextSwitchTo(oldcontext);
+
+	buffer->tuples[buffer->ntuples++] = copy;
+	buffer->nbytes += copy->t_len;
+
+	return (buffer->ntuples == HEAP_MULTI_INSERT_MAX_TUPLES ||
+			buffer->nbytes > HEAP_MULTI_INSERT_MAX_BYTES);
+}
+
+/*
+ * Forget the buffered tuples, which the caller has written out.
+ */
+static void
+heapInsertBufferReset(HeapInsertBuffer *buffer)
+{
+	MemoryContextReset(buffer->context);
+	buffer->ntuples = 0;
+	buffer->nbytes = 0;
+}
+
+/*
+ * Write out the rows buffered for one INSERT result relation, and make
+ * their index entries.
+ *
+ * Unique index violations are therefore raised here, when the batch is
+ * flushed, rather than while the row that causes them is inserted; the
+ * error context points at whatever row triggered the flush, or at the end
+ * of the statement.
+ */
+static void
+ExecFlushHeapInsertBuffer(ResultRelInfo *resultRelInfo, EState *estate)
+{
+	HeapInsertBuffer *buffer = resultRelInfo->ri_heapInsertBuffer;
+	ResultRelInfo *saveRelInfo;
+	TupleTableSlot *slot;
+	TupleDesc	tupdesc;
+	int			i;
+
+	if (buffer == NULL || buffer->ntuples == 0)
+		return;
+
+	heap_multi_insert(resultRelInfo->ri_RelationDesc,
+					  buffer->tuples, buffer->ntuples,
+					  estate->es_output_cid, true, true);
+
+	setLastTid(&(buffer->tuples[buffer->ntuples - 1]->t_self));
+
+	if (resultRelInfo->ri_NumIndices > 0)
+	{
+		/*
+		 * ExecInsertIndexTuples() works on es_result_relation_info, which
+		 * need not be this relation when inserting into a partitioned table.
+		 * The trigger tuple slot is free, since we only buffer rows of
+		 * relations without row triggers.
+		 */
+		saveRelInfo = estate->es_result_relation_info;
+		estate->es_result_relation_info = resultRelInfo;
+
+		slot = estate->es_trig_tuple_slot;
+		tupdesc = RelationGetDescr(resultRelInfo->ri_RelationDesc);
+		if (slot->tts_tupleDescriptor != tupdesc)
+			ExecSetSlotDescriptor(slot, tupdesc);
+
+		for (i = 0; i < buffer->ntuples; i++)
+		{
+			ExecStoreGenericTuple(buffer->tuples[i], slot, false);
+			ExecInsertIndexTuples(slot, &(buffer->tuples[i]->t_self),
+								  estate, false);
+		}
+		ExecClearTuple(slot);
+
+		estate->es_result_relation_info = saveRelInfo;
+	}
+
+	estate->es_heap_insert_bytes -= buffer->nbytes;
+	heapInsertBufferReset(buffer);
+}
+
+/*
+ * Write out and free the least recently used INSERT buffers, other than
+ * the current one, until they fit in HEAP_INSERT_BUFFERS_MAX_BYTES again.
+ */
+static void
+ExecTrimHeapInsertBuffers(ResultRelInfo *current, EState *estate)
+{
+	while (estate->es_heap_insert_bytes > HEAP_INSERT_BUFFERS_MAX_BYTES)
+	{
+		ResultRelInfo *victim = NULL;
+		HeapInsertBuffer *buffer;
+		int			i;
+
+		for (i = 0; i < estate->es_num_result_relations; i++)
+		{
+			ResultRelInfo *resultRelInfo = &estate->es_result_relations[i];
+
+			buffer = resultRelInfo->ri_heapInsertBuffer;
+			if (resultRelInfo == current || buffer == NULL)
+				continue;
+			if (victim == NULL ||
+				buffer->lastUsed < victim->ri_heapInsertBuffer->lastUsed)
+				victim = resultRelInfo;
+		}
+
+		if (victim == NULL)
+			break;
+
+		ExecFlushHeapInsertBuffer(victim, estate);
+
+		buffer = victim->ri_heapInsertBuffer;
+		MemoryContextDelete(buffer->context);
+		pfree(buffer);
+		victim->ri_heapInsertBuffer = NULL;
+		estate->es_heap_insert_bytes -= sizeof(HeapInsertBuffer);
+	}
+}
+
+/*
+ * Write out the rows buffered for all the INSERT result relations.
+ */
+static void
+ExecFlushHeapInserts(EState *estate)
+{
+	int			i;
+
+	for (i = 0; i < estate->es_num_result_relations; i++)
+		ExecFlushHeapInsertBuffer(&estate->es_result_relations[i], estate);
+}
+
+/*
+ * Does a plan tree, including its SubPlans, call any volatile functions?
+ * This is contain_volatile_functions() for plans.
+ */
+static bool
+plan_has_volatile_functions_walker(Node *node, void *context)
+{
+	Oid			funcid = InvalidOid;
+
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, FuncExpr))
+		funcid = ((FuncExpr *) node)->funcid;
+	else if (IsA(node, OpExpr) || IsA(node, DistinctExpr) ||
+			 IsA(node, NullIfExpr))
+	{
+		set_opfuncid((OpExpr *) node);	/* rely on struct equivalence */
+		funcid = ((OpExpr *) node)->opfuncid;
+	}
+	else if (IsA(node, ScalarArrayOpExpr))
+	{
+		set_sa_opfuncid((ScalarArrayOpExpr *) node);
+		funcid = ((ScalarArrayOpExpr *) node)->opfuncid;
+	}
+
+	if (OidIsValid(funcid) && func_volatile(funcid) == PROVOLATILE_VOLATILE)
+		return true;
+
+	return plan_tree_walker(node, plan_has_volatile_functions_walker,
+							context);
+}
+
 /* ----------------------------------------------------------------
  *		ExecDelete
  *
@@ -4672,8 +4969,11 @@ typedef struct
 	EState	   *estate;			/* EState we are working with */
 	AppendOnlyInsertDescData *ao_insertDesc; /* descriptor to AO tables */
         AOCSInsertDescData *aocs_ins;           /* descriptor for aocs */
+	HeapInsertBuffer *heap_buffer;	/* rows not yet written to a heap table */
 } DR_intorel;
 
+static void intorel_flush(DR_intorel *myState);
+
 /*
  * OpenIntoRel --- actually create the SELECT INTO target relation
  *
@@ -5066,6 +5366,7 @@ CreateIntoRelDestReceiver(void)
 	self->estate = NULL;
 	self->ao_insertDesc = NULL;
         self->aocs_ins = NULL;
+	self->heap_buffer = NULL;
 
 	return (DestReceiver *) self;
 }
@@ -5110,6 +5411,14 @@ intorel_receive(TupleTableSlot *slot, DestReceiver *self)
 
 		aocs_insert(myState->aocs_ins, slot);
 	}
+	else if (estate->es_heap_insert_batch)
+	{
+		if (myState->heap_buffer == NULL)
+			myState->heap_buffer = makeHeapInsertBuffer(estate);
+
+		if (heapInsertBufferAdd(myState->heap_buffer, ExecFetchSlotHeapTuple(slot)))
+			intorel_flush(myState);
+	}
 	else
 	{
 		HeapTuple	tuple = ExecCopySlotHeapTuple(slot);
@@ -5131,6 +5440,31 @@ intorel_receive(TupleTableSlot *slot, DestReceiver *self)
 	IncrAppended();
 }
 
+/*
+ * intorel_flush --- write out the buffered rows of a heap target
+ */
+static void
+intorel_flush(DR_intorel *myState)
+{
+	EState	   *estate = myState->estate;
+	HeapInsertBuffer *buffer = myState->heap_buffer;
+
+	if (buffer == NULL || buffer->ntuples == 0)
+		return;
+
+	heap_multi_insert(estate->es_into_relation_descriptor,
+					  buffer->tuples, buffer->ntuples,
+					  estate->es_output_cid,
+					  !estate->es_into_relation_is_bulkload,
+					  false /* never any point in using FSM */);
+
+	/* Pages are only ever appended, so the last row is on the last page */
+	estate->es_into_relation_last_heap_tid =
+		buffer->tuples[buffer->ntuples - 1]->t_self;
+
+	heapInsertBufferReset(buffer);
+}
+
 /*
  * intorel_shutdown --- executor end
  */
@@ -5142,6 +5476,8 @@ intorel_shutdown(DestReceiver *self)
 	EState	   *estate = myState->estate;
 	Relation	into_rel = estate->es_into_relation_descriptor;
 
+	intorel_flush(myState);
+
 
 	if (RelationIsAoRows(into_rel) && myState->ao_insertDesc)
 		appendonly_insert_finish(myState->ao_insertDesc);
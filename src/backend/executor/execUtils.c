@@ -371,6 +371,32 @@ FreeExecutorState(EState *estate)
 	MemoryContextDelete(estate->es_query_cxt);
 }
 
+/* ----------------
+ *		CreateExprContextPerTupleMemory
+ *
+ *		Create the "per-tuple" memory context of an ExprContext.
+ *
+ * Per-tuple memory is reset after every tuple and nearly never pfree'd
+ * piecemeal, so unless disabled we use a bump context, which makes both
+ * palloc and the reset itself cheap.
+ * ----------------
+ */
+static MemoryContext
+CreateExprContextPerTupleMemory(MemoryContext parent)
+{
+	if (gp_enable_bump_context)
+		return BumpContextCreate(parent,
+								 "ExprContext",
+								 ALLOCSET_DEFAULT_INITSIZE,
+								 ALLOCSET_DEFAULT_MAXSIZE);
+
+	return AllocSetContextCreate(parent,
+								 "ExprContext",
+								 ALLOCSET_DEFAULT_MINSIZE,
+								 ALLOCSET_DEFAULT_INITSIZE,
+								 ALLOCSET_DEFAULT_MAXSIZE);
+}
+
 /* ----------------
  *		CreateExprContext
  *
@@ -406,11 +432,7 @@ CreateExprContext(EState *estate)
 	 * Create working memory for expression evaluation in this context.
 	 */
 	econtext->ecxt_per_tuple_memory =
-		AllocSetContextCreate(estate->es_query_cxt,
-							  "ExprContext",
-							  ALLOCSET_DEFAULT_MINSIZE,
-							  ALLOCSET_DEFAULT_INITSIZE,
-							  ALLOCSET_DEFAULT_MAXSIZE);
+		CreateExprContextPerTupleMemory(estate->es_query_cxt);
 
 	econtext->ecxt_param_exec_vals = estate->es_param_exec_vals;
 	econtext->ecxt_param_list_info = estate->es_param_list_info;
@@ -477,11 +499,7 @@ CreateStandaloneExprContext(void)
 	 * Create working memory for expression evaluation in this context.
 	 */
 	econtext->ecxt_per_tuple_memory =
-		AllocSetContextCreate(CurrentMemoryContext,
-							  "ExprContext",
-							  ALLOCSET_DEFAULT_MINSIZE,
-							  ALLOCSET_DEFAULT_INITSIZE,
-							  ALLOCSET_DEFAULT_MAXSIZE);
+		CreateExprContextPerTupleMemory(CurrentMemoryContext);
 
 	econtext->ecxt_param_exec_vals = NULL;
 	econtext->ecxt_param_list_info = NULL;
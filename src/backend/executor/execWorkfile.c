@@ -731,8 +731,9 @@ ExecWorkFile_AdjustBFZSize(ExecWorkFile *workfile, int64 file_size)
 		/* Actual file on disk is bigger than expected. This can happen when:
 		 *  - added checksums to an uncompressed file
 		 *  - closing empty or very small compressed file (zlib header overhead larger than saved space)
+		 *  - closing an lz compressed file of incompressible data (block headers)
 		 */
-		Assert( (bfz_file->has_checksum && bfz_file->compression_index == 0) || (bfz_file->compression_index > 0 && workfile->size < BFZ_BUFFER_SIZE));
+		Assert( (bfz_file->has_checksum && bfz_file->compression_index == 0) || bfz_file->compression_index > 0);
 
 		/*
 		 * If we're already under disk full, don't try to reserve, as it will
@@ -18,6 +18,7 @@
 #include "executor/execIndexscan.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/execDynamicIndexScan.h"
+#include "executor/execDynamicScan.h"
 #include "executor/nodeDynamicIndexscan.h"
 #include "cdb/cdbpartition.h"
 #include "parser/parsetree.h"
@@ -76,6 +77,9 @@ ExecInitDynamicIndexScan(DynamicIndexScan *node, EState *estate, int eflags)
 
 	InitRuntimeKeysContext(indexState);
 
+	dynamicIndexScanState->partitionCache =
+		DynamicScan_CreatePartitionCache("DynamicIndexScan partitions");
+
 	initGpmonPktForDynamicIndexScan((Plan *)node, &indexState->ss.ps.gpmon_pkt, estate);
 
 	return dynamicIndexScanState;
@@ -148,15 +152,24 @@ initNextIndexToScan(DynamicIndexScanState *node)
 	if (indexState->ss.scan_state == SCAN_INIT ||
 		indexState->ss.scan_state == SCAN_DONE)
 	{
-		/* This is the oid of a partition of the table (*not* index) */
-		Oid *pid = hash_seq_search(&node->pidxStatus);
-		if (pid == NULL)
+		PartOidEntry *partOidEntry;
+
+		/* Skip partitions that every partition selector has withdrawn */
+		do
+		{
+			partOidEntry = hash_seq_search(&node->pidxStatus);
+		} while (partOidEntry != NULL && partOidEntry->selectorList == NIL);
+
+		if (partOidEntry == NULL)
 		{
 			/* Return if all parts have been scanned. */
 			node->shouldCallHashSeqTerm = false;
 			return false;
 		}
 
+		/* This is the oid of a partition of the table (*not* index) */
+		Oid *pid = &partOidEntry->partOid;
+
 		/* Collect number of partitions scanned in EXPLAIN ANALYZE */
 		if(NULL != indexState->ss.ps.instrument)
 		{
@@ -173,7 +186,9 @@ initNextIndexToScan(DynamicIndexScanState *node)
 		 * We started at table level, and now we are fetching the oid of an index
 		 * partition.
 		 */
-		Relation currentRelation = OpenScanRelationByOid(*pid);
+		DynamicScanPartitionEntry *partEntry =
+			DynamicScan_LookupPartition(node->partitionCache, *pid);
+		Relation currentRelation = partEntry->relation;
 		indexState->ss.ss_currentRelation = currentRelation;
 
 		indexState->ss.ss_ScanTupleSlot->tts_tableOid = *pid;
@@ -193,12 +208,19 @@ initNextIndexToScan(DynamicIndexScanState *node)
 		indexState->ss.ps.qual = (List *) ExecInitExpr((Expr *) indexState->ss.ps.plan->qual, (PlanState *) indexState);
 		indexState->ss.ps.targetlist = (List *) ExecInitExpr((Expr *) indexState->ss.ps.plan->targetlist, (PlanState *) indexState);
 
-		Oid pindex = getPhysicalIndexRelid(currentRelation, dynamicIndexScan->logicalIndexInfo);
+		/*
+		 * Finding the physical index of a partition is a catalog lookup, so
+		 * do it once per partition and keep the index open for rescans.
+		 */
+		if (NULL == partEntry->indexRelation)
+		{
+			Oid pindex = getPhysicalIndexRelid(currentRelation, dynamicIndexScan->logicalIndexInfo);
 
-		Assert(OidIsValid(pindex));
+			Assert(OidIsValid(pindex));
 
-		indexState->iss_RelationDesc =
-			OpenIndexRelation(estate, pindex, *pid);
+			partEntry->indexRelation = OpenIndexRelation(estate, pindex, *pid);
+		}
+		indexState->iss_RelationDesc = partEntry->indexRelation;
 
 		/*
 		 * build the index scan keys from the index qualification
@@ -317,8 +339,8 @@ ExecDynamicIndexScan(DynamicIndexScanState *node)
 }
 
 /*
- * Release resources for one part (this includes closing the index and
- * the relation).
+ * Release resources for one part. The index and the relation stay open
+ * in the partition cache.
  */
 static inline void
 CleanupOnePartition(IndexScanState *indexState)
@@ -338,10 +360,7 @@ CleanupOnePartition(IndexScanState *indexState)
 		index_endscan(indexState->iss_ScanDesc);
 		indexState->iss_ScanDesc = NULL;
 
-		index_close(indexState->iss_RelationDesc, NoLock);
 		indexState->iss_RelationDesc = NULL;
-
-		ExecCloseScanRelation(indexState->ss.ss_currentRelation);
 		indexState->ss.ss_currentRelation = NULL;
 	}
 
@@ -379,6 +398,9 @@ ExecEndDynamicIndexScan(DynamicIndexScanState *node)
 	FreeRuntimeKeysContext((IndexScanState *) node);
 	EndPlanStateGpmonPkt(&indexState->ss.ps);
 
+	DynamicScan_DestroyPartitionCache(node->partitionCache);
+	node->partitionCache = NULL;
+
 	MemoryContextDelete(node->partitionMemoryContext);
 }
 
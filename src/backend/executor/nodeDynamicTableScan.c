@@ -11,6 +11,7 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/execDynamicScan.h"
 #include "executor/instrument.h"
 #include "nodes/execnodes.h"
 #include "executor/nodeDynamicTableScan.h"
@@ -60,6 +61,8 @@ ExecInitDynamicTableScan(DynamicTableScan *node, EState *estate, int eflags)
 									 ALLOCSET_DEFAULT_INITSIZE,
 									 ALLOCSET_DEFAULT_MAXSIZE);
 
+	state->partitionCache = DynamicScan_CreatePartitionCache("DynamicTableScan partitions");
+
 	initGpmonPktForDynamicTableScan((Plan *)node, &state->tableScanState.ss.ps.gpmon_pkt, estate);
 
 	return state;
@@ -82,12 +85,20 @@ initNextTableToScan(DynamicTableScanState *node)
 	if (scanState->scan_state == SCAN_INIT ||
 		scanState->scan_state == SCAN_DONE)
 	{
-		Oid *pid = hash_seq_search(&node->pidStatus);
-		if (pid == NULL)
+		PartOidEntry *partOidEntry;
+
+		/* Skip partitions that every partition selector has withdrawn */
+		do
+		{
+			partOidEntry = hash_seq_search(&node->pidStatus);
+		} while (partOidEntry != NULL && partOidEntry->selectorList == NIL);
+
+		if (partOidEntry == NULL)
 		{
 			node->shouldCallHashSeqTerm = false;
 			return false;
 		}
+		Oid *pid = &partOidEntry->partOid;
 		
 		/* Collect number of partitions scanned in EXPLAIN ANALYZE */
 		if (NULL != scanState->ps.instrument)
@@ -107,18 +118,28 @@ initNextTableToScan(DynamicTableScanState *node)
 		 */
 		scanState->ss_ScanTupleSlot->tts_tableOid = *pid;
 
-		scanState->ss_currentRelation = OpenScanRelationByOid(*pid);
-		Relation lastScannedRel = OpenScanRelationByOid(node->lastRelOid);
-		TupleDesc lastTupDesc = RelationGetDescr(lastScannedRel);
-		CloseScanRelation(lastScannedRel);
+		/*
+		 * Partitions stay open in the partition cache until the end of the
+		 * scan, so in a nested loop only the first visit to a partition pays
+		 * for opening it.
+		 */
+		DynamicScanPartitionEntry *partEntry =
+			DynamicScan_LookupPartition(node->partitionCache, *pid);
+		scanState->ss_currentRelation = partEntry->relation;
 
 		TupleDesc partTupDesc = RelationGetDescr(scanState->ss_currentRelation);
 
 		ExecAssignScanType(scanState, partTupDesc);
 
-		AttrNumber	*attMap;
+		AttrNumber	*attMap = NULL;
 
-		attMap = varattnos_map(lastTupDesc, partTupDesc);
+		if (node->lastRelOid != *pid)
+		{
+			DynamicScanPartitionEntry *lastEntry =
+				DynamicScan_LookupPartition(node->partitionCache, node->lastRelOid);
+
+			attMap = varattnos_map(RelationGetDescr(lastEntry->relation), partTupDesc);
+		}
 
 		/* If attribute remapping is not necessary, then do not change the varattno */
 		if (attMap)
@@ -242,7 +263,8 @@ ExecDynamicTableScan(DynamicTableScanState *node)
 
 /*
  * CleanupOnePartition
- *		Cleans up a partition's relation and releases all locks.
+ *		Ends the scan of the current partition. The relation itself stays
+ *		open in the partition cache.
  */
 static inline void
 CleanupOnePartition(ScanState *scanState)
@@ -253,7 +275,6 @@ CleanupOnePartition(ScanState *scanState)
 		EndTableScanRelation(scanState);
 
 		Assert(scanState->ss_currentRelation != NULL);
-		ExecCloseScanRelation(scanState->ss_currentRelation);
 		scanState->ss_currentRelation = NULL;
 	}
 }
@@ -284,8 +305,11 @@ ExecEndDynamicTableScan(DynamicTableScanState *node)
 {
 	DynamicTableScanEndCurrentScan(node);
 
-	/* We do not close the relation. We closed it in DynamicScan_CleanupOneRelation. */
+	/* We do not close the relation here. The partition cache owns it. */
 	FreeScanRelationInternal((ScanState *)node, false /* closeCurrentRelation */);
+
+	DynamicScan_DestroyPartitionCache(node->partitionCache);
+	node->partitionCache = NULL;
 	EndPlanStateGpmonPkt(&node->tableScanState.ss.ps);
 }
 
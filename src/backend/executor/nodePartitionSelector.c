@@ -23,6 +23,8 @@
 
 static void
 partition_propagation(List *partOids, List *scanIds, int32 selectorId);
+static void
+partition_withdrawal(PartitionSelectorState *node, List *partOids);
 
 /* PartitionSelector Slots */
 #define PARTITIONSELECTOR_NSLOTS 1
@@ -164,11 +166,29 @@ ExecPartitionSelector(PartitionSelectorState *node)
 	/* partition propagation */
 	if (NULL != ps->propagationExpression)
 	{
+		/*
+		 * A selector without child runs once per rescan, e.g. on the inner
+		 * side of a nested loop. Withdraw what the previous rescan selected,
+		 * otherwise the selections of all outer tuples pile up in the pid
+		 * index and the dynamic scan ends up scanning their union.
+		 */
+		if (NULL == outerPlanState(node))
+		{
+			partition_withdrawal(node, selparts->partOids);
+		}
 		partition_propagation(selparts->partOids, selparts->scanIds, ps->selectorId);
 	}
 
-	list_free(selparts->partOids);
-	list_free(selparts->scanIds);
+	if (NULL != ps->propagationExpression && NULL == outerPlanState(node))
+	{
+		node->propagatedPartOids = selparts->partOids;
+		node->propagatedScanIds = selparts->scanIds;
+	}
+	else
+	{
+		list_free(selparts->partOids);
+		list_free(selparts->scanIds);
+	}
 	pfree(selparts);
 
 	TupleTableSlot *candidateOutputSlot = NULL;
@@ -282,5 +302,42 @@ partition_propagation(List *partOids, List *scanIds, int32 selectorId)
 	}
 }
 
+/* ----------------------------------------------------------------
+ *		partition_withdrawal
+ *
+ *		Withdraw the leaf part Oids propagated by the previous execution
+ *		of this selector that are not in the new selection
+ *
+ *		Withdrawn entries stay in the pid index with an empty selector
+ *		list, so this is safe even while a scan iterates over it.
+ *
+ * ----------------------------------------------------------------
+ */
+static void
+partition_withdrawal(PartitionSelectorState *node, List *partOids)
+{
+	PartitionSelector *ps = (PartitionSelector *) node->ps.plan;
+
+	Assert (list_length(node->propagatedPartOids) == list_length(node->propagatedScanIds));
+
+	ListCell *lcOid = NULL;
+	ListCell *lcScanId = NULL;
+	forboth (lcOid, node->propagatedPartOids, lcScanId, node->propagatedScanIds)
+	{
+		Oid partOid = lfirst_oid(lcOid);
+		int scanId = lfirst_int(lcScanId);
+
+		if (!list_member_oid(partOids, partOid))
+		{
+			RemovePidFromDynamicTableScanInfo(scanId, partOid, ps->selectorId);
+		}
+	}
+
+	list_free(node->propagatedPartOids);
+	list_free(node->propagatedScanIds);
+	node->propagatedPartOids = NIL;
+	node->propagatedScanIds = NIL;
+}
+
 /* EOF */
 
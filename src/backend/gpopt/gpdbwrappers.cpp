@@ -194,8 +194,16 @@
 #define ALLOW_isMotionGather
 #define ALLOW_estimate_rel_size
 #define ALLOW_rel_partitioning_is_uniform
+#define ALLOW_GetSysCacheHashValue
+#define ALLOW_hash_search
+#define ALLOW_list_free_deep
 
 #include "gpopt/utils/gpdbdefs.h"
+#include "portability/instr_time.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
 
 #include "gpos/base.h"
 #include "gpos/error/CException.h"
@@ -1180,22 +1188,6 @@ gpdb::PlCheckConstraint
 	return NULL;
 }
 
-Node *
-gpdb::PnodePartConstraintRel
-	(
-	Oid oidRel,
-	List **pplDefaultLevels
-	)
-{
-	GP_WRAP_START;
-	{
-		/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
-		return get_relation_part_constraints(oidRel, pplDefaultLevels);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
 bool
 gpdb::FLeafPartition
 	(
@@ -2517,21 +2509,6 @@ gpdb::PlRelationIndexes
 	return NIL;
 }
 
-LogicalIndexes *
-gpdb::Plgidx
-	(
-	Oid oid
-	)
-{
-	GP_WRAP_START;
-	{
-		/* catalog tables: pg_partition, pg_partition_rule, pg_index */
-		return BuildLogicalIndexInfo(oid);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
 LogicalIndexInfo *
 gpdb::Plgidxinfo
 	(
@@ -3048,16 +3025,28 @@ gpdb::UlLeafPartitions
 }
 
 /*
- * To detect changes to catalog tables that require resetting the Metadata
+ * To detect changes to catalog tables that invalidate entries of the Metadata
  * Cache, we use the normal PostgreSQL catalog cache invalidation mechanism.
  * We register a callback to a cache on all the catalog tables that contain
  * information that's contained in the ORCA metadata cache.
-
- * There is no fine-grained mechanism in the metadata cache for invalidating
- * individual entries ATM, so we just blow the whole cache whenever anything
- * changes. The callback simply increments a counter. Whenever we start
- * planning a query, we check the counter to see if it has changed since the
- * last planned query, and reset the whole cache if it has.
+ *
+ * The metadata cache itself knows nothing about the catalogs, so we keep
+ * track of which invalidation events affect which of its entries: whenever
+ * an object is translated from the catalogs into the cache, the provider
+ * calls MDCacheTrackEntry(), which remembers the entry under the relcache
+ * and syscache keys it was built from. The callbacks only queue the keys of
+ * the invalidation events. Whenever we start planning a query, the queued
+ * keys are looked up, and only the entries registered under them are
+ * dropped from the cache. An ETL load or ANALYZE of one table therefore
+ * does not throw away the metadata of all the other tables.
+ *
+ * Changes to pg_class, pg_statistic, pg_type, pg_proc, pg_aggregate and
+ * pg_constraint are handled this way. For the other catalogs it's hard to
+ * tell which cache entries depend on a changed row (e.g. a new pg_amop
+ * row changes the comparison of two types, or a pg_partition_rule row the
+ * metadata of the partitioned table), so we still blow the whole cache
+ * whenever anything changes in them, as we do if the invalidation queue
+ * overflows or too many entries are being tracked.
  *
  * To make sure we've covered all catalog tables that contain information
  * that's stored in the metadata cache, there are "catalog tables: xxx"
@@ -3066,20 +3055,117 @@ gpdb::UlLeafPartitions
  * anything fetched via the wrapper functions in this file can end up in the
  * metadata cache and hence need to have an invalidation callback registered.
  */
-static bool mdcache_invalidation_counter_registered = false;
-static int64 mdcache_invalidation_counter = 0;
-static int64 last_mdcache_invalidation_counter = 0;
+
+/* pseudo cache id of relcache invalidations, keyed by the relation oid */
+#define MDCACHE_RELCACHE_ID			(-1)
+
+/* max number of invalidation events to queue between two queries */
+#define MDCACHE_MAX_PENDING_INVALS	1024
+
+/* max number of cache entries to track before we fall back to a full reset */
+#define MDCACHE_MAX_TRACKED_ENTRIES	(256 * 1024)
+
+typedef struct MDCacheInvalKey
+{
+	int			cacheid;		/* syscache id, or MDCACHE_RELCACHE_ID */
+	uint32		hashValue;		/* hash of the syscache keys, or relation oid */
+} MDCacheInvalKey;
+
+typedef struct MDCacheTrackedKey
+{
+	MDCacheInvalKey key;		/* hash key, must be first */
+	List	   *entries;		/* gpdb::SMDCacheEntry's built from this key */
+} MDCacheTrackedKey;
+
+static bool mdcache_invalidation_callbacks_registered = false;
+static bool mdcache_reset_pending = false;
+
+static MDCacheInvalKey mdcache_pending_invals[MDCACHE_MAX_PENDING_INVALS];
+static int	mdcache_num_pending_invals = 0;
+
+static MemoryContext mdcache_tracking_context = NULL;
+static HTAB *mdcache_tracked_keys = NULL;
+static int64 mdcache_num_tracked_entries = 0;
+
+static gpdb::SMDCacheStats mdcache_stats;
+
+/* has all the cached partition metadata been invalidated? (see below) */
+static bool part_metadata_stale = false;
+
+static void mark_part_metadata_stale(Oid relid);
+
+/*
+ * Is there a catalog cache whose invalidations we can map to individual
+ * metadata cache entries?
+ */
+static bool
+mdcache_fine_grained_cacheid(int cacheid)
+{
+	switch (cacheid)
+	{
+		case AGGFNOID:
+		case CONSTROID:
+		case PROCOID:
+		case STATRELATT:
+		case TYPEOID:
+			return true;
+		default:
+			return false;
+	}
+}
 
 static void
-mdsyscache_invalidation_counter_callback(Datum arg, int cacheid,  ItemPointer tuplePtr)
+mdcache_queue_invalidation(int cacheid, uint32 hashValue)
 {
-	mdcache_invalidation_counter++;
+	if (mdcache_reset_pending)
+		return;
+
+	if (mdcache_num_pending_invals >= MDCACHE_MAX_PENDING_INVALS)
+	{
+		mdcache_reset_pending = true;
+		return;
+	}
+
+	mdcache_pending_invals[mdcache_num_pending_invals].cacheid = cacheid;
+	mdcache_pending_invals[mdcache_num_pending_invals].hashValue = hashValue;
+	mdcache_num_pending_invals++;
 }
 
 static void
-mdrelcache_invalidation_counter_callback(Datum arg, Oid relid)
+mdsyscache_invalidation_callback(Datum arg, int cacheid, ItemPointer tuplePtr,
+								 uint32 hashValue)
 {
-	mdcache_invalidation_counter++;
+	mdcache_stats.m_lInvalMessages++;
+
+	if (tuplePtr == NULL || cacheid == PARTOID || cacheid == PARTRULEOID ||
+		cacheid == CONSTROID)
+		part_metadata_stale = true;
+
+	if (tuplePtr == NULL || !mdcache_fine_grained_cacheid(cacheid))
+		mdcache_reset_pending = true;
+	else
+		mdcache_queue_invalidation(cacheid, hashValue);
+}
+
+static void
+mdrelcache_invalidation_callback(Datum arg, Oid relid)
+{
+	mdcache_stats.m_lInvalMessages++;
+
+	/*
+	 * The relation may be a part of a partitioned table with cached
+	 * metadata. Creating or dropping an index on a part also invalidates
+	 * the part itself.
+	 */
+	if (!OidIsValid(relid))
+		part_metadata_stale = true;
+	else
+		mark_part_metadata_stale(relid);
+
+	if (!OidIsValid(relid))
+		mdcache_reset_pending = true;
+	else
+		mdcache_queue_invalidation(MDCACHE_RELCACHE_ID, (uint32) relid);
 }
 
 static void
@@ -3141,16 +3227,376 @@ register_mdcache_invalidation_callbacks(void)
 	for (i = 0; i < lengthof(metadata_caches); i++)
 	{
 		CacheRegisterSyscacheCallback(metadata_caches[i],
-									  &mdsyscache_invalidation_counter_callback,
+									  &mdsyscache_invalidation_callback,
 									  (Datum) 0);
 	}
 
 	/* also register the relcache callback */
-	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_counter_callback,
+	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_callback,
 								  (Datum) 0);
 }
 
-// Has there been any catalog changes since last call?
+/*
+ * Forget about all tracked entries, after the whole cache has been reset.
+ */
+static void
+reset_mdcache_tracking(void)
+{
+	if (mdcache_tracking_context == NULL)
+	{
+		mdcache_tracking_context =
+			AllocSetContextCreate(TopMemoryContext,
+								  "ORCA metadata cache tracking",
+								  ALLOCSET_DEFAULT_MINSIZE,
+								  ALLOCSET_DEFAULT_INITSIZE,
+								  ALLOCSET_DEFAULT_MAXSIZE);
+	}
+	else
+	{
+		if (mdcache_tracked_keys != NULL)
+			hash_destroy(mdcache_tracked_keys);
+		MemoryContextReset(mdcache_tracking_context);
+	}
+
+	HASHCTL		info;
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(MDCacheInvalKey);
+	info.entrysize = sizeof(MDCacheTrackedKey);
+	info.hash = tag_hash;
+	info.hcxt = mdcache_tracking_context;
+	mdcache_tracked_keys = hash_create("ORCA metadata cache tracked keys",
+									   1024,
+									   &info,
+									   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	mdcache_num_tracked_entries = 0;
+	mdcache_num_pending_invals = 0;
+}
+
+static void
+track_mdcache_entry(int cacheid, uint32 hashValue, const gpdb::SMDCacheEntry *pentry)
+{
+	MDCacheInvalKey key;
+	MDCacheTrackedKey *tracked;
+	gpdb::SMDCacheEntry *pentryCopy;
+	bool		found;
+
+	key.cacheid = cacheid;
+	key.hashValue = hashValue;
+
+	tracked = (MDCacheTrackedKey *) hash_search(mdcache_tracked_keys, &key,
+												HASH_ENTER, &found);
+	if (!found)
+		tracked->entries = NIL;
+
+	MemoryContext oldcxt = MemoryContextSwitchTo(mdcache_tracking_context);
+	pentryCopy = (gpdb::SMDCacheEntry *) palloc(sizeof(gpdb::SMDCacheEntry));
+	*pentryCopy = *pentry;
+	tracked->entries = lappend(tracked->entries, pentryCopy);
+	MemoryContextSwitchTo(oldcxt);
+
+	mdcache_num_tracked_entries++;
+}
+
+/*
+ * The partition metadata of a partitioned table -- the logical indexes over
+ * its parts, along with the part constraints each of them covers, and the
+ * part constraints of the table itself -- is built by walking all the parts
+ * of the table. On a table with thousands of parts that takes a long time,
+ * and the translator used to redo it for the table and once more for every
+ * index on it. We build each piece the first time the translator asks for
+ * it, and keep it for the later requests, across queries, until a change to
+ * pg_class, pg_index, pg_partition, pg_partition_rule or pg_constraint could
+ * have made it stale. The metadata handed out must stay valid while the
+ * optimizer runs, so stale metadata is only dropped when the next
+ * optimization starts.
+ *
+ * A relcache invalidation of the root or of one of its parts only makes
+ * the metadata of that root stale; the parts of each cached root are
+ * registered in a second hash table for that. Changes to pg_partition,
+ * pg_partition_rule and pg_constraint, which can't be mapped to a root
+ * this way, make all of it stale.
+ *
+ * The memory kept is capped by optimizer_partition_metadata_cache_size.
+ * Beyond it, the metadata is built in the caller's memory context for every
+ * request, as before.
+ */
+typedef struct PartMetadataEntry
+{
+	Oid			rootOid;			/* hash key, must be first */
+	bool		stale;				/* to be dropped at the next optimization */
+	MemoryContext context;			/* holds the metadata below */
+	Size		bytes;				/* memory used in context */
+	bool		haveLogicalIndexes;
+	LogicalIndexes *logicalIndexes;
+	bool		havePartCons;
+	Node	   *partCons;
+	List	   *defaultLevels;
+} PartMetadataEntry;
+
+/* maps a partitioned table or one of its parts to the cached root */
+typedef struct PartMetadataMember
+{
+	Oid			relid;				/* hash key, must be first */
+	Oid			rootOid;
+} PartMetadataMember;
+
+static MemoryContext part_metadata_context = NULL;
+static HTAB *part_metadata_hash = NULL;
+static HTAB *part_metadata_members = NULL;
+static int	part_metadata_num_stale = 0;
+static Size part_metadata_entry_bytes = 0;
+
+static int	md_translation_depth = 0;
+static instr_time md_translation_start;
+static gpdb::SMDTranslationStats md_translation_stats;
+
+/*
+ * Forget about all cached partition metadata.
+ */
+static void
+reset_part_metadata(void)
+{
+	HASHCTL		info;
+
+	if (part_metadata_context == NULL)
+	{
+		part_metadata_context =
+			AllocSetContextCreate(TopMemoryContext,
+								  "ORCA partition metadata",
+								  ALLOCSET_DEFAULT_MINSIZE,
+								  ALLOCSET_DEFAULT_INITSIZE,
+								  ALLOCSET_DEFAULT_MAXSIZE);
+	}
+	else
+		MemoryContextResetAndDeleteChildren(part_metadata_context);
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(Oid);
+	info.entrysize = sizeof(PartMetadataEntry);
+	info.hash = oid_hash;
+	info.hcxt = part_metadata_context;
+	part_metadata_hash = hash_create("ORCA partition metadata",
+									 64,
+									 &info,
+									 HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(Oid);
+	info.entrysize = sizeof(PartMetadataMember);
+	info.hash = oid_hash;
+	info.hcxt = part_metadata_context;
+	part_metadata_members = hash_create("ORCA partition metadata parts",
+										256,
+										&info,
+										HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	part_metadata_stale = false;
+	part_metadata_num_stale = 0;
+	part_metadata_entry_bytes = 0;
+}
+
+/*
+ * Mark the cached metadata of the partitioned table that a relation belongs
+ * to as stale. Called from the relcache invalidation callback, so it must
+ * not access the catalogs.
+ */
+static void
+mark_part_metadata_stale(Oid relid)
+{
+	PartMetadataMember *member;
+	PartMetadataEntry *entry;
+
+	if (part_metadata_members == NULL)
+		return;
+
+	member = (PartMetadataMember *) hash_search(part_metadata_members, &relid,
+												HASH_FIND, NULL);
+	if (member == NULL)
+		return;
+
+	entry = (PartMetadataEntry *) hash_search(part_metadata_hash,
+											  &member->rootOid,
+											  HASH_FIND, NULL);
+	if (entry != NULL && !entry->stale)
+	{
+		entry->stale = true;
+		part_metadata_num_stale++;
+	}
+}
+
+/*
+ * Drop the cached metadata of the partitioned tables marked stale.
+ */
+static void
+drop_stale_part_metadata(void)
+{
+	HASH_SEQ_STATUS status;
+	PartMetadataMember *member;
+	PartMetadataEntry *entry;
+
+	/* removing the current element of a seq scan is allowed */
+	hash_seq_init(&status, part_metadata_members);
+	while ((member = (PartMetadataMember *) hash_seq_search(&status)) != NULL)
+	{
+		entry = (PartMetadataEntry *) hash_search(part_metadata_hash,
+												  &member->rootOid,
+												  HASH_FIND, NULL);
+		if (entry == NULL || entry->stale)
+			hash_search(part_metadata_members, &member->relid, HASH_REMOVE, NULL);
+	}
+
+	hash_seq_init(&status, part_metadata_hash);
+	while ((entry = (PartMetadataEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (!entry->stale)
+			continue;
+
+		MemoryContextDelete(entry->context);
+		part_metadata_entry_bytes -= entry->bytes;
+		hash_search(part_metadata_hash, &entry->rootOid, HASH_REMOVE, NULL);
+	}
+
+	part_metadata_num_stale = 0;
+}
+
+/*
+ * Memory used by the cached partition metadata.
+ */
+static Size
+part_metadata_bytes(void)
+{
+	if (part_metadata_context == NULL)
+		return 0;
+
+	return MemoryContextGetCurrentSpace(part_metadata_context) +
+		part_metadata_entry_bytes;
+}
+
+/*
+ * Has the cached partition metadata reached its memory cap?
+ */
+static bool
+part_metadata_cache_full(void)
+{
+	return part_metadata_bytes() >=
+		(Size) optimizer_partition_metadata_cache_size * 1024L;
+}
+
+/*
+ * Account for the metadata just added to a cache entry.
+ */
+static void
+part_metadata_entry_grown(PartMetadataEntry *entry)
+{
+	Size		bytes = MemoryContextGetCurrentSpace(entry->context);
+
+	part_metadata_entry_bytes += bytes - entry->bytes;
+	entry->bytes = bytes;
+}
+
+/*
+ * Look up the cached partition metadata of a partitioned table, adding an
+ * empty entry if there is none yet. Returns NULL if the metadata can't be
+ * cached, and must be built for the caller alone.
+ */
+static PartMetadataEntry *
+part_metadata_entry(Oid rootOid)
+{
+	PartMetadataEntry *entry;
+	bool		found;
+
+	/*
+	 * Without the invalidation callbacks, we wouldn't find out when the
+	 * metadata goes stale. They are registered when the first optimization
+	 * starts.
+	 */
+	if (!mdcache_invalidation_callbacks_registered ||
+		optimizer_partition_metadata_cache_size <= 0)
+		return NULL;
+
+	if (part_metadata_hash == NULL)
+		reset_part_metadata();
+
+	entry = (PartMetadataEntry *) hash_search(part_metadata_hash, &rootOid,
+											  HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		/* stale metadata is still in use, but must not be handed out again */
+		return entry->stale ? NULL : entry;
+	}
+
+	if (part_metadata_cache_full())
+		return NULL;
+
+	/*
+	 * Register the table and its parts, so that a relcache invalidation of
+	 * any of them makes the entry stale.
+	 * catalog tables: pg_inherits
+	 */
+	List	   *plParts = find_all_inheritors(rootOid);
+	ListCell   *lc;
+
+	foreach(lc, plParts)
+	{
+		Oid			relid = lfirst_oid(lc);
+		PartMetadataMember *member;
+
+		member = (PartMetadataMember *) hash_search(part_metadata_members, &relid,
+													HASH_ENTER, &found);
+		member->rootOid = rootOid;
+	}
+	list_free(plParts);
+
+	entry = (PartMetadataEntry *) hash_search(part_metadata_hash, &rootOid,
+											  HASH_ENTER, &found);
+	Assert(!found);
+	entry->stale = false;
+	entry->context = AllocSetContextCreate(part_metadata_context,
+										   "ORCA partition metadata entry",
+										   ALLOCSET_SMALL_MINSIZE,
+										   ALLOCSET_SMALL_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+	entry->bytes = 0;
+	entry->haveLogicalIndexes = false;
+	entry->logicalIndexes = NULL;
+	entry->havePartCons = false;
+	entry->partCons = NULL;
+	entry->defaultLevels = NIL;
+
+	return entry;
+}
+
+static void
+add_part_metadata_build_time(instr_time starttime)
+{
+	instr_time	duration;
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, starttime);
+	md_translation_stats.m_dPartMetadataMs += INSTR_TIME_GET_MILLISEC(duration);
+	md_translation_stats.m_lPartMetadataBuilt++;
+	mdcache_stats.m_lPartMetadataBuilt++;
+}
+
+/*
+ * Called when an optimization starts.
+ */
+static void
+start_md_translation(void)
+{
+	if (part_metadata_stale && part_metadata_hash != NULL)
+		reset_part_metadata();
+	else if (part_metadata_num_stale > 0)
+		drop_stale_part_metadata();
+
+	MemSet(&md_translation_stats, 0, sizeof(md_translation_stats));
+	md_translation_depth = 0;
+}
+
+// Has there been any catalog changes since last call that we can't map to
+// individual cache entries, so that the whole cache needs to be reset?
 bool
 gpdb::FMDCacheNeedsReset
 		(
@@ -3159,22 +3605,400 @@ gpdb::FMDCacheNeedsReset
 {
 	GP_WRAP_START;
 	{
-		if (!mdcache_invalidation_counter_registered)
+		mdcache_stats.m_lOptimizations++;
+
+		/* this is the start of a new optimization */
+		start_md_translation();
+
+		if (!mdcache_invalidation_callbacks_registered)
 		{
 			register_mdcache_invalidation_callbacks();
-			mdcache_invalidation_counter_registered = true;
+			mdcache_invalidation_callbacks_registered = true;
+
+			/* start from scratch, we may have missed earlier invalidations */
+			reset_mdcache_tracking();
+			mdcache_reset_pending = false;
+			return true;
 		}
-		if (last_mdcache_invalidation_counter == mdcache_invalidation_counter)
+
+		if (mdcache_num_tracked_entries > MDCACHE_MAX_TRACKED_ENTRIES)
+			mdcache_reset_pending = true;
+
+		if (!mdcache_reset_pending)
 			return false;
+
+		reset_mdcache_tracking();
+		mdcache_reset_pending = false;
+		mdcache_stats.m_lResets++;
+		return true;
+	}
+	GP_WRAP_END;
+
+	return true;
+}
+
+// Remember the catalog objects an entry of the metadata cache was built
+// from, so that it can be invalidated on its own when they change
+void
+gpdb::MDCacheTrackEntry
+	(
+	const SMDCacheEntry *pentry,
+	AttrNumber attno
+	)
+{
+	GP_WRAP_START;
+	{
+		mdcache_stats.m_lLoads++;
+
+		if (mdcache_tracked_keys == NULL)
+			reset_mdcache_tracking();
+
+		Oid oid = pentry->m_oid;
+
+		switch (pentry->m_iKind)
+		{
+			case MDCacheEntryObject:
+				/* catalog tables: pg_class, pg_type, pg_proc, pg_trigger, pg_constraint */
+				if (relation_exists(oid))
+				{
+					/* tables and indexes */
+					track_mdcache_entry(MDCACHE_RELCACHE_ID, oid, pentry);
+				}
+				else if (type_exists(oid))
+				{
+					track_mdcache_entry(TYPEOID,
+										GetSysCacheHashValue1(TYPEOID, ObjectIdGetDatum(oid)),
+										pentry);
+				}
+				else if (function_exists(oid))
+				{
+					/* functions and aggregates */
+					track_mdcache_entry(PROCOID,
+										GetSysCacheHashValue1(PROCOID, ObjectIdGetDatum(oid)),
+										pentry);
+					track_mdcache_entry(AGGFNOID,
+										GetSysCacheHashValue1(AGGFNOID, ObjectIdGetDatum(oid)),
+										pentry);
+				}
+				else if (trigger_exists(oid))
+				{
+					/* pg_trigger changes are sent as relcache invalidations */
+					track_mdcache_entry(MDCACHE_RELCACHE_ID, get_trigger_relid(oid),
+										pentry);
+				}
+				else if (check_constraint_exists(oid))
+				{
+					track_mdcache_entry(CONSTROID,
+										GetSysCacheHashValue1(CONSTROID, ObjectIdGetDatum(oid)),
+										pentry);
+					track_mdcache_entry(MDCACHE_RELCACHE_ID,
+										get_check_constraint_relid(oid),
+										pentry);
+				}
+
+				/*
+				 * Operators are not tracked; pg_operator changes always
+				 * reset the whole cache.
+				 */
+				break;
+
+			case MDCacheEntryRelStats:
+				/* catalog tables: pg_class */
+				track_mdcache_entry(MDCACHE_RELCACHE_ID, oid, pentry);
+				break;
+
+			case MDCacheEntryColStats:
+				/* catalog tables: pg_class, pg_statistic */
+				track_mdcache_entry(MDCACHE_RELCACHE_ID, oid, pentry);
+				track_mdcache_entry(STATRELATT,
+									GetSysCacheHashValue2(STATRELATT,
+														  ObjectIdGetDatum(oid),
+														  Int16GetDatum(attno)),
+									pentry);
+				break;
+
+			default:
+				break;
+		}
+	}
+	GP_WRAP_END;
+}
+
+// Return the metadata cache entries invalidated by catalog changes since
+// the last call, as a palloc'd array of *pulEntries elements
+gpdb::SMDCacheEntry *
+gpdb::PMDCacheInvalidEntries
+	(
+	ULONG *pulEntries
+	)
+{
+	GP_WRAP_START;
+	{
+		SMDCacheEntry *pentries = NULL;
+		ULONG ulEntries = 0;
+		ULONG ulSize = 0;
+
+		*pulEntries = 0;
+		if (mdcache_tracked_keys == NULL || mdcache_num_pending_invals == 0)
+		{
+			mdcache_num_pending_invals = 0;
+			return NULL;
+		}
+
+		for (int i = 0; i < mdcache_num_pending_invals; i++)
+		{
+			MDCacheInvalKey key;
+			MDCacheTrackedKey *tracked;
+			ListCell   *lc;
+
+			key = mdcache_pending_invals[i];
+
+			tracked = (MDCacheTrackedKey *) hash_search(mdcache_tracked_keys, &key,
+														HASH_FIND, NULL);
+			if (tracked == NULL)
+				continue;
+
+			foreach (lc, tracked->entries)
+			{
+				if (ulEntries == ulSize)
+				{
+					ulSize = (ulSize == 0) ? 64 : ulSize * 2;
+					if (pentries == NULL)
+						pentries = (SMDCacheEntry *) palloc(ulSize * sizeof(SMDCacheEntry));
+					else
+						pentries = (SMDCacheEntry *) repalloc(pentries, ulSize * sizeof(SMDCacheEntry));
+				}
+				pentries[ulEntries++] = *(SMDCacheEntry *) lfirst(lc);
+			}
+
+			/*
+			 * The entries will be reloaded, and tracked again, the next
+			 * time they're needed. Their registrations under their other
+			 * keys are left behind, and cause at most a spurious reload.
+			 */
+			mdcache_num_tracked_entries -= list_length(tracked->entries);
+			list_free_deep(tracked->entries);
+			hash_search(mdcache_tracked_keys, &key, HASH_REMOVE, NULL);
+		}
+		mdcache_num_pending_invals = 0;
+
+		mdcache_stats.m_lInvalidations += ulEntries;
+		*pulEntries = ulEntries;
+		return pentries;
+	}
+	GP_WRAP_END;
+
+	return NULL;
+}
+
+// Statistics of the metadata cache of this backend
+void
+gpdb::MDCacheGetStats
+	(
+	SMDCacheStats *pstats
+	)
+{
+	*pstats = mdcache_stats;
+	pstats->m_lTrackedEntries = mdcache_num_tracked_entries;
+}
+
+// Return a copy of cached logical indexes for the caller to free. The index
+// infos it points to stay owned by the partition metadata cache.
+static LogicalIndexes *
+copy_cached_logical_indexes
+	(
+	LogicalIndexes *plgidx
+	)
+{
+	if (plgidx == NULL)
+		return NULL;
+
+	LogicalIndexes *plgidxCopy = (LogicalIndexes *) palloc(sizeof(LogicalIndexes));
+	*plgidxCopy = *plgidx;
+
+	return plgidxCopy;
+}
+
+// Return the logical indexes of a partitioned table, building them on the
+// first request. The caller frees the result with GPDBFree(); the index
+// infos it points to may be owned by the partition metadata cache.
+LogicalIndexes *
+gpdb::Plgidx
+	(
+	Oid oid
+	)
+{
+	GP_WRAP_START;
+	{
+		PartMetadataEntry *entry = part_metadata_entry(oid);
+		LogicalIndexes *plgidx;
+		instr_time	starttime;
+
+		if (entry != NULL && entry->haveLogicalIndexes)
+		{
+			md_translation_stats.m_lPartMetadataReused++;
+			mdcache_stats.m_lPartMetadataReused++;
+			return copy_cached_logical_indexes(entry->logicalIndexes);
+		}
+
+		INSTR_TIME_SET_CURRENT(starttime);
+		if (entry == NULL || part_metadata_cache_full())
+		{
+			/* catalog tables: pg_partition, pg_partition_rule, pg_index */
+			plgidx = BuildLogicalIndexInfo(oid);
+		}
 		else
 		{
-			last_mdcache_invalidation_counter = mdcache_invalidation_counter;
-			return true;
+			MemoryContext oldcxt = MemoryContextSwitchTo(entry->context);
+
+			PG_TRY();
+			{
+				/* catalog tables: pg_partition, pg_partition_rule, pg_index */
+				plgidx = BuildLogicalIndexInfo(oid);
+			}
+			PG_CATCH();
+			{
+				MemoryContextSwitchTo(oldcxt);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+			MemoryContextSwitchTo(oldcxt);
+
+			entry->logicalIndexes = plgidx;
+			entry->haveLogicalIndexes = true;
+			part_metadata_entry_grown(entry);
+			plgidx = copy_cached_logical_indexes(plgidx);
 		}
+		add_part_metadata_build_time(starttime);
+
+		return plgidx;
 	}
 	GP_WRAP_END;
+	return NULL;
+}
 
-	return true;
+// Return the oids of the logical indexes of a partitioned table. Unlike
+// Plgidx(), this doesn't need the part constraints covered by each index.
+List *
+gpdb::PlLogicalIndexOids
+	(
+	Oid oid
+	)
+{
+	GP_WRAP_START;
+	{
+		PartMetadataEntry *entry = part_metadata_entry(oid);
+		LogicalIndexes *plgidx;
+		List	   *plOids = NIL;
+
+		if (entry != NULL && entry->haveLogicalIndexes)
+			plgidx = entry->logicalIndexes;
+		else
+		{
+			/* catalog tables: pg_partition, pg_partition_rule, pg_index */
+			plgidx = BuildLogicalIndexOids(oid);
+		}
+
+		if (plgidx == NULL)
+			return NIL;
+
+		for (int i = 0; i < plgidx->numLogicalIndexes; i++)
+			plOids = lappend_oid(plOids, plgidx->logicalIndexInfo[i]->logicalIndexOid);
+
+		if (entry == NULL || !entry->haveLogicalIndexes)
+			pfree(plgidx);
+
+		return plOids;
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
+// Return the part constraints of a partitioned table, building them on the
+// first request. The result is owned by the partition metadata cache.
+Node *
+gpdb::PnodePartConstraintRel
+	(
+	Oid oidRel,
+	List **pplDefaultLevels
+	)
+{
+	GP_WRAP_START;
+	{
+		PartMetadataEntry *entry = part_metadata_entry(oidRel);
+		Node	   *pnode;
+		instr_time	starttime;
+
+		if (entry != NULL && entry->havePartCons)
+		{
+			md_translation_stats.m_lPartMetadataReused++;
+			mdcache_stats.m_lPartMetadataReused++;
+			*pplDefaultLevels = entry->defaultLevels;
+			return entry->partCons;
+		}
+
+		INSTR_TIME_SET_CURRENT(starttime);
+		/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
+		pnode = get_relation_part_constraints(oidRel, pplDefaultLevels);
+
+		if (entry != NULL && !part_metadata_cache_full())
+		{
+			MemoryContext oldcxt = MemoryContextSwitchTo(entry->context);
+
+			entry->partCons = (Node *) copyObject(pnode);
+			entry->defaultLevels = list_copy(*pplDefaultLevels);
+			entry->havePartCons = true;
+			MemoryContextSwitchTo(oldcxt);
+			part_metadata_entry_grown(entry);
+		}
+		add_part_metadata_build_time(starttime);
+
+		return pnode;
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
+// Start the translation of a metadata object. Objects may be translated
+// while translating another one; only the outermost translation is timed.
+void
+gpdb::MDTranslationStart
+	(
+	void
+	)
+{
+	if (md_translation_depth++ == 0)
+		INSTR_TIME_SET_CURRENT(md_translation_start);
+}
+
+// Finish the translation of a metadata object
+void
+gpdb::MDTranslationEnd
+	(
+	void
+	)
+{
+	md_translation_stats.m_lObjects++;
+
+	if (md_translation_depth > 0 && --md_translation_depth == 0)
+	{
+		instr_time	duration;
+
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, md_translation_start);
+		md_translation_stats.m_dObjectsMs += INSTR_TIME_GET_MILLISEC(duration);
+	}
+}
+
+// Statistics of the metadata translated in the current optimization
+void
+gpdb::MDTranslationGetStats
+	(
+	SMDTranslationStats *pstats
+	)
+{
+	*pstats = md_translation_stats;
+	pstats->m_lPartMetadataBytes = part_metadata_bytes();
 }
 
 // EOF
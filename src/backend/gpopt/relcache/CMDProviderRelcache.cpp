@@ -18,10 +18,16 @@
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/mdcache/CMDAccessor.h"
+#include "gpopt/gpdbwrappers.h"
 
 #include "gpos/io/COstreamString.h"
 
 #include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdGPDB.h"
+#include "naucrates/md/CMDIdRelStats.h"
+#include "naucrates/md/IMDColumn.h"
+#include "naucrates/md/IMDRelation.h"
 
 #include "naucrates/exception.h"
 
@@ -64,10 +70,14 @@ CMDProviderRelcache::PstrObject
 	)
 	const
 {
+	gpdb::MDTranslationStart();
 	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
+	gpdb::MDTranslationEnd();
 
 	GPOS_ASSERT(NULL != pimdobj);
 
+	TrackObject(pmda, pmdid);
+
 	CWStringDynamic *pstr = CDXLUtils::PstrSerializeMDObj(m_pmp, pimdobj, true /*fSerializeHeaders*/, false /*findent*/);
 
 	// cleanup DXL object
@@ -76,4 +86,62 @@ CMDProviderRelcache::PstrObject
 	return pstr;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::TrackObject
+//
+//	@doc:
+//		Register a metadata object loaded into the metadata cache, so that
+//		catalog changes can invalidate it without resetting the whole cache
+//
+//---------------------------------------------------------------------------
+void
+CMDProviderRelcache::TrackObject
+	(
+	CMDAccessor *pmda,
+	IMDId *pmdid
+	)
+{
+	gpdb::SMDCacheEntry entry;
+	AttrNumber attno = InvalidAttrNumber;
+
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+			entry.m_iKind = gpdb::MDCacheEntryObject;
+			entry.m_oid = CMDIdGPDB::PmdidConvert(pmdid)->OidObjectId();
+			entry.m_ulPos = 0;
+			break;
+
+		case IMDId::EmdidRelStats:
+		{
+			IMDId *pmdidRel = CMDIdRelStats::PmdidConvert(pmdid)->PmdidRel();
+			entry.m_iKind = gpdb::MDCacheEntryRelStats;
+			entry.m_oid = CMDIdGPDB::PmdidConvert(pmdidRel)->OidObjectId();
+			entry.m_ulPos = 0;
+			break;
+		}
+
+		case IMDId::EmdidColStats:
+		{
+			CMDIdColStats *pmdidColStats = CMDIdColStats::PmdidConvert(pmdid);
+			IMDId *pmdidRel = pmdidColStats->PmdidRel();
+			entry.m_iKind = gpdb::MDCacheEntryColStats;
+			entry.m_oid = CMDIdGPDB::PmdidConvert(pmdidRel)->OidObjectId();
+			entry.m_ulPos = pmdidColStats->UlPos();
+
+			// the relation has just been looked up to build the statistics
+			const IMDRelation *pmdrel = pmda->Pmdrel(pmdidRel);
+			attno = (AttrNumber) pmdrel->Pmdcol(entry.m_ulPos)->IAttno();
+			break;
+		}
+
+		default:
+			// casts and scalar comparisons are only dropped by a full reset
+			return;
+	}
+
+	gpdb::MDCacheTrackEntry(&entry, attno);
+}
+
 // EOF
@@ -358,27 +358,9 @@ CTranslatorRelcacheToDXL::PlIndexOidsPartTable
 		return NIL;
 	}
 
-	List *plOids = NIL;
-	
-	LogicalIndexes *plgidx = gpdb::Plgidx(rel->rd_id);
-
-	if (NULL == plgidx)
-	{
-		return NIL;
-	}
-	GPOS_ASSERT(NULL != plgidx);
-	GPOS_ASSERT(0 <= plgidx->numLogicalIndexes);
-	
-	const ULONG ulIndexes = (ULONG) plgidx->numLogicalIndexes;
-	for (ULONG ul = 0; ul < ulIndexes; ul++)
-	{
-		LogicalIndexInfo *pidxinfo = (plgidx->logicalIndexInfo)[ul];
-		plOids = gpdb::PlAppendOid(plOids, pidxinfo->logicalIndexOid);
-	}
-	
-	gpdb::GPDBFree(plgidx);
-	
-	return plOids;
+	// the part constraints of the indexes are only needed when the indexes
+	// themselves are translated
+	return gpdb::PlLogicalIndexOids(rel->rd_id);
 }
 
 //---------------------------------------------------------------------------
@@ -45,6 +45,7 @@
 #include "gpos/io/COstreamFile.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/memory/CCacheAccessor.h"
 #include "gpos/task/CWorkerPoolManager.h"
 #include "gpos/task/CAutoTaskProxy.h"
 #include "gpos/task/CTaskContext.h"
@@ -62,6 +63,7 @@
 #include "gpopt/engine/CCTEConfig.h"
 #include "gpopt/mdcache/CAutoMDAccessor.h"
 #include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/mdcache/CMDKey.h"
 #include "gpopt/minidump/CMiniDumperDXL.h"
 #include "gpopt/minidump/CMinidumperUtils.h"
 #include "gpopt/minidump/CSerializableStackTrace.h"
@@ -948,6 +950,84 @@ COptTasks::Pcm
 	return pcm;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::InvalidateMDCacheEntries
+//
+//	@doc:
+//		Drop the metadata cache entries invalidated by catalog changes since
+//		the last query, e.g. the relation and statistics of a table that has
+//		been loaded or analyzed, leaving the rest of the cache intact
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::InvalidateMDCacheEntries
+	(
+	IMemoryPool *pmp
+	)
+{
+	ULONG ulEntries = 0;
+	gpdb::SMDCacheEntry *pentries = gpdb::PMDCacheInvalidEntries(&ulEntries);
+
+	for (ULONG ul = 0; ul < ulEntries; ul++)
+	{
+		gpdb::SMDCacheEntry *pentry = &pentries[ul];
+		CMDIdGPDB *pmdidObj = GPOS_NEW(pmp) CMDIdGPDB(pentry->m_oid, 1 /* major */, 0 /* minor */);
+		IMDId *pmdid = pmdidObj;
+
+		if (gpdb::MDCacheEntryRelStats == pentry->m_iKind)
+		{
+			pmdid = GPOS_NEW(pmp) CMDIdRelStats(pmdidObj);
+		}
+		else if (gpdb::MDCacheEntryColStats == pentry->m_iKind)
+		{
+			pmdid = GPOS_NEW(pmp) CMDIdColStats(pmdidObj, pentry->m_ulPos);
+		}
+
+		{
+			CMDKey mdkey(pmdid);
+			CCacheAccessor<IMDCacheObject*, CMDKey*> cacc(CMDCache::Pcache());
+
+			// the entry may already have been evicted to stay within the quota
+			if (NULL != cacc.PtLookup(&mdkey))
+			{
+				cacc.MarkForDeletion();
+			}
+		}
+
+		pmdid->Release();
+	}
+
+	if (NULL != pentries)
+	{
+		gpdb::GPDBFree(pentries);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PrintMDTranslationStats
+//
+//	@doc:
+//		Log how many metadata objects were translated from the catalogs for
+//		the current query and how long that took, including the partition
+//		metadata built for partitioned tables
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::PrintMDTranslationStats()
+{
+	gpdb::SMDTranslationStats stats;
+	gpdb::MDTranslationGetStats(&stats);
+
+	elog(LOG, "[OPT]: Metadata translation: " INT64_FORMAT " objects in %.3f ms; "
+		 "partition metadata: " INT64_FORMAT " built in %.3f ms, " INT64_FORMAT " reused, "
+		 INT64_FORMAT " bytes cached",
+		 stats.m_lObjects, stats.m_dObjectsMs,
+		 stats.m_lPartMetadataBuilt, stats.m_dPartMetadataMs,
+		 stats.m_lPartMetadataReused, stats.m_lPartMetadataBytes);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PvOptimizeTask
@@ -975,7 +1055,8 @@ COptTasks::PvOptimizeTask
 	AUTO_MEM_POOL(amp);
 	IMemoryPool *pmp = amp.Pmp();
 
-	// Does the metadatacache need to be reset?
+	// Does the metadatacache need to be reset? Catalog changes that can
+	// be tracked to individual entries only invalidate those entries.
 	//
 	// On the first call, before the cache has been initialized, we
 	// don't care about the return value of FMDCacheNeedsReset(). But
@@ -994,9 +1075,15 @@ COptTasks::PvOptimizeTask
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() != optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		// drop the entries affected by catalog changes since the last query
+		InvalidateMDCacheEntries(pmp);
+
+		if (CMDCache::ULLGetCacheQuota() != optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
 
 
@@ -1080,6 +1167,11 @@ COptTasks::PvOptimizeTask
 									pocconf
 									);
 
+			if (optimizer_print_optimization_stats)
+			{
+				PrintMDTranslationStats();
+			}
+
 			if (poctx->m_fSerializePlanDXL)
 			{
 				// serialize DXL to xml
@@ -1548,7 +1640,8 @@ COptTasks::PvEvalExprFromDXLTask
 	CDXLNode *pdxlnResult = NULL;
 	BOOL fReleaseCache = false;
 
-	// Does the metadatacache need to be reset?
+	// Does the metadatacache need to be reset? Catalog changes that can
+	// be tracked to individual entries only invalidate those entries.
 	//
 	// On the first call, before the cache has been initialized, we
 	// don't care about the return value of FMDCacheNeedsReset(). But
@@ -1568,9 +1661,15 @@ COptTasks::PvEvalExprFromDXLTask
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() != optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		// drop the entries affected by catalog changes since the last query
+		InvalidateMDCacheEntries(pmp);
+
+		if (CMDCache::ULLGetCacheQuota() != optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
 
 	GPOS_TRY
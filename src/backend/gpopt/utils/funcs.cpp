@@ -21,6 +21,8 @@
 #include "gpopt/utils/COptTasks.h"
 #include "gpopt/mdcache/CMDCache.h"
 #include "utils/guc.h"
+#include "funcapi.h"
+#include "catalog/pg_type.h"
 
 #include "gpos/_api.h"
 #include "gpos/io/CFileReader.h"
@@ -72,6 +74,7 @@ PG_FUNCTION_INFO_V1(DumpQueryFromFileToDXLFile);
 PG_FUNCTION_INFO_V1(DisableXform);
 PG_FUNCTION_INFO_V1(EnableXform);
 PG_FUNCTION_INFO_V1(LibraryVersion);
+PG_FUNCTION_INFO_V1(MDCacheStats);
 
 PG_FUNCTION_INFO_V1(Optimize);
 
@@ -1066,6 +1069,52 @@ LibraryVersion()
 }
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		MDCacheStats
+//
+//	@doc:
+//		Returns the statistics of the metadata cache of this backend
+//
+//---------------------------------------------------------------------------
+extern "C" {
+Datum
+MDCacheStats(PG_FUNCTION_ARGS __attribute__((unused)))
+{
+	gpdb::SMDCacheStats stats;
+	gpdb::MDCacheGetStats(&stats);
+
+	// this must match the function's pg_proc entry
+	TupleDesc tupdesc = CreateTemplateTupleDesc(8, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "optimizations", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "entries_loaded", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "entries_invalidated", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "full_resets", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "invalidation_messages", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "tracked_entries", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "part_metadata_built", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "part_metadata_reused", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	Datum values[8];
+	bool isnull[8];
+
+	values[0] = Int64GetDatum(stats.m_lOptimizations);
+	values[1] = Int64GetDatum(stats.m_lLoads);
+	values[2] = Int64GetDatum(stats.m_lInvalidations);
+	values[3] = Int64GetDatum(stats.m_lResets);
+	values[4] = Int64GetDatum(stats.m_lInvalMessages);
+	values[5] = Int64GetDatum(stats.m_lTrackedEntries);
+	values[6] = Int64GetDatum(stats.m_lPartMetadataBuilt);
+	values[7] = Int64GetDatum(stats.m_lPartMetadataReused);
+	memset(isnull, false, sizeof(isnull));
+
+	HeapTuple tuple = heap_form_tuple(tupdesc, values, isnull);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+}
+
 extern "C" {
 StringInfo
 OptVersion()
@@ -3114,6 +3114,7 @@ _copyCopyStmt(CopyStmt *from)
 	COPY_STRING_FIELD(filename);
 	COPY_NODE_FIELD(options);
 	COPY_NODE_FIELD(sreh);
+	COPY_NODE_FIELD(dist_attrs);
 
 	return newnode;
 }
@@ -1147,7 +1147,7 @@ _equalCopyStmt(CopyStmt *a, CopyStmt *b)
 	COMPARE_STRING_FIELD(filename);
 	COMPARE_NODE_FIELD(options);
 	COMPARE_NODE_FIELD(sreh);
-
+	COMPARE_NODE_FIELD(dist_attrs);
 
 	return true;
 }
@@ -1434,6 +1434,7 @@ _readCopyStmt(void)
 	READ_NODE_FIELD(sreh);
 	READ_NODE_FIELD(partitions);
 	READ_NODE_FIELD(ao_segnos);
+	READ_NODE_FIELD(dist_attrs);
 
 	READ_DONE();
 
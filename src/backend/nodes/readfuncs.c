@@ -921,6 +921,27 @@ _readTruncateStmt(void)
 }
 #endif /* COMPILING_BINARY_FUNCS */
 
+#ifndef COMPILING_BINARY_FUNCS
+static CopyStmt *
+_readCopyStmt(void)
+{
+	READ_LOCALS(CopyStmt);
+
+	READ_NODE_FIELD(relation);
+	READ_NODE_FIELD(attlist);
+	READ_BOOL_FIELD(is_from);
+	READ_BOOL_FIELD(skip_ext_partition);
+	READ_STRING_FIELD(filename);
+	READ_NODE_FIELD(options);
+	READ_NODE_FIELD(sreh);
+	READ_NODE_FIELD(partitions);
+	READ_NODE_FIELD(ao_segnos);
+	READ_NODE_FIELD(dist_attrs);
+
+	READ_DONE();
+}
+#endif /* COMPILING_BINARY_FUNCS */
+
 #ifndef COMPILING_BINARY_FUNCS
 static AlterTableStmt *
 _readAlterTableStmt(void)
@@ -3054,6 +3075,7 @@ static ParseNodeInfo infoAr[] =
 	{"CONSTRAINT", (ReadFn)_readConstraint},
 	{"CONSTRAINTSSETSTMT", (ReadFn)_readConstraintsSetStmt},
 	{"CONVERTROWTYPEEXPR", (ReadFn)_readConvertRowtypeExpr},
+	{"COPYSTMT", (ReadFn)_readCopyStmt},
 	{"CREATECAST", (ReadFn)_readCreateCastStmt},
 	{"CREATECONVERSION", (ReadFn)_readCreateConversionStmt},
 	{"CREATEDBSTMT", (ReadFn)_readCreatedbStmt},
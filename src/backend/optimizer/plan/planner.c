@@ -43,6 +43,7 @@
 #include "parser/parse_oper.h"
 #include "parser/parsetree.h"
 #include "utils/lsyscache.h"
+#include "utils/optplancache.h"
 #include "utils/selfuncs.h"
 #include "utils/syscache.h"
 
@@ -183,6 +184,24 @@ optimize_query(Query *parse, ParamListInfo boundParams)
 	List	   *invalItems;
 	ListCell   *lc;
 	ListCell   *lp;
+	char	   *cacheKey;
+	int			cacheKeyLen = 0;
+	uint64		cacheGeneration = 0;
+	instr_time	starttime;
+	instr_time	duration;
+
+	/* Reuse the plan of an identical query, if it's in the plan cache */
+	cacheKey = OptPlanCacheBuildKey(parse, boundParams, &cacheKeyLen);
+	if (cacheKey != NULL)
+	{
+		result = OptPlanCacheLookup(cacheKey, cacheKeyLen, &cacheGeneration);
+		if (result != NULL)
+		{
+			pfree(cacheKey);
+			return result;
+		}
+		INSTR_TIME_SET_CURRENT(starttime);
+	}
 
 	/*
 	 * Initialize a dummy PlannerGlobal struct. ORCA doesn't use it, but
@@ -321,6 +340,15 @@ optimize_query(Query *parse, ParamListInfo boundParams)
 	result->relationOids = glob->relationOids;
 	result->invalItems = glob->invalItems;
 
+	if (cacheKey != NULL)
+	{
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, starttime);
+		OptPlanCacheInsert(cacheKey, cacheKeyLen, result,
+						   INSTR_TIME_GET_MILLISEC(duration), cacheGeneration);
+		pfree(cacheKey);
+	}
+
 	return result;
 }
 #endif
@@ -1580,6 +1608,16 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		 */
 		MemSet(&agg_counts, 0, sizeof(AggClauseCounts));
 
+		/*
+		 * If allowed, compute count(DISTINCT ...) from mergeable sketches
+		 * instead, so that it doesn't force a DQA plan.
+		 */
+		if (parse->hasAggs && root->config->gp_enable_approx_count_distinct)
+		{
+			approximate_count_distinct((Node *) tlist);
+			approximate_count_distinct(parse->havingQual);
+		}
+
 		if (parse->hasAggs)
 		{
 			count_agg_clauses((Node *) tlist, &agg_counts);
@@ -3334,6 +3334,10 @@ copy_opt_item:
 				{
 					$$ = makeDefElem("newline", (Node *)makeString($3));
 				}	
+			| ON SEGMENT
+				{
+					$$ = makeDefElem("on_segment", (Node *)makeInteger(TRUE));
+				}
 		;
 
 /* The following exist for backward compatibility */
@@ -82,7 +82,8 @@ static bool make_oper_cache_key(OprCacheKey *key, List *opname,
 								Oid ltypeId, Oid rtypeId);
 static Oid	find_oper_cache_entry(OprCacheKey *key);
 static void make_oper_cache_entry(OprCacheKey *key, Oid opr_oid);
-static void InvalidateOprCacheCallBack(Datum arg, int cacheid, ItemPointer tuplePtr);
+static void InvalidateOprCacheCallBack(Datum arg, int cacheid, ItemPointer tuplePtr,
+				  uint32 hashValue);
 
 static HeapTuple fetch_op_tup(Oid oproid, bool bValid);
 /*
@@ -1303,7 +1304,8 @@ make_oper_cache_entry(OprCacheKey *key, Oid opr_oid)
  * Callback for pg_operator and pg_cast inval events
  */
 static void
-InvalidateOprCacheCallBack(Datum arg, int cacheid, ItemPointer tuplePtr)
+InvalidateOprCacheCallBack(Datum arg, int cacheid, ItemPointer tuplePtr,
+				  uint32 hashValue)
 {
 	HASH_SEQ_STATUS status;
 	OprCacheEntry *hentry;
@@ -702,9 +702,13 @@ static DistributedTransactionTimeStamp Save_DtxStartTime = 0;
 extern struct timeval FileRepResync_GetEstimateResyncCompletionTime(void);
 extern int64 FileRepResync_GetBlocksSynchronized(void);
 extern int64 FileRepResync_GetTotalBlocksToSynchronize(void);
+extern int64 FileRepResync_GetBlocksSynchronizedPerSecond(void);
 extern int FileRepResync_GetCurFsobjCount(void);
 extern int FileRepResync_GetTotalFsobjCount(void);
 
+/* mirroring traffic info from cdbfilerepprimary.h */
+extern void FileRepPrimary_GetBytesSent(int64 *messageBytesSent, int64 *wireBytesSent);
+
 /* changetracking size info from cdbresynchronizechangetracking.h */
 extern int64 ChangeTracking_GetTotalSpaceUsedOnDisk(void);
 
@@ -3136,7 +3140,10 @@ processTransitionRequest_getMirrorStatus(void)
 
 	int64 resyncNumCompleted = FileRepResync_GetBlocksSynchronized();
 	int64 resyncTotalToComplete = FileRepResync_GetTotalBlocksToSynchronize();
+	int64 resyncNumCompletedPerSecond = FileRepResync_GetBlocksSynchronizedPerSecond();
 	int64 changeTrackingBytesUsed = ChangeTracking_GetTotalSpaceUsedOnDisk();
+	int64 mirrorBytesSent;
+	int64 mirrorWireBytesSent;
 
 	int fsobjCount = FileRepResync_GetCurFsobjCount();
 	int totalFsobjCount = FileRepResync_GetTotalFsobjCount();
@@ -3151,6 +3158,8 @@ processTransitionRequest_getMirrorStatus(void)
 	bool isIOSuspended = primaryMirrorIsIOSuspended();
 	char *databaseStatus;
 
+	FileRepPrimary_GetBytesSent(&mirrorBytesSent, &mirrorWireBytesSent);
+
 	/** Note: some of these status field results are used in python to determine whether there is a warning or not */
 	if ( pm_mode == PMModeMirrorSegment)
 	{
@@ -3193,7 +3202,10 @@ processTransitionRequest_getMirrorStatus(void)
 							  "changeTrackingBytesUsed:" INT64_FORMAT "\n"
 							  "estimatedCompletionTimeSecondsSinceEpoch:" INT64_FORMAT "\n"
 							  "totalResyncObjectCount:%d\n"
-							  "curResyncObjectCount:%d\n",
+							  "curResyncObjectCount:%d\n"
+							  "resyncNumCompletedPerSecond:" INT64_FORMAT "\n"
+							  "mirrorBytesSent:" INT64_FORMAT "\n"
+							  "mirrorWireBytesSent:" INT64_FORMAT "\n",
 			 getMirrorModeLabel(pm_mode), 
 			 getSegmentStateLabel(s_state), 
 			 getDataStateLabel(d_state),
@@ -3206,7 +3218,10 @@ processTransitionRequest_getMirrorStatus(void)
 			 changeTrackingBytesUsed,
 			 (int64)estimateResyncCompletionTime.tv_sec,
 			 totalFsobjCount,
-			 fsobjCount);
+			 fsobjCount,
+			 resyncNumCompletedPerSecond,
+			 mirrorBytesSent,
+			 mirrorWireBytesSent);
 
 	sendPrimaryMirrorTransitionResult(statusBuf);
 }
@@ -139,9 +139,10 @@ walrcv_connect(char *conninfo, XLogRecPtr startpoint)
 
 	/*
 	 * Start streaming from the point requested by startup process.
-	 * We want this connection to be synchronous.
+	 * We want this connection to be synchronous, and we can decompress
+	 * compressed WAL data messages.
 	 */
-	snprintf(cmd, sizeof(cmd), "START_REPLICATION %X/%X SYNC",
+	snprintf(cmd, sizeof(cmd), "START_REPLICATION %X/%X SYNC COMPRESS",
 			 startpoint.xlogid, startpoint.xrecoff);
 	res = libpqrcv_PQexec(cmd);
 	if (PQresultStatus(res) != PGRES_COPY_BOTH)
@@ -78,12 +78,13 @@ Node *replication_parse_result;
 %token K_WAL
 %token K_START_REPLICATION
 %token K_SYNC
+%token K_COMPRESS
 
 %type <node>	command
 %type <node>	base_backup start_replication identify_system
 %type <list>	base_backup_opt_list
 %type <defelt>	base_backup_opt
-%type <boolval> sync_opt
+%type <boolval> sync_opt compress_opt
 %%
 
 firstcmd: command opt_semicolon
@@ -161,16 +162,17 @@ base_backup_opt:
 			;
 
 /*
- * START_REPLICATION %X/%X
+ * START_REPLICATION %X/%X [SYNC] [COMPRESS]
  */
 start_replication:
-			K_START_REPLICATION RECPTR sync_opt
+			K_START_REPLICATION RECPTR sync_opt compress_opt
 				{
 					StartReplicationCmd *cmd;
 
 					cmd = makeNode(StartReplicationCmd);
 					cmd->startpoint = $2;
 					cmd->sync = $3;
+					cmd->compress = $4;
 
 					$$ = (Node *) cmd;
 				}
@@ -180,6 +182,11 @@ sync_opt:
 		K_SYNC				{ $$ = true; }
 		| /* EMPTY */		{ $$ = false; }
 		;
+
+compress_opt:
+		K_COMPRESS			{ $$ = true; }
+		| /* EMPTY */		{ $$ = false; }
+		;
 %%
 
 #include "repl_scanner.c"
@@ -42,10 +42,12 @@
 #include "replication/walprotocol.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
+#include "storage/bfz.h"
 #include "storage/ipc.h"
 #include "storage/pmsignal.h"
 #include "storage/procarray.h"
 #include "utils/guc.h"
+#include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/resowner.h"
 #include "utils/timestamp.h"
@@ -93,6 +95,9 @@ static struct
 
 static StandbyReplyMessage reply_message;
 
+/* Buffer for decompressing WAL data messages, allocated when first needed */
+static char *decompress_buffer = NULL;
+
 /*
  * About SIGTERM handling:
  *
@@ -573,6 +578,49 @@ XLogWalRcvProcessMsg(unsigned char type, char *buf, Size len)
 				XLogWalRcvWrite(buf, len, msghdr.dataStart);
 				break;
 			}
+		case 'z':				/* compressed WAL records */
+			{
+				WalCompressedDataMessageHeader zmsghdr;
+
+				if (len < sizeof(WalCompressedDataMessageHeader))
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid WAL message received from primary"),
+							 errSendAlert(true)));
+				/* memcpy is required here for alignment reasons */
+				memcpy(&zmsghdr, buf, sizeof(WalCompressedDataMessageHeader));
+
+				if (zmsghdr.rawLen > MAX_SEND_SIZE)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("invalid WAL message received from primary"),
+							 errSendAlert(true)));
+
+				if (decompress_buffer == NULL)
+					decompress_buffer = MemoryContextAlloc(TopMemoryContext,
+														   MAX_SEND_SIZE);
+
+				buf += sizeof(WalCompressedDataMessageHeader);
+				len -= sizeof(WalCompressedDataMessageHeader);
+
+				if (bfz_lz_decompress(buf, len, decompress_buffer,
+									  zmsghdr.rawLen) != (int) zmsghdr.rawLen)
+					ereport(ERROR,
+							(errcode(ERRCODE_PROTOCOL_VIOLATION),
+							 errmsg_internal("corrupt compressed WAL message received from primary"),
+							 errSendAlert(true)));
+
+				elogif(debug_walrepl_rcv, LOG,
+					   "walrcv msg metadata -- datastart %s, buflen %d, rawlen %u",
+					    XLogLocationToString(&(zmsghdr.hdr.dataStart)), (int) len,
+					    zmsghdr.rawLen);
+
+				ProcessWalSndrMessage(zmsghdr.hdr.walEnd, zmsghdr.hdr.sendTime);
+
+				XLogWalRcvWrite(decompress_buffer, zmsghdr.rawLen,
+								zmsghdr.hdr.dataStart);
+				break;
+			}
 		case 'k':				/* Keepalive */
 			{
 				PrimaryKeepaliveMessage keepalive;
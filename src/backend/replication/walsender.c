@@ -56,6 +56,7 @@
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
 #include "replication/walsender_private.h"
+#include "storage/bfz.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/pmsignal.h"
@@ -84,6 +85,7 @@ int			max_wal_senders = 1;	/* the maximum number of concurrent walsenders */
 int			replication_timeout = 60 * 1000;	/* maximum time to send one
 												 * WAL data message */
 int			repl_catchup_within_range = XLogSegsPerFile;
+bool		wal_sender_compression = false;	/* compress WAL data messages */
 
 static bool replication_started = false; 	/* Started streaming yet? */
 
@@ -104,6 +106,13 @@ static uint32 sendOff = 0;
  */
 static XLogRecPtr sentPtr = {0, 0};
 
+/*
+ * Buffer for compressed WAL data messages. Only allocated if the client
+ * asked for them with START_REPLICATION ... COMPRESS.
+ */
+static bool client_accepts_compression = false;
+static char *compressed_message = NULL;
+
 /*
  * Buffer for processing reply messages.
  */
@@ -287,6 +296,7 @@ StartReplication(StartReplicationCmd *cmd)
 	 */
 	WalSndSetState(WALSNDSTATE_CATCHUP);
 	WalSndSetSync(cmd->sync);
+	client_accepts_compression = cmd->compress;
 
 	/* Send a CopyBothResponse message, and start streaming */
 	pq_beginmessage(&buf, 'W');
@@ -542,6 +552,9 @@ WalSndLoop(void)
 	 * enough for maximum-sized messages.
 	 */
 	output_message = palloc(1 + sizeof(WalDataMessageHeader) + MAX_SEND_SIZE);
+	if (client_accepts_compression)
+		compressed_message = palloc(1 + sizeof(WalCompressedDataMessageHeader) +
+									LZ_COMPRESS_BOUND(MAX_SEND_SIZE));
 
 	/*
 	 * Allocate buffer that will be used for processing reply messages.  As
@@ -760,6 +773,8 @@ InitWalSenderSlot(void)
 			walsnd->synchronous = false;
 			walsnd->xlogCleanUpTo = InvalidXLogRecPtr;
 			walsnd->caughtup_within_range = false;
+			walsnd->sentBytes = 0;
+			walsnd->sentWireBytes = 0;
 			SpinLockRelease(&walsnd->mutex);
 			/* don't need the lock anymore */
 			OwnLatch((Latch *) &walsnd->latch);
@@ -966,6 +981,8 @@ XLogSend(char *msgbuf, bool *caughtup, bool *caughtup_within_range)
 	XLogRecPtr	startptr;
 	XLogRecPtr	endptr;
 	Size		nbytes;
+	Size		wirebytes;
+	int			zlen;
 	WalDataMessageHeader msghdr;
 
 	SendRqstPtr = GetFlushRecPtr();
@@ -1044,6 +1061,16 @@ XLogSend(char *msgbuf, bool *caughtup, bool *caughtup_within_range)
 	 */
 	XLogRead(msgbuf + 1 + sizeof(WalDataMessageHeader), startptr, nbytes);
 
+	/*
+	 * Compress the slice if asked to, and if the client said it can
+	 * decompress it. It is sent as is if it does not get smaller.
+	 */
+	zlen = -1;
+	if (wal_sender_compression && client_accepts_compression && nbytes > 0)
+		zlen = bfz_lz_compress(msgbuf + 1 + sizeof(WalDataMessageHeader), nbytes,
+							   compressed_message + 1 + sizeof(WalCompressedDataMessageHeader),
+							   LZ_COMPRESS_BOUND(MAX_SEND_SIZE));
+
 	/*
 	 * We fill the message header last so that the send timestamp is taken as
 	 * late as possible.
@@ -1052,9 +1079,27 @@ XLogSend(char *msgbuf, bool *caughtup, bool *caughtup_within_range)
 	msghdr.walEnd = SendRqstPtr;
 	msghdr.sendTime = GetCurrentTimestamp();
 
-	memcpy(msgbuf + 1, &msghdr, sizeof(WalDataMessageHeader));
+	if (zlen >= 0 && (Size) zlen < nbytes)
+	{
+		WalCompressedDataMessageHeader zmsghdr;
+
+		zmsghdr.hdr = msghdr;
+		zmsghdr.rawLen = nbytes;
+
+		compressed_message[0] = 'z';
+		memcpy(compressed_message + 1, &zmsghdr, sizeof(WalCompressedDataMessageHeader));
 
-	pq_putmessage_noblock('d', msgbuf, 1 + sizeof(WalDataMessageHeader) + nbytes);
+		pq_putmessage_noblock('d', compressed_message,
+							  1 + sizeof(WalCompressedDataMessageHeader) + zlen);
+		wirebytes = zlen;
+	}
+	else
+	{
+		memcpy(msgbuf + 1, &msghdr, sizeof(WalDataMessageHeader));
+
+		pq_putmessage_noblock('d', msgbuf, 1 + sizeof(WalDataMessageHeader) + nbytes);
+		wirebytes = nbytes;
+	}
 
 	sentPtr = endptr;
 
@@ -1069,6 +1114,8 @@ XLogSend(char *msgbuf, bool *caughtup, bool *caughtup_within_range)
 
 		SpinLockAcquire(&walsnd->mutex);
 		walsnd->sentPtr = sentPtr;
+		walsnd->sentBytes += nbytes;
+		walsnd->sentWireBytes += wirebytes;
 		SpinLockRelease(&walsnd->mutex);
 	}
 
@@ -1467,7 +1514,7 @@ WalSndIsCatchupWithinRange(XLogRecPtr currRecPtr, XLogRecPtr catchupRecPtr)
 Datum
 pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_SENDERS_COLS	8
+#define PG_STAT_GET_WAL_SENDERS_COLS	11
 	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
 	TupleDesc	tupdesc;
 	Tuplestorestate *tupstore;
@@ -1547,6 +1594,8 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		XLogRecPtr	write;
 		XLogRecPtr	flush;
 		XLogRecPtr	apply;
+		int64		sentBytes;
+		int64		sentWireBytes;
 		WalSndState state;
 		Datum		values[PG_STAT_GET_WAL_SENDERS_COLS];
 		bool		nulls[PG_STAT_GET_WAL_SENDERS_COLS];
@@ -1561,6 +1610,8 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		write = walsnd->write;
 		flush = walsnd->flush;
 		apply = walsnd->apply;
+		sentBytes = walsnd->sentBytes;
+		sentWireBytes = walsnd->sentWireBytes;
 		SpinLockRelease(&walsnd->mutex);
 
 		memset(nulls, 0, sizeof(nulls));
@@ -1612,6 +1663,16 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 				values[7] = CStringGetTextDatum("sync");
 			else
 				values[7] = CStringGetTextDatum("potential");
+
+			values[8] = Int64GetDatum(sentBytes);
+			values[9] = Int64GetDatum(sentWireBytes);
+
+			/* How far replay on the standby is behind what has been sent */
+			if (apply.xlogid == 0 && apply.xrecoff == 0)
+				nulls[10] = true;
+			else
+				values[10] = Int64GetDatum(XLogRecPtrToBytePos(sentPtr) -
+										   XLogRecPtrToBytePos(apply));
 		}
 
 		tuple = heap_form_tuple(tupdesc, values, nulls);
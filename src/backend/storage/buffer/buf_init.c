@@ -139,17 +139,13 @@ InitBufferPool(void)
 			buf->buf_id = i;
 
 			/*
-			 * Initially link all the buffers together as unused. Subsequent
-			 * management of this list is done by freelist.c.
+			 * freelist.c puts all the buffers on its free list, as unused.
 			 */
-			buf->freeNext = i + 1;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
 
 			buf->io_in_progress_lock = LWLockAssign();
 			buf->content_lock = LWLockAssign();
 		}
-
-		/* Correct last entry of linked list */
-		BufferDescriptors[NBuffers - 1].freeNext = FREENEXT_END_OF_LIST;
 	}
 
     ProtectMemoryPoolBuffers();
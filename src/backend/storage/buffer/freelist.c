@@ -15,17 +15,25 @@
  */
 #include "postgres.h"
 
+#include "miscadmin.h"
+#include "port/atomics.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/spin.h"
 
 
 /*
- * The shared freelist control information.
+ * The free list is split into partitions, each with its own spinlock, so
+ * that backends allocating buffers at the same time don't serialize on it.
+ * A buffer always goes to the partition given by its buffer id; a backend
+ * looking for a free buffer starts with a partition of its own, and moves
+ * on to the others if that one is empty.
  */
+#define NUM_FREELIST_PARTITIONS		8
+
 typedef struct
 {
-	/* Clock sweep hand: index of next buffer to consider grabbing */
-	int			nextVictimBuffer;
+	slock_t		mutex;			/* protects the list */
 
 	int			firstFreeBuffer;	/* Head of list of unused buffers */
 	int			lastFreeBuffer; /* Tail of list of unused buffers */
@@ -34,15 +42,46 @@ typedef struct
 	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
 	 * when the list is empty)
 	 */
+} BufferFreelist;
+
+/* Keep each partition in a cache line of its own */
+#define FREELIST_PADDED_SIZE	64
+
+typedef union BufferFreelistPadded
+{
+	BufferFreelist freelist;
+	char		pad[FREELIST_PADDED_SIZE];
+} BufferFreelistPadded;
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/*
+	 * Clock sweep hand: index of next buffer to consider grabbing, modulo
+	 * NBuffers.  It is advanced with an atomic add and only ever grows, until
+	 * the backend that moves it past NBuffers wraps it around under
+	 * clock_lock.
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	/* Protects the wraparound of nextVictimBuffer, and completePasses */
+	slock_t		clock_lock;
 
 	/*
 	 * Statistics.	These counters should be wide enough that they can't
 	 * overflow during a single bgwriter cycle.
 	 */
 	uint32		completePasses; /* Complete cycles of the clock sweep */
-	uint32		numBufferAllocs;	/* Buffers allocated since last reset */
+	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
+
+	BufferFreelistPadded freelists[NUM_FREELIST_PARTITIONS];
 } BufferStrategyControl;
 
+#define BufferFreelistPartition(buf_id) \
+	(&StrategyControl->freelists[(buf_id) % NUM_FREELIST_PARTITIONS].freelist)
+
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
@@ -86,6 +125,51 @@ static void AddBufferToRing(BufferAccessStrategy strategy,
 				volatile BufferDesc *buf);
 
 
+/*
+ * ClockSweepTick -- advance the clock hand, and return the buffer it was on
+ */
+static inline int
+ClockSweepTick(void)
+{
+	uint32		victim;
+
+	victim = pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+
+	if (victim >= (uint32) NBuffers)
+	{
+		uint32		expected = victim + 1;
+
+		victim = victim % NBuffers;
+
+		/*
+		 * If we are the one who went past the end of the buffers, wrap the
+		 * hand around, and count the pass.  Others may advance the hand
+		 * meanwhile, so retry until the hand is wrapped from where it is.
+		 * Doing both under clock_lock lets StrategySyncStart read them
+		 * consistently.
+		 */
+		if (victim == 0)
+		{
+			volatile BufferStrategyControl *control = StrategyControl;
+			bool		wrapped = false;
+
+			while (!wrapped)
+			{
+				SpinLockAcquire(&control->clock_lock);
+				wrapped = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+														 &expected,
+														 expected % NBuffers);
+				if (wrapped)
+					control->completePasses++;
+				SpinLockRelease(&control->clock_lock);
+			}
+		}
+	}
+
+	return (int) victim;
+}
+
+
 /*
  * StrategyGetBuffer
  *
@@ -96,87 +180,96 @@ static void AddBufferToRing(BufferAccessStrategy strategy,
  *	strategy is a BufferAccessStrategy object, or NULL for default strategy.
  *
  *	To ensure that no one else can pin the buffer before we do, we must
- *	return the buffer with the buffer header spinlock still held.  If
- *	*lock_held is set on exit, we have returned with the BufFreelistLock
- *	still held, as well; the caller must release that lock once the spinlock
- *	is dropped.  We do it that way because releasing the BufFreelistLock
- *	might awaken other processes, and it would be bad to do the associated
- *	kernel calls while holding the buffer header spinlock.
+ *	return the buffer with the buffer header spinlock still held.  No
+ *	system-wide lock is held: the free list partitions are protected by
+ *	spinlocks that are released before the buffer header spinlock is taken,
+ *	and the clock hand is advanced atomically.
  */
 volatile BufferDesc *
-StrategyGetBuffer(BufferAccessStrategy strategy, bool *lock_held)
+StrategyGetBuffer(BufferAccessStrategy strategy)
 {
 	volatile BufferDesc *buf;
 	int			trycounter;
+	int			start;
+	int			i;
 
 	/*
 	 * If given a strategy object, see whether it can select a buffer. We
-	 * assume strategy objects don't need the BufFreelistLock.
+	 * assume strategy objects don't need any shared state.
 	 */
 	if (strategy != NULL)
 	{
 		buf = GetBufferFromRing(strategy);
 		if (buf != NULL)
-		{
-			*lock_held = false;
 			return buf;
-		}
 	}
 
-	/* Nope, so lock the freelist */
-	*lock_held = true;
-	LWLockAcquire(BufFreelistLock, LW_EXCLUSIVE);
-
 	/*
 	 * We count buffer allocation requests so that the bgwriter can estimate
 	 * the rate of buffer consumption.	Note that buffers recycled by a
 	 * strategy object are intentionally not counted here.
 	 */
-	StrategyControl->numBufferAllocs++;
+	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
 
 	/*
-	 * Try to get a buffer from the freelist.  Note that the freeNext fields
-	 * are considered to be protected by the BufFreelistLock not the
-	 * individual buffer spinlocks, so it's OK to manipulate them without
-	 * holding the spinlock.
+	 * Try to get a buffer from the freelist, starting with our own
+	 * partition.  Note that the freeNext fields are considered to be
+	 * protected by the partition's spinlock not the individual buffer
+	 * spinlocks, so it's OK to manipulate them without holding the buffer
+	 * spinlock.
 	 */
-	while (StrategyControl->firstFreeBuffer >= 0)
+	start = MyProcPid % NUM_FREELIST_PARTITIONS;
+	for (i = 0; i < NUM_FREELIST_PARTITIONS; i++)
 	{
-		buf = &BufferDescriptors[StrategyControl->firstFreeBuffer];
-		Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
-
-		/* Unconditionally remove buffer from freelist */
-		StrategyControl->firstFreeBuffer = buf->freeNext;
-		buf->freeNext = FREENEXT_NOT_IN_LIST;
+		volatile BufferFreelist *freelist =
+			&StrategyControl->freelists[(start + i) % NUM_FREELIST_PARTITIONS].freelist;
 
 		/*
-		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
-		 * it; discard it and retry.  (This can only happen if VACUUM put a
-		 * valid buffer in the freelist and then someone else used it before
-		 * we got to it.  It's probably impossible altogether as of 8.3, but
-		 * we'd better check anyway.)
+		 * Once all buffers have been used, the lists stay empty, so check
+		 * without the spinlock first.  If we miss a buffer just put on the
+		 * list, the clock sweep will find it.
 		 */
-		LockBufHdr(buf);
-		if (buf->refcount == 0 && buf->usage_count == 0)
+		if (freelist->firstFreeBuffer < 0)
+			continue;
+
+		SpinLockAcquire(&freelist->mutex);
+		while (freelist->firstFreeBuffer >= 0)
 		{
-			if (strategy != NULL)
-				AddBufferToRing(strategy, buf);
-			return buf;
+			buf = &BufferDescriptors[freelist->firstFreeBuffer];
+			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
+
+			/* Unconditionally remove buffer from freelist */
+			freelist->firstFreeBuffer = buf->freeNext;
+			buf->freeNext = FREENEXT_NOT_IN_LIST;
+
+			SpinLockRelease(&freelist->mutex);
+
+			/*
+			 * If the buffer is pinned or has a nonzero usage_count, we cannot
+			 * use it; discard it and retry.  (This can only happen if VACUUM
+			 * put a valid buffer in the freelist and then someone else used
+			 * it before we got to it.  It's probably impossible altogether as
+			 * of 8.3, but we'd better check anyway.)
+			 */
+			LockBufHdr(buf);
+			if (buf->refcount == 0 && buf->usage_count == 0)
+			{
+				if (strategy != NULL)
+					AddBufferToRing(strategy, buf);
+				return buf;
+			}
+			UnlockBufHdr(buf);
+
+			SpinLockAcquire(&freelist->mutex);
 		}
-		UnlockBufHdr(buf);
+		SpinLockRelease(&freelist->mutex);
 	}
 
 	/* Nothing on the freelist, so run the "clock sweep" algorithm */
 	trycounter = NBuffers;
 	for (;;)
 	{
-		buf = &BufferDescriptors[StrategyControl->nextVictimBuffer];
-
-		if (++StrategyControl->nextVictimBuffer >= NBuffers)
-		{
-			StrategyControl->nextVictimBuffer = 0;
-			StrategyControl->completePasses++;
-		}
+		buf = &BufferDescriptors[ClockSweepTick()];
 
 		/*
 		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
@@ -229,21 +322,24 @@ StrategyGetBuffer(BufferAccessStrategy strategy, bool *lock_held)
 void
 StrategyFreeBuffer(volatile BufferDesc *buf)
 {
-	LWLockAcquire(BufFreelistLock, LW_EXCLUSIVE);
+	volatile BufferFreelist *freelist = BufferFreelistPartition(buf->buf_id);
+
+	SpinLockAcquire(&freelist->mutex);
 
 	/*
 	 * It is possible that we are told to put something in the freelist that
-	 * is already in it; don't screw up the list if so.
+	 * is already in it; don't screw up the list if so.  A buffer only ever
+	 * goes to its own partition, so the partition's lock covers this check.
 	 */
 	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
 	{
-		buf->freeNext = StrategyControl->firstFreeBuffer;
+		buf->freeNext = freelist->firstFreeBuffer;
 		if (buf->freeNext < 0)
-			StrategyControl->lastFreeBuffer = buf->buf_id;
-		StrategyControl->firstFreeBuffer = buf->buf_id;
+			freelist->lastFreeBuffer = buf->buf_id;
+		freelist->firstFreeBuffer = buf->buf_id;
 	}
 
-	LWLockRelease(BufFreelistLock);
+	SpinLockRelease(&freelist->mutex);
 }
 
 /*
@@ -260,18 +356,24 @@ StrategyFreeBuffer(volatile BufferDesc *buf)
 int
 StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 {
+	volatile BufferStrategyControl *control = StrategyControl;
+	uint32		nextVictimBuffer;
 	int			result;
 
-	LWLockAcquire(BufFreelistLock, LW_EXCLUSIVE);
-	result = StrategyControl->nextVictimBuffer;
+	/*
+	 * The hand may be past NBuffers, not wrapped yet; the passes it has made
+	 * beyond completePasses count too.
+	 */
+	SpinLockAcquire(&control->clock_lock);
+	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
+	result = nextVictimBuffer % NBuffers;
 	if (complete_passes)
-		*complete_passes = StrategyControl->completePasses;
+		*complete_passes = control->completePasses + nextVictimBuffer / NBuffers;
+	SpinLockRelease(&control->clock_lock);
+
 	if (num_buf_alloc)
-	{
-		*num_buf_alloc = StrategyControl->numBufferAllocs;
-		StrategyControl->numBufferAllocs = 0;
-	}
-	LWLockRelease(BufFreelistLock);
+		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
+
 	return result;
 }
 
@@ -302,8 +404,8 @@ StrategyShmemSize(void)
  * StrategyInitialize -- initialize the buffer cache replacement
  *		strategy.
  *
- * Assumes: All of the buffers are already built into a linked list.
- *		Only called by postmaster and only during initialization.
+ * Assumes: All of the buffer headers are already initialized, and in no
+ *		list.  Only called by postmaster and only during initialization.
  */
 void
 StrategyInitialize(bool init)
@@ -332,24 +434,46 @@ StrategyInitialize(bool init)
 
 	if (!found)
 	{
+		int			i;
+
 		/*
 		 * Only done once, usually in postmaster
 		 */
 		Assert(init);
 
 		/*
-		 * Grab the whole linked list of free buffers for our strategy. We
-		 * assume it was previously set up by InitBufferPool().
+		 * Put all the buffers on the free list partitions, in buffer order
+		 * within each.
 		 */
-		StrategyControl->firstFreeBuffer = 0;
-		StrategyControl->lastFreeBuffer = NBuffers - 1;
+		for (i = 0; i < NUM_FREELIST_PARTITIONS; i++)
+		{
+			BufferFreelist *freelist = &StrategyControl->freelists[i].freelist;
+
+			SpinLockInit(&freelist->mutex);
+			freelist->firstFreeBuffer = FREENEXT_END_OF_LIST;
+			freelist->lastFreeBuffer = FREENEXT_END_OF_LIST;
+		}
+
+		for (i = 0; i < NBuffers; i++)
+		{
+			BufferFreelist *freelist = BufferFreelistPartition(i);
+
+			Assert(BufferDescriptors[i].freeNext == FREENEXT_NOT_IN_LIST);
+			if (freelist->firstFreeBuffer < 0)
+				freelist->firstFreeBuffer = i;
+			else
+				BufferDescriptors[freelist->lastFreeBuffer].freeNext = i;
+			BufferDescriptors[i].freeNext = FREENEXT_END_OF_LIST;
+			freelist->lastFreeBuffer = i;
+		}
 
 		/* Initialize the clock sweep pointer */
-		StrategyControl->nextVictimBuffer = 0;
+		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+		SpinLockInit(&StrategyControl->clock_lock);
 
 		/* Clear statistics */
 		StrategyControl->completePasses = 0;
-		StrategyControl->numBufferAllocs = 0;
+		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
 	}
 	else
 		Assert(!init);
@@ -1,5 +1,6 @@
 /* bfz.c */
 #include "postgres.h"
+#include <pthread.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -13,6 +14,7 @@
 #include "utils/workfile_mgr.h"
 #include "storage/fd.h"
 #include "postmaster/primary_mirror_mode.h"
+#include "cdb/cdbgang.h"
 
 typedef pg_crc32 BFZ_CHECKSUM_TYPE;
 
@@ -36,9 +38,45 @@ static const struct{
 {
     {{"none", "false", "no", "off", "0", 0}, bfz_nothing_init},
     {{"zlib", 0}, bfz_zlib_init},
+    {{"lz", 0}, bfz_lz_init},
     {{0}}
 };
 
+/*
+ * Write-behind.
+ *
+ * When gp_workfile_write_behind is on, a full block is copied aside and
+ * handed to a helper thread, which compresses and writes it while the
+ * operator fills the next one. Each file has at most one block in flight:
+ * writing the next block, ending the append and closing the file all wait
+ * for it first. Blocks therefore reach the file in order, and the extra
+ * memory is one block per file being appended to, which is freed by
+ * bfz_append_end. A failed write is reported by the next call that waits.
+ *
+ * The thread is started on first use, and serves all the files of the
+ * backend. It only calls the try_write_ex of the compression algorithm,
+ * so algorithms that cannot do without palloc or elog, like zlib, are
+ * always written synchronously.
+ */
+typedef struct bfz_writebehind
+{
+	struct bfz_writebehind *next;	/* in the queue of the thread */
+	bfz_t	   *bfz;
+	int			size;			/* bytes in buffer */
+	bool		busy;			/* queued or being written */
+	int			error;			/* errno of a failed write, or 0 */
+	char		buffer[BFZ_BUFFER_SIZE];
+} bfz_writebehind;
+
+static pthread_mutex_t writebehind_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writebehind_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t writebehind_written = PTHREAD_COND_INITIALIZER;
+static bfz_writebehind *writebehind_head = NULL;
+static bfz_writebehind *writebehind_tail = NULL;
+static pthread_t writebehind_thread;
+static bool writebehind_started = false;
+static bool writebehind_failed = false;
+
 static bfz_t *bfz_create_internal(bfz_t * bfz_handle, const char *fileName, bool open_existing, bool delOnClose, int compress);
 
 int
@@ -106,6 +144,179 @@ compute_checksum(const char *buffer, uint32 size)
 	return crc;
 }
 
+static void *
+bfz_writebehind_main(void *arg)
+{
+	gp_set_thread_sigmasks();
+
+	pthread_mutex_lock(&writebehind_mutex);
+	for (;;)
+	{
+		bfz_writebehind *wb;
+		int			error = 0;
+
+		while (writebehind_head == NULL)
+			pthread_cond_wait(&writebehind_queued, &writebehind_mutex);
+
+		wb = writebehind_head;
+		writebehind_head = wb->next;
+		if (writebehind_head == NULL)
+			writebehind_tail = NULL;
+		pthread_mutex_unlock(&writebehind_mutex);
+
+		if (!wb->bfz->freeable_stuff->try_write_ex(wb->bfz, wb->buffer, wb->size))
+			error = errno != 0 ? errno : EIO;
+
+		pthread_mutex_lock(&writebehind_mutex);
+		wb->error = error;
+		wb->busy = false;
+		pthread_cond_broadcast(&writebehind_written);
+	}
+
+	return NULL;
+}
+
+/*
+ * Starts the write-behind thread if it is not running. Returns false if it
+ * cannot be started, in which case blocks are written synchronously.
+ */
+static bool
+bfz_writebehind_start(void)
+{
+	int			err;
+
+	if (writebehind_started)
+		return true;
+	if (writebehind_failed)
+		return false;
+
+	err = gp_pthread_create(&writebehind_thread, bfz_writebehind_main, NULL,
+							"bfz_writebehind_start");
+	if (err != 0)
+	{
+		elog(LOG, "could not start workfile write-behind thread, error %d; "
+			 "writing workfiles synchronously", err);
+		writebehind_failed = true;
+		return false;
+	}
+
+	writebehind_started = true;
+	return true;
+}
+
+/*
+ * Waits until the block in flight for this file, if any, has been written.
+ *
+ * This is also called when closing the file at transaction abort, hence it
+ * must not throw.
+ */
+static void
+bfz_writebehind_wait(bfz_t *bfz)
+{
+	bfz_writebehind *wb = bfz->writebehind;
+
+	if (wb == NULL)
+		return;
+
+	pthread_mutex_lock(&writebehind_mutex);
+	while (wb->busy)
+		pthread_cond_wait(&writebehind_written, &writebehind_mutex);
+	pthread_mutex_unlock(&writebehind_mutex);
+}
+
+/*
+ * Waits for the block in flight for this file, and reports a failure to
+ * write it like write_bfz_buffer does.
+ */
+static void
+bfz_writebehind_finish(bfz_t *bfz)
+{
+	bfz_writebehind *wb = bfz->writebehind;
+
+	if (wb == NULL)
+		return;
+
+	bfz_writebehind_wait(bfz);
+
+	if (wb->error != 0)
+	{
+		errno = wb->error;
+		wb->error = 0;
+
+		elog(gp_workfile_caching_loglevel, "BFZ write-behind failed, presumably because of OODS, seting flag");
+		WorkfileDiskspace_SetFull(true /* isFull */);
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				errmsg("could not write to temporary file: %m")));
+	}
+}
+
+/*
+ * Hands a block over to the write-behind thread. Returns false if it must
+ * be written synchronously instead.
+ */
+static bool
+bfz_writebehind_submit(bfz_t *bfz, const char *buffer, int size)
+{
+	bfz_writebehind *wb = bfz->writebehind;
+
+	if (wb == NULL)
+		return false;
+
+	bfz_writebehind_finish(bfz);
+
+	if (!bfz_writebehind_start())
+		return false;
+
+	memcpy(wb->buffer, buffer, size);
+	wb->size = size;
+	wb->bfz = bfz;
+	wb->next = NULL;
+	wb->busy = true;
+
+	pthread_mutex_lock(&writebehind_mutex);
+	if (writebehind_tail != NULL)
+		writebehind_tail->next = wb;
+	else
+		writebehind_head = wb;
+	writebehind_tail = wb;
+	pthread_cond_signal(&writebehind_queued);
+	pthread_mutex_unlock(&writebehind_mutex);
+
+	return true;
+}
+
+/*
+ * Frees the write-behind block of a file, once nothing is in flight.
+ */
+static void
+bfz_writebehind_free(bfz_t *bfz)
+{
+	if (bfz->writebehind == NULL)
+		return;
+
+	bfz_writebehind_wait(bfz);
+	pfree(bfz->writebehind);
+	bfz->writebehind = NULL;
+}
+
+/*
+ * bfz_append_buffer_size
+ *   Memory used by the buffers of a bfz file being appended to, with the
+ *   current settings. Operators that keep many spill files open count this
+ *   against their memory quota.
+ */
+Size
+bfz_append_buffer_size(void)
+{
+	Size		size = sizeof(struct bfz_freeable_stuff);
+
+	if (gp_workfile_write_behind)
+		size += sizeof(bfz_writebehind);
+
+	return size;
+}
+
 /*
  * Write out a bfz buffer.
  *
@@ -142,6 +353,12 @@ write_bfz_buffer(bfz_t *bfz, bool isLast)
 		fs->buffer_pointer += sizeof(BFZ_CHECKSUM_TYPE);
 	}
 	
+	if (bfz_writebehind_submit(bfz, fs->buffer, fs->buffer_pointer - fs->buffer))
+	{
+		bfz->numBlocks ++;
+		return;
+	}
+
 	PG_TRY();
 	{
 		fs->write_ex(bfz, fs->buffer, fs->buffer_pointer - fs->buffer);
@@ -399,6 +616,9 @@ bfz_create_internal(bfz_t *bfz_handle, const char *fileName, bool open_existing,
 	bfz_handle->numBlocks = bfz_handle->blockNo = bfz_handle->chosenBlockNo = 0;
 	
 	fs = bfz_handle->freeable_stuff;
+
+	if (!open_existing && gp_workfile_write_behind && fs->try_write_ex != NULL)
+		bfz_handle->writebehind = palloc0(sizeof(bfz_writebehind));
 	fs->tot_bytes = 0;
 
 	if (open_existing)
@@ -440,6 +660,9 @@ bfz_close(bfz_t * thiz, bool unreg, bool error_on_unlink)
 	if (unreg)
 		UnregisterXactCallbackOnce(bfz_close_callback, thiz);
 
+	/* The thread may still be writing to the file */
+	bfz_writebehind_free(thiz);
+
 	if (thiz->freeable_stuff)
 	{
 		thiz->freeable_stuff->close_ex(thiz);
@@ -492,8 +715,11 @@ bfz_append_end(bfz_t * thiz)
 	else
 	{
 		write_bfz_buffer(thiz, true);
+		bfz_writebehind_finish(thiz);
 	}
 
+	bfz_writebehind_free(thiz);
+
 	tot_bytes = fs->tot_bytes;
 
 
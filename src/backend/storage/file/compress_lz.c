@@ -0,0 +1,405 @@
+/* compress_lz.c */
+#include "postgres.h"
+
+#include <unistd.h>
+#include "storage/bfz.h"
+#include "storage/fd.h"
+
+/*
+ * This file implements bfz compression algorithm "lz", a fast LZ77 block
+ * compressor in the style of LZ4. It trades compression ratio for speed,
+ * which is what spill files want: a workfile is written once and read back
+ * once, soon after.
+ *
+ * Every buffer handed to write_ex is compressed independently, and stored
+ * behind a header giving its raw and stored length. A buffer that does not
+ * compress is stored as is. read_ex returns one buffer per call, so block
+ * boundaries, and the checksums bfz puts at the end of each block, are
+ * preserved.
+ *
+ * A compressed block is a sequence of
+ *
+ *   token, [literal length], literals, offset, [match length]
+ *
+ * The high nibble of the token is the number of literals and the low nibble
+ * the match length less LZ_MIN_MATCH; a nibble of 15 is continued by bytes
+ * of 255 and a final byte below 255. The offset is two bytes, little endian.
+ * The last sequence has literals only.
+ *
+ * Compression and decompression use no memory but what they are given and
+ * the stack, and never elog, so writes can be done by the write-behind
+ * thread (see bfz.c).
+ */
+
+#define LZ_MIN_MATCH		4
+#define LZ_MAX_OFFSET		65535
+#define LZ_HASH_BITS		12
+#define LZ_HASH_SIZE		(1 << LZ_HASH_BITS)
+
+/* Header stored in front of every block */
+typedef struct bfz_lz_header
+{
+	int32		rawlen;			/* length of the block as written */
+	int32		storedlen;		/* length on disk; rawlen if not compressed */
+} bfz_lz_header;
+
+struct bfz_lz_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+
+	/* A block as it is on disk, header included */
+	char		zbuffer[sizeof(bfz_lz_header) + LZ_COMPRESS_BOUND(BFZ_BUFFER_SIZE)];
+};
+
+static inline uint32
+lz_read32(const unsigned char *p)
+{
+	uint32		v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32
+lz_hash(uint32 v)
+{
+	return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/*
+ * Appends a length continuation to *op. Returns false if it does not fit.
+ */
+static inline bool
+lz_put_length(unsigned char **op, unsigned char *oend, int len)
+{
+	unsigned char *p = *op;
+
+	for (len -= 15; len >= 255; len -= 255)
+	{
+		if (p >= oend)
+			return false;
+		*p++ = 255;
+	}
+	if (p >= oend)
+		return false;
+	*p++ = (unsigned char) len;
+	*op = p;
+	return true;
+}
+
+/*
+ * Appends a sequence of 'nlit' literals and, unless matchlen is 0, a match.
+ */
+static bool
+lz_put_sequence(unsigned char **op, unsigned char *oend,
+				const unsigned char *lit, int nlit, int offset, int matchlen)
+{
+	unsigned char *token = *op;
+	int			mlen = matchlen > 0 ? matchlen - LZ_MIN_MATCH : 0;
+
+	if (*op >= oend)
+		return false;
+	*token = (Min(nlit, 15) << 4) | Min(mlen, 15);
+	(*op)++;
+
+	if (nlit >= 15 && !lz_put_length(op, oend, nlit))
+		return false;
+	if (oend - *op < nlit)
+		return false;
+	memcpy(*op, lit, nlit);
+	*op += nlit;
+
+	if (matchlen == 0)
+		return true;
+
+	if (oend - *op < 2)
+		return false;
+	(*op)[0] = offset & 0xff;
+	(*op)[1] = (offset >> 8) & 0xff;
+	*op += 2;
+
+	if (mlen >= 15 && !lz_put_length(op, oend, mlen))
+		return false;
+
+	return true;
+}
+
+/*
+ * bfz_lz_compress
+ *   Compresses 'srclen' bytes into 'dst', which has room for 'dstlen'.
+ *
+ *   Returns the compressed length, or -1 if it would not fit. Input longer
+ *   than LZ_MAX_OFFSET is fine, matches just never reach back further.
+ */
+int
+bfz_lz_compress(const char *src, int srclen, char *dst, int dstlen)
+{
+	uint32		table[LZ_HASH_SIZE];
+	const unsigned char *base = (const unsigned char *) src;
+	const unsigned char *ip = base;
+	const unsigned char *anchor = base;
+	const unsigned char *iend = base + srclen;
+	unsigned char *op = (unsigned char *) dst;
+	unsigned char *oend = op + dstlen;
+
+	memset(table, 0, sizeof(table));
+
+	while (iend - ip >= LZ_MIN_MATCH)
+	{
+		uint32		seq = lz_read32(ip);
+		uint32		h = lz_hash(seq);
+		const unsigned char *ref = base + table[h];
+
+		table[h] = (uint32) (ip - base);
+
+		if (ref < ip && ip - ref <= LZ_MAX_OFFSET && lz_read32(ref) == seq)
+		{
+			const unsigned char *mp = ip + LZ_MIN_MATCH;
+			const unsigned char *rp = ref + LZ_MIN_MATCH;
+
+			while (mp < iend && *mp == *rp)
+			{
+				mp++;
+				rp++;
+			}
+
+			if (!lz_put_sequence(&op, oend, anchor, ip - anchor,
+								 ip - ref, mp - ip))
+				return -1;
+
+			ip = anchor = mp;
+		}
+		else
+			ip++;
+	}
+
+	if (!lz_put_sequence(&op, oend, anchor, iend - anchor, 0, 0))
+		return -1;
+
+	return op - (unsigned char *) dst;
+}
+
+/*
+ * Reads a length continuation. Returns -1 if the input is truncated.
+ */
+static inline int
+lz_get_length(const unsigned char **ip, const unsigned char *iend)
+{
+	int			len = 15;
+	unsigned char b;
+
+	do
+	{
+		if (*ip >= iend)
+			return -1;
+		b = *(*ip)++;
+		len += b;
+	} while (b == 255);
+
+	return len;
+}
+
+/*
+ * bfz_lz_decompress
+ *   Decompresses 'srclen' bytes into 'dst', which has room for 'dstlen'.
+ *
+ *   Returns the decompressed length, or -1 if the input is corrupt.
+ */
+int
+bfz_lz_decompress(const char *src, int srclen, char *dst, int dstlen)
+{
+	const unsigned char *ip = (const unsigned char *) src;
+	const unsigned char *iend = ip + srclen;
+	unsigned char *base = (unsigned char *) dst;
+	unsigned char *op = base;
+	unsigned char *oend = base + dstlen;
+
+	while (ip < iend)
+	{
+		unsigned char token = *ip++;
+		int			len = token >> 4;
+		int			offset;
+		unsigned char *ref;
+
+		if (len == 15 && (len = lz_get_length(&ip, iend)) < 0)
+			return -1;
+		if (len > iend - ip || len > oend - op)
+			return -1;
+		memcpy(op, ip, len);
+		ip += len;
+		op += len;
+
+		/* The last sequence has no match */
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - base)
+			return -1;
+
+		len = token & 15;
+		if (len == 15 && (len = lz_get_length(&ip, iend)) < 0)
+			return -1;
+		len += LZ_MIN_MATCH;
+		if (len > oend - op)
+			return -1;
+
+		/* The match may overlap what it produces, so copy bytewise */
+		ref = op - offset;
+		while (len-- > 0)
+			*op++ = *ref++;
+	}
+
+	return op - base;
+}
+
+/*
+ * bfz_lz_close_ex
+ *  Close a file and freeing up descriptor, buffers etc.
+ *
+ *  This is also called from an xact end callback, hence it should
+ *  not contain any elog(ERROR) calls.
+ */
+static void
+bfz_lz_close_ex(bfz_t * thiz)
+{
+	gp_retry_close(thiz->fd);
+	thiz->fd = -1;
+	pfree(thiz->freeable_stuff);
+	thiz->freeable_stuff = NULL;
+}
+
+/*
+ * Reads exactly 'size' bytes. Returns false at end of file, and errors out
+ * if the file ends in the middle.
+ */
+static bool
+bfz_lz_read_fully(bfz_t * thiz, char *buffer, int size)
+{
+	int			done = 0;
+
+	while (done < size)
+	{
+		int			i = readAndRetry(thiz->fd, buffer + done, size - done);
+
+		if (i < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_IO_ERROR),
+					errmsg("could not read from temporary file: %m")));
+		if (i == 0)
+			break;
+		done += i;
+	}
+
+	if (done > 0 && done < size)
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				errmsg("unexpected end of compressed temporary file")));
+
+	return done == size;
+}
+
+static int
+bfz_lz_read_ex(bfz_t * thiz, char *buffer, int size)
+{
+	struct bfz_lz_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	bfz_lz_header header;
+
+	if (!bfz_lz_read_fully(thiz, (char *) &header, sizeof(header)))
+		return 0;
+
+	if (header.rawlen < 0 || header.rawlen > size ||
+		header.storedlen < 0 || header.storedlen > header.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				errmsg("invalid block header in compressed temporary file")));
+
+	if (header.storedlen == header.rawlen)
+	{
+		bfz_lz_read_fully(thiz, buffer, header.rawlen);
+		return header.rawlen;
+	}
+
+	bfz_lz_read_fully(thiz, fs->zbuffer, header.storedlen);
+
+	if (bfz_lz_decompress(fs->zbuffer, header.storedlen,
+						  buffer, header.rawlen) != header.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				errmsg("corrupt block in compressed temporary file")));
+
+	return header.rawlen;
+}
+
+/*
+ * bfz_lz_try_write_ex
+ *   Compress and write a block. Returns false, with errno set, on failure.
+ *
+ *   This runs in the write-behind thread, so it must not elog or palloc.
+ */
+static bool
+bfz_lz_try_write_ex(bfz_t * thiz, const char *buffer, int size)
+{
+	struct bfz_lz_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	bfz_lz_header header;
+	char	   *payload = fs->zbuffer + sizeof(header);
+	char	   *p;
+	int			left;
+	int			zlen;
+
+	zlen = bfz_lz_compress(buffer, size, payload, LZ_COMPRESS_BOUND(size));
+
+	header.rawlen = size;
+	if (zlen >= 0 && zlen < size)
+		header.storedlen = zlen;
+	else
+	{
+		header.storedlen = size;
+		memcpy(payload, buffer, size);
+	}
+	memcpy(fs->zbuffer, &header, sizeof(header));
+
+	p = fs->zbuffer;
+	left = sizeof(header) + header.storedlen;
+	while (left)
+	{
+		int			i = writeAndRetry(thiz->fd, p, left);
+
+		if (i < 0)
+			return false;
+		p += i;
+		left -= i;
+	}
+
+	return true;
+}
+
+static void
+bfz_lz_write_ex(bfz_t * thiz, const char *buffer, int size)
+{
+	if (!bfz_lz_try_write_ex(thiz, buffer, size))
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				errmsg("could not write to temporary file: %m")));
+}
+
+void
+bfz_lz_init(bfz_t * thiz)
+{
+	/*
+	 * Check that we are allocating in the TopMemoryContext since this
+	 * memory context must still be available when calling the transaction
+	 * callback at the time when the transaction aborts.
+	 */
+	Assert(TopMemoryContext == CurrentMemoryContext);
+	struct bfz_lz_freeable_stuff *fs = palloc(sizeof *fs);
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_lz_read_ex;
+	fs->super.write_ex = bfz_lz_write_ex;
+	fs->super.try_write_ex = bfz_lz_try_write_ex;
+	fs->super.close_ex = bfz_lz_close_ex;
+}
@@ -49,20 +49,35 @@ bfz_nothing_read_ex(bfz_t * thiz, char *buffer, int size)
 	return orig_size - size;
 }
 
-static void
-bfz_nothing_write_ex(bfz_t * bfz, const char *buffer, int size)
+/*
+ * bfz_nothing_try_write_ex
+ *   Write a block. Returns false, with errno set, on failure.
+ *
+ *   This runs in the write-behind thread, so it must not elog or palloc.
+ */
+static bool
+bfz_nothing_try_write_ex(bfz_t * bfz, const char *buffer, int size)
 {
 	while (size)
 	{
 		int			i = writeAndRetry(bfz->fd, buffer, size);
 
 		if (i < 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_IO_ERROR),
-					errmsg("could not write to temporary file: %m")));
+			return false;
 		buffer += i;
 		size -= i;
 	}
+
+	return true;
+}
+
+static void
+bfz_nothing_write_ex(bfz_t * bfz, const char *buffer, int size)
+{
+	if (!bfz_nothing_try_write_ex(bfz, buffer, size))
+		ereport(ERROR,
+				(errcode(ERRCODE_IO_ERROR),
+				errmsg("could not write to temporary file: %m")));
 }
 
 void
@@ -85,5 +100,6 @@ bfz_nothing_init(bfz_t * thiz)
 
 	fs->read_ex = bfz_nothing_read_ex;
 	fs->write_ex = bfz_nothing_write_ex;
+	fs->try_write_ex = bfz_nothing_try_write_ex;
 	fs->close_ex = bfz_nothing_close_ex;
 }
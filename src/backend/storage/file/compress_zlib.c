@@ -125,5 +125,7 @@ bfz_zlib_init(bfz_t * thiz)
 	thiz->freeable_stuff = &fs->super;
 	fs->super.read_ex = bfz_zlib_read_ex;
 	fs->super.write_ex = bfz_zlib_write_ex;
+	/* gfile allocates and reports errors itself; write in the main thread */
+	fs->super.try_write_ex = NULL;
 	fs->super.close_ex = bfz_zlib_close_ex;
 }
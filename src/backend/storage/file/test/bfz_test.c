@@ -43,13 +43,61 @@ test__bfz_scan_begin_initbytes(void **state)
 
 }
 
+/* ==================== bfz_writebehind_submit =================== */
+/*
+ * Tests that blocks handed to the write-behind thread reach the file
+ * whole and in order.
+ */
+void
+test__bfz_writebehind_submit_inorder(void **state)
+{
+	char		path[] = "/tmp/bfz_test_XXXXXX";
+	char		block[BFZ_BUFFER_SIZE];
+	char		out[BFZ_BUFFER_SIZE];
+	bfz_t	   *bfz = palloc0(sizeof(bfz_t));
+	MemoryContext oldcxt;
+	int			i;
+
+	bfz->fd = mkstemp(path);
+	assert_true(bfz->fd >= 0);
+	unlink(path);
+
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	bfz_nothing_init(bfz);
+	bfz->writebehind = palloc0(sizeof(bfz_writebehind));
+	MemoryContextSwitchTo(oldcxt);
+
+	for (i = 0; i < 8; i++)
+	{
+		memset(block, 'a' + i, sizeof(block));
+		assert_true(bfz_writebehind_submit(bfz, block, sizeof(block)));
+	}
+	bfz_writebehind_finish(bfz);
+	assert_false(bfz->writebehind->busy);
+	bfz_writebehind_free(bfz);
+	assert_true(bfz->writebehind == NULL);
+
+	assert_true(lseek(bfz->fd, 0, SEEK_SET) == 0);
+	for (i = 0; i < 8; i++)
+	{
+		memset(block, 'a' + i, sizeof(block));
+		assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, sizeof(out)), sizeof(out));
+		assert_true(memcmp(block, out, sizeof(out)) == 0);
+	}
+	assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, sizeof(out)), 0);
+
+	bfz->freeable_stuff->close_ex(bfz);
+	pfree(bfz);
+}
+
 int
 main(int argc, char* argv[])
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-		unit_test(test__bfz_scan_begin_initbytes)
+		unit_test(test__bfz_scan_begin_initbytes),
+		unit_test(test__bfz_writebehind_submit_inorder)
 	};
 
 	MemoryContextInit();
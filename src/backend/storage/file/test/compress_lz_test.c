@@ -0,0 +1,209 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "c.h"
+
+/* Ignore ereport */
+#include "utils/elog.h"
+#undef ereport
+#undef errcode
+#undef errmsg
+#define ereport
+#define errcode
+#define errmsg
+
+#include "../compress_lz.c"
+#include "utils/memutils.h"
+
+/*
+ * Fills a buffer with rows of text, which compress well, or with
+ * pseudo-random bytes, which do not.
+ */
+static void
+fill_buffer(char *buffer, int size, bool compressible)
+{
+	uint32		seed = 12345;
+	char		row[32];
+	int			i;
+
+	for (i = 0; i < size; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		if (compressible)
+		{
+			snprintf(row, sizeof(row), "%d|some text|", i / 64);
+			buffer[i] = row[i % strlen(row)];
+		}
+		else
+			buffer[i] = (char) (seed >> 16);
+	}
+}
+
+/* ==================== bfz_lz_compress =================== */
+/*
+ * Tests that blocks come back unchanged from bfz_lz_decompress, and that
+ * repetitive data is made smaller.
+ */
+void
+test__bfz_lz_compress_roundtrip(void **state)
+{
+	char		raw[BFZ_BUFFER_SIZE];
+	char		compressed[LZ_COMPRESS_BOUND(BFZ_BUFFER_SIZE)];
+	char		out[BFZ_BUFFER_SIZE];
+	int			sizes[] = {0, 1, 3, 4, 17, 1000, BFZ_BUFFER_SIZE};
+	int			i;
+	int			zlen;
+
+	for (i = 0; i < lengthof(sizes); i++)
+	{
+		fill_buffer(raw, sizes[i], true);
+		zlen = bfz_lz_compress(raw, sizes[i], compressed, sizeof(compressed));
+		assert_true(zlen >= 0);
+		assert_int_equal(bfz_lz_decompress(compressed, zlen, out, sizes[i]), sizes[i]);
+		assert_true(memcmp(raw, out, sizes[i]) == 0);
+
+		fill_buffer(raw, sizes[i], false);
+		zlen = bfz_lz_compress(raw, sizes[i], compressed, sizeof(compressed));
+		assert_true(zlen >= 0);
+		assert_int_equal(bfz_lz_decompress(compressed, zlen, out, sizes[i]), sizes[i]);
+		assert_true(memcmp(raw, out, sizes[i]) == 0);
+	}
+
+	fill_buffer(raw, BFZ_BUFFER_SIZE, true);
+	zlen = bfz_lz_compress(raw, BFZ_BUFFER_SIZE, compressed, sizeof(compressed));
+	assert_true(zlen < BFZ_BUFFER_SIZE / 2);
+
+	/* A long run is a single match overlapping its own output */
+	memset(raw, 'x', BFZ_BUFFER_SIZE);
+	zlen = bfz_lz_compress(raw, BFZ_BUFFER_SIZE, compressed, sizeof(compressed));
+	assert_true(zlen < 100);
+	assert_int_equal(bfz_lz_decompress(compressed, zlen, out, BFZ_BUFFER_SIZE), BFZ_BUFFER_SIZE);
+	assert_true(memcmp(raw, out, BFZ_BUFFER_SIZE) == 0);
+
+	/* Output that does not fit is refused */
+	fill_buffer(raw, 1000, false);
+	assert_int_equal(bfz_lz_compress(raw, 1000, compressed, 500), -1);
+}
+
+/*
+ * Tests input longer than the furthest a match can reach back, as sent by
+ * replication.
+ */
+void
+test__bfz_lz_compress_large(void **state)
+{
+	int			size = 4 * (LZ_MAX_OFFSET + 1) + 100;
+	char	   *raw = palloc(size);
+	char	   *compressed = palloc(LZ_COMPRESS_BOUND(size));
+	char	   *out = palloc(size);
+	int			zlen;
+
+	fill_buffer(raw, size, true);
+	zlen = bfz_lz_compress(raw, size, compressed, LZ_COMPRESS_BOUND(size));
+	assert_true(zlen > 0 && zlen < size / 2);
+	assert_int_equal(bfz_lz_decompress(compressed, zlen, out, size), size);
+	assert_true(memcmp(raw, out, size) == 0);
+
+	fill_buffer(raw, size, false);
+	zlen = bfz_lz_compress(raw, size, compressed, LZ_COMPRESS_BOUND(size));
+	assert_true(zlen >= 0);
+	assert_int_equal(bfz_lz_decompress(compressed, zlen, out, size), size);
+	assert_true(memcmp(raw, out, size) == 0);
+
+	pfree(raw);
+	pfree(compressed);
+	pfree(out);
+}
+
+/* ==================== bfz_lz_decompress =================== */
+/*
+ * Tests that corrupt blocks are detected rather than read past.
+ */
+void
+test__bfz_lz_decompress_corrupt(void **state)
+{
+	char		raw[1000];
+	char		compressed[LZ_COMPRESS_BOUND(1000)];
+	char		out[1000];
+	/* two literals, then a match 3 bytes back */
+	char		badoffset[] = {0x20, 'a', 'b', 3, 0};
+	int			zlen;
+
+	assert_int_equal(bfz_lz_decompress(badoffset, sizeof(badoffset), out, sizeof(out)), -1);
+
+	fill_buffer(raw, sizeof(raw), true);
+	zlen = bfz_lz_compress(raw, sizeof(raw), compressed, sizeof(compressed));
+
+	/* Truncated input, and output that does not fit */
+	assert_true(bfz_lz_decompress(compressed, zlen / 2, out, sizeof(out)) != sizeof(raw));
+	assert_int_equal(bfz_lz_decompress(compressed, zlen, out, sizeof(out) - 1), -1);
+}
+
+/* ==================== bfz_lz_init =================== */
+/*
+ * Tests that blocks written to a file are read back one per read_ex call,
+ * whether they were compressed or stored.
+ */
+void
+test__bfz_lz_init_writeread(void **state)
+{
+	char		path[] = "/tmp/compress_lz_test_XXXXXX";
+	char		compressible[BFZ_BUFFER_SIZE];
+	char		random[BFZ_BUFFER_SIZE];
+	char		out[BFZ_BUFFER_SIZE];
+	bfz_t	   *bfz = palloc0(sizeof(bfz_t));
+	MemoryContext oldcxt;
+	off_t		filesize;
+
+	bfz->fd = mkstemp(path);
+	assert_true(bfz->fd >= 0);
+	unlink(path);
+
+	fill_buffer(compressible, BFZ_BUFFER_SIZE, true);
+	fill_buffer(random, BFZ_BUFFER_SIZE, false);
+
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	bfz_lz_init(bfz);
+	MemoryContextSwitchTo(oldcxt);
+
+	assert_true(bfz->freeable_stuff->try_write_ex != NULL);
+	bfz->freeable_stuff->write_ex(bfz, compressible, BFZ_BUFFER_SIZE);
+	bfz->freeable_stuff->write_ex(bfz, random, BFZ_BUFFER_SIZE);
+	bfz->freeable_stuff->write_ex(bfz, compressible, 100);
+
+	filesize = lseek(bfz->fd, 0, SEEK_END);
+	assert_true(filesize < 2 * BFZ_BUFFER_SIZE);
+	assert_true(lseek(bfz->fd, 0, SEEK_SET) == 0);
+
+	assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, BFZ_BUFFER_SIZE), BFZ_BUFFER_SIZE);
+	assert_true(memcmp(out, compressible, BFZ_BUFFER_SIZE) == 0);
+	assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, BFZ_BUFFER_SIZE), BFZ_BUFFER_SIZE);
+	assert_true(memcmp(out, random, BFZ_BUFFER_SIZE) == 0);
+	assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, BFZ_BUFFER_SIZE), 100);
+	assert_true(memcmp(out, compressible, 100) == 0);
+	assert_int_equal(bfz->freeable_stuff->read_ex(bfz, out, BFZ_BUFFER_SIZE), 0);
+
+	bfz->freeable_stuff->close_ex(bfz);
+	assert_true(bfz->freeable_stuff == NULL);
+	assert_int_equal(bfz->fd, -1);
+	pfree(bfz);
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__bfz_lz_compress_roundtrip),
+		unit_test(test__bfz_lz_compress_large),
+		unit_test(test__bfz_lz_decompress_corrupt),
+		unit_test(test__bfz_lz_init_writeread)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -23,6 +23,7 @@
 #include "access/subtrans.h"
 #include "access/twophase.h"
 #include "access/distributedlog.h"
+#include "access/appendonly_compaction.h"
 #include "access/appendonlywriter.h"
 #include "cdb/cdbfilerep.h"
 #include "cdb/cdbfilerepprimaryack.h"
@@ -55,6 +56,8 @@
 #include "storage/procsignal.h"
 #include "storage/sinvaladt.h"
 #include "storage/spin.h"
+#include "utils/optplancache.h"
+#include "utils/resgroup.h"
 #include "utils/resscheduler.h"
 #include "utils/faultinjector.h"
 #include "utils/sharedsnapshot.h"
@@ -147,9 +150,13 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 				size = add_size(size, ResPortalIncrementShmemSize());				
 			}
 		}
+		size = add_size(size, ResGroupShmemSize());
+		size = add_size(size, AppendOnlyCompactionShmemSize());
+		size = add_size(size, OptPlanCacheShmemSize());
 		size = add_size(size, ProcGlobalShmemSize());
 		size = add_size(size, XLOGShmemSize());
 		size = add_size(size, DistributedLog_ShmemSize());
+		size = add_size(size, SharedDistribXactCache_ShmemSize());
 		size = add_size(size, CLOGShmemSize());
 		size = add_size(size, ChangeTrackingShmemSize());
 		size = add_size(size, SUBTRANSShmemSize());
@@ -296,6 +303,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	CLOGShmemInit();
 	ChangeTrackingShmemInit();
 	DistributedLog_ShmemInit();
+	SharedDistribXactCache_ShmemInit();
 	SUBTRANSShmemInit();
 	TwoPhaseShmemInit();
 	MultiXactShmemInit();
@@ -333,6 +341,21 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		InitResPortalIncrementHash();
 	}
 
+	/*
+	 * Set up resource groups, which also run on the segments
+	 */
+	ResGroupShmemInit();
+
+	/*
+	 * Set up the append-only compaction progress reporting
+	 */
+	AppendOnlyCompactionShmemInit();
+
+	/*
+	 * Set up the shared cache of optimizer plans
+	 */
+	OptPlanCacheShmemInit();
+
 
 	if (!IsUnderPostmaster)
 	{
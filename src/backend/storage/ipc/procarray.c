@@ -56,6 +56,14 @@ typedef struct ProcArrayStruct
 	int			numProcs;		/* number of valid procs entries */
 	int			maxProcs;		/* allocated size of procs array */
 
+	/*
+	 * Number of times a transaction has left the set of running ones, by
+	 * clearing its xid or subxids.  Protected by ProcArrayLock; it starts at
+	 * 1, so a snapshot that was never computed never matches.  See
+	 * GetSnapshotData.
+	 */
+	uint64		xactCompletionCount;
+
 	/*
 	 * We declare procs[] as 1 entry because C wants a fixed-size array, but
 	 * actually it is maxProcs entries long.
@@ -132,6 +140,7 @@ CreateSharedProcArray(void)
 		 */
 		procArray->numProcs = 0;
 		procArray->maxProcs = MaxBackends + max_prepared_xacts;
+		procArray->xactCompletionCount = 1;
 	}
 }
 
@@ -198,6 +207,8 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 		if (TransactionIdPrecedes(ShmemVariableCache->latestCompletedXid,
 								  latestXid))
 			ShmemVariableCache->latestCompletedXid = latestXid;
+
+		arrayP->xactCompletionCount++;
 	}
 	else
 	{
@@ -337,6 +348,9 @@ ProcArrayEndTransaction(PGPROC *proc, TransactionId latestXid, bool isCommit,
 								  latestXid))
 			ShmemVariableCache->latestCompletedXid = latestXid;
 
+		/* Cached snapshots are stale now, even if the xid is cleared later */
+		procArray->xactCompletionCount++;
+
 		LWLockRelease(ProcArrayLock);
 	}
 	else
@@ -409,6 +423,12 @@ ClearTransactionFromPgProc_UnderLock(PGPROC *proc)
 	 * directly.
 	 */
 	ProcArrayClearTransaction(proc);
+
+	/*
+	 * The QD ends a distributed transaction here, after its commit has been
+	 * delivered; cached snapshots must see that.
+	 */
+	procArray->xactCompletionCount++;
 }
 
 /*
@@ -798,6 +818,77 @@ GetOldestXmin(bool allDbs, bool ignoreVacuum)
 	return result;
 }
 
+/*
+ * Publish the writer's distributed snapshot in the shared snapshot slot, so
+ * that the readers of the slice don't each build their own from the copy
+ * the QD sent them.  Must be done before the slot is marked ready.
+ */
+static void
+updateSharedDistributedSnapshot(Snapshot snapshot)
+{
+	volatile SnapshotData *shared = &SharedLocalSnapshotSlot->snapshot;
+	DistributedSnapshotWithLocalMapping *dslm = &snapshot->distribSnapshotWithLocalMapping;
+	int			maxCount = shared->distribSnapshotWithLocalMapping.header.maxCount;
+
+	shared->haveDistribSnapshot = false;
+
+	if (!snapshot->haveDistribSnapshot || dslm->header.count > maxCount)
+		return;
+
+	shared->distribSnapshotWithLocalMapping.header = dslm->header;
+	shared->distribSnapshotWithLocalMapping.header.maxCount = maxCount;
+	shared->distribSnapshotWithLocalMapping.minCachedLocalXid = dslm->minCachedLocalXid;
+	shared->distribSnapshotWithLocalMapping.maxCachedLocalXid = dslm->maxCachedLocalXid;
+	if (dslm->header.count > 0)
+		memcpy(shared->distribSnapshotWithLocalMapping.inProgressEntryArray,
+			   dslm->inProgressEntryArray,
+			   dslm->header.count * sizeof(DistributedSnapshotMapEntry));
+
+	shared->haveDistribSnapshot = true;
+}
+
+/*
+ * Take the distributed snapshot published by the writer, if it is the one
+ * the QD sent us.  Returns false if the caller has to build its own.
+ */
+static bool
+readSharedDistributedSnapshot(Snapshot snapshot)
+{
+	volatile SnapshotData *shared = &SharedLocalSnapshotSlot->snapshot;
+	DistributedSnapshotWithLocalMapping *dslm = &snapshot->distribSnapshotWithLocalMapping;
+	int			count = shared->distribSnapshotWithLocalMapping.header.count;
+
+	if (!shared->haveDistribSnapshot ||
+		Debug_disable_distributed_snapshot ||
+		QEDtxContextInfo.distributedSnapshot.header.distribSnapshotId == 0 ||
+		shared->distribSnapshotWithLocalMapping.header.distribSnapshotId !=
+		QEDtxContextInfo.distributedSnapshot.header.distribSnapshotId ||
+		shared->distribSnapshotWithLocalMapping.header.distribTransactionTimeStamp !=
+		QEDtxContextInfo.distributedSnapshot.header.distribTransactionTimeStamp ||
+		dslm->header.maxCount < count)
+		return false;
+
+	dslm->header.distribTransactionTimeStamp = shared->distribSnapshotWithLocalMapping.header.distribTransactionTimeStamp;
+	dslm->header.xminAllDistributedSnapshots = shared->distribSnapshotWithLocalMapping.header.xminAllDistributedSnapshots;
+	dslm->header.distribSnapshotId = shared->distribSnapshotWithLocalMapping.header.distribSnapshotId;
+	dslm->header.xmin = shared->distribSnapshotWithLocalMapping.header.xmin;
+	dslm->header.xmax = shared->distribSnapshotWithLocalMapping.header.xmax;
+	dslm->header.count = count;
+	/* Do not copy maxCount. */
+
+	dslm->minCachedLocalXid = shared->distribSnapshotWithLocalMapping.minCachedLocalXid;
+	dslm->maxCachedLocalXid = shared->distribSnapshotWithLocalMapping.maxCachedLocalXid;
+	dslm->epochXid = InvalidTransactionId;
+	if (count > 0)
+		memcpy(dslm->inProgressEntryArray,
+			   (void *) shared->distribSnapshotWithLocalMapping.inProgressEntryArray,
+			   count * sizeof(DistributedSnapshotMapEntry));
+
+	snapshot->haveDistribSnapshot = true;
+
+	return true;
+}
+
 void
 updateSharedLocalSnapshot(DtxContextInfo *dtxContextInfo, Snapshot snapshot, char *debugCaller)
 {
@@ -850,6 +941,8 @@ updateSharedLocalSnapshot(DtxContextInfo *dtxContextInfo, Snapshot snapshot, cha
 
 	SharedLocalSnapshotSlot->snapshot.curcid = snapshot->curcid;
 
+	updateSharedDistributedSnapshot(snapshot);
+
 	elog((Debug_print_full_dtm ? LOG : DEBUG5),
 		 "updateSharedLocalSnapshot: combocidsize is now %d max %d segmateSync %d->%d",
 		 combocidSize, MaxComboCids, SharedLocalSnapshotSlot->segmateSync, dtxContextInfo->segmateSync);
@@ -975,6 +1068,7 @@ FillInDistributedSnapshot(Snapshot snapshot)
 				snapshot->haveDistribSnapshot = true;
 
 				dslm->header.distribTransactionTimeStamp = ds->header.distribTransactionTimeStamp;
+				dslm->header.xminAllDistributedSnapshots = ds->header.xminAllDistributedSnapshots;
 				dslm->header.distribSnapshotId = ds->header.distribSnapshotId;
 				
 				dslm->header.xmin = ds->header.xmin;
@@ -984,13 +1078,17 @@ FillInDistributedSnapshot(Snapshot snapshot)
 
 				count = ds->header.count;
 				
+				/* The QD sent the in-progress xids sorted; keep them so. */
 				for (i = 0; i < count; i++)
 				{
+					Assert(i == 0 ||
+						   ds->inProgressXidArray[i - 1] < ds->inProgressXidArray[i]);
 					dslm->inProgressEntryArray[i].distribXid = ds->inProgressXidArray[i];
 
 					/* UNDONE: Lookup in distributed cache. */
 					dslm->inProgressEntryArray[i].localXid = InvalidTransactionId;
 				}
+				DistributedSnapshotWithLocalMapping_SetLocalXidRange(dslm);
 			}
 			else
 			{
@@ -1170,13 +1268,8 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 
 		segmate_timeout_us = (3 * (uint64)Max(interconnect_setup_timeout, 1) * 1000* 1000) / 4;
 
-		/*
-		 * Make a copy of the distributed snapshot information; this
-		 * doesn't use the shared-snapshot-slot stuff it is just
-		 * making copies from the QEDtxContextInfo structure sent by
-		 * the QD.
-		 */
-		FillInDistributedSnapshot(snapshot);
+		/* The local part comes from the writer, not the ProcArray */
+		snapshot->snapXactCompletionCount = 0;
 
 		/*
 		 * If we're a cursor-reader, we get out snapshot from the
@@ -1185,6 +1278,14 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 		 */
 		if (QEDtxContextInfo.cursorContext)
 		{
+			/*
+			 * Make a copy of the distributed snapshot information; this
+			 * doesn't use the shared-snapshot-slot stuff it is just
+			 * making copies from the QEDtxContextInfo structure sent by
+			 * the QD.
+			 */
+			FillInDistributedSnapshot(snapshot);
+
 			readSharedLocalSnapshot_forCursor(snapshot);
 
 			if (gp_enable_slow_cursor_testmode)
@@ -1235,6 +1336,14 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 
 				snapshot->curcid = SharedLocalSnapshotSlot->snapshot.curcid;
 
+				/*
+				 * Take the distributed snapshot the writer published with
+				 * its local snapshot, along with the local xids it has
+				 * learnt; else copy the one sent by the QD.
+				 */
+				if (!readSharedDistributedSnapshot(snapshot))
+					FillInDistributedSnapshot(snapshot);
+
 				/* combocid */
 				if (usedComboCids != SharedLocalSnapshotSlot->combocidcnt)
 				{
@@ -1358,18 +1467,6 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 	 */
 	LWLockAcquire(ProcArrayLock, LW_SHARED);
 
-	/* xmax is always latestCompletedXid + 1 */
-	xmax = ShmemVariableCache->latestCompletedXid;
-	Assert(TransactionIdIsNormal(xmax));
-	TransactionIdAdvance(xmax);
-
-	/* initialize xmin calculation with xmax */
-	globalxmin = xmin = xmax;
-
-	elog((Debug_print_full_dtm ? LOG : DEBUG5),
-		 "GetSnapshotData setting globalxmin and xmin to %u", 
-	 	 xmin);
-
 	/*
 	 * Get the distributed snapshot if needed and copy it into the field 
 	 * called distribSnapshotWithLocalMapping in the snapshot structure.
@@ -1409,78 +1506,122 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 	FillInDistributedSnapshot(snapshot);
 
 	/*
-	 * Spin over procArray checking xid, xmin, and subxids.  The goal is to
-	 * gather all active xids, find the lowest xmin, and try to record
-	 * subxids.
+	 * If no transaction has left the running set since we last computed the
+	 * local part of this snapshot, it is still right: transactions that got
+	 * an xid since have xids >= its xmax, which it treats as running anyway.
+	 * Then skip the walk over all the PGPROCs.  The global xmin computed
+	 * with it cannot have advanced either.
 	 */
-	for (index = 0; index < arrayP->numProcs; index++)
+	if (snapshot->snapXactCompletionCount == arrayP->xactCompletionCount)
 	{
-		volatile PGPROC *proc = arrayP->procs[index];
-		TransactionId xid;
+		xmin = snapshot->xmin;
+		xmax = snapshot->xmax;
+		globalxmin = snapshot->snapGlobalXmin;
+		count = snapshot->xcnt;
+		subcount = snapshot->subxcnt;
 
-		/* Ignore procs running LAZY VACUUM */
-		if (proc->vacuumFlags & PROC_IN_VACUUM)
-			continue;
+		elog((Debug_print_full_dtm ? LOG : DEBUG5),
+			 "GetSnapshotData reusing snapshot xmin %u xmax %u",
+			 xmin, xmax);
+	}
+	else
+	{
+		/* xmax is always latestCompletedXid + 1 */
+		xmax = ShmemVariableCache->latestCompletedXid;
+		Assert(TransactionIdIsNormal(xmax));
+		TransactionIdAdvance(xmax);
 
-		/* Update globalxmin to be the smallest valid xmin */
-		xid = proc->xmin;               /* fetch just once */
-		if (TransactionIdIsNormal(xid) &&
-			TransactionIdPrecedes(xid, globalxmin))
-			globalxmin = xid;
+		/* initialize xmin calculation with xmax */
+		globalxmin = xmin = xmax;
 
-		/* Fetch xid just once - see GetNewTransactionId */
-		xid = proc->xid;
+		elog((Debug_print_full_dtm ? LOG : DEBUG5),
+			 "GetSnapshotData setting globalxmin and xmin to %u",
+			 xmin);
 
 		/*
-		 * If the transaction has been assigned an xid < xmax we add it to the
-		 * snapshot, and update xmin if necessary.	There's no need to store
-		 * XIDs >= xmax, since we'll treat them as running anyway.  We don't
-		 * bother to examine their subxids either.
-		 *
-		 * We don't include our own XID (if any) in the snapshot, but we must
-		 * include it into xmin.
+		 * Spin over procArray checking xid, xmin, and subxids.  The goal is to
+		 * gather all active xids, find the lowest xmin, and try to record
+		 * subxids.
 		 */
-		if (TransactionIdIsNormal(xid))
+		for (index = 0; index < arrayP->numProcs; index++)
 		{
-			if (TransactionIdFollowsOrEquals(xid, xmax))
+			volatile PGPROC *proc = arrayP->procs[index];
+			TransactionId xid;
+
+			/* Ignore procs running LAZY VACUUM */
+			if (proc->vacuumFlags & PROC_IN_VACUUM)
 				continue;
-			if (proc != MyProc)
-				snapshot->xip[count++] = xid;
-			if (TransactionIdPrecedes(xid, xmin))
-				xmin = xid;
-		}
 
-		/*
-		 * Save subtransaction XIDs if possible (if we've already overflowed,
-		 * there's no point).  Note that the subxact XIDs must be later than
-		 * their parent, so no need to check them against xmin.  We could
-		 * filter against xmax, but it seems better not to do that much work
-		 * while holding the ProcArrayLock.
-		 *
-		 * The other backend can add more subxids concurrently, but cannot
-		 * remove any.	Hence it's important to fetch nxids just once. Should
-		 * be safe to use memcpy, though.  (We needn't worry about missing any
-		 * xids added concurrently, because they must postdate xmax.)
-		 *
-		 * Again, our own XIDs are not included in the snapshot.
-		 */
-		if (subcount >= 0 && proc != MyProc)
-		{
-			if (proc->subxids.overflowed)
-				subcount = -1;	/* overflowed */
-			else
+			/* Update globalxmin to be the smallest valid xmin */
+			xid = proc->xmin;               /* fetch just once */
+			if (TransactionIdIsNormal(xid) &&
+				TransactionIdPrecedes(xid, globalxmin))
+				globalxmin = xid;
+
+			/* Fetch xid just once - see GetNewTransactionId */
+			xid = proc->xid;
+
+			/*
+			 * If the transaction has been assigned an xid < xmax we add it to the
+			 * snapshot, and update xmin if necessary.	There's no need to store
+			 * XIDs >= xmax, since we'll treat them as running anyway.  We don't
+			 * bother to examine their subxids either.
+			 *
+			 * We don't include our own XID (if any) in the snapshot, but we must
+			 * include it into xmin.
+			 */
+			if (TransactionIdIsNormal(xid))
 			{
-				int			nxids = proc->subxids.nxids;
+				if (TransactionIdFollowsOrEquals(xid, xmax))
+					continue;
+				if (proc != MyProc)
+					snapshot->xip[count++] = xid;
+				if (TransactionIdPrecedes(xid, xmin))
+					xmin = xid;
+			}
 
-				if (nxids > 0)
+			/*
+			 * Save subtransaction XIDs if possible (if we've already overflowed,
+			 * there's no point).  Note that the subxact XIDs must be later than
+			 * their parent, so no need to check them against xmin.  We could
+			 * filter against xmax, but it seems better not to do that much work
+			 * while holding the ProcArrayLock.
+			 *
+			 * The other backend can add more subxids concurrently, but cannot
+			 * remove any.	Hence it's important to fetch nxids just once. Should
+			 * be safe to use memcpy, though.  (We needn't worry about missing any
+			 * xids added concurrently, because they must postdate xmax.)
+			 *
+			 * Again, our own XIDs are not included in the snapshot.
+			 */
+			if (subcount >= 0 && proc != MyProc)
+			{
+				if (proc->subxids.overflowed)
+					subcount = -1;	/* overflowed */
+				else
 				{
-					memcpy(snapshot->subxip + subcount,
-						   (void *) proc->subxids.xids,
-						   nxids * sizeof(TransactionId));
-					subcount += nxids;
+					int			nxids = proc->subxids.nxids;
+
+					if (nxids > 0)
+					{
+						memcpy(snapshot->subxip + subcount,
+							   (void *) proc->subxids.xids,
+							   nxids * sizeof(TransactionId));
+						subcount += nxids;
+					}
 				}
 			}
 		}
+
+		/*
+		 * Update globalxmin to include actual process xids.  This is a
+		 * slightly different way of computing it than GetOldestXmin uses,
+		 * but should give the same result.
+		 */
+		if (TransactionIdPrecedes(xmin, globalxmin))
+			globalxmin = xmin;
+
+		snapshot->snapXactCompletionCount = arrayP->xactCompletionCount;
 	}
 
 	if (serializable)
@@ -1500,14 +1641,6 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 
 	LWLockRelease(ProcArrayLock);
 
-	/*
-	 * Update globalxmin to include actual process xids.  This is a slightly
-	 * different way of computing it than GetOldestXmin uses, but should give
-	 * the same result.
-	 */
-	if (TransactionIdPrecedes(xmin, globalxmin))
-		globalxmin = xmin;
-
 	/* Update global variables too */
 	RecentGlobalXmin = globalxmin;
 	RecentXmin = xmin;
@@ -1516,6 +1649,7 @@ GetSnapshotData(Snapshot snapshot, bool serializable)
 	snapshot->xmax = xmax;
 	snapshot->xcnt = count;
 	snapshot->subxcnt = subcount;
+	snapshot->snapGlobalXmin = globalxmin;
 
 	snapshot->curcid = GetCurrentCommandId(false);
 
@@ -1762,6 +1896,42 @@ BackendXidGetPid(TransactionId xid)
 	return result;
 }
 
+/*
+ * DistributedXidGetBackendXid -- get the local xid of the backend that is
+ * running a given distributed transaction.
+ *
+ * Returns InvalidTransactionId if no backend is, or if it has no xid.  Used
+ * on a segment to wait for a one-phase commit that may still be underway.
+ */
+TransactionId
+DistributedXidGetBackendXid(DistributedTransactionTimeStamp distribTimeStamp,
+							DistributedTransactionId distribXid)
+{
+	TransactionId result = InvalidTransactionId;
+	ProcArrayStruct *arrayP = procArray;
+	int			index;
+
+	LWLockAcquire(ProcArrayLock, LW_SHARED);
+
+	for (index = 0; index < arrayP->numProcs; index++)
+	{
+		volatile PGPROC *proc = arrayP->procs[index];
+
+		if (proc != MyProc &&
+			proc->localDistribXactData.state != LOCALDISTRIBXACT_STATE_NONE &&
+			proc->localDistribXactData.distribTimeStamp == distribTimeStamp &&
+			proc->localDistribXactData.distribXid == distribXid)
+		{
+			result = proc->xid;
+			break;
+		}
+	}
+
+	LWLockRelease(ProcArrayLock);
+
+	return result;
+}
+
 /*
  * IsBackendPid -- is a given pid a running backend
  */
@@ -2110,6 +2280,8 @@ XidCacheRemoveRunningXids(TransactionId xid,
 							  latestXid))
 		ShmemVariableCache->latestCompletedXid = latestXid;
 
+	procArray->xactCompletionCount++;
+
 	LWLockRelease(ProcArrayLock);
 }
 
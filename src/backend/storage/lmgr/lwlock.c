@@ -31,18 +31,34 @@
 #include "storage/ipc.h"
 #include "storage/proc.h"
 #include "storage/spin.h"
+#include "utils/gp_atomic.h"
 
 
 /* We use the ShmemLock spinlock to protect LWLockAssign */
 extern slock_t *ShmemLock;
 
+/*
+ * The lock is held, and waited for, through a single atomic state word: the
+ * low bits count the shared holders, one bit above them is set while the
+ * lock is held exclusively, and the top bits are flags. Acquiring or
+ * releasing the lock is one compare-and-swap or atomic add on it. The
+ * spinlock only protects the queue of waiting PGPROCs, and is taken only
+ * when a backend has to wait or has waiters to wake up.
+ */
+#define LW_FLAG_HAS_WAITERS		((uint32) 1 << 30)
+#define LW_FLAG_RELEASE_OK		((uint32) 1 << 29)
+
+#define LW_VAL_EXCLUSIVE		((uint32) 1 << 24)
+#define LW_VAL_SHARED			1
+
+#define LW_LOCK_MASK			((uint32) ((1 << 25) - 1))
+/* MaxBackends is limited to MAX_MAX_BACKENDS, so the shared count never overflows */
+#define LW_SHARED_MASK			((uint32) ((1 << 24) - 1))
 
 typedef struct LWLock
 {
-	slock_t		mutex;			/* Protects LWLock and queue of PGPROCs */
-	bool		releaseOK;		/* T if ok to release waiters */
-	char		exclusive;		/* # of exclusive holders (0 or 1) */
-	int			shared;			/* # of shared holders (0..MaxBackends) */
+	slock_t		mutex;			/* Protects queue of PGPROCs */
+	pg_atomic_uint32 state;		/* holders and flags, see above */
 	int			exclusivePid;	/* PID of the exclusive holder. */
 	PGPROC	   *head;			/* head of list of waiting PGPROCs */
 	PGPROC	   *tail;			/* tail of list of waiting PGPROCs */
@@ -115,10 +131,15 @@ inline static void
 PRINT_LWDEBUG(const char *where, LWLockId lockid, const volatile LWLock *lock)
 {
 	if (Trace_lwlocks)
+	{
+		uint32		state = pg_atomic_read_u32((pg_atomic_uint32 *) &lock->state);
+
 		elog(LOG, "%s(%d): excl %d excl pid %d shared %d head %p rOK %d",
 			 where, (int) lockid,
-			 (int) lock->exclusive, lock->exclusivePid, lock->shared, lock->head,
-			 (int) lock->releaseOK);
+			 (state & LW_VAL_EXCLUSIVE) != 0, lock->exclusivePid,
+			 state & LW_SHARED_MASK, lock->head,
+			 (state & LW_FLAG_RELEASE_OK) != 0);
+	}
 }
 
 inline static void
@@ -277,9 +298,8 @@ CreateLWLocks(void)
 	for (id = 0, lock = LWLockArray; id < numLocks; id++, lock++)
 	{
 		SpinLockInit(&lock->lock.mutex);
-		lock->lock.releaseOK = true;
-		lock->lock.exclusive = 0;
-		lock->lock.shared = 0;
+		pg_atomic_init_u32(&lock->lock.state, LW_FLAG_RELEASE_OK);
+		lock->lock.exclusivePid = 0;
 		lock->lock.head = NULL;
 		lock->lock.tail = NULL;
 	}
@@ -351,14 +371,10 @@ LWLockTryLockWaiting(
 			int count = 0;
 			char buffer[200];
 
-			SpinLockAcquire(&lock->mutex);
-			
-			if (lock->exclusive > 0)
+			if (pg_atomic_read_u32((pg_atomic_uint32 *) &lock->state) & LW_VAL_EXCLUSIVE)
 				exclusivePid = lock->exclusivePid;
 			else
 				exclusivePid = 0;
-			
-			SpinLockRelease(&lock->mutex);
 
 			memcpy(buffer, "none", 5);
 			
@@ -385,6 +401,222 @@ LWLockTryLockWaiting(
 
 #endif
 
+/*
+ * LWLockAttemptLock - try to grab the lock in the given mode
+ *
+ * This is one compare-and-swap on the state word, retried only if the word
+ * changed under us. Returns true if the lock is held in a conflicting mode
+ * and we have to wait, in which case the state is left as it was.
+ */
+static bool
+LWLockAttemptLock(volatile LWLock *lock, LWLockMode mode)
+{
+	pg_atomic_uint32 *state = (pg_atomic_uint32 *) &lock->state;
+	uint32		old_state = pg_atomic_read_u32(state);
+
+	for (;;)
+	{
+		uint32		desired_state = old_state;
+		bool		lock_free;
+
+		if (mode == LW_EXCLUSIVE)
+		{
+			lock_free = (old_state & LW_LOCK_MASK) == 0;
+			if (lock_free)
+				desired_state += LW_VAL_EXCLUSIVE;
+		}
+		else
+		{
+			lock_free = (old_state & LW_VAL_EXCLUSIVE) == 0;
+			if (lock_free)
+				desired_state += LW_VAL_SHARED;
+		}
+
+		/* On failure, old_state is updated and we try again */
+		if (pg_atomic_compare_exchange_u32(state, &old_state, desired_state))
+		{
+			if (lock_free && mode == LW_EXCLUSIVE)
+				lock->exclusivePid = MyProcPid;
+			return !lock_free;
+		}
+	}
+}
+
+/*
+ * LWLockQueueSelf - add myself to the end of the wait queue of the lock
+ *
+ * The waiters flag is set before we are queued, so that a releaser that
+ * sees the lock free after our next attempt to get it knows to wake us.
+ */
+static void
+LWLockQueueSelf(LWLockId lockid, LWLockMode mode)
+{
+	volatile LWLock *lock = &(LWLockArray[lockid].lock);
+	PGPROC	   *proc = MyProc;
+
+	/*
+	 * If we don't have a PGPROC structure, there's no way to wait. This
+	 * should never occur, since MyProc should only be null during shared
+	 * memory initialization.
+	 */
+	if (proc == NULL)
+		elog(PANIC, "cannot wait without a PGPROC structure");
+
+	SpinLockAcquire(&lock->mutex);
+
+	pg_atomic_fetch_or_u32((pg_atomic_uint32 *) &lock->state, LW_FLAG_HAS_WAITERS);
+
+	proc->lwWaiting = true;
+	proc->lwWaitMode = mode;
+	lwWaitingLockId = lockid;
+	proc->lwWaitLink = NULL;
+	if (lock->head == NULL)
+		lock->head = proc;
+	else
+		lock->tail->lwWaitLink = proc;
+	lock->tail = proc;
+
+	SpinLockRelease(&lock->mutex);
+}
+
+/*
+ * LWLockDequeueSelf - remove myself from the wait queue of the lock
+ *
+ * Used when we got the lock after all, after queueing ourselves. Returns
+ * the number of wakeups absorbed, which the caller must give back to the
+ * semaphore.
+ */
+static int
+LWLockDequeueSelf(volatile LWLock *lock)
+{
+	PGPROC	   *proc = MyProc;
+	PGPROC	   *prev = NULL;
+	PGPROC	   *curr;
+	int			extraWaits = 0;
+
+	SpinLockAcquire(&lock->mutex);
+
+	for (curr = lock->head; curr != NULL; prev = curr, curr = curr->lwWaitLink)
+	{
+		if (curr == proc)
+			break;
+	}
+
+	if (curr != NULL)
+	{
+		if (prev == NULL)
+			lock->head = proc->lwWaitLink;
+		else
+			prev->lwWaitLink = proc->lwWaitLink;
+		if (lock->tail == proc)
+			lock->tail = prev;
+		proc->lwWaitLink = NULL;
+		proc->lwWaiting = false;
+
+		if (lock->head == NULL)
+			pg_atomic_fetch_and_u32((pg_atomic_uint32 *) &lock->state, ~LW_FLAG_HAS_WAITERS);
+	}
+
+	SpinLockRelease(&lock->mutex);
+
+	if (curr == NULL)
+	{
+		/*
+		 * A releaser has already taken us off the queue, and has woken us up
+		 * or is about to. Absorb that wakeup. The releaser also stopped
+		 * others from waking waiters until we ran; we have, so allow it
+		 * again.
+		 */
+		for (;;)
+		{
+			PGSemaphoreLock(&proc->sem, false);
+			if (!proc->lwWaiting)
+				break;
+			extraWaits++;
+		}
+
+		pg_atomic_fetch_or_u32((pg_atomic_uint32 *) &lock->state, LW_FLAG_RELEASE_OK);
+	}
+
+	return extraWaits;
+}
+
+/*
+ * LWLockWakeup - wake up the waiters that can get the lock
+ *
+ * Waiters that only wait for the lock to become free are awakened first.
+ * Then, if the front waiter wants exclusive lock, awaken him only.
+ * Otherwise awaken as many waiters as want shared access.
+ */
+static void
+LWLockWakeup(LWLockId lockid)
+{
+	volatile LWLock *lock = &(LWLockArray[lockid].lock);
+	PGPROC	   *head;
+	PGPROC	   *proc;
+	uint32		clearFlags = 0;
+
+	SpinLockAcquire(&lock->mutex);
+
+	head = lock->head;
+	if (head != NULL)
+	{
+		bool		wokeShared = false;
+
+		/*
+		 * Remove the to-be-awakened PGPROCs from the queue.
+		 */
+		proc = head;
+		for (;;)
+		{
+			/*
+			 * Prevent additional wakeups until the retryers get to run. Those
+			 * that only wait for the lock to become free don't retry, and
+			 * proc->pid can be 0 if process exited while waiting for lock.
+			 */
+			if (proc->lwWaitMode != LW_WAIT_UNTIL_FREE && proc->pid != 0)
+				clearFlags |= LW_FLAG_RELEASE_OK;
+
+			if (proc->lwWaitMode == LW_EXCLUSIVE || proc->lwWaitLink == NULL)
+				break;
+			if (proc->lwWaitMode == LW_SHARED)
+				wokeShared = true;
+			if (proc->lwWaitLink->lwWaitMode == LW_EXCLUSIVE && wokeShared)
+				break;
+			proc = proc->lwWaitLink;
+		}
+		/* proc is now the last PGPROC to be released */
+		lock->head = proc->lwWaitLink;
+		proc->lwWaitLink = NULL;
+	}
+
+	if (lock->head == NULL)
+		clearFlags |= LW_FLAG_HAS_WAITERS;
+	if (clearFlags != 0)
+		pg_atomic_fetch_and_u32((pg_atomic_uint32 *) &lock->state, ~clearFlags);
+
+	/* We are done updating the queue. */
+	SpinLockRelease(&lock->mutex);
+
+	/*
+	 * Awaken any waiters I removed from the queue.
+	 */
+	while (head != NULL)
+	{
+#ifdef LWLOCK_TRACE_MIRROREDLOCK
+		if (lockid == MirroredLock)
+			elog(LOG, "LWLockRelease: release waiter for MirroredLock (this PID %u", MyProcPid);
+#endif
+		LOG_LWDEBUG("LWLockRelease", lockid, "release waiter");
+		proc = head;
+		head = proc->lwWaitLink;
+		proc->lwWaitLink = NULL;
+		pg_write_barrier();
+		proc->lwWaiting = false;
+		PGSemaphoreUnlock(&proc->sem);
+	}
+}
+
 // Turn this on if we find a deadlock or missing unlock issue...
 // #define LWLOCK_TRACE_MIRROREDLOCK
 
@@ -400,7 +632,6 @@ LWLockAcquire(LWLockId lockid, LWLockMode mode)
 {
 	volatile LWLock *lock = &(LWLockArray[lockid].lock);
 	PGPROC	   *proc = MyProc;
-	bool		retry = false;
 	int			extraWaits = 0;
 
 	PRINT_LWDEBUG("LWLockAcquire", lockid, lock);
@@ -469,64 +700,30 @@ LWLockAcquire(LWLockId lockid, LWLockMode mode)
 		bool		mustwait;
 		int			c;
 
-		/* Acquire mutex.  Time spent holding mutex should be short! */
-		SpinLockAcquire(&lock->mutex);
-
-		/* If retrying, allow LWLockRelease to release waiters again */
-		if (retry)
-			lock->releaseOK = true;
-
 		/* If I can get the lock, do so quickly. */
-		if (mode == LW_EXCLUSIVE)
-		{
-			if (lock->exclusive == 0 && lock->shared == 0)
-			{
-				lock->exclusive++;
-				lock->exclusivePid = MyProcPid;
-				mustwait = false;
-			}
-			else
-				mustwait = true;
-		}
-		else
-		{
-			if (lock->exclusive == 0)
-			{
-				lock->shared++;
-				mustwait = false;
-			}
-			else
-				mustwait = true;
-		}
+		mustwait = LWLockAttemptLock(lock, mode);
 
 		if (!mustwait)
 		{
-			LOG_LWDEBUG("LWLockAcquire", lockid, "acquired!");
+			LOG_LWDEBUG("LWLockAcquire", lockid, "immediately acquired lock");
 			break;				/* got the lock */
 		}
 
 		/*
-		 * Add myself to wait queue.
-		 *
-		 * If we don't have a PGPROC structure, there's no way to wait. This
-		 * should never occur, since MyProc should only be null during shared
-		 * memory initialization.
+		 * Add myself to wait queue, and try again: the holder may have
+		 * released the lock before it could see us waiting, in which case no
+		 * one would wake us up.
 		 */
-		if (proc == NULL)
-			elog(PANIC, "cannot wait without a PGPROC structure");
+		LWLockQueueSelf(lockid, mode);
 
-		proc->lwWaiting = true;
-		proc->lwExclusive = (mode == LW_EXCLUSIVE);
-		lwWaitingLockId = lockid;
-		proc->lwWaitLink = NULL;
-		if (lock->head == NULL)
-			lock->head = proc;
-		else
-			lock->tail->lwWaitLink = proc;
-		lock->tail = proc;
-		
-		/* Can release the mutex now */
-		SpinLockRelease(&lock->mutex);
+		mustwait = LWLockAttemptLock(lock, mode);
+
+		if (!mustwait)
+		{
+			LOG_LWDEBUG("LWLockAcquire", lockid, "acquired, undoing queue");
+			extraWaits += LWLockDequeueSelf(lock);
+			break;
+		}
 
 		/*
 		 * Wait until awakened.
@@ -572,6 +769,9 @@ LWLockAcquire(LWLockId lockid, LWLockMode mode)
 			extraWaits++;
 		}
 
+		/* Retrying, allow LWLockRelease to release waiters again */
+		pg_atomic_fetch_or_u32((pg_atomic_uint32 *) &lock->state, LW_FLAG_RELEASE_OK);
+
 		PG_TRACE2(lwlock__endwait, lockid, mode);
 
 		LOG_LWDEBUG("LWLockAcquire", lockid, "awakened");
@@ -581,12 +781,8 @@ LWLockAcquire(LWLockId lockid, LWLockMode mode)
 			elog(LOG, "LWLockAcquire: awakened for MirroredLock (PID %u)", MyProcPid);
 #endif
 		/* Now loop back and try to acquire lock again. */
-		retry = true;
 	}
 
-	/* We are done updating shared state of the lock itself. */
-	SpinLockRelease(&lock->mutex);
-
 	PG_TRACE2(lwlock__acquire, lockid, mode);
 
 #ifdef LWLOCK_TRACE_MIRROREDLOCK
@@ -640,34 +836,8 @@ LWLockConditionalAcquire(LWLockId lockid, LWLockMode mode)
 	 */
 	HOLD_INTERRUPTS();
 
-	/* Acquire mutex.  Time spent holding mutex should be short! */
-	SpinLockAcquire(&lock->mutex);
-
-	/* If I can get the lock, do so quickly. */
-	if (mode == LW_EXCLUSIVE)
-	{
-		if (lock->exclusive == 0 && lock->shared == 0)
-		{
-			lock->exclusive++;
-			lock->exclusivePid = MyProcPid;
-			mustwait = false;
-		}
-		else
-			mustwait = true;
-	}
-	else
-	{
-		if (lock->exclusive == 0)
-		{
-			lock->shared++;
-			mustwait = false;
-		}
-		else
-			mustwait = true;
-	}
-
-	/* We are done updating shared state of the lock itself. */
-	SpinLockRelease(&lock->mutex);
+	/* Check for the lock */
+	mustwait = LWLockAttemptLock(lock, mode);
 
 	if (mustwait)
 	{
@@ -701,6 +871,117 @@ LWLockConditionalAcquire(LWLockId lockid, LWLockMode mode)
 	return !mustwait;
 }
 
+/*
+ * LWLockAcquireOrWait - Acquire lock, or wait until it's free
+ *
+ * The semantics of this function are a bit funky.  If the lock is currently
+ * free, it is acquired in the given mode, and the function returns true.  If
+ * the lock isn't immediately free, the function waits until it is released
+ * and returns false, but does not acquire the lock.
+ *
+ * This is currently used for WALWriteLock: when a backend flushes the WAL,
+ * holding WALWriteLock, it can flush the commit records of many other
+ * backends as a side-effect.  Those other backends need to wait until the
+ * flush finishes, but don't need to acquire the lock anymore.  They can just
+ * wake up, observe that their records have already been flushed, and return.
+ */
+bool
+LWLockAcquireOrWait(LWLockId lockid, LWLockMode mode)
+{
+	volatile LWLock *lock = &(LWLockArray[lockid].lock);
+	PGPROC	   *proc = MyProc;
+	bool		mustwait;
+	int			extraWaits = 0;
+
+	PRINT_LWDEBUG("LWLockAcquireOrWait", lockid, lock);
+
+	Assert(mode == LW_SHARED || mode == LW_EXCLUSIVE);
+
+	/* Ensure we will have room to remember the lock */
+	if (num_held_lwlocks >= MAX_SIMUL_LWLOCKS)
+		elog(ERROR, "too many LWLocks taken");
+
+	/*
+	 * Lock out cancel/die interrupts until we exit the code section protected
+	 * by the LWLock.  This ensures that interrupts will not interfere with
+	 * manipulations of data structures in shared memory.
+	 */
+	HOLD_INTERRUPTS();
+
+	/* If I can get the lock, do so quickly. */
+	mustwait = LWLockAttemptLock(lock, mode);
+
+	if (mustwait)
+	{
+		/* Queue ourselves, and try again, as in LWLockAcquire */
+		LWLockQueueSelf(lockid, LW_WAIT_UNTIL_FREE);
+
+		mustwait = LWLockAttemptLock(lock, mode);
+
+		if (mustwait)
+		{
+			/*
+			 * Wait until awakened.  Like in LWLockAcquire, be prepared for
+			 * bogus wakeups, because we share the semaphore with
+			 * ProcWaitForSignal.
+			 */
+			LOG_LWDEBUG("LWLockAcquireOrWait", lockid, "waiting");
+
+#ifdef LWLOCK_STATS
+			block_counts[lockid]++;
+#endif
+
+			PG_TRACE2(lwlock__startwait, lockid, mode);
+
+			for (;;)
+			{
+				/* "false" means cannot accept cancel/die interrupt here. */
+				PGSemaphoreLock(&proc->sem, false);
+				if (!proc->lwWaiting)
+					break;
+				extraWaits++;
+			}
+
+			PG_TRACE2(lwlock__endwait, lockid, mode);
+
+			LOG_LWDEBUG("LWLockAcquireOrWait", lockid, "awakened");
+		}
+		else
+		{
+			LOG_LWDEBUG("LWLockAcquireOrWait", lockid, "acquired, undoing queue");
+			extraWaits += LWLockDequeueSelf(lock);
+		}
+	}
+
+	/*
+	 * Fix the process wait semaphore's count for any absorbed wakeups.
+	 */
+	while (extraWaits-- > 0)
+		PGSemaphoreUnlock(&proc->sem);
+
+	if (mustwait)
+	{
+		/* Failed to get lock, so release interrupt holdoff */
+		RESUME_INTERRUPTS();
+		LOG_LWDEBUG("LWLockAcquireOrWait", lockid, "failed");
+	}
+	else
+	{
+#ifdef USE_TEST_UTILS_X86
+		/* keep track of stack trace where lock got acquired */
+		held_lwlocks_depth[num_held_lwlocks] =
+				gp_backtrace(held_lwlocks_addresses[num_held_lwlocks], MAX_FRAME_DEPTH);
+#endif /* USE_TEST_UTILS_X86 */
+
+		/* Add lock to list of locks held by this backend */
+		held_lwlocks_exclusive[num_held_lwlocks] = (mode == LW_EXCLUSIVE);
+		held_lwlocks[num_held_lwlocks++] = lockid;
+		PG_TRACE2(lwlock__acquire, lockid, mode);
+	}
+
+	return !mustwait;
+}
+
 /*
  * LWLockRelease - release a previously acquired lock
  */
@@ -708,8 +989,7 @@ void
 LWLockRelease(LWLockId lockid)
 {
 	volatile LWLock *lock = &(LWLockArray[lockid].lock);
-	PGPROC	   *head;
-	PGPROC	   *proc;
+	uint32		newstate;
 	int			i;
 	bool		saveExclusive;
 
@@ -768,90 +1048,32 @@ LWLockRelease(LWLockId lockid)
 	held_lwlocks_depth[num_held_lwlocks] = 0;
 #endif /* USE_TEST_UTILS_X86 */
 
-	/* Acquire mutex.  Time spent holding mutex should be short! */
-	SpinLockAcquire(&lock->mutex);
-
-	/* Release my hold on lock */
-	if (lock->exclusive > 0)
+	/* Release my hold on lock, with a single atomic operation */
+	if (saveExclusive)
 	{
-		lock->exclusive--;
 		lock->exclusivePid = 0;
+		newstate = pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) &lock->state,
+										   LW_VAL_EXCLUSIVE);
 	}
 	else
 	{
-		Assert(lock->shared > 0);
-		lock->shared--;
+		Assert(pg_atomic_read_u32((pg_atomic_uint32 *) &lock->state) & LW_SHARED_MASK);
+		newstate = pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) &lock->state,
+										   LW_VAL_SHARED);
 	}
 
+	PG_TRACE1(lwlock__release, lockid);
+
 	/*
 	 * See if I need to awaken any waiters.  If I released a non-last shared
 	 * hold, there cannot be anything to do.  Also, do not awaken any waiters
 	 * if someone has already awakened waiters that haven't yet acquired the
 	 * lock.
 	 */
-	head = lock->head;
-	if (head != NULL)
-	{
-		if (lock->exclusive == 0 && lock->shared == 0 && lock->releaseOK)
-		{
-			/*
-			 * Remove the to-be-awakened PGPROCs from the queue.  If the front
-			 * waiter wants exclusive lock, awaken him only. Otherwise awaken
-			 * as many waiters as want shared access.
-			 */
-			proc = head;
-			if (!proc->lwExclusive)
-			{
-				while (proc->lwWaitLink != NULL &&
-					   !proc->lwWaitLink->lwExclusive)
-				{
-					proc = proc->lwWaitLink;
-					if (proc->pid != 0)
-					{
-						lock->releaseOK = false;
-					}					
-				}
-			}
-			/* proc is now the last PGPROC to be released */
-			lock->head = proc->lwWaitLink;
-			proc->lwWaitLink = NULL;
-			
-			/* proc->pid can be 0 if process exited while waiting for lock */
-			if (proc->pid != 0)
-			{
-				/* prevent additional wakeups until retryer gets to run */
-				lock->releaseOK = false;
-			}
-		}
-		else
-		{
-			/* lock is still held, can't awaken anything */
-			head = NULL;
-		}
-	}
-
-	/* We are done updating shared state of the lock itself. */
-	SpinLockRelease(&lock->mutex);
-
-	PG_TRACE1(lwlock__release, lockid);
-
-	/*
-	 * Awaken any waiters I removed from the queue.
-	 */
-	while (head != NULL)
-	{
-#ifdef LWLOCK_TRACE_MIRROREDLOCK
-		if (lockid == MirroredLock)
-			elog(LOG, "LWLockRelease: release waiter for MirroredLock (this PID %u", MyProcPid);
-#endif
-		LOG_LWDEBUG("LWLockRelease", lockid, "release waiter");
-		proc = head;
-		head = proc->lwWaitLink;
-		proc->lwWaitLink = NULL;
-		pg_write_barrier();
-		proc->lwWaiting = false;
-		PGSemaphoreUnlock(&proc->sem);
-	}
+	if ((newstate & (LW_FLAG_HAS_WAITERS | LW_FLAG_RELEASE_OK)) ==
+		(LW_FLAG_HAS_WAITERS | LW_FLAG_RELEASE_OK) &&
+		(newstate & LW_LOCK_MASK) == 0)
+		LWLockWakeup(lockid);
 
 	/*
 	 * Now okay to allow cancel/die interrupts.
@@ -919,6 +1141,10 @@ LWLockWaitCancel(void)
 	if (lwWaitingLock->tail == proc)
 		lwWaitingLock->tail = currProc;
 
+	if (lwWaitingLock->head == NULL)
+		pg_atomic_fetch_and_u32((pg_atomic_uint32 *) &lwWaitingLock->state,
+								~LW_FLAG_HAS_WAITERS);
+
 	/* Done with modification */
 	SpinLockRelease(&lwWaitingLock->mutex);
 
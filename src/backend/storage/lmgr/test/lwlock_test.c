@@ -5,6 +5,15 @@
 
 #include "../lwlock.c"
 
+/* Counts the wakeups of LWLockWakeup, instead of posting the semaphores */
+static int	semaphoreUnlocks = 0;
+
+void
+__wrap_PGSemaphoreUnlock(PGSemaphore sema)
+{
+	semaphoreUnlocks++;
+}
+
 /* Returns true if passed in proc is found in the waiters list */
 bool
 FindProcInWaitersList(LWLockId lockId, PGPROC *proc)
@@ -146,13 +155,133 @@ test__LWLockCancelWait(void **state)
 	assert_true(proc1.lwWaitLink == &proc3);
 }
 
+/*
+ * Unit test for the lock state word. Shared holders are counted, and an
+ * exclusive holder excludes everyone else, without waiting.
+ */
+void
+test__LWLockConditionalAcquire__StateWord(void **state)
+{
+	LWLockPadded myLWLockPaddedArray[5];
+	pg_atomic_uint32 *lockState = &myLWLockPaddedArray[1].lock.state;
+
+	LWLockArray = myLWLockPaddedArray;
+	memset(LWLockArray, 0, sizeof(myLWLockPaddedArray));
+	pg_atomic_init_u32(lockState, LW_FLAG_RELEASE_OK);
+
+	assert_true(LWLockConditionalAcquire(1, LW_SHARED));
+	assert_true(LWLockConditionalAcquire(1, LW_SHARED));
+	assert_int_equal(pg_atomic_read_u32(lockState) & LW_SHARED_MASK, 2);
+	assert_false(LWLockConditionalAcquire(1, LW_EXCLUSIVE));
+
+	LWLockRelease(1);
+	LWLockRelease(1);
+	assert_int_equal(pg_atomic_read_u32(lockState), LW_FLAG_RELEASE_OK);
+
+	assert_true(LWLockConditionalAcquire(1, LW_EXCLUSIVE));
+	assert_true(LWLockHeldExclusiveByMe(1));
+	assert_int_equal(pg_atomic_read_u32(lockState) & LW_LOCK_MASK, LW_VAL_EXCLUSIVE);
+	assert_false(LWLockConditionalAcquire(1, LW_SHARED));
+	assert_false(LWLockConditionalAcquire(1, LW_EXCLUSIVE));
+
+	LWLockRelease(1);
+	assert_false(LWLockHeldByMe(1));
+	assert_int_equal(pg_atomic_read_u32(lockState), LW_FLAG_RELEASE_OK);
+}
+
+/*
+ * Unit test for LWLockWaitCancel() clearing the waiters flag once the
+ * last waiter is gone.
+ */
+void
+test__LWLockCancelWait__ClearsWaitersFlag(void **state)
+{
+	LWLockPadded myLWLockPaddedArray[5];
+	PGPROC proc1, proc2;
+	pg_atomic_uint32 *lockState = &myLWLockPaddedArray[1].lock.state;
+
+	LWLockArray = myLWLockPaddedArray;
+	memset(LWLockArray, 0, sizeof(myLWLockPaddedArray));
+	pg_atomic_init_u32(lockState, LW_VAL_EXCLUSIVE | LW_FLAG_HAS_WAITERS | LW_FLAG_RELEASE_OK);
+
+	lwWaitingLockId = 1;
+	MyProc = &proc2;
+	MyProc->lwWaiting = true;
+	LWLockArray[1].lock.head = &proc1;
+	proc1.lwWaitLink = MyProc;
+	MyProc->lwWaitLink = NULL;
+	LWLockArray[1].lock.tail = MyProc;
+
+	/* Another waiter remains */
+	LWLockWaitCancel();
+	assert_true(pg_atomic_read_u32(lockState) & LW_FLAG_HAS_WAITERS);
+
+	/* No waiter remains */
+	MyProc = &proc1;
+	MyProc->lwWaiting = true;
+	LWLockWaitCancel();
+	assert_true(LWLockArray[1].lock.head == NULL);
+	assert_int_equal(pg_atomic_read_u32(lockState), LW_VAL_EXCLUSIVE | LW_FLAG_RELEASE_OK);
+}
+
+/*
+ * Unit test for LWLockWakeup() with waiters that only wait for the lock to
+ * become free, as LWLockAcquireOrWait() queues them. They are awakened
+ * together with the waiters that get the lock next.
+ */
+void
+test__LWLockWakeup__WaitUntilFree(void **state)
+{
+	LWLockPadded myLWLockPaddedArray[5];
+	PGPROC		procs[4];
+	LWLockMode	modes[4] = {LW_WAIT_UNTIL_FREE, LW_EXCLUSIVE, LW_WAIT_UNTIL_FREE, LW_SHARED};
+	pg_atomic_uint32 *lockState = &myLWLockPaddedArray[1].lock.state;
+	int			i;
+
+	LWLockArray = myLWLockPaddedArray;
+	memset(LWLockArray, 0, sizeof(myLWLockPaddedArray));
+	memset(procs, 0, sizeof(procs));
+	pg_atomic_init_u32(lockState, LW_FLAG_HAS_WAITERS | LW_FLAG_RELEASE_OK);
+
+	for (i = 0; i < 4; i++)
+	{
+		procs[i].pid = 1000 + i;
+		procs[i].lwWaiting = true;
+		procs[i].lwWaitMode = modes[i];
+		procs[i].lwWaitLink = (i < 3) ? &procs[i + 1] : NULL;
+	}
+	LWLockArray[1].lock.head = &procs[0];
+	LWLockArray[1].lock.tail = &procs[3];
+
+	/* The first waiter for the lock to be free, and the exclusive waiter */
+	semaphoreUnlocks = 0;
+	LWLockWakeup(1);
+	assert_int_equal(semaphoreUnlocks, 2);
+	assert_false(procs[0].lwWaiting);
+	assert_false(procs[1].lwWaiting);
+	assert_true(LWLockArray[1].lock.head == &procs[2]);
+	assert_int_equal(pg_atomic_read_u32(lockState), LW_FLAG_HAS_WAITERS);
+
+	/* Once the exclusive waiter has retried, all the others */
+	pg_atomic_fetch_or_u32(lockState, LW_FLAG_RELEASE_OK);
+	LWLockWakeup(1);
+	assert_int_equal(semaphoreUnlocks, 4);
+	assert_false(procs[2].lwWaiting);
+	assert_false(procs[3].lwWaiting);
+	assert_true(LWLockArray[1].lock.head == NULL);
+	assert_int_equal(pg_atomic_read_u32(lockState), 0);
+}
+
 int
 main(int argc, char* argv[])
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-		unit_test(test__LWLockCancelWait)
+		unit_test(test__LWLockCancelWait),
+		unit_test(test__LWLockConditionalAcquire__StateWord),
+		unit_test(test__LWLockCancelWait__ClearsWaitersFlag),
+		unit_test(test__LWLockWakeup__WaitUntilFree)
 	};
 
 	return run_tests(tests);
@@ -91,6 +91,7 @@
 #include "postmaster/backoff.h"
 #include <pthread.h>
 #include "utils/resscheduler.h"
+#include "utils/resgroup.h"
 #include "pgstat.h"
 #include "executor/nodeFunctionscan.h"
 #include "cdb/cdbfilerep.h"
@@ -1087,12 +1088,23 @@ exec_mpp_query(const char *query_string,
 
  	/*
      * Deserialize the query execution plan (a PlannedStmt node), if there is one.
+     *
+     * The plan tree lives exactly as long as MessageContext and is never
+     * freed piecemeal, so build it in a bump context underneath it.
      */
 	if (serializedPlantree != NULL && serializedPlantreelen > 0)
 	{
+		if (gp_enable_bump_context)
+			MemoryContextSwitchTo(BumpContextCreate(MessageContext,
+													"MPP plan",
+													ALLOCSET_DEFAULT_INITSIZE,
+													ALLOCSET_DEFAULT_MAXSIZE));
+
 		plan = (PlannedStmt *) deserializeNode(serializedPlantree,serializedPlantreelen);
 		if (!plan || !IsA(plan, PlannedStmt))
 			elog(ERROR, "MPPEXEC: receive invalid planned statement");
+
+		MemoryContextSwitchTo(MessageContext);
     }
 
 	/*
@@ -4989,6 +5001,7 @@ PostgresMain(int argc, char *argv[],
 					Oid suid;
 					Oid ouid;
 					Oid cuid;
+					Oid resQueueId;
 					bool suid_is_super = false;
 					bool ouid_is_super = false;
 
@@ -5011,6 +5024,10 @@ PostgresMain(int argc, char *argv[],
 					if(pq_getmsgbyte(&input_message) == 1)
 						ouid_is_super = true;	
 					cuid = pq_getmsgint(&input_message, 4);		
+
+					/* the resource group is joined by PortalStart() */
+					resQueueId = pq_getmsgint(&input_message, 4);
+					ResGroupSetDispatchedQueueId(resQueueId);
 					
 					rootIdx = pq_getmsgint(&input_message, 4);
 
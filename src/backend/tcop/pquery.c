@@ -26,6 +26,7 @@
 #include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/memutils.h"
+#include "utils/resgroup.h"
 #include "utils/resscheduler.h"
 #include "commands/vacuum.h"
 #include "commands/tablecmds.h"
@@ -649,6 +650,9 @@ PortalStart(Portal portal, ParamListInfo params, Snapshot snapshot,
 		/* Initialize the backoff weight for this backend */
 		PortalSetBackoffWeight(portal);
 
+		/* Run the statement in the resource group of its queue */
+		ResGroupStatementStart(portal->queueId);
+
 		/*
 		 * Fire her up according to the strategy
 		 */
@@ -8,6 +8,8 @@
  *
  * gp_opt_version: This function wraps LibraryVersion. 
  *
+ * gp_opt_mdcache_stats: This function wraps MDCacheStats.
+ *
  * Copyright(c) 2012 - present, EMC/Greenplum
  */
 
@@ -60,3 +62,18 @@ gp_opt_version(PG_FUNCTION_ARGS __attribute__((unused)))
 	return CStringGetTextDatum("Server has been compiled without ORCA");
 #endif
 }
+
+extern Datum MDCacheStats(PG_FUNCTION_ARGS);
+
+/*
+* Returns the statistics of the optimizer metadata cache of this backend.
+*/
+Datum
+gp_opt_mdcache_stats(PG_FUNCTION_ARGS)
+{
+#ifdef USE_ORCA
+	return MDCacheStats(fcinfo);
+#else
+	PG_RETURN_NULL();
+#endif
+}
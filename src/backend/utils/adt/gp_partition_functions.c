@@ -148,7 +148,6 @@ InsertPidIntoDynamicTableScanInfo(int32 index, Oid partOid, int32 selectorId)
 		if (found)
 		{
 			Assert(hashEntry->partOid == partOid);
-			Assert(NIL != hashEntry->selectorList);
 			hashEntry->selectorList = list_append_unique_int(hashEntry->selectorList, selectorId);
 		}
 		else
@@ -161,6 +160,36 @@ InsertPidIntoDynamicTableScanInfo(int32 index, Oid partOid, int32 selectorId)
 	MemoryContextSwitchTo(oldCxt);
 }
 
+/*
+ * RemovePidFromDynamicTableScanInfo
+ * 		Withdraws a partition oid that the given partition selector
+ * 		propagated earlier. The entry is kept in the pid index, with an
+ * 		empty selector list once no selector propagates it any more, so
+ * 		that this is safe while a dynamic scan iterates over the index.
+ * 		Dynamic scans skip such entries.
+ */
+void
+RemovePidFromDynamicTableScanInfo(int32 index, Oid partOid, int32 selectorId)
+{
+	Assert(dynamicTableScanInfo != NULL &&
+		   dynamicTableScanInfo->memoryContext != NULL);
+	Assert(index > 0 && index <= dynamicTableScanInfo->numScans);
+	Assert(OidIsValid(partOid));
+
+	HTAB *pidIndex = dynamicTableScanInfo->pidIndexes[index - 1];
+	Assert(pidIndex != NULL);
+
+	PartOidEntry *hashEntry = hash_search(pidIndex, &partOid, HASH_FIND, NULL);
+	if (hashEntry == NULL)
+	{
+		return;
+	}
+
+	MemoryContext oldCxt = MemoryContextSwitchTo(dynamicTableScanInfo->memoryContext);
+	hashEntry->selectorList = list_delete_int(hashEntry->selectorList, selectorId);
+	MemoryContextSwitchTo(oldCxt);
+}
+
 PG_FUNCTION_INFO_V1(gp_partition_propagation);
 
 /*
@@ -0,0 +1,300 @@
+/*-------------------------------------------------------------------------
+ *
+ * hyperloglog.c
+ *	  HyperLogLog sketches for estimating the number of distinct values.
+ *
+ * A sketch hashes every value into one of HLL_NUM_REGISTERS registers and
+ * keeps, per register, the largest number of leading zero bits seen in the
+ * rest of the hash. Two sketches over different inputs merge into the
+ * sketch of the union of the inputs by taking the register-wise maximum,
+ * which is what makes them useful here: each segment builds the sketch of
+ * its own rows, and the master merges them. See Flajolet et al.,
+ * "HyperLogLog: the analysis of a near-optimal cardinality estimation
+ * algorithm", 2007.
+ *
+ * Values are hashed with the hash function of their type's default hash
+ * opclass, so that values that are equal but stored differently (numeric
+ * 1.0 and 1.00, float8 0 and -0) count once. Types without a hash opclass
+ * can't be sketched.
+ *
+ * The SQL-level pieces are the gp_hll_sketch(anyelement) aggregate, whose
+ * transition and preliminary functions are gp_hll_accum and gp_hll_merge,
+ * and gp_hll_estimate(bytea). ANALYZE uses them, see analyze.c. The
+ * gp_approx_count_distinct(anyelement) aggregate shares the transition and
+ * preliminary functions and finishes with gp_hll_count; the planner uses it
+ * in place of count(DISTINCT ...) when gp_enable_approx_count_distinct is
+ * set, see cdbgroup.c.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/hash.h"
+#include "catalog/pg_am.h"
+#include "commands/defrem.h"
+#include "nodes/nodes.h"
+#include "utils/builtins.h"
+#include "utils/hyperloglog.h"
+#include "utils/lsyscache.h"
+
+/* Largest rank a register can hold: all remaining hash bits are zero */
+#define HLL_MAX_RANK		(32 - HLL_PRECISION + 1)
+
+#define TWO_POW_32			4294967296.0
+
+/*
+ * hll_create
+ *		Returns a new, empty sketch allocated in the current memory context.
+ */
+HLLSketch *
+hll_create(void)
+{
+	HLLSketch  *sketch = (HLLSketch *) palloc0(HLL_SKETCH_SIZE);
+
+	SET_VARSIZE(sketch, HLL_SKETCH_SIZE);
+	sketch->precision = HLL_PRECISION;
+
+	return sketch;
+}
+
+/*
+ * hll_is_valid
+ *		Is this a sketch, as opposed to the empty initial aggregate state?
+ */
+bool
+hll_is_valid(HLLSketch *sketch)
+{
+	if (sketch == NULL || VARSIZE(sketch) == VARHDRSZ)
+		return false;
+
+	if (VARSIZE(sketch) != HLL_SKETCH_SIZE || sketch->precision != HLL_PRECISION)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid HyperLogLog sketch")));
+
+	return true;
+}
+
+/*
+ * hll_add_hash
+ *		Adds a hashed value to the sketch.
+ *
+ * The first HLL_PRECISION bits of the hash pick the register, the rank of
+ * the first one bit in the rest is the candidate register value.
+ */
+void
+hll_add_hash(HLLSketch *sketch, uint32 hash)
+{
+	uint32		index = hash >> (32 - HLL_PRECISION);
+	uint32		rest = hash << HLL_PRECISION;
+	uint8		rank = 1;
+
+	while (rank < HLL_MAX_RANK && (rest & 0x80000000) == 0)
+	{
+		rank++;
+		rest <<= 1;
+	}
+
+	if (sketch->registers[index] < rank)
+		sketch->registers[index] = rank;
+}
+
+/*
+ * hll_merge
+ *		Merges src into dst, so that dst becomes the sketch of the union.
+ */
+void
+hll_merge(HLLSketch *dst, HLLSketch *src)
+{
+	int			i;
+
+	for (i = 0; i < HLL_NUM_REGISTERS; i++)
+	{
+		if (dst->registers[i] < src->registers[i])
+			dst->registers[i] = src->registers[i];
+	}
+}
+
+/*
+ * hll_estimate
+ *		Estimates the number of distinct values added to the sketch.
+ *
+ * Uses the raw HyperLogLog estimate, with linear counting for small
+ * cardinalities and the correction for hash collisions of a 32-bit hash
+ * for very large ones.
+ */
+double
+hll_estimate(HLLSketch *sketch)
+{
+	double		m = HLL_NUM_REGISTERS;
+	double		alpha = 0.7213 / (1.0 + 1.079 / m);
+	double		sum = 0.0;
+	int			zeros = 0;
+	double		estimate;
+	int			i;
+
+	for (i = 0; i < HLL_NUM_REGISTERS; i++)
+	{
+		sum += ldexp(1.0, -((int) sketch->registers[i]));
+		if (sketch->registers[i] == 0)
+			zeros++;
+	}
+
+	estimate = alpha * m * m / sum;
+
+	if (estimate <= 2.5 * m)
+	{
+		if (zeros > 0)
+			estimate = m * log(m / zeros);
+	}
+	else if (estimate > TWO_POW_32 / 30.0)
+	{
+		if (estimate >= TWO_POW_32)
+			estimate = TWO_POW_32;
+		else
+			estimate = -TWO_POW_32 * log(1.0 - estimate / TWO_POW_32);
+	}
+
+	return estimate;
+}
+
+/*
+ * hll_hash_proc
+ *		Returns the hash function of the default hash opclass of a type, or
+ *		InvalidOid if the type has none.
+ */
+Oid
+hll_hash_proc(Oid typid)
+{
+	Oid			opclass = GetDefaultOpClass(typid, HASH_AM_OID);
+	Oid			opintype;
+
+	if (!OidIsValid(opclass))
+		return InvalidOid;
+
+	opintype = get_opclass_input_type(opclass);
+
+	return get_opfamily_proc(get_opclass_family(opclass), opintype, opintype,
+							 HASHPROC);
+}
+
+/*
+ * hll_hash_datum
+ *		Hashes a value with the function found by hll_hash_proc().
+ *
+ * Everything that adds values to sketches which may be merged must hash
+ * them with this.
+ */
+uint32
+hll_hash_datum(FmgrInfo *hashproc, Datum value)
+{
+	return DatumGetUInt32(FunctionCall1(hashproc, value));
+}
+
+/*
+ * gp_hll_accum
+ *		Transition function of gp_hll_sketch(anyelement).
+ *
+ * The state starts out as an empty bytea and is updated in place, like
+ * the bytea states of the avg() aggregates.
+ */
+Datum
+gp_hll_accum(PG_FUNCTION_ARGS)
+{
+	HLLSketch  *sketch = (HLLSketch *) PG_GETARG_BYTEA_P(0);
+	Datum		value = PG_GETARG_DATUM(1);
+	FmgrInfo   *hashproc = (FmgrInfo *) fcinfo->flinfo->fn_extra;
+
+	if (!(fcinfo->context && IS_AGG_EXECUTION_NODE(fcinfo->context)))
+		elog(ERROR, "gp_hll_accum called in non-aggregate context");
+
+	if (hashproc == NULL)
+	{
+		Oid			typid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+		Oid			procid;
+
+		if (!OidIsValid(typid))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("could not determine input data type")));
+
+		procid = hll_hash_proc(typid);
+		if (!OidIsValid(procid))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("could not identify a hash function for type %s",
+							format_type_be(typid))));
+
+		hashproc = (FmgrInfo *) MemoryContextAlloc(fcinfo->flinfo->fn_mcxt,
+												   sizeof(FmgrInfo));
+		fmgr_info_cxt(procid, hashproc, fcinfo->flinfo->fn_mcxt);
+		fcinfo->flinfo->fn_extra = hashproc;
+	}
+
+	if (!hll_is_valid(sketch))
+		sketch = hll_create();
+
+	hll_add_hash(sketch, hll_hash_datum(hashproc, value));
+
+	PG_RETURN_BYTEA_P(sketch);
+}
+
+/*
+ * gp_hll_merge
+ *		Preliminary function of gp_hll_sketch(anyelement): merges the
+ *		sketches built on the segments.
+ */
+Datum
+gp_hll_merge(PG_FUNCTION_ARGS)
+{
+	HLLSketch  *sketch = (HLLSketch *) PG_GETARG_BYTEA_P(0);
+	HLLSketch  *other = (HLLSketch *) PG_GETARG_BYTEA_P(1);
+
+	if (!(fcinfo->context && IS_AGG_EXECUTION_NODE(fcinfo->context)))
+		elog(ERROR, "gp_hll_merge called in non-aggregate context");
+
+	if (!hll_is_valid(other))
+		PG_RETURN_BYTEA_P(sketch);
+
+	if (!hll_is_valid(sketch))
+		sketch = hll_create();
+
+	hll_merge(sketch, other);
+
+	PG_RETURN_BYTEA_P(sketch);
+}
+
+/*
+ * gp_hll_estimate
+ *		Returns the estimated number of distinct values of a sketch.
+ */
+Datum
+gp_hll_estimate(PG_FUNCTION_ARGS)
+{
+	HLLSketch  *sketch = (HLLSketch *) PG_GETARG_BYTEA_P(0);
+
+	if (!hll_is_valid(sketch))
+		PG_RETURN_FLOAT8(0.0);
+
+	PG_RETURN_FLOAT8(hll_estimate(sketch));
+}
+
+/*
+ * gp_hll_count
+ *		Final function of gp_approx_count_distinct(anyelement): the
+ *		estimate of gp_hll_estimate, rounded to a count.
+ */
+Datum
+gp_hll_count(PG_FUNCTION_ARGS)
+{
+	HLLSketch  *sketch = (HLLSketch *) PG_GETARG_BYTEA_P(0);
+
+	if (!hll_is_valid(sketch))
+		PG_RETURN_INT64(0);
+
+	PG_RETURN_INT64((int64) rint(hll_estimate(sketch)));
+}
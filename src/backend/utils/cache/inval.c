@@ -536,7 +536,8 @@ LocalExecuteInvalidationMessage(SharedInvalidationMessage *msg)
 
 				if (ccitem->id == msg->cc.id)
 					(*ccitem->function) (ccitem->arg,
-										 msg->cc.id, &msg->cc.tuplePtr);
+										 msg->cc.id, &msg->cc.tuplePtr,
+										 msg->cc.hashValue);
 			}
 		}
 	}
@@ -594,7 +595,7 @@ InvalidateSystemCaches(void)
 	{
 		struct SYSCACHECALLBACK *ccitem = syscache_callback_list + i;
 
-		(*ccitem->function) (ccitem->arg, ccitem->id, NULL);
+		(*ccitem->function) (ccitem->arg, ccitem->id, NULL, 0);
 	}
 
 	for (i = 0; i < relcache_callback_count; i++)
@@ -1283,8 +1284,10 @@ CacheInvalidateRelcacheByRelid(Oid relid)
 /*
  * CacheRegisterSyscacheCallback
  *		Register the specified function to be called for all future
- *		invalidation events in the specified cache.  The cache ID and the
- *		TID of the tuple being invalidated will be passed to the function.
+ *		invalidation events in the specified cache.  The cache ID, the
+ *		TID of the tuple being invalidated and the hash value of its cache
+ *		keys will be passed to the function.  The hash value can be matched
+ *		against GetSysCacheHashValue() to tell which cached object changed.
  *
  * NOTE: NULL will be passed for the TID if a cache reset request is received.
  * In this case the called routines should flush all cached state.
@@ -0,0 +1,1014 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.c
+ *	  Shared cache of plans produced by the GPORCA optimizer.
+ *
+ * Optimizing a complex query with GPORCA can take much longer than
+ * executing it, and reporting tools tend to send the same queries over and
+ * over again, from many sessions. This module keeps the PlannedStmts that
+ * GPORCA produced in shared memory, so that any session of the same
+ * database can reuse them.
+ *
+ * A plan is looked up by the analyzed Query tree, which has all names
+ * resolved to OIDs, together with the types and values of the bound
+ * parameters, a fingerprint of the settings of the GUCs that are sent to the
+ * segments (which include all the optimizer GUCs), the number of segments
+ * and the catalog version. The full key is stored along with the plan, so a
+ * hash collision cannot return the wrong plan.
+ *
+ * Stable functions, like now() and current_user, are folded to constants
+ * before the query is handed to GPORCA, so their values end up in the plan.
+ * Queries that call any function that isn't immutable are therefore not
+ * cached at all.
+ *
+ * Cached plans are invalidated like the plans of plancache.c: on relcache
+ * invalidation events for the relations they use, and on pg_proc syscache
+ * invalidation events for the functions they depend on. Changes to
+ * pg_namespace, pg_operator and pg_amop drop all the plans of the
+ * database. Every backend applies the invalidation events it receives to the
+ * shared cache. A backend that missed some events (because of an overflow
+ * of the shared invalidation queue) doesn't know what they were, so it
+ * drops all the plans of its database.
+ *
+ * Since every backend receives every event, only the first one to apply it
+ * finds anything to drop. To keep the others from scanning the whole cache,
+ * a second hash table counts the plans that depend on each relation, each
+ * function, and each database; an event with no entry there is ignored.
+ *
+ * A transaction that has changed the catalogs sees them differently from
+ * everybody else until it commits, so it neither uses the cached plans nor
+ * adds to them. Changing the catalogs assigns a transaction ID, so that is
+ * what we test.
+ *
+ * A backend could have optimized a query using catalog contents that were
+ * changed while it was optimizing. Before inserting a plan, we therefore
+ * process any pending invalidation events, and skip the insertion if there
+ * were relevant ones since the lookup.
+ *
+ * Plans are stored in serialized form, in a chain of fixed-size chunks
+ * carved out of a shared memory area of optimizer_plan_cache_size kilobytes.
+ * When there isn't enough free space for a new plan, the least recently
+ * used plans are evicted. The whole cache is protected by OptPlanCacheLock;
+ * lookups only take it in shared mode, and update the LRU clock and the
+ * statistics they touch under a spinlock.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/heapam.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/catversion.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbsrlz.h"
+#include "cdb/cdbutil.h"
+#include "cdb/cdbvars.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "optimizer/clauses.h"
+#include "optimizer/walkers.h"
+#include "portability/instr_time.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/lsyscache.h"
+#include "utils/optplancache.h"
+#include "utils/syscache.h"
+
+#define OPT_PLAN_CACHE_CHUNK_SIZE		8192
+
+/* plans that depend on more objects than this are not cached */
+#define OPT_PLAN_CACHE_MAX_RELATIONS	64
+#define OPT_PLAN_CACHE_MAX_INVAL_ITEMS	64
+
+/* expected number of dependencies per plan, to size the dependency table */
+#define OPT_PLAN_CACHE_DEPS_PER_PLAN	16
+
+/* cacheId of the dependencies on a relation, and on the whole database */
+#define OPT_PLAN_CACHE_DEP_RELATION		(-1)
+#define OPT_PLAN_CACHE_DEP_DATABASE		(-2)
+
+typedef struct OptPlanCacheKey
+{
+	Oid			dbid;
+	uint32		keyHash;		/* hash of the full key */
+} OptPlanCacheKey;
+
+typedef struct OptPlanCacheInvalItem
+{
+	int			cacheId;
+	ItemPointerData tupleId;
+} OptPlanCacheInvalItem;
+
+typedef struct OptPlanCacheEntry
+{
+	OptPlanCacheKey key;		/* hash key, must be first */
+
+	int			firstChunk;		/* chunks holding the key and the plan */
+	int			numChunks;
+	int			keyLen;
+	int			planLen;		/* length of the serialized plan */
+
+	uint64		lastUsed;		/* value of the LRU clock at last use */
+	double		optimizeMs;		/* time it took to produce the plan */
+
+	int			numRelationOids;
+	Oid			relationOids[OPT_PLAN_CACHE_MAX_RELATIONS];
+	int			numInvalItems;
+	OptPlanCacheInvalItem invalItems[OPT_PLAN_CACHE_MAX_INVAL_ITEMS];
+} OptPlanCacheEntry;
+
+/*
+ * Something that cached plans depend on: a relation, a syscache entry, or
+ * (for invalidation events that drop everything) the database itself.
+ */
+typedef struct OptPlanCacheDepKey
+{
+	Oid			dbid;
+	int			cacheId;		/* syscache, or OPT_PLAN_CACHE_DEP_* */
+	Oid			relid;			/* for OPT_PLAN_CACHE_DEP_RELATION */
+	ItemPointerData tupleId;	/* for syscache entries */
+} OptPlanCacheDepKey;
+
+typedef struct OptPlanCacheDep
+{
+	OptPlanCacheDepKey key;		/* hash key, must be first */
+	int			refCount;		/* number of plans with this dependency */
+} OptPlanCacheDep;
+
+typedef struct OptPlanCacheShared
+{
+	int			numChunks;
+	int			numFreeChunks;
+	int			firstFreeChunk;
+
+	slock_t		mutex;			/* protects the fields below it */
+	uint64		clock;			/* LRU clock, advanced on every use */
+	int64		lookups;
+	int64		hits;
+	double		savedMs;		/* optimization time saved by the hits */
+
+	/* these are protected by OptPlanCacheLock */
+	int64		inserts;
+	int64		evictions;
+	int64		invalidations;
+} OptPlanCacheShared;
+
+static OptPlanCacheShared *OptPlanCache = NULL;
+static int *OptPlanCacheChunkNext = NULL;
+static char *OptPlanCacheChunks = NULL;
+static HTAB *OptPlanCacheHash = NULL;
+static HTAB *OptPlanCacheDepHash = NULL;
+
+/*
+ * Number of relevant invalidation events this backend has applied to the
+ * cache, to detect catalog changes during an optimization.
+ */
+static uint64 localGeneration = 0;
+
+static bool OptPlanCacheSubqueryWalker(Node *node, void *context);
+
+static int
+OptPlanCacheNumChunks(void)
+{
+	/* plans are only made on the master */
+	if (Gp_role != GP_ROLE_DISPATCH)
+		return 0;
+
+	return (int) Min((int64) optimizer_plan_cache_size * 1024L / OPT_PLAN_CACHE_CHUNK_SIZE,
+					 INT_MAX / OPT_PLAN_CACHE_CHUNK_SIZE);
+}
+
+/*
+ * Report shared-memory space needed by OptPlanCacheShmemInit.
+ */
+Size
+OptPlanCacheShmemSize(void)
+{
+	int			numChunks = OptPlanCacheNumChunks();
+	Size		size;
+
+	if (numChunks <= 0)
+		return 0;
+
+	size = MAXALIGN(sizeof(OptPlanCacheShared));
+	size = add_size(size, MAXALIGN(mul_size(numChunks, sizeof(int))));
+	size = add_size(size, mul_size(numChunks, OPT_PLAN_CACHE_CHUNK_SIZE));
+	size = add_size(size, hash_estimate_size(numChunks, sizeof(OptPlanCacheEntry)));
+	size = add_size(size, hash_estimate_size(mul_size(numChunks, OPT_PLAN_CACHE_DEPS_PER_PLAN),
+											 sizeof(OptPlanCacheDep)));
+
+	return size;
+}
+
+/*
+ * Initialize the shared plan cache.
+ */
+void
+OptPlanCacheShmemInit(void)
+{
+	int			numChunks = OptPlanCacheNumChunks();
+	HASHCTL		info;
+	bool		found;
+	char	   *ptr;
+
+	if (numChunks <= 0)
+		return;
+
+	ptr = ShmemInitStruct("Optimizer Plan Cache",
+						  MAXALIGN(sizeof(OptPlanCacheShared)) +
+						  MAXALIGN(numChunks * sizeof(int)) +
+						  (Size) numChunks * OPT_PLAN_CACHE_CHUNK_SIZE,
+						  &found);
+	OptPlanCache = (OptPlanCacheShared *) ptr;
+	ptr += MAXALIGN(sizeof(OptPlanCacheShared));
+	OptPlanCacheChunkNext = (int *) ptr;
+	ptr += MAXALIGN(numChunks * sizeof(int));
+	OptPlanCacheChunks = ptr;
+
+	if (!found)
+	{
+		int			i;
+
+		MemSet(OptPlanCache, 0, sizeof(OptPlanCacheShared));
+		OptPlanCache->numChunks = numChunks;
+		OptPlanCache->numFreeChunks = numChunks;
+		OptPlanCache->firstFreeChunk = 0;
+		SpinLockInit(&OptPlanCache->mutex);
+		for (i = 0; i < numChunks; i++)
+			OptPlanCacheChunkNext[i] = (i + 1 < numChunks) ? i + 1 : -1;
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(OptPlanCacheKey);
+	info.entrysize = sizeof(OptPlanCacheEntry);
+	info.hash = tag_hash;
+	OptPlanCacheHash = ShmemInitHash("Optimizer Plan Cache Hash",
+									 numChunks, numChunks,
+									 &info,
+									 HASH_ELEM | HASH_FUNCTION);
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(OptPlanCacheDepKey);
+	info.entrysize = sizeof(OptPlanCacheDep);
+	info.hash = tag_hash;
+	OptPlanCacheDepHash = ShmemInitHash("Optimizer Plan Cache Dependencies",
+										numChunks,
+										numChunks * OPT_PLAN_CACHE_DEPS_PER_PLAN,
+										&info,
+										HASH_ELEM | HASH_FUNCTION);
+}
+
+/*
+ * Is the cache in use in this backend?
+ */
+static bool
+OptPlanCacheEnabled(void)
+{
+	return OptPlanCache != NULL && optimizer_enable_plan_cache &&
+		Gp_role == GP_ROLE_DISPATCH;
+}
+
+/*
+ * The dependencies of a plan are the database, then its relations, then its
+ * invalidation items. Fill in the n'th one.
+ */
+static int
+OptPlanCacheNumDeps(OptPlanCacheEntry *entry)
+{
+	return 1 + entry->numRelationOids + entry->numInvalItems;
+}
+
+static void
+OptPlanCacheGetDep(OptPlanCacheEntry *entry, int n, OptPlanCacheDepKey *dkey)
+{
+	MemSet(dkey, 0, sizeof(OptPlanCacheDepKey));
+	dkey->dbid = entry->key.dbid;
+
+	if (n == 0)
+		dkey->cacheId = OPT_PLAN_CACHE_DEP_DATABASE;
+	else if (n <= entry->numRelationOids)
+	{
+		dkey->cacheId = OPT_PLAN_CACHE_DEP_RELATION;
+		dkey->relid = entry->relationOids[n - 1];
+	}
+	else
+	{
+		OptPlanCacheInvalItem *item;
+
+		item = &entry->invalItems[n - 1 - entry->numRelationOids];
+		dkey->cacheId = item->cacheId;
+		dkey->tupleId = item->tupleId;
+	}
+}
+
+/*
+ * Forget the first n dependencies of a plan. Caller must hold
+ * OptPlanCacheLock exclusively.
+ */
+static void
+OptPlanCacheDropDeps(OptPlanCacheEntry *entry, int n)
+{
+	int			i;
+
+	for (i = 0; i < n; i++)
+	{
+		OptPlanCacheDepKey dkey;
+		OptPlanCacheDep *dep;
+
+		OptPlanCacheGetDep(entry, i, &dkey);
+		dep = (OptPlanCacheDep *) hash_search(OptPlanCacheDepHash, &dkey,
+											  HASH_FIND, NULL);
+		Assert(dep != NULL && dep->refCount > 0);
+		if (dep != NULL && --dep->refCount == 0)
+			hash_search(OptPlanCacheDepHash, &dkey, HASH_REMOVE, NULL);
+	}
+}
+
+/*
+ * Record the dependencies of a plan. Returns false, having recorded none of
+ * them, if the dependency table is full. Caller must hold OptPlanCacheLock
+ * exclusively.
+ */
+static bool
+OptPlanCacheAddDeps(OptPlanCacheEntry *entry)
+{
+	int			n = OptPlanCacheNumDeps(entry);
+	int			i;
+
+	for (i = 0; i < n; i++)
+	{
+		OptPlanCacheDepKey dkey;
+		OptPlanCacheDep *dep;
+		bool		found;
+
+		OptPlanCacheGetDep(entry, i, &dkey);
+		dep = (OptPlanCacheDep *) hash_search(OptPlanCacheDepHash, &dkey,
+											  HASH_ENTER_NULL, &found);
+		if (dep == NULL)
+		{
+			OptPlanCacheDropDeps(entry, i);
+			return false;
+		}
+		if (!found)
+			dep->refCount = 0;
+		dep->refCount++;
+	}
+
+	return true;
+}
+
+/*
+ * Drop a plan from the cache. Caller must hold OptPlanCacheLock exclusively.
+ */
+static void
+OptPlanCacheRemove(OptPlanCacheEntry *entry)
+{
+	int			last = entry->firstChunk;
+
+	OptPlanCacheDropDeps(entry, OptPlanCacheNumDeps(entry));
+
+	while (OptPlanCacheChunkNext[last] != -1)
+		last = OptPlanCacheChunkNext[last];
+	OptPlanCacheChunkNext[last] = OptPlanCache->firstFreeChunk;
+	OptPlanCache->firstFreeChunk = entry->firstChunk;
+	OptPlanCache->numFreeChunks += entry->numChunks;
+
+	hash_search(OptPlanCacheHash, &entry->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * Evict the least recently used plan. Caller must hold OptPlanCacheLock
+ * exclusively.
+ */
+static bool
+OptPlanCacheEvictOne(void)
+{
+	HASH_SEQ_STATUS status;
+	OptPlanCacheEntry *entry;
+	OptPlanCacheEntry *victim = NULL;
+
+	hash_seq_init(&status, OptPlanCacheHash);
+	while ((entry = (OptPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (victim == NULL || entry->lastUsed < victim->lastUsed)
+			victim = entry;
+	}
+
+	if (victim == NULL)
+		return false;
+
+	OptPlanCacheRemove(victim);
+	OptPlanCache->evictions++;
+	return true;
+}
+
+/*
+ * Copy data into, or out of, the chunks of an entry, starting at offset.
+ */
+static void
+OptPlanCacheCopyChunks(OptPlanCacheEntry *entry, int offset, char *data,
+					   int len, bool store)
+{
+	int			chunk = entry->firstChunk;
+
+	while (offset >= OPT_PLAN_CACHE_CHUNK_SIZE)
+	{
+		chunk = OptPlanCacheChunkNext[chunk];
+		offset -= OPT_PLAN_CACHE_CHUNK_SIZE;
+	}
+
+	while (len > 0)
+	{
+		char	   *chunkData = OptPlanCacheChunks +
+			(Size) chunk * OPT_PLAN_CACHE_CHUNK_SIZE + offset;
+		int			n = Min(len, OPT_PLAN_CACHE_CHUNK_SIZE - offset);
+
+		if (store)
+			memcpy(chunkData, data, n);
+		else
+			memcpy(data, chunkData, n);
+
+		data += n;
+		len -= n;
+		offset = 0;
+		chunk = OptPlanCacheChunkNext[chunk];
+	}
+}
+
+/*
+ * Does the key of a cached plan match the given key?
+ */
+static bool
+OptPlanCacheKeyMatches(OptPlanCacheEntry *entry, const char *key, int keyLen)
+{
+	char	   *storedKey;
+	bool		result;
+
+	if (entry->keyLen != keyLen)
+		return false;
+
+	storedKey = palloc(keyLen);
+	OptPlanCacheCopyChunks(entry, 0, storedKey, keyLen, false);
+	result = (memcmp(storedKey, key, keyLen) == 0);
+	pfree(storedKey);
+
+	return result;
+}
+
+/*
+ * Fingerprint of the settings that can change the plan of a query.
+ */
+static uint32
+OptPlanCacheGucFingerprint(void)
+{
+	struct config_generic **gucs = get_guc_variables();
+	int			ngucs = get_num_guc_variables();
+	StringInfoData buf;
+	uint32		result;
+	int			i;
+
+	initStringInfo(&buf);
+	for (i = 0; i < ngucs; i++)
+	{
+		struct config_generic *guc = gucs[i];
+
+		if (!(guc->flags & GUC_GPDB_ADDOPT))
+			continue;
+
+		switch (guc->vartype)
+		{
+			case PGC_BOOL:
+				appendStringInfo(&buf, "%s=%d;", guc->name,
+								 (int) *((struct config_bool *) guc)->variable);
+				break;
+			case PGC_INT:
+				appendStringInfo(&buf, "%s=%d;", guc->name,
+								 *((struct config_int *) guc)->variable);
+				break;
+			case PGC_REAL:
+				appendStringInfo(&buf, "%s=%g;", guc->name,
+								 *((struct config_real *) guc)->variable);
+				break;
+			case PGC_STRING:
+				{
+					const char *str = *((struct config_string *) guc)->variable;
+
+					appendStringInfo(&buf, "%s=%s;", guc->name, str ? str : "");
+					break;
+				}
+		}
+	}
+
+	result = DatumGetUInt32(hash_any((unsigned char *) buf.data, buf.len));
+	pfree(buf.data);
+
+	return result;
+}
+
+/*
+ * Does a query, or any of its sub-queries, call a function that isn't
+ * immutable?
+ */
+static bool
+OptPlanCacheMutableWalker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Query))
+		return query_tree_walker((Query *) node, OptPlanCacheMutableWalker,
+								 context, 0);
+
+	if (contain_mutable_functions(node))
+		return true;
+
+	/* contain_mutable_functions() doesn't look into sub-queries */
+	return OptPlanCacheSubqueryWalker(node, context);
+}
+
+static bool
+OptPlanCacheSubqueryWalker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Query))
+		return OptPlanCacheMutableWalker(node, context);
+
+	return expression_tree_walker(node, OptPlanCacheSubqueryWalker, context);
+}
+
+/*
+ * Build the key to look up the plan of a query.
+ *
+ * Returns NULL if plans of the query are not cached. Only plain SELECTs are;
+ * the plans of other statements carry state that isn't serialized. Nor are
+ * the plans of queries that call stable or volatile functions, which would
+ * be folded into the plan, nor are plans cached, or looked up, in a
+ * transaction that may have changed the catalogs.
+ */
+char *
+OptPlanCacheBuildKey(Query *parse, ParamListInfo boundParams, int *keyLen)
+{
+	StringInfoData buf;
+	char	   *queryStr;
+
+	if (!OptPlanCacheEnabled())
+		return NULL;
+
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return NULL;
+
+	if (parse->commandType != CMD_SELECT ||
+		parse->utilityStmt != NULL ||
+		parse->intoClause != NULL ||
+		parse->rowMarks != NIL)
+		return NULL;
+
+	if (OptPlanCacheMutableWalker((Node *) parse, NULL))
+		return NULL;
+
+	initStringInfo(&buf);
+
+	queryStr = nodeToString(parse);
+	appendStringInfoString(&buf, queryStr);
+	pfree(queryStr);
+
+	if (boundParams != NULL)
+	{
+		int			i;
+
+		for (i = 0; i < boundParams->numParams; i++)
+		{
+			ParamExternData *prm = &boundParams->params[i];
+
+			appendStringInfo(&buf, " $%d:%u", i + 1, prm->ptype);
+			if (prm->isnull || !OidIsValid(prm->ptype))
+				appendStringInfoString(&buf, ":null");
+			else
+			{
+				int16		typLen;
+				bool		typByVal;
+				Size		len;
+
+				get_typlenbyval(prm->ptype, &typLen, &typByVal);
+				appendStringInfoChar(&buf, ':');
+				if (typByVal)
+					appendBinaryStringInfo(&buf, (char *) &prm->value,
+										   sizeof(Datum));
+				else
+				{
+					len = datumGetSize(prm->value, typByVal, typLen);
+					appendBinaryStringInfo(&buf, DatumGetPointer(prm->value),
+										   (int) len);
+				}
+			}
+		}
+	}
+
+	appendStringInfo(&buf, " gucs:%08x segments:%d catversion:%d",
+					 OptPlanCacheGucFingerprint(), getgpsegmentCount(),
+					 CATALOG_VERSION_NO);
+
+	*keyLen = buf.len;
+	return buf.data;
+}
+
+/*
+ * Look up the plan of a query, by the key from OptPlanCacheBuildKey().
+ *
+ * Returns a copy of the plan, or NULL if it's not cached. On a miss,
+ * *generation is set to the value to pass to OptPlanCacheInsert().
+ */
+PlannedStmt *
+OptPlanCacheLookup(const char *key, int keyLen, uint64 *generation)
+{
+	OptPlanCacheKey hkey;
+	OptPlanCacheEntry *entry;
+	PlannedStmt *plan = NULL;
+	char	   *planData = NULL;
+	int			planLen = 0;
+	List	   *invalItems = NIL;
+
+	*generation = localGeneration;
+
+	MemSet(&hkey, 0, sizeof(hkey));
+	hkey.dbid = MyDatabaseId;
+	hkey.keyHash = DatumGetUInt32(hash_any((const unsigned char *) key, keyLen));
+
+	LWLockAcquire(OptPlanCacheLock, LW_SHARED);
+
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hkey,
+											  HASH_FIND, NULL);
+	if (entry != NULL && OptPlanCacheKeyMatches(entry, key, keyLen))
+	{
+		int			i;
+
+		planLen = entry->planLen;
+		planData = palloc(planLen);
+		OptPlanCacheCopyChunks(entry, entry->keyLen, planData, planLen, false);
+
+		/* the invalidation items are not serialized with the plan */
+		for (i = 0; i < entry->numInvalItems; i++)
+		{
+			PlanInvalItem *item = makeNode(PlanInvalItem);
+
+			item->cacheId = entry->invalItems[i].cacheId;
+			item->tupleId = entry->invalItems[i].tupleId;
+			invalItems = lappend(invalItems, item);
+		}
+	}
+
+	SpinLockAcquire(&OptPlanCache->mutex);
+	OptPlanCache->lookups++;
+	if (planData != NULL)
+	{
+		entry->lastUsed = ++OptPlanCache->clock;
+		OptPlanCache->hits++;
+		OptPlanCache->savedMs += entry->optimizeMs;
+	}
+	SpinLockRelease(&OptPlanCache->mutex);
+
+	LWLockRelease(OptPlanCacheLock);
+
+	if (planData != NULL)
+	{
+		plan = (PlannedStmt *) deserializeNode(planData, planLen);
+		plan->invalItems = invalItems;
+		pfree(planData);
+	}
+
+	return plan;
+}
+
+/*
+ * Store the plan of a query in the cache.
+ *
+ * generation is the value returned by the OptPlanCacheLookup() call that
+ * missed. If any relevant catalog change has been seen since then, the plan
+ * may be stale, and is not stored.
+ */
+void
+OptPlanCacheInsert(const char *key, int keyLen, PlannedStmt *plan,
+				   double optimizeMs, uint64 generation)
+{
+	OptPlanCacheKey hkey;
+	OptPlanCacheEntry *entry;
+	OptPlanCacheEntry deps;
+	char	   *planData;
+	int			planLen;
+	int			numChunks;
+	ListCell   *lc;
+	bool		found;
+	int			i;
+
+	if (plan->transientPlan || plan->intoPolicy != NULL)
+		return;
+
+	/* the catalogs this plan was made from may not be committed */
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return;
+
+	/* collect the dependencies, and give up if there are too many */
+	deps.numRelationOids = 0;
+	foreach(lc, plan->relationOids)
+	{
+		Oid			relid = lfirst_oid(lc);
+
+		for (i = 0; i < deps.numRelationOids; i++)
+		{
+			if (deps.relationOids[i] == relid)
+				break;
+		}
+		if (i < deps.numRelationOids)
+			continue;
+		if (deps.numRelationOids == OPT_PLAN_CACHE_MAX_RELATIONS)
+			return;
+		deps.relationOids[deps.numRelationOids++] = relid;
+	}
+
+	deps.numInvalItems = 0;
+	foreach(lc, plan->invalItems)
+	{
+		PlanInvalItem *item = (PlanInvalItem *) lfirst(lc);
+
+		if (deps.numInvalItems == OPT_PLAN_CACHE_MAX_INVAL_ITEMS)
+			return;
+		deps.invalItems[deps.numInvalItems].cacheId = item->cacheId;
+		deps.invalItems[deps.numInvalItems].tupleId = item->tupleId;
+		deps.numInvalItems++;
+	}
+
+	/*
+	 * Apply the catalog changes that were committed while we were
+	 * optimizing. If there were any, the plan may have been made with stale
+	 * metadata.
+	 */
+	AcceptInvalidationMessages();
+	if (localGeneration != generation)
+		return;
+
+	planData = serializeNode((Node *) plan, &planLen, NULL);
+
+	numChunks = (keyLen + planLen + OPT_PLAN_CACHE_CHUNK_SIZE - 1) / OPT_PLAN_CACHE_CHUNK_SIZE;
+	if (numChunks > OptPlanCache->numChunks / 4)
+	{
+		/* don't let a single plan take over the cache */
+		pfree(planData);
+		return;
+	}
+
+	MemSet(&hkey, 0, sizeof(hkey));
+	hkey.dbid = MyDatabaseId;
+	hkey.keyHash = DatumGetUInt32(hash_any((const unsigned char *) key, keyLen));
+
+	LWLockAcquire(OptPlanCacheLock, LW_EXCLUSIVE);
+
+	/* another backend may have stored the plan meanwhile; replace it */
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hkey,
+											  HASH_FIND, NULL);
+	if (entry != NULL)
+		OptPlanCacheRemove(entry);
+
+	while (OptPlanCache->numFreeChunks < numChunks)
+	{
+		if (!OptPlanCacheEvictOne())
+			break;
+	}
+
+	entry = NULL;
+	if (OptPlanCache->numFreeChunks >= numChunks)
+		entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hkey,
+												  HASH_ENTER_NULL, &found);
+	if (entry != NULL)
+	{
+		entry->numRelationOids = deps.numRelationOids;
+		memcpy(entry->relationOids, deps.relationOids,
+			   deps.numRelationOids * sizeof(Oid));
+		entry->numInvalItems = deps.numInvalItems;
+		memcpy(entry->invalItems, deps.invalItems,
+			   deps.numInvalItems * sizeof(OptPlanCacheInvalItem));
+
+		/* a plan that invalidation can't find must not be stored */
+		if (!OptPlanCacheAddDeps(entry))
+		{
+			hash_search(OptPlanCacheHash, &hkey, HASH_REMOVE, NULL);
+			entry = NULL;
+		}
+	}
+	if (entry != NULL)
+	{
+		int			last = -1;
+
+		/* take the chunks off the free list */
+		entry->firstChunk = OptPlanCache->firstFreeChunk;
+		for (i = 0; i < numChunks; i++)
+		{
+			last = OptPlanCache->firstFreeChunk;
+			OptPlanCache->firstFreeChunk = OptPlanCacheChunkNext[last];
+		}
+		OptPlanCacheChunkNext[last] = -1;
+		OptPlanCache->numFreeChunks -= numChunks;
+
+		entry->numChunks = numChunks;
+		entry->keyLen = keyLen;
+		entry->planLen = planLen;
+		SpinLockAcquire(&OptPlanCache->mutex);
+		entry->lastUsed = ++OptPlanCache->clock;
+		SpinLockRelease(&OptPlanCache->mutex);
+		entry->optimizeMs = optimizeMs;
+
+		OptPlanCacheCopyChunks(entry, 0, (char *) key, keyLen, true);
+		OptPlanCacheCopyChunks(entry, keyLen, planData, planLen, true);
+
+		OptPlanCache->inserts++;
+	}
+
+	LWLockRelease(OptPlanCacheLock);
+
+	pfree(planData);
+}
+
+/*
+ * Drop the plans of the current database that match a relcache or syscache
+ * invalidation event. With relid and cacheId both invalid, all of them.
+ */
+static void
+OptPlanCacheInvalidate(Oid relid, int cacheId, ItemPointer tuplePtr)
+{
+	HASH_SEQ_STATUS status;
+	OptPlanCacheEntry *entry;
+	OptPlanCacheDepKey dkey;
+	bool		all = !OidIsValid(relid) && cacheId < 0;
+	bool		found;
+
+	localGeneration++;
+
+	MemSet(&dkey, 0, sizeof(dkey));
+	dkey.dbid = MyDatabaseId;
+	if (all)
+		dkey.cacheId = OPT_PLAN_CACHE_DEP_DATABASE;
+	else if (OidIsValid(relid))
+	{
+		dkey.cacheId = OPT_PLAN_CACHE_DEP_RELATION;
+		dkey.relid = relid;
+	}
+	else
+	{
+		dkey.cacheId = cacheId;
+		dkey.tupleId = *tuplePtr;
+	}
+
+	/* nothing to do if no plan depends on it (anymore) */
+	LWLockAcquire(OptPlanCacheLock, LW_SHARED);
+	found = (hash_search(OptPlanCacheDepHash, &dkey, HASH_FIND, NULL) != NULL);
+	LWLockRelease(OptPlanCacheLock);
+	if (!found)
+		return;
+
+	LWLockAcquire(OptPlanCacheLock, LW_EXCLUSIVE);
+
+	hash_seq_init(&status, OptPlanCacheHash);
+	while ((entry = (OptPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		bool		match = all;
+		int			i;
+
+		if (entry->key.dbid != MyDatabaseId)
+			continue;
+
+		for (i = 0; !match && i < entry->numRelationOids; i++)
+			match = (entry->relationOids[i] == relid);
+
+		for (i = 0; !match && i < entry->numInvalItems; i++)
+			match = (entry->invalItems[i].cacheId == cacheId &&
+					 ItemPointerEquals(&entry->invalItems[i].tupleId, tuplePtr));
+
+		if (match)
+		{
+			OptPlanCacheRemove(entry);
+			OptPlanCache->invalidations++;
+		}
+	}
+
+	LWLockRelease(OptPlanCacheLock);
+}
+
+/*
+ * Relcache inval callback: drop the plans using the relation. InvalidOid
+ * means that we missed some events, so drop everything.
+ */
+static void
+OptPlanCacheRelCallback(Datum arg, Oid relid)
+{
+	OptPlanCacheInvalidate(relid, -1, NULL);
+}
+
+/*
+ * pg_proc syscache inval callback: drop the plans depending on the function.
+ */
+static void
+OptPlanCacheFuncCallback(Datum arg, int cacheid, ItemPointer tuplePtr,
+						 uint32 hashValue)
+{
+	if (tuplePtr == NULL)
+		OptPlanCacheInvalidate(InvalidOid, -1, NULL);
+	else
+		OptPlanCacheInvalidate(InvalidOid, cacheid, tuplePtr);
+}
+
+/*
+ * Syscache inval callback for the catalogs we don't track in detail: drop
+ * all plans of the database.
+ */
+static void
+OptPlanCacheSysCallback(Datum arg, int cacheid, ItemPointer tuplePtr,
+						uint32 hashValue)
+{
+	OptPlanCacheInvalidate(InvalidOid, -1, NULL);
+}
+
+/*
+ * InitOptPlanCache: initialize module during InitPostgres.
+ *
+ * Like InitPlanCache, we hook into inval.c's callback lists, if there is a
+ * shared cache to maintain.
+ */
+void
+InitOptPlanCache(void)
+{
+	if (OptPlanCache == NULL)
+		return;
+
+	CacheRegisterRelcacheCallback(OptPlanCacheRelCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(PROCOID, OptPlanCacheFuncCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(NAMESPACEOID, OptPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(OPEROID, OptPlanCacheSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(AMOPOPID, OptPlanCacheSysCallback, (Datum) 0);
+}
+
+/*
+ * Return the statistics of the shared plan cache.
+ */
+Datum
+gp_opt_plan_cache_stats(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	HeapTuple	tuple;
+	Datum		values[9];
+	bool		isnull[9];
+
+	/* this must match the function's pg_proc entry */
+	tupdesc = CreateTemplateTupleDesc(9, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "lookups", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "hits", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "inserts", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "evictions", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "invalidations", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "entries", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "used_bytes", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "size_bytes", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "saved_time_ms", FLOAT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(values, 0, sizeof(values));
+	MemSet(isnull, false, sizeof(isnull));
+
+	if (OptPlanCache != NULL)
+	{
+		LWLockAcquire(OptPlanCacheLock, LW_SHARED);
+		SpinLockAcquire(&OptPlanCache->mutex);
+		values[0] = Int64GetDatum(OptPlanCache->lookups);
+		values[1] = Int64GetDatum(OptPlanCache->hits);
+		values[8] = Float8GetDatum(OptPlanCache->savedMs);
+		SpinLockRelease(&OptPlanCache->mutex);
+		values[2] = Int64GetDatum(OptPlanCache->inserts);
+		values[3] = Int64GetDatum(OptPlanCache->evictions);
+		values[4] = Int64GetDatum(OptPlanCache->invalidations);
+		values[5] = Int64GetDatum((int64) hash_get_num_entries(OptPlanCacheHash));
+		values[6] = Int64GetDatum((int64) (OptPlanCache->numChunks - OptPlanCache->numFreeChunks) *
+								  OPT_PLAN_CACHE_CHUNK_SIZE);
+		values[7] = Int64GetDatum((int64) OptPlanCache->numChunks * OPT_PLAN_CACHE_CHUNK_SIZE);
+		LWLockRelease(OptPlanCacheLock);
+	}
+	else
+	{
+		values[0] = values[1] = values[2] = values[3] = values[4] =
+			values[5] = values[6] = values[7] = Int64GetDatum(0);
+		values[8] = Float8GetDatum(0.0);
+	}
+
+	tuple = heap_form_tuple(tupdesc, values, isnull);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
@@ -49,6 +49,7 @@
 #include "utils/flatfiles.h"
 #include "utils/fmgroids.h"
 #include "utils/guc.h"
+#include "utils/optplancache.h"
 #include "utils/plancache.h"
 #include "utils/portal.h"
 #include "utils/ps_status.h"
@@ -637,6 +638,7 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 	RelationCacheInitialize();
 	InitCatalogCache();
 	InitPlanCache();
+	InitOptPlanCache();
 
 	/* Initialize portal manager */
 	EnablePortalManager();
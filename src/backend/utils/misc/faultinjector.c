@@ -229,6 +229,8 @@ FaultInjectorIdentifierEnumToString[] = {
 		/* inject fault after abort broadcast */
 	_("dtm_xlog_distributed_commit"),
 		/* inject fault after distributed commit was inserted in xlog */
+	_("dtm_qe_onephase_commit"),
+		/* inject fault on a segment after a one-phase commit, before it is acknowledged */
 	_("dtm_init"),
 		/* inject fault before initializing dtm */
         _("end_prepare_two_phase_sleep"),
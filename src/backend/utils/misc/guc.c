@@ -108,8 +108,6 @@
 
 /* XXX these should appear in other modules' header files */
 extern bool Log_disconnections;
-extern int	CommitDelay;
-extern int	CommitSiblings;
 extern char *default_tablespace;
 extern char *temp_tablespaces;
 extern bool synchronize_seqscans;
@@ -37,6 +37,8 @@
 #include "storage/proc.h"
 #include "utils/guc_tables.h"
 #include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/resgroup.h"
 #include "utils/resscheduler.h"
 #include "utils/vmem_tracker.h"
 
@@ -185,12 +187,15 @@ int			Test_blocksize_override = 0;
 int			Test_safefswritesize_override = 0;
 bool		Master_mirroring_administrator_disable = false;
 int			gp_max_local_distributed_cache = 1024;
+int			gp_max_shared_distributed_cache = 8192;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_verify_eof = true;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
 bool		gp_heap_require_relhasoids_match = true;
+bool		gp_enable_heap_multi_insert = false;
+int			gp_copy_insert_desc_memory = 131072;
 bool		Debug_appendonly_rezero_quicklz_compress_scratch = false;
 bool		Debug_appendonly_rezero_quicklz_decompress_scratch = false;
 bool		Debug_appendonly_guard_end_quicklz_scratch = false;
@@ -233,6 +238,7 @@ char	   *memory_profiler_dataset_id = "none";
 char	   *memory_profiler_query_id = "none";
 int			memory_profiler_dataset_size = 0;
 bool		gp_dump_memory_usage = FALSE;
+bool		gp_enable_bump_context = false;
 
 
 #define VERIFY_CHECKPOINT_INTERVAL_DEFAULT 180
@@ -471,6 +477,7 @@ bool		gp_enable_sequential_window_plans = FALSE;
 bool		gp_hashagg_streambottom = true;
 bool		gp_enable_agg_distinct = true;
 bool		gp_enable_dqa_pruning = true;
+bool		gp_enable_approx_count_distinct = false;
 bool		gp_eager_dqa_pruning = FALSE;
 bool		gp_eager_one_phase_agg = FALSE;
 bool		gp_eager_two_phase_agg = FALSE;
@@ -493,6 +500,9 @@ bool		optimizer_print_plan;
 bool		optimizer_print_xform;
 bool		optimizer_metadata_caching;
 int		optimizer_mdcache_size;
+int		optimizer_partition_metadata_cache_size;
+bool		optimizer_enable_plan_cache;
+int		optimizer_plan_cache_size;
 bool		optimizer_disable_xform_result_printing;
 bool		optimizer_print_memo_after_exploration;
 bool		optimizer_print_memo_after_implementation;
@@ -671,6 +681,14 @@ struct config_bool ConfigureNamesBool_gp[] =
 		&gp_enable_direct_dispatch,
 		true, NULL, NULL
 	},
+	{
+		{"gp_enable_onephase_commit", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Commit transactions that wrote on only one segment without a distributed prepare."),
+			gettext_noop("Only direct dispatch transactions that wrote nothing on the master qualify.")
+		},
+		&gp_enable_onephase_commit,
+		false, NULL, NULL
+	},
 	{
 		{"gp_enable_predicate_propagation", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("When two expressions are equivalent (such as with "
@@ -691,6 +709,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		&gp_workfile_checksumming,
 		true, NULL, NULL
 	},
+	{
+		{"gp_workfile_write_behind", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Compress and write executor work files from a helper thread, "
+				"while the operator produces more data."),
+			gettext_noop("Each work file being written uses one more buffer. "
+				"Work files compressed with ZLIB are always written synchronously."),
+			GUC_GPDB_ADDOPT
+		},
+		&gp_workfile_write_behind,
+		false, NULL, NULL
+	},
 	{
 		{"force_bitmap_table_scan", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Forces bitmap table scan instead of bitmap heap/ao/aoco scan."),
@@ -842,6 +871,15 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_approx_count_distinct", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Compute count(DISTINCT ...) approximately, with 2-phase aggregation of HyperLogLog sketches."),
+			gettext_noop("Only the legacy query optimizer honors this. ORCA ignores it and counts distinct values exactly.")
+		},
+		&gp_enable_approx_count_distinct,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_enable_groupext_distinct_pruning", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enable 3-phase aggregation and join to compute distinct-qualified aggregates"
@@ -966,6 +1004,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_bump_context", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Use bump-pointer memory contexts for per-tuple and plan memory."),
+			gettext_noop("Bump contexts have no freelists and are reset in constant time."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_bump_context,
+		false, NULL, NULL
+	},
+
 	{
 		{"gp_enable_motion_mk_sort", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enable multi-key sort in sorted motion recv."),
@@ -1178,6 +1226,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"gp_enable_heap_multi_insert", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Batch rows inserted into heap tables by COPY, INSERT ... SELECT and CREATE TABLE AS, writing one WAL record per page."),
+			gettext_noop("Index entries are made when a batch is written out, so a unique violation "
+						 "is raised then; only COPY reports it against the line that caused it."),
+			GUC_NOT_IN_SAMPLE | GUC_NO_SHOW_ALL
+		},
+		&gp_enable_heap_multi_insert,
+		false, NULL, NULL
+	},
+
 	{
 		{"debug_appendonly_rezero_quicklz_compress_scratch", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Zero the QuickLZ scratch buffer before each append-only block that is being compressed."),
@@ -1357,6 +1416,23 @@ struct config_bool ConfigureNamesBool_gp[] =
 		&ResourceCleanupIdleGangs,
 		true, NULL, NULL
 	},
+	{
+		{"gp_resqueue_admit_shortest_first", PGC_SIGHUP, RESOURCES_MGM,
+			gettext_noop("Wake up statements waiting on a resource queue cheapest first."),
+			gettext_noop("If off, waiting statements are considered in the order they arrived.")
+		},
+		&gp_resqueue_admit_shortest_first,
+		false, NULL, NULL
+	},
+	{
+		{"gp_resgroup_enable", PGC_SIGHUP, RESOURCES_MGM,
+			gettext_noop("Run each transaction in the resource group of its resource queue."),
+			gettext_noop("The group gets CPU from its cgroup, see gp_resgroup_cgroup_dir, and its "
+						 "vmem is limited by the memory_limit of the queue.")
+		},
+		&gp_resgroup_enable,
+		false, NULL, NULL
+	},
 
 	{
 		{"gp_debug_resqueue_priority", PGC_USERSET, RESOURCES_MGM,
@@ -2339,6 +2415,24 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_filerep_compression", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Compresses the data a primary segment sends to its mirror."),
+			NULL
+		},
+		&file_rep_compression,
+		false, NULL, NULL
+	},
+
+	{
+		{"wal_sender_compression", PGC_SIGHUP, WAL_REPLICATION,
+			gettext_noop("Compresses the WAL sent to the standby master."),
+			gettext_noop("Only used if the standby asks for compressed WAL when it starts replication.")
+		},
+		&wal_sender_compression,
+		false, NULL, NULL
+	},
+
 	{
 		{"debug_walrepl_snd", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Print debug messages for WAL sender in WAL based replication (Master Mirroring)."),
@@ -2698,6 +2792,15 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true, NULL, NULL
 	},
 
+	{
+		{"optimizer_enable_plan_cache", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the reuse of plans from the shared optimizer plan cache."),
+			gettext_noop("The cache is only allocated if optimizer_plan_cache_size is set.")
+		},
+		&optimizer_enable_plan_cache,
+		true, NULL, NULL
+	},
+
 	{
 		{"optimizer_disable_missing_stats_collection", PGC_USERSET, LOGGING_WHAT,
 			gettext_noop("Disable collecting of columns with missing statistics."),
@@ -3136,6 +3239,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_statistics_use_hll", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Estimate the number of distinct values with HyperLogLog sketches built on the segments during ANALYZE."),
+			gettext_noop("ANALYZE then reads all the rows of the table, not only a sample, unless it is an append-only table "
+						 "that can be analyzed incrementally or a partitioned table whose leaf partitions all have sketches. "
+						 "Sketches of leaf partitions are kept, so that the root partition can be analyzed by merging them.")
+		},
+		&gp_statistics_use_hll,
+		false, NULL, NULL
+	},
+
 	{
 		{"optimizer_enable_constant_expression_evaluation", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable constant expression evaluation in the optimizer"),
@@ -3475,6 +3589,15 @@ struct config_int ConfigureNamesInt_gp[] =
 		1024, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_max_shared_distributed_cache", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of local-distributed transactions to cache in shared memory for optimizing visibility processing by all backends."),
+			NULL
+		},
+		&gp_max_shared_distributed_cache,
+		8192, 0, INT_MAX / 1024, NULL, NULL
+	},
+
 	{
 		{"gp_max_databases", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Sets the maximum number of databases."),
@@ -3584,6 +3707,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		32768, 2 * BLCKSZ / 1024, MAX_KILOBYTES, NULL, NULL
 	},
 
+	{
+		{"gp_copy_insert_desc_memory", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the memory COPY FROM may use for open insert descriptors of append-only partitions."),
+			gettext_noop("Beyond this, the least recently used descriptors are closed, "
+						 "and reopened when more rows arrive for their partitions. "
+						 "Zero means no limit."),
+			GUC_UNIT_KB | GUC_GPDB_ADDOPT
+		},
+		&gp_copy_insert_desc_memory,
+		131072, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
 	{
 		{"max_work_mem", PGC_SUSET, DEPRECATED_OPTIONS,
 			gettext_noop("Sets the maximum value for work_mem setting."),
@@ -3824,6 +3959,25 @@ struct config_int ConfigureNamesInt_gp[] =
 		64, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_resqueue_short_query_slots", PGC_SIGHUP, RESOURCES_MGM,
+			gettext_noop("Number of active statements a resource queue admits beyond its limit for short queries."),
+			gettext_noop("A short query is one cheaper than gp_resqueue_short_query_cost.")
+		},
+		&gp_resqueue_short_query_slots,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"gp_resqueue_starvation_timeout", PGC_SIGHUP, RESOURCES_MGM,
+			gettext_noop("Time after which a statement waiting on a resource queue is admitted before cheaper ones."),
+			gettext_noop("Only used when gp_resqueue_admit_shortest_first is on."),
+			GUC_UNIT_S
+		},
+		&gp_resqueue_starvation_timeout,
+		60, 0, INT_MAX / 1000, NULL, NULL
+	},
+
 	{
 		{"max_appendonly_tables", PGC_POSTMASTER, APPENDONLY_TABLES,
 			gettext_noop("Maximum number of different (unrelated) append only tables that can participate in writing data concurrently."),
@@ -4532,6 +4686,15 @@ struct config_int ConfigureNamesInt_gp[] =
 		10, 0, 300, NULL, NULL
 	},
 
+	{
+		{"filerep_resync_workers", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Number of processes that resynchronize segment files to the mirror in parallel."),
+			gettext_noop("At most 4. Takes effect at the next resynchronization.")
+		},
+		&file_rep_resync_workers,
+		4, 1, 4, NULL, NULL
+	},
+
 	{
 		{"gp_blockdirectory_entry_min_range", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Minimal range in bytes one block directory entry covers."),
@@ -4732,6 +4895,26 @@ struct config_int ConfigureNamesInt_gp[] =
 		0, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"optimizer_partition_metadata_cache_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the cache of partition metadata translated for the optimizer."),
+			gettext_noop("0 disables the cache."),
+			GUC_UNIT_KB | GUC_GPDB_ADDOPT
+		},
+		&optimizer_partition_metadata_cache_size,
+		16384, 0, INT_MAX, NULL, NULL
+	},
+
+	{
+		{"optimizer_plan_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the shared cache of plans produced by the optimizer."),
+			gettext_noop("0 disables the cache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX / 1024, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -4856,6 +5039,15 @@ struct config_real ConfigureNamesReal_gp[] =
 		0, 0, DBL_MAX, NULL, NULL
 	},
 
+	{
+		{"gp_resqueue_short_query_cost", PGC_SIGHUP, RESOURCES_MGM,
+			gettext_noop("Statements cheaper than this may use gp_resqueue_short_query_slots."),
+			gettext_noop("0 disables the extra slots for short queries.")
+		},
+		&gp_resqueue_short_query_cost,
+		0, 0, DBL_MAX, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_rewrite_limit", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("(Obsolete) Planner will not choose hashed aggregation if "
@@ -4904,6 +5096,14 @@ struct config_real ConfigureNamesReal_gp[] =
 		&gp_statistics_sampling_threshold,
 		20000.0, 0.0, DBL_MAX, NULL, NULL
 	},
+	{
+		{"gp_statistics_incremental_threshold", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Analyze an append-only table incrementally if at most this fraction of its rows were appended since the last ANALYZE."),
+			gettext_noop("Needs gp_statistics_use_hll. Zero disables incremental ANALYZE.")
+		},
+		&gp_statistics_incremental_threshold,
+		0.10, 0.0, 1.0, NULL, NULL
+	},
 	{
 		{"gp_resqueue_priority_cpucores_per_segment", PGC_POSTMASTER, RESOURCES_MGM,
 			gettext_noop("Number of processing units associated with a segment."),
@@ -4993,7 +5193,7 @@ struct config_string ConfigureNamesString_gp[] =
 	{
 		{"gp_workfile_compress_algorithm", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify the compression algorithm that work files in the query executor use."),
-			gettext_noop("Valid values are \"NONE\", \"ZLIB\"."),
+			gettext_noop("Valid values are \"NONE\", \"ZLIB\", \"LZ\"."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_workfile_compress_algorithm_str,
@@ -5316,6 +5516,16 @@ struct config_string ConfigureNamesString_gp[] =
 		"MEDIUM", gpvars_assign_gp_resqueue_priority_default_value, NULL
 	},
 
+	{
+		{"gp_resgroup_cgroup_dir", PGC_POSTMASTER, RESOURCES_MGM,
+			gettext_noop("Sets the cgroup directory under which resource groups get their cgroups."),
+			gettext_noop("It must be writable by the server, normally in a hierarchy with the cpu "
+						 "and cpuacct controllers. If empty, the CPU of the groups is not controlled.")
+		},
+		&gp_resgroup_cgroup_dir,
+		"", NULL, NULL
+	},
+
 	{
 		{"gp_email_smtp_server", PGC_SUSET, LOGGING,
 			gettext_noop("Sets the SMTP server and port used to send e-mail alerts."),
@@ -5656,6 +5866,11 @@ assign_debug_dtm_action_protocol(const char *newval,
 		if (doit)
 			Debug_dtm_action_protocol = DTX_PROTOCOL_COMMAND_RECOVERY_ABORT_PREPARED;
 	}
+	else if (pg_strcasecmp(newval, "commit_onephase") == 0)
+	{
+		if (doit)
+			Debug_dtm_action_protocol = DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE;
+	}
 	else if (pg_strcasecmp(newval, "subtransaction_begin") == 0)
 	{
 		if (doit)
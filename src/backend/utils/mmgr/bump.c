@@ -0,0 +1,755 @@
+/*-------------------------------------------------------------------------
+ *
+ * bump.c
+ *	  Bump-pointer implementation of the abstract MemoryContext type.
+ *
+ * A BumpContext hands out memory by advancing a pointer within its current
+ * block.  There are no freelists and no per-chunk memory accounting: chunks
+ * are only reclaimed wholesale when the context is reset or deleted.  This
+ * makes it a good fit for memory that is either reset after every tuple
+ * (econtext per-tuple memory) or that lives exactly as long as its owner and
+ * is never individually freed (a deserialized plan tree).
+ *
+ * Every chunk is still preceded by a StandardChunkHeader, because pfree(),
+ * repalloc() and GetMemoryChunkContext() find the owning context through
+ * it.  However, the header's sharedHeader always points into the block that
+ * holds the chunk, so no SharedChunkHeader needs to be looked up or created
+ * on the allocation path.  Memory accounting is done at block granularity:
+ * a block is charged, in full, to the memory account that was active when
+ * the block was first used, and released again on reset.
+ *
+ * pfree() is mostly a no-op.  As a cheap concession to palloc/pfree pairs
+ * in tight loops, freeing the most recently allocated chunk of the active
+ * block rolls back the bump pointer, and freeing an oversized chunk returns
+ * its dedicated block to the host memory manager right away.
+ *
+ * The first regular block of the context is kept over resets ("keeper"),
+ * so a context that is reset after every tuple and never outgrows its first
+ * block is reset in O(1) without touching malloc().
+ *
+ * Copyright (c) 2016 Pivotal Inc. All Rights Reserved
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/memutils.h"
+#include "utils/memaccounting.h"
+#include "utils/gp_alloc.h"
+
+#include "miscadmin.h"
+
+#ifdef CDB_PALLOC_CALLER_ID
+#define CDB_MCXT_WHERE(context) (context)->callerFile, (context)->callerLine
+#else
+#define CDB_MCXT_WHERE(context) __FILE__, __LINE__
+#endif
+
+#define BUMP_BLOCKHDRSZ	MAXALIGN(sizeof(BumpBlockData))
+#define BUMP_CHUNKHDRSZ	STANDARDCHUNKHEADERSIZE
+
+/*
+ * Requests larger than this fraction of maxBlockSize are given a dedicated
+ * block, so that a single big request does not waste the rest of the
+ * active block.
+ */
+#define BUMP_CHUNK_FRACTION	8
+
+typedef struct BumpBlockData *BumpBlock;
+
+/*
+ * BumpBlock
+ *		The unit of memory obtained from gp_malloc().  The embedded
+ *		SharedChunkHeader is what every chunk in the block points to; it
+ *		records the owning context and the memory account charged for the
+ *		block.  A balance of zero means the block is not currently charged.
+ */
+typedef struct BumpBlockData
+{
+	SharedChunkHeader sharedHeader;	/* shared by all chunks in this block */
+	BumpBlock	next;			/* next block in context's list */
+	char	   *freeptr;		/* start of free space in this block */
+	char	   *endptr;			/* end of space in this block */
+} BumpBlockData;
+
+/*
+ * BumpContext
+ *
+ * The head of the blocks list is the active block that allocations are
+ * carved from.  Dedicated blocks for oversized chunks are always linked
+ * in behind the head, so they never become the active block.
+ */
+typedef struct BumpContext
+{
+	MemoryContextData header;	/* Standard memory-context fields */
+	BumpBlock	blocks;			/* head of list of blocks in this context */
+	BumpBlock	keeper;			/* if not NULL, keep this block over resets */
+	bool		isReset;		/* T = no space alloced since last reset */
+	/* Allocation parameters for this context: */
+	Size		initBlockSize;	/* initial block size */
+	Size		maxBlockSize;	/* maximum block size */
+	Size		nextBlockSize;	/* next block size to allocate */
+	Size		chunkLimit;		/* larger requests get a dedicated block */
+} BumpContext;
+
+#define BumpPointerGetChunk(ptr) \
+	((StandardChunkHeader *)(((char *)(ptr)) - BUMP_CHUNKHDRSZ))
+#define BumpChunkGetPointer(chk) \
+	((void *)(((char *)(chk)) + BUMP_CHUNKHDRSZ))
+#define BumpChunkGetBlock(chk) \
+	((BumpBlock) (chk)->sharedHeader)
+
+/*
+ * These functions implement the MemoryContext API for Bump contexts.
+ */
+static void *BumpAlloc(MemoryContext context, Size size);
+static void BumpFree(MemoryContext context, void *pointer);
+static void *BumpRealloc(MemoryContext context, void *pointer, Size size);
+static void BumpInit(MemoryContext context);
+static void BumpReset(MemoryContext context);
+static void BumpDelete(MemoryContext context);
+static Size BumpGetChunkSpace(MemoryContext context, void *pointer);
+static bool BumpIsEmpty(MemoryContext context);
+static void Bump_GetStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld);
+static void BumpReleaseAccounting(MemoryContext context);
+static void BumpUpdateGeneration(MemoryContext context);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+static void BumpCheck(MemoryContext context);
+#endif
+
+/*
+ * This is the virtual function table for Bump contexts.
+ */
+static MemoryContextMethods BumpMethods = {
+	BumpAlloc,
+	BumpFree,
+	BumpRealloc,
+	BumpInit,
+	BumpReset,
+	BumpDelete,
+	BumpGetChunkSpace,
+	BumpIsEmpty,
+	Bump_GetStats,
+	BumpReleaseAccounting,
+	BumpUpdateGeneration
+#ifdef MEMORY_CONTEXT_CHECKING
+	,BumpCheck
+#endif
+};
+
+/*
+ * BumpBlockCharge
+ *		Charge a block, in full, to the active memory account.
+ *
+ * Blocks obtained before memory accounting is set up are not charged, in
+ * the same way as AllocSet's nullAccountHeader chunks.
+ */
+static inline void
+BumpBlockCharge(BumpBlock block)
+{
+	Size		blksize = block->endptr - (char *) block;
+
+	Assert(block->sharedHeader.balance == 0);
+
+	block->sharedHeader.memoryAccount = ActiveMemoryAccount;
+	block->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+	block->sharedHeader.balance = blksize;
+
+	if (ActiveMemoryAccount != NULL)
+		MemoryAccounting_Allocate(ActiveMemoryAccount, blksize);
+}
+
+/*
+ * BumpBlockRelease
+ *		Release the accounting of a charged block.
+ */
+static inline void
+BumpBlockRelease(BumpBlock block)
+{
+	if (block->sharedHeader.balance == 0)
+		return;
+
+	if (block->sharedHeader.memoryAccount != NULL)
+		MemoryAccounting_Free(block->sharedHeader.memoryAccount,
+							  block->sharedHeader.memoryAccountGeneration,
+							  block->sharedHeader.balance);
+
+	block->sharedHeader.balance = 0;
+}
+
+/*
+ * BumpBlockAlloc
+ *		Obtain a new block of the given size from the host memory manager
+ *		and charge it to the active memory account.
+ */
+static BumpBlock
+BumpBlockAlloc(BumpContext *set, Size blksize)
+{
+	BumpBlock	block;
+
+	block = (BumpBlock) gp_malloc(blksize);
+	if (block == NULL)
+		MemoryContextError(ERRCODE_OUT_OF_MEMORY,
+						   &set->header, CDB_MCXT_WHERE(&set->header),
+						   "Out of memory.  Failed on request of size %lu bytes.",
+						   (unsigned long) blksize);
+
+	MemoryContextNoteAlloc(&set->header, UserPtr_GetUserPtrSize(block));
+
+	block->sharedHeader.context = (MemoryContext) set;
+	block->sharedHeader.balance = 0;
+	block->sharedHeader.prev = NULL;
+	block->sharedHeader.next = NULL;
+	block->next = NULL;
+	block->freeptr = ((char *) block) + BUMP_BLOCKHDRSZ;
+	block->endptr = ((char *) block) + blksize;
+
+	BumpBlockCharge(block);
+
+	return block;
+}
+
+/*
+ * BumpBlockFree
+ *		Return a block to the host memory manager.
+ */
+static void
+BumpBlockFree(BumpContext *set, BumpBlock block)
+{
+	BumpBlockRelease(block);
+
+	MemoryContextNoteFree(&set->header, UserPtr_GetUserPtrSize(block));
+
+#ifdef CLOBBER_FREED_MEMORY
+	/* Wipe freed memory for debugging purposes */
+	memset(block, 0x7F, block->freeptr - ((char *) block));
+#endif
+	gp_free(block);
+}
+
+/*
+ * BumpChunkInit
+ *		Set up the header of a freshly carved chunk.
+ */
+static inline void *
+BumpChunkInit(BumpBlock block, StandardChunkHeader *chunk, Size chunk_size, Size size)
+{
+	chunk->sharedHeader = &block->sharedHeader;
+	chunk->size = chunk_size;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	chunk->requested_size = size;
+	/* set mark to catch clobber of "unused" space */
+	if (size < chunk_size)
+		((char *) BumpChunkGetPointer(chunk))[size] = 0x7E;
+#endif
+
+	return BumpChunkGetPointer(chunk);
+}
+
+
+/*
+ * Public routines
+ */
+
+
+/*
+ * BumpContextCreate
+ *		Create a new Bump context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * initBlockSize: initial allocation block size
+ * maxBlockSize: maximum allocation block size
+ *
+ * The ALLOCSET_*_INITSIZE / ALLOCSET_*_MAXSIZE recommendations apply to
+ * bump contexts as well.
+ */
+MemoryContext
+BumpContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size initBlockSize,
+				  Size maxBlockSize)
+{
+	BumpContext *context;
+
+	/* Do the type-independent part of context creation */
+	context = (BumpContext *) MemoryContextCreate(T_BumpContext,
+												  sizeof(BumpContext),
+												  &BumpMethods,
+												  parent,
+												  name);
+
+	/*
+	 * Make sure alloc parameters are reasonable, and save them.
+	 *
+	 * As in aset.c, we somewhat arbitrarily enforce a minimum 1K block size.
+	 */
+	initBlockSize = MAXALIGN(initBlockSize);
+	if (initBlockSize < 1024)
+		initBlockSize = 1024;
+	maxBlockSize = MAXALIGN(maxBlockSize);
+	if (maxBlockSize < initBlockSize)
+		maxBlockSize = initBlockSize;
+	context->initBlockSize = initBlockSize;
+	context->maxBlockSize = maxBlockSize;
+	context->nextBlockSize = initBlockSize;
+	context->chunkLimit = MAXALIGN(maxBlockSize / BUMP_CHUNK_FRACTION);
+
+	context->isReset = true;
+
+	return (MemoryContext) context;
+}
+
+/*
+ * BumpContextContainsPointer
+ *		Does the given pointer lie within the allocated part of one of the
+ *		context's blocks?
+ *
+ * This is exact, and safe for pointers that were not palloc'ed at all,
+ * which is what MemoryContextContainsGenericAllocation() needs.
+ */
+bool
+BumpContextContainsPointer(MemoryContext context, void *pointer)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+
+	Assert(IsA(context, BumpContext));
+
+	for (block = set->blocks; block != NULL; block = block->next)
+	{
+		if ((char *) pointer >= ((char *) block) + BUMP_BLOCKHDRSZ + BUMP_CHUNKHDRSZ &&
+			(char *) pointer < block->freeptr)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * BumpInit
+ *		Context-type-specific initialization routine.
+ */
+static void
+BumpInit(MemoryContext context)
+{
+	/*
+	 * Since MemoryContextCreate already zeroed the context node, we don't
+	 * have to do anything here: it's already OK.
+	 */
+}
+
+/*
+ * BumpReleaseAccounting
+ *		Release the accounting of every charged block.
+ *
+ * Like its AllocSet counterpart this can be called any number of times; a
+ * released block is re-charged when it is next allocated from.
+ */
+static void
+BumpReleaseAccounting(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+
+	for (block = set->blocks; block != NULL; block = block->next)
+		BumpBlockRelease(block);
+}
+
+/*
+ * BumpUpdateGeneration
+ *		Hand the accounting of every charged block over to
+ *		RolloverMemoryAccount in the current generation.
+ */
+static void
+BumpUpdateGeneration(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+
+	for (block = set->blocks; block != NULL; block = block->next)
+	{
+		if (block->sharedHeader.balance == 0)
+			continue;
+
+		block->sharedHeader.memoryAccount = RolloverMemoryAccount;
+		block->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+	}
+}
+
+/*
+ * BumpReset
+ *		Frees all memory which is allocated in the given context.
+ *
+ * The keeper block, if any, is retained and becomes the active block again.
+ */
+static void
+BumpReset(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+
+	/* Nothing to do if no pallocs since startup or last reset */
+	if (set->isReset)
+		return;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption before freeing */
+	BumpCheck(context);
+#endif
+
+	block = set->blocks;
+	set->blocks = set->keeper;
+
+	while (block != NULL)
+	{
+		BumpBlock	next = block->next;
+
+		if (block == set->keeper)
+		{
+			BumpBlockRelease(block);
+
+#ifdef CLOBBER_FREED_MEMORY
+			/* Wipe freed memory for debugging purposes */
+			memset(((char *) block) + BUMP_BLOCKHDRSZ, 0x7F,
+				   block->freeptr - (((char *) block) + BUMP_BLOCKHDRSZ));
+#endif
+			block->freeptr = ((char *) block) + BUMP_BLOCKHDRSZ;
+			block->next = NULL;
+		}
+		else
+			BumpBlockFree(set, block);
+
+		block = next;
+	}
+
+	/* Reset block size allocation sequence, too */
+	set->nextBlockSize = set->initBlockSize;
+
+	set->isReset = true;
+}
+
+/*
+ * BumpDelete
+ *		Frees all memory which is allocated in the given context, in
+ *		preparation for deletion of the context.
+ */
+static void
+BumpDelete(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block = set->blocks;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption before freeing */
+	BumpCheck(context);
+#endif
+
+	/* Make it look empty, just in case... */
+	set->blocks = NULL;
+	set->keeper = NULL;
+
+	while (block != NULL)
+	{
+		BumpBlock	next = block->next;
+
+		BumpBlockFree(set, block);
+		block = next;
+	}
+}
+
+/*
+ * BumpAlloc
+ *		Returns pointer to allocated memory of given size; memory is added
+ *		to the context.
+ */
+static void *
+BumpAlloc(MemoryContext context, Size size)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+	StandardChunkHeader *chunk;
+	Size		chunk_size = MAXALIGN(size);
+	Size		required = chunk_size + BUMP_CHUNKHDRSZ;
+
+	set->isReset = false;
+
+	/*
+	 * Oversized requests get a block of their own, linked in behind the
+	 * active block so that the rest of the active block stays usable.
+	 */
+	if (chunk_size > set->chunkLimit)
+	{
+		block = BumpBlockAlloc(set, required + BUMP_BLOCKHDRSZ);
+
+		if (set->blocks != NULL)
+		{
+			block->next = set->blocks->next;
+			set->blocks->next = block;
+		}
+		else
+			set->blocks = block;
+
+		chunk = (StandardChunkHeader *) block->freeptr;
+		block->freeptr += required;
+		Assert(block->freeptr == block->endptr);
+
+		return BumpChunkInit(block, chunk, chunk_size, size);
+	}
+
+	block = set->blocks;
+
+	if (block == NULL || (Size) (block->endptr - block->freeptr) < required)
+	{
+		Size		blksize = set->nextBlockSize;
+
+		/* Double the next block size, up to maxBlockSize */
+		set->nextBlockSize <<= 1;
+		if (set->nextBlockSize > set->maxBlockSize)
+			set->nextBlockSize = set->maxBlockSize;
+
+		while (blksize < required + BUMP_BLOCKHDRSZ)
+			blksize <<= 1;
+
+		block = BumpBlockAlloc(set, blksize);
+		block->next = set->blocks;
+		set->blocks = block;
+
+		/* The first regular block is kept over resets */
+		if (set->keeper == NULL)
+			set->keeper = block;
+	}
+	else if (block->sharedHeader.balance == 0)
+	{
+		/* The keeper block after a reset; charge it again */
+		BumpBlockCharge(block);
+	}
+
+	chunk = (StandardChunkHeader *) block->freeptr;
+	block->freeptr += required;
+	Assert(block->freeptr <= block->endptr);
+
+	return BumpChunkInit(block, chunk, chunk_size, size);
+}
+
+/*
+ * BumpFree
+ *		Individual chunks are not reclaimed, with two exceptions: the most
+ *		recently allocated chunk of the active block, and oversized chunks
+ *		living in a dedicated block.
+ */
+static void
+BumpFree(MemoryContext context, void *pointer)
+{
+	BumpContext *set = (BumpContext *) context;
+	StandardChunkHeader *chunk = BumpPointerGetChunk(pointer);
+	BumpBlock	block = BumpChunkGetBlock(chunk);
+
+	Assert(block->sharedHeader.context == context);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Test for someone scribbling on unused space in chunk */
+	if (chunk->requested_size < chunk->size)
+	{
+		if (((char *) pointer)[chunk->requested_size] != 0x7E)
+		{
+			Assert(!"Memory error");
+			elog(WARNING, "detected write past chunk end in %s %p (%s:%d)",
+				 set->header.name, chunk, CDB_MCXT_WHERE(&set->header));
+		}
+	}
+#endif
+
+	if (chunk->size > set->chunkLimit)
+	{
+		BumpBlock	prevblock = NULL;
+		BumpBlock	cur;
+
+		for (cur = set->blocks; cur != NULL; prevblock = cur, cur = cur->next)
+		{
+			if (cur == block)
+				break;
+		}
+		if (cur == NULL)
+			MemoryContextError(ERRCODE_INTERNAL_ERROR,
+							   &set->header, CDB_MCXT_WHERE(&set->header),
+							   "could not find block containing chunk %p", chunk);
+
+		if (prevblock == NULL)
+			set->blocks = block->next;
+		else
+			prevblock->next = block->next;
+
+		BumpBlockFree(set, block);
+	}
+	else if (block == set->blocks &&
+			 (char *) pointer + chunk->size == block->freeptr)
+	{
+#ifdef CLOBBER_FREED_MEMORY
+		/* Wipe freed memory for debugging purposes */
+		memset(pointer, 0x7F, chunk->size);
+#endif
+		block->freeptr = (char *) chunk;
+	}
+}
+
+/*
+ * BumpRealloc
+ *		Returns new pointer to allocated memory of given size.
+ *
+ * The most recently allocated chunk of the active block is grown in place
+ * when there is room; otherwise the data is copied into a new chunk.
+ */
+static void *
+BumpRealloc(MemoryContext context, void *pointer, Size size)
+{
+	BumpContext *set = (BumpContext *) context;
+	StandardChunkHeader *chunk = BumpPointerGetChunk(pointer);
+	BumpBlock	block = BumpChunkGetBlock(chunk);
+	Size		oldsize = chunk->size;
+	Size		chunk_size = MAXALIGN(size);
+	void	   *newPointer;
+
+	/* The allocated area may already be big enough */
+	if (oldsize >= size)
+	{
+#ifdef MEMORY_CONTEXT_CHECKING
+		chunk->requested_size = size;
+		/* set mark to catch clobber of "unused" space */
+		if (size < oldsize)
+			((char *) pointer)[size] = 0x7E;
+#endif
+		return pointer;
+	}
+
+	/* Grow the last chunk of the active block in place, if it fits */
+	if (block == set->blocks &&
+		oldsize <= set->chunkLimit &&
+		chunk_size <= set->chunkLimit &&
+		(char *) pointer + oldsize == block->freeptr &&
+		(Size) (block->endptr - (char *) pointer) >= chunk_size)
+	{
+		block->freeptr = (char *) pointer + chunk_size;
+		return BumpChunkInit(block, chunk, chunk_size, size);
+	}
+
+	newPointer = BumpAlloc(context, size);
+	memcpy(newPointer, pointer, oldsize);
+	BumpFree(context, pointer);
+
+	return newPointer;
+}
+
+/*
+ * BumpGetChunkSpace
+ *		Given a currently-allocated chunk, determine the total space
+ *		it occupies (including all memory-allocation overhead).
+ */
+static Size
+BumpGetChunkSpace(MemoryContext context, void *pointer)
+{
+	StandardChunkHeader *chunk = BumpPointerGetChunk(pointer);
+
+	return chunk->size + BUMP_CHUNKHDRSZ;
+}
+
+/*
+ * BumpIsEmpty
+ *		Is a bump context empty of any allocated space?
+ */
+static bool
+BumpIsEmpty(MemoryContext context)
+{
+	return ((BumpContext *) context)->isReset;
+}
+
+/*
+ * Bump_GetStats
+ *		Returns stats about memory consumption of a Bump context.
+ *
+ * Individual chunks are not tracked, so nChunks reports the number of
+ * blocks that still have free space, mirroring how AllocSet counts the
+ * free space at the end of its active block as a chunk.
+ */
+static void
+Bump_GetStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld)
+{
+	BumpContext *set = (BumpContext *) context;
+	BumpBlock	block;
+
+	*nBlocks = 0;
+	*nChunks = 0;
+	*currentAvailable = 0;
+	*allAllocated = set->header.allBytesAlloc;
+	*allFreed = set->header.allBytesFreed;
+	*maxHeld = set->header.maxBytesHeld;
+
+	for (block = set->blocks; block != NULL; block = block->next)
+	{
+		*nBlocks = *nBlocks + 1;
+
+		if (block->endptr > block->freeptr)
+		{
+			*nChunks = *nChunks + 1;
+			*currentAvailable += block->endptr - block->freeptr;
+		}
+	}
+}
+
+#ifdef MEMORY_CONTEXT_CHECKING
+
+/*
+ * BumpCheck
+ *		Walk through chunks and check consistency of memory.
+ *
+ * NOTE: report errors as WARNING, *not* ERROR or FATAL.
+ */
+static void
+BumpCheck(MemoryContext context)
+{
+	BumpContext *set = (BumpContext *) context;
+	char	   *name = set->header.name;
+	BumpBlock	block;
+
+	for (block = set->blocks; block != NULL; block = block->next)
+	{
+		char	   *bpoz = ((char *) block) + BUMP_BLOCKHDRSZ;
+
+		if (block->freeptr > block->endptr || block->freeptr < bpoz)
+		{
+			Assert(!"Memory context error");
+			elog(WARNING, "problem in bump context %s: bogus free pointer in block %p (%s:%d)",
+				 name, block, CDB_MCXT_WHERE(&set->header));
+			continue;
+		}
+
+		while (bpoz < block->freeptr)
+		{
+			StandardChunkHeader *chunk = (StandardChunkHeader *) bpoz;
+
+			if (chunk->sharedHeader != &block->sharedHeader)
+			{
+				Assert(!"Memory context error");
+				elog(WARNING, "problem in bump context %s: bogus block link in block %p, chunk %p (%s:%d)",
+					 name, block, chunk, CDB_MCXT_WHERE(&set->header));
+				break;
+			}
+
+			if (chunk->requested_size < chunk->size &&
+				((char *) BumpChunkGetPointer(chunk))[chunk->requested_size] != 0x7E)
+			{
+				elog(WARNING, "problem in bump context %s: detected write past chunk end in block %p, chunk %p (%s:%d)",
+					 name, block, chunk, CDB_MCXT_WHERE(&set->header));
+			}
+
+			bpoz += BUMP_CHUNKHDRSZ + chunk->size;
+		}
+	}
+}
+
+#endif   /* MEMORY_CONTEXT_CHECKING */
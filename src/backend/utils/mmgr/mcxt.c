@@ -913,6 +913,16 @@ MemoryContextContainsGenericAllocation(MemoryContext context, void *pointer)
 	/*
 	 * OK, it's probably safe to look at the chunk header.
 	 */
+	/* Bump and slab contexts can tell exactly, from their block boundaries */
+	if (IsA(context, BumpContext))
+	{
+		return BumpContextContainsPointer(context, pointer);
+	}
+	if (IsA(context, SlabContext))
+	{
+		return SlabContextContainsPointer(context, pointer);
+	}
+
 	header = (StandardChunkHeader *)
 		((char *) pointer - STANDARDCHUNKHEADERSIZE);
 
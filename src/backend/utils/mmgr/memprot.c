@@ -230,10 +230,11 @@ MemoryProtection_IsOwnerThread()
 static void gp_failed_to_alloc(MemoryAllocationStatus ec, int en, int sz)
 {
 	/*
-	 * A per-query vmem overflow shouldn't trigger a segment-wide
-	 * OOM reporting.
+	 * A per-query or per-resource-group vmem overflow shouldn't trigger
+	 * a segment-wide OOM reporting.
 	 */
-	if (MemoryFailure_QueryMemoryExhausted != ec)
+	if (MemoryFailure_QueryMemoryExhausted != ec &&
+			MemoryFailure_ResourceGroupMemoryExhausted != ec)
 	{
 		UpdateTimeAtomically(segmentOOMTime);
 	}
@@ -248,6 +249,10 @@ static void gp_failed_to_alloc(MemoryAllocationStatus ec, int en, int sz)
 	{
 		elog(LOG, "Logging memory usage for reaching per-query memory limit");
 	}
+	else if (ec == MemoryFailure_ResourceGroupMemoryExhausted)
+	{
+		elog(LOG, "Logging memory usage for reaching resource group memory limit");
+	}
 	else if (ec == MemoryFailure_VmemExhausted)
 	{
 		elog(LOG, "Logging memory usage for reaching Vmem limit");
@@ -300,6 +305,15 @@ static void gp_failed_to_alloc(MemoryAllocationStatus ec, int en, int sz)
 				)
 		));
 	}
+	else if (ec == MemoryFailure_ResourceGroupMemoryExhausted)
+	{
+		ereport(ERROR, (errcode(ERRCODE_GP_MEMPROT_KILL),
+				errmsg("Out of memory"),
+				errdetail("Resource group memory limit reached: current limit is %d MB, requested %d bytes",
+						VmemTracker_GetResGroupVmemLimitMB(), sz
+				)
+		));
+	}
 	else if (ec == MemoryFailure_SystemMemoryExhausted)
 	{
 		ereport(ERROR, (errcode(ERRCODE_GP_MEMPROT_KILL),
@@ -0,0 +1,839 @@
+/*-------------------------------------------------------------------------
+ *
+ * slab.c
+ *	  Slab implementation of the abstract MemoryContext type.
+ *
+ * A SlabContext hands out chunks of one fixed size, fixed when the context
+ * is created.  Memory is obtained from the host memory manager in blocks
+ * that are carved into an array of equal-sized chunks.  Each block keeps a
+ * bitmap of its free chunks, so pfree() is O(1) and the chunk is reused by
+ * the next allocation instead of sitting on a freelist that is shared by
+ * all chunk sizes, as happens with AllocSet.
+ *
+ * Blocks are kept on two lists: blocks with at least one free chunk, and
+ * blocks that are completely in use.  Allocations are always served from
+ * the head of the first list.  When every chunk of a block has been freed,
+ * the whole block is given back to the host memory manager.  One empty
+ * block is cached so that a context which oscillates around a block
+ * boundary does not malloc() and free() on every other call.
+ *
+ * As in bump.c, every chunk is preceded by a StandardChunkHeader whose
+ * sharedHeader points into the block holding the chunk, and memory
+ * accounting is done at block granularity.
+ *
+ * Copyright (c) 2016 Pivotal Inc. All Rights Reserved
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/memutils.h"
+#include "utils/memaccounting.h"
+#include "utils/gp_alloc.h"
+
+#include "miscadmin.h"
+
+#ifdef CDB_PALLOC_CALLER_ID
+#define CDB_MCXT_WHERE(context) (context)->callerFile, (context)->callerLine
+#else
+#define CDB_MCXT_WHERE(context) __FILE__, __LINE__
+#endif
+
+#define SLAB_CHUNKHDRSZ	STANDARDCHUNKHEADERSIZE
+
+#define SLAB_BITS_PER_WORD	32
+
+typedef struct SlabBlockData *SlabBlock;
+
+/*
+ * SlabBlock
+ *		The unit of memory obtained from gp_malloc().  The embedded
+ *		SharedChunkHeader is what every chunk in the block points to; it
+ *		records the owning context and the memory account charged for the
+ *		block.  A balance of zero means the block is not currently charged.
+ *
+ * The header is followed by the free bitmap (a set bit means the chunk is
+ * free) and then, at SlabContext.blockHdrSize, by the chunks themselves.
+ */
+typedef struct SlabBlockData
+{
+	SharedChunkHeader sharedHeader;	/* shared by all chunks in this block */
+	SlabBlock	prev;			/* prev block in its list */
+	SlabBlock	next;			/* next block in its list */
+	int			nfree;			/* number of free chunks */
+	int			firstFreeWord;	/* no free chunks in freemap words below this */
+	uint32		freemap[1];		/* VARIABLE LENGTH ARRAY */
+} SlabBlockData;
+
+/*
+ * SlabContext
+ */
+typedef struct SlabContext
+{
+	MemoryContextData header;	/* Standard memory-context fields */
+	SlabBlock	freeBlocks;		/* blocks with at least one free chunk */
+	SlabBlock	fullBlocks;		/* blocks with no free chunks */
+	SlabBlock	emptyBlock;		/* cached empty block, or NULL */
+	/* Allocation parameters for this context: */
+	Size		chunkSize;		/* requested chunk size */
+	Size		fullChunkSize;	/* chunk size including header and alignment */
+	Size		blockSize;		/* size of each block */
+	Size		blockHdrSize;	/* block header plus free bitmap */
+	int			chunksPerBlock;	/* number of chunks in each block */
+	int			freemapWords;	/* number of words in each free bitmap */
+} SlabContext;
+
+#define SlabPointerGetChunk(ptr) \
+	((StandardChunkHeader *)(((char *)(ptr)) - SLAB_CHUNKHDRSZ))
+#define SlabChunkGetPointer(chk) \
+	((void *)(((char *)(chk)) + SLAB_CHUNKHDRSZ))
+#define SlabChunkGetBlock(chk) \
+	((SlabBlock) (chk)->sharedHeader)
+#define SlabBlockGetChunk(set, block, idx) \
+	((StandardChunkHeader *)(((char *)(block)) + (set)->blockHdrSize + \
+							 (Size) (idx) * (set)->fullChunkSize))
+#define SlabChunkIndex(set, block, chk) \
+	((int) ((((char *)(chk)) - ((char *)(block)) - (set)->blockHdrSize) / \
+			(set)->fullChunkSize))
+
+#define SlabFreemapWords(nchunks) \
+	(((nchunks) + SLAB_BITS_PER_WORD - 1) / SLAB_BITS_PER_WORD)
+#define SlabBlockHdrSize(freemapWords) \
+	MAXALIGN(offsetof(SlabBlockData, freemap) + (freemapWords) * sizeof(uint32))
+
+#define SlabChunkIsFree(block, idx) \
+	(((block)->freemap[(idx) / SLAB_BITS_PER_WORD] & \
+	  ((uint32) 1 << ((idx) % SLAB_BITS_PER_WORD))) != 0)
+
+/*
+ * These functions implement the MemoryContext API for Slab contexts.
+ */
+static void *SlabAlloc(MemoryContext context, Size size);
+static void SlabFree(MemoryContext context, void *pointer);
+static void *SlabRealloc(MemoryContext context, void *pointer, Size size);
+static void SlabInit(MemoryContext context);
+static void SlabReset(MemoryContext context);
+static void SlabDelete(MemoryContext context);
+static Size SlabGetChunkSpace(MemoryContext context, void *pointer);
+static bool SlabIsEmpty(MemoryContext context);
+static void Slab_GetStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld);
+static void SlabReleaseAccounting(MemoryContext context);
+static void SlabUpdateGeneration(MemoryContext context);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+static void SlabCheck(MemoryContext context);
+#endif
+
+/*
+ * This is the virtual function table for Slab contexts.
+ */
+static MemoryContextMethods SlabMethods = {
+	SlabAlloc,
+	SlabFree,
+	SlabRealloc,
+	SlabInit,
+	SlabReset,
+	SlabDelete,
+	SlabGetChunkSpace,
+	SlabIsEmpty,
+	Slab_GetStats,
+	SlabReleaseAccounting,
+	SlabUpdateGeneration
+#ifdef MEMORY_CONTEXT_CHECKING
+	,SlabCheck
+#endif
+};
+
+/*
+ * SlabBlockCharge
+ *		Charge a block, in full, to the active memory account.
+ */
+static inline void
+SlabBlockCharge(SlabContext *set, SlabBlock block)
+{
+	Assert(block->sharedHeader.balance == 0);
+
+	block->sharedHeader.memoryAccount = ActiveMemoryAccount;
+	block->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+	block->sharedHeader.balance = set->blockSize;
+
+	if (ActiveMemoryAccount != NULL)
+		MemoryAccounting_Allocate(ActiveMemoryAccount, set->blockSize);
+}
+
+/*
+ * SlabBlockRelease
+ *		Release the accounting of a charged block.
+ */
+static inline void
+SlabBlockRelease(SlabBlock block)
+{
+	if (block->sharedHeader.balance == 0)
+		return;
+
+	if (block->sharedHeader.memoryAccount != NULL)
+		MemoryAccounting_Free(block->sharedHeader.memoryAccount,
+							  block->sharedHeader.memoryAccountGeneration,
+							  block->sharedHeader.balance);
+
+	block->sharedHeader.balance = 0;
+}
+
+/*
+ * SlabBlockMarkAllFree
+ *		Set up the free bitmap of a block whose chunks are all free.
+ */
+static void
+SlabBlockMarkAllFree(SlabContext *set, SlabBlock block)
+{
+	int			lastbits = set->chunksPerBlock % SLAB_BITS_PER_WORD;
+
+	memset(block->freemap, 0xFF, set->freemapWords * sizeof(uint32));
+	if (lastbits != 0)
+		block->freemap[set->freemapWords - 1] = ((uint32) 1 << lastbits) - 1;
+
+	block->nfree = set->chunksPerBlock;
+	block->firstFreeWord = 0;
+}
+
+/*
+ * SlabBlockAlloc
+ *		Obtain a new block from the host memory manager.  The block is not
+ *		charged to any memory account yet.
+ */
+static SlabBlock
+SlabBlockAlloc(SlabContext *set)
+{
+	SlabBlock	block;
+
+	block = (SlabBlock) gp_malloc(set->blockSize);
+	if (block == NULL)
+		MemoryContextError(ERRCODE_OUT_OF_MEMORY,
+						   &set->header, CDB_MCXT_WHERE(&set->header),
+						   "Out of memory.  Failed on request of size %lu bytes.",
+						   (unsigned long) set->blockSize);
+
+	MemoryContextNoteAlloc(&set->header, UserPtr_GetUserPtrSize(block));
+
+	block->sharedHeader.context = (MemoryContext) set;
+	block->sharedHeader.balance = 0;
+	block->sharedHeader.prev = NULL;
+	block->sharedHeader.next = NULL;
+	block->prev = NULL;
+	block->next = NULL;
+	SlabBlockMarkAllFree(set, block);
+
+	return block;
+}
+
+/*
+ * SlabBlockFree
+ *		Return a block to the host memory manager.
+ */
+static void
+SlabBlockFree(SlabContext *set, SlabBlock block)
+{
+	SlabBlockRelease(block);
+
+	MemoryContextNoteFree(&set->header, UserPtr_GetUserPtrSize(block));
+
+#ifdef CLOBBER_FREED_MEMORY
+	/* Wipe freed memory for debugging purposes */
+	memset(block, 0x7F, set->blockSize);
+#endif
+	gp_free(block);
+}
+
+/*
+ * SlabBlockPush / SlabBlockUnlink
+ *		Maintain the doubly linked block lists.
+ */
+static inline void
+SlabBlockPush(SlabBlock *list, SlabBlock block)
+{
+	block->prev = NULL;
+	block->next = *list;
+	if (*list != NULL)
+		(*list)->prev = block;
+	*list = block;
+}
+
+static inline void
+SlabBlockUnlink(SlabBlock *list, SlabBlock block)
+{
+	if (block->prev != NULL)
+		block->prev->next = block->next;
+	else
+	{
+		Assert(*list == block);
+		*list = block->next;
+	}
+	if (block->next != NULL)
+		block->next->prev = block->prev;
+
+	block->prev = NULL;
+	block->next = NULL;
+}
+
+/*
+ * SlabFreeBlockList
+ *		Return every block of a list to the host memory manager.
+ */
+static void
+SlabFreeBlockList(SlabContext *set, SlabBlock block)
+{
+	while (block != NULL)
+	{
+		SlabBlock	next = block->next;
+
+		SlabBlockFree(set, block);
+		block = next;
+	}
+}
+
+
+/*
+ * Public routines
+ */
+
+
+/*
+ * SlabContextCreate
+ *		Create a new Slab context.
+ *
+ * parent: parent context, or NULL if top-level context
+ * name: name of context (for debugging --- string will be copied)
+ * blockSize: allocation block size
+ * chunkSize: size of every chunk handed out by the context
+ *
+ * The block size is raised, if needed, so that each block holds at least
+ * one chunk.
+ */
+MemoryContext
+SlabContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size blockSize,
+				  Size chunkSize)
+{
+	SlabContext *context;
+	Size		fullChunkSize;
+	Size		blockHdrSize;
+	int			chunksPerBlock;
+	int			freemapWords;
+
+	if (chunkSize == 0)
+		elog(ERROR, "invalid chunk size for slab context \"%s\"", name);
+
+	fullChunkSize = SLAB_CHUNKHDRSZ + MAXALIGN(chunkSize);
+
+	/*
+	 * The number of chunks depends on the bitmap size, which depends on the
+	 * number of chunks.  Start from an estimate that ignores the bitmap and
+	 * shrink until everything fits.
+	 */
+	blockSize = MAXALIGN(blockSize);
+	if (blockSize < 1024)
+		blockSize = 1024;
+
+	chunksPerBlock = (blockSize - MAXALIGN(sizeof(SlabBlockData))) / fullChunkSize;
+	if (chunksPerBlock < 1)
+		chunksPerBlock = 1;
+
+	for (;;)
+	{
+		freemapWords = SlabFreemapWords(chunksPerBlock);
+		blockHdrSize = SlabBlockHdrSize(freemapWords);
+		if (chunksPerBlock == 1 ||
+			blockHdrSize + chunksPerBlock * fullChunkSize <= blockSize)
+			break;
+		chunksPerBlock--;
+	}
+
+	if (blockHdrSize + chunksPerBlock * fullChunkSize > blockSize)
+		blockSize = blockHdrSize + chunksPerBlock * fullChunkSize;
+
+	/* Do the type-independent part of context creation */
+	context = (SlabContext *) MemoryContextCreate(T_SlabContext,
+												  sizeof(SlabContext),
+												  &SlabMethods,
+												  parent,
+												  name);
+
+	context->chunkSize = chunkSize;
+	context->fullChunkSize = fullChunkSize;
+	context->blockSize = blockSize;
+	context->blockHdrSize = blockHdrSize;
+	context->chunksPerBlock = chunksPerBlock;
+	context->freemapWords = freemapWords;
+
+	return (MemoryContext) context;
+}
+
+/*
+ * SlabBlockSizeFor
+ *		Block size that holds exactly nchunks chunks of chunkSize bytes.
+ *
+ * Callers that want a given number of chunks per block should pass this to
+ * SlabContextCreate(), rather than nchunks * chunkSize, which leaves no
+ * room for the block header and chunk headers.
+ */
+Size
+SlabBlockSizeFor(Size chunkSize, int nchunks)
+{
+	Assert(nchunks > 0);
+
+	return SlabBlockHdrSize(SlabFreemapWords(nchunks)) +
+		(Size) nchunks * (SLAB_CHUNKHDRSZ + MAXALIGN(chunkSize));
+}
+
+/*
+ * SlabContextContainsPointer
+ *		Does the given pointer lie within a live chunk of the context?
+ *
+ * This is exact, and safe for pointers that were not palloc'ed at all,
+ * which is what MemoryContextContainsGenericAllocation() needs.
+ */
+bool
+SlabContextContainsPointer(MemoryContext context, void *pointer)
+{
+	SlabContext *set = (SlabContext *) context;
+	SlabBlock	lists[2];
+	int			i;
+
+	Assert(IsA(context, SlabContext));
+
+	lists[0] = set->freeBlocks;
+	lists[1] = set->fullBlocks;
+
+	for (i = 0; i < 2; i++)
+	{
+		SlabBlock	block;
+
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			char	   *first = ((char *) block) + set->blockHdrSize;
+			char	   *end = first + set->chunksPerBlock * set->fullChunkSize;
+			int			idx;
+
+			if ((char *) pointer < first || (char *) pointer >= end)
+				continue;
+
+			idx = ((char *) pointer - first) / set->fullChunkSize;
+
+			return ((char *) pointer >= (char *) SlabBlockGetChunk(set, block, idx) + SLAB_CHUNKHDRSZ &&
+					!SlabChunkIsFree(block, idx));
+		}
+	}
+
+	return false;
+}
+
+/*
+ * SlabInit
+ *		Context-type-specific initialization routine.
+ */
+static void
+SlabInit(MemoryContext context)
+{
+	/*
+	 * Since MemoryContextCreate already zeroed the context node, we don't
+	 * have to do anything here: it's already OK.
+	 */
+}
+
+/*
+ * SlabReleaseAccounting
+ *		Release the accounting of every charged block.
+ *
+ * Like its AllocSet counterpart this can be called any number of times; a
+ * released block is re-charged when it is next allocated from.
+ */
+static void
+SlabReleaseAccounting(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+	SlabBlock	block;
+
+	for (block = set->freeBlocks; block != NULL; block = block->next)
+		SlabBlockRelease(block);
+	for (block = set->fullBlocks; block != NULL; block = block->next)
+		SlabBlockRelease(block);
+}
+
+/*
+ * SlabUpdateGeneration
+ *		Hand the accounting of every charged block over to
+ *		RolloverMemoryAccount in the current generation.
+ */
+static void
+SlabUpdateGeneration(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+	SlabBlock	lists[2];
+	int			i;
+
+	lists[0] = set->freeBlocks;
+	lists[1] = set->fullBlocks;
+
+	for (i = 0; i < 2; i++)
+	{
+		SlabBlock	block;
+
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			if (block->sharedHeader.balance == 0)
+				continue;
+
+			block->sharedHeader.memoryAccount = RolloverMemoryAccount;
+			block->sharedHeader.memoryAccountGeneration = MemoryAccountingCurrentGeneration;
+		}
+	}
+}
+
+/*
+ * SlabReset
+ *		Frees all memory which is allocated in the given context.
+ *
+ * The cached empty block, if any, is retained.
+ */
+static void
+SlabReset(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Check for corruption before freeing */
+	SlabCheck(context);
+#endif
+
+	SlabFreeBlockList(set, set->freeBlocks);
+	SlabFreeBlockList(set, set->fullBlocks);
+	set->freeBlocks = NULL;
+	set->fullBlocks = NULL;
+}
+
+/*
+ * SlabDelete
+ *		Frees all memory which is allocated in the given context, in
+ *		preparation for deletion of the context.
+ */
+static void
+SlabDelete(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+
+	SlabReset(context);
+
+	if (set->emptyBlock != NULL)
+		SlabBlockFree(set, set->emptyBlock);
+	set->emptyBlock = NULL;
+}
+
+/*
+ * SlabAlloc
+ *		Returns pointer to allocated memory of given size; memory is added
+ *		to the context.
+ *
+ * Requests larger than the context's chunk size are an error.
+ */
+static void *
+SlabAlloc(MemoryContext context, Size size)
+{
+	SlabContext *set = (SlabContext *) context;
+	SlabBlock	block;
+	StandardChunkHeader *chunk;
+	int			word;
+	int			bit;
+	int			idx;
+	uint32		bits;
+
+	if (size > set->chunkSize)
+		MemoryContextError(ERRCODE_INTERNAL_ERROR,
+						   &set->header, CDB_MCXT_WHERE(&set->header),
+						   "invalid request of %lu bytes from slab context with chunk size %lu",
+						   (unsigned long) size, (unsigned long) set->chunkSize);
+
+	block = set->freeBlocks;
+
+	if (block == NULL)
+	{
+		if (set->emptyBlock != NULL)
+		{
+			block = set->emptyBlock;
+			set->emptyBlock = NULL;
+		}
+		else
+			block = SlabBlockAlloc(set);
+
+		SlabBlockPush(&set->freeBlocks, block);
+	}
+
+	/* A new block, the cached block, or one whose accounting was released */
+	if (block->sharedHeader.balance == 0)
+		SlabBlockCharge(set, block);
+
+	Assert(block->nfree > 0);
+
+	/* Find the first free chunk, starting from the hint */
+	for (word = block->firstFreeWord; block->freemap[word] == 0; word++)
+		Assert(word < set->freemapWords - 1);
+
+	bits = block->freemap[word];
+	for (bit = 0; (bits & ((uint32) 1 << bit)) == 0; bit++)
+		;
+
+	block->freemap[word] &= ~((uint32) 1 << bit);
+	block->firstFreeWord = word;
+	block->nfree--;
+
+	if (block->nfree == 0)
+	{
+		SlabBlockUnlink(&set->freeBlocks, block);
+		SlabBlockPush(&set->fullBlocks, block);
+	}
+
+	idx = word * SLAB_BITS_PER_WORD + bit;
+	Assert(idx < set->chunksPerBlock);
+
+	chunk = SlabBlockGetChunk(set, block, idx);
+	chunk->sharedHeader = &block->sharedHeader;
+	chunk->size = set->fullChunkSize - SLAB_CHUNKHDRSZ;
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	chunk->requested_size = size;
+	/* set mark to catch clobber of "unused" space */
+	if (size < chunk->size)
+		((char *) SlabChunkGetPointer(chunk))[size] = 0x7E;
+#endif
+
+	return SlabChunkGetPointer(chunk);
+}
+
+/*
+ * SlabFree
+ *		Frees allocated memory; memory is removed from the context.
+ *
+ * A block whose chunks have all been freed is given back to the host
+ * memory manager, unless it can become the cached empty block.
+ */
+static void
+SlabFree(MemoryContext context, void *pointer)
+{
+	SlabContext *set = (SlabContext *) context;
+	StandardChunkHeader *chunk = SlabPointerGetChunk(pointer);
+	SlabBlock	block = SlabChunkGetBlock(chunk);
+	int			idx = SlabChunkIndex(set, block, chunk);
+	int			word = idx / SLAB_BITS_PER_WORD;
+
+	Assert(block->sharedHeader.context == context);
+	Assert(idx >= 0 && idx < set->chunksPerBlock);
+
+	if (SlabChunkIsFree(block, idx))
+		MemoryContextError(ERRCODE_INTERNAL_ERROR,
+						   &set->header, CDB_MCXT_WHERE(&set->header),
+						   "chunk %p freed twice in slab context", chunk);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	/* Test for someone scribbling on unused space in chunk */
+	if (chunk->requested_size < chunk->size)
+	{
+		if (((char *) pointer)[chunk->requested_size] != 0x7E)
+		{
+			Assert(!"Memory error");
+			elog(WARNING, "detected write past chunk end in %s %p (%s:%d)",
+				 set->header.name, chunk, CDB_MCXT_WHERE(&set->header));
+		}
+	}
+#endif
+
+#ifdef CLOBBER_FREED_MEMORY
+	/* Wipe freed memory for debugging purposes */
+	memset(pointer, 0x7F, chunk->size);
+#endif
+
+	block->freemap[word] |= ((uint32) 1 << (idx % SLAB_BITS_PER_WORD));
+	if (word < block->firstFreeWord)
+		block->firstFreeWord = word;
+
+	if (block->nfree++ == 0)
+	{
+		/* The block was full; it can serve allocations again */
+		SlabBlockUnlink(&set->fullBlocks, block);
+		SlabBlockPush(&set->freeBlocks, block);
+	}
+
+	if (block->nfree == set->chunksPerBlock)
+	{
+		SlabBlockUnlink(&set->freeBlocks, block);
+
+		if (set->emptyBlock == NULL)
+		{
+			SlabBlockRelease(block);
+			set->emptyBlock = block;
+		}
+		else
+			SlabBlockFree(set, block);
+	}
+}
+
+/*
+ * SlabRealloc
+ *		Returns new pointer to allocated memory of given size.
+ *
+ * Every chunk already has room for chunkSize bytes, so this only succeeds
+ * within that limit.
+ */
+static void *
+SlabRealloc(MemoryContext context, void *pointer, Size size)
+{
+	SlabContext *set = (SlabContext *) context;
+
+	if (size > set->chunkSize)
+		MemoryContextError(ERRCODE_INTERNAL_ERROR,
+						   &set->header, CDB_MCXT_WHERE(&set->header),
+						   "invalid request of %lu bytes from slab context with chunk size %lu",
+						   (unsigned long) size, (unsigned long) set->chunkSize);
+
+#ifdef MEMORY_CONTEXT_CHECKING
+	{
+		StandardChunkHeader *chunk = SlabPointerGetChunk(pointer);
+
+		chunk->requested_size = size;
+		/* set mark to catch clobber of "unused" space */
+		if (size < chunk->size)
+			((char *) pointer)[size] = 0x7E;
+	}
+#endif
+
+	return pointer;
+}
+
+/*
+ * SlabGetChunkSpace
+ *		Given a currently-allocated chunk, determine the total space
+ *		it occupies (including all memory-allocation overhead).
+ */
+static Size
+SlabGetChunkSpace(MemoryContext context, void *pointer)
+{
+	return ((SlabContext *) context)->fullChunkSize;
+}
+
+/*
+ * SlabIsEmpty
+ *		Is a slab context empty of any allocated space?
+ */
+static bool
+SlabIsEmpty(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+
+	return set->freeBlocks == NULL && set->fullBlocks == NULL;
+}
+
+/*
+ * Slab_GetStats
+ *		Returns stats about memory consumption of a Slab context.
+ *
+ * nChunks reports the number of free chunks, as AllocSet does.
+ */
+static void
+Slab_GetStats(MemoryContext context, uint64 *nBlocks, uint64 *nChunks,
+		uint64 *currentAvailable, uint64 *allAllocated, uint64 *allFreed, uint64 *maxHeld)
+{
+	SlabContext *set = (SlabContext *) context;
+	SlabBlock	block;
+
+	*nBlocks = 0;
+	*nChunks = 0;
+	*currentAvailable = 0;
+	*allAllocated = set->header.allBytesAlloc;
+	*allFreed = set->header.allBytesFreed;
+	*maxHeld = set->header.maxBytesHeld;
+
+	for (block = set->freeBlocks; block != NULL; block = block->next)
+	{
+		*nBlocks = *nBlocks + 1;
+		*nChunks = *nChunks + block->nfree;
+		*currentAvailable += block->nfree * set->fullChunkSize;
+	}
+
+	for (block = set->fullBlocks; block != NULL; block = block->next)
+		*nBlocks = *nBlocks + 1;
+
+	if (set->emptyBlock != NULL)
+	{
+		*nBlocks = *nBlocks + 1;
+		*nChunks = *nChunks + set->chunksPerBlock;
+		*currentAvailable += set->chunksPerBlock * set->fullChunkSize;
+	}
+}
+
+#ifdef MEMORY_CONTEXT_CHECKING
+
+/*
+ * SlabCheck
+ *		Walk through chunks and check consistency of memory.
+ *
+ * NOTE: report errors as WARNING, *not* ERROR or FATAL.
+ */
+static void
+SlabCheck(MemoryContext context)
+{
+	SlabContext *set = (SlabContext *) context;
+	char	   *name = set->header.name;
+	SlabBlock	lists[2];
+	int			i;
+
+	lists[0] = set->freeBlocks;
+	lists[1] = set->fullBlocks;
+
+	for (i = 0; i < 2; i++)
+	{
+		SlabBlock	block;
+
+		for (block = lists[i]; block != NULL; block = block->next)
+		{
+			int			nfree = 0;
+			int			idx;
+
+			for (idx = 0; idx < set->chunksPerBlock; idx++)
+			{
+				StandardChunkHeader *chunk = SlabBlockGetChunk(set, block, idx);
+
+				if (SlabChunkIsFree(block, idx))
+				{
+					nfree++;
+					continue;
+				}
+
+				if (chunk->sharedHeader != &block->sharedHeader)
+				{
+					Assert(!"Memory context error");
+					elog(WARNING, "problem in slab context %s: bogus block link in block %p, chunk %p (%s:%d)",
+						 name, block, chunk, CDB_MCXT_WHERE(&set->header));
+					continue;
+				}
+
+				if (chunk->requested_size < chunk->size &&
+					((char *) SlabChunkGetPointer(chunk))[chunk->requested_size] != 0x7E)
+				{
+					elog(WARNING, "problem in slab context %s: detected write past chunk end in block %p, chunk %p (%s:%d)",
+						 name, block, chunk, CDB_MCXT_WHERE(&set->header));
+				}
+			}
+
+			if (nfree != block->nfree ||
+				(i == 0 && nfree == 0) || (i == 1 && nfree != 0))
+			{
+				Assert(!"Memory context error");
+				elog(WARNING, "problem in slab context %s: free count mismatch in block %p (%s:%d)",
+					 name, block, CDB_MCXT_WHERE(&set->header));
+			}
+		}
+	}
+}
+
+#endif   /* MEMORY_CONTEXT_CHECKING */
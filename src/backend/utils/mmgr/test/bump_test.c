@@ -0,0 +1,239 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../bump.c"
+
+#define NEW_ALLOC_SIZE 1024
+
+extern MemoryAccount *MemoryAccountTreeLogicalRoot;
+extern MemoryAccount *TopMemoryAccount;
+extern MemoryAccount *MemoryAccountMemoryAccount;
+
+/*
+ * This method sets up MemoryContext tree as well as
+ * the basic MemoryAccount data structures.
+ */
+void SetupMemoryDataStructures(void **state)
+{
+	MemoryContextInit();
+}
+
+/*
+ * This method cleans up MemoryContext tree and
+ * the MemoryAccount data structures.
+ */
+void
+TeardownMemoryDataStructures(void **state)
+{
+	MemoryContextReset(TopMemoryContext); /* TopMemoryContext deletion is not supported */
+
+	/* These are needed to be NULL for calling MemoryContextInit() */
+	TopMemoryContext = NULL;
+	CurrentMemoryContext = NULL;
+
+	MemoryAccountTreeLogicalRoot = NULL;
+	TopMemoryAccount = NULL;
+	MemoryAccountMemoryAccount = NULL;
+	RolloverMemoryAccount = NULL;
+	SharedChunkHeadersMemoryAccount = NULL;
+	ActiveMemoryAccount = NULL;
+	AlienExecutorMemoryAccount = NULL;
+	MemoryAccountMemoryContext = NULL;
+}
+
+static MemoryContext
+CreateTestBumpContext(void)
+{
+	return BumpContextCreate(TopMemoryContext,
+							 "TestBumpContext",
+							 ALLOCSET_DEFAULT_INITSIZE,
+							 ALLOCSET_DEFAULT_MAXSIZE);
+}
+
+/* Tests that consecutive allocations are carved from the same block */
+void
+test__BumpAlloc__BumpsPointer(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+	BumpContext *set = (BumpContext *) context;
+
+	char *first = MemoryContextAlloc(context, 10);
+	char *second = MemoryContextAlloc(context, 10);
+
+	assert_true(second == first + MAXALIGN(10) + BUMP_CHUNKHDRSZ);
+	assert_true(set->blocks != NULL && set->blocks->next == NULL);
+
+	/* Both chunks point at the block they live in */
+	assert_true(GetMemoryChunkContext(first) == context);
+	assert_true(BumpPointerGetChunk(first)->sharedHeader ==
+				BumpPointerGetChunk(second)->sharedHeader);
+	assert_true(BumpPointerGetChunk(first)->sharedHeader == &set->blocks->sharedHeader);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that a reset keeps the first block and does not call free */
+void
+test__BumpReset__KeepsKeeperBlock(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+	BumpContext *set = (BumpContext *) context;
+
+	char *first = MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+	BumpBlock keeper = set->blocks;
+
+	assert_true(set->keeper == keeper);
+
+	/* Force a second regular block */
+	for (int i = 0; i < 16; i++)
+		MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+
+	assert_true(set->blocks != keeper);
+
+	MemoryContextReset(context);
+
+	assert_true(set->blocks == keeper && keeper->next == NULL);
+	assert_true(MemoryContextIsEmpty(context));
+
+	/* Allocation restarts at the beginning of the keeper block */
+	assert_true(MemoryContextAlloc(context, NEW_ALLOC_SIZE) == first);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that oversized requests do not displace the active block */
+void
+test__BumpAlloc__LargeAllocInDedicatedBlock(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+	BumpContext *set = (BumpContext *) context;
+
+	MemoryContextAlloc(context, 10);
+	BumpBlock active = set->blocks;
+
+	void *large = MemoryContextAlloc(context, set->chunkLimit + 1);
+
+	assert_true(set->blocks == active);
+	assert_true(BumpChunkGetBlock(BumpPointerGetChunk(large)) == active->next);
+
+	uint64 heldBefore = context->allBytesAlloc - context->allBytesFreed;
+
+	/* Freeing it gives the whole block back */
+	pfree(large);
+
+	assert_true(active->next == NULL);
+	assert_true(context->allBytesAlloc - context->allBytesFreed < heldBefore);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that freeing the last chunk rolls back the bump pointer */
+void
+test__BumpFree__RollsBackLastChunk(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+
+	void *first = MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+	void *second = MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+
+	/* Not the last chunk: no-op */
+	pfree(first);
+	assert_true(MemoryContextAlloc(context, NEW_ALLOC_SIZE) != first);
+
+	second = MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+	pfree(second);
+	assert_true(MemoryContextAlloc(context, NEW_ALLOC_SIZE) == second);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that the last chunk is grown in place by repalloc */
+void
+test__BumpRealloc__GrowsLastChunkInPlace(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+
+	char *first = MemoryContextAlloc(context, 16);
+	memset(first, 'x', 16);
+
+	char *grown = repalloc(first, 64);
+	assert_true(grown == first);
+	assert_true(GetMemoryChunkSpace(grown) == 64 + BUMP_CHUNKHDRSZ);
+
+	/* Once it is no longer the last chunk, repalloc has to copy */
+	MemoryContextAlloc(context, 16);
+	char *moved = repalloc(grown, 128);
+	assert_true(moved != grown);
+	assert_true(moved[0] == 'x' && moved[15] == 'x');
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that blocks, not chunks, are charged to the active memory account */
+void
+test__BumpAlloc__ChargesActiveAccountPerBlock(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+	BumpContext *set = (BumpContext *) context;
+
+	MemoryAccount *newActiveAccount = MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Exec_Hash);
+	MemoryAccount *oldActiveAccount = MemoryAccounting_SwitchAccount(newActiveAccount);
+
+	uint64 prevOutstanding = MemoryAccountingOutstandingBalance;
+
+	MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+
+	Size blksize = set->blocks->endptr - (char *) set->blocks;
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == blksize);
+	assert_true(MemoryAccountingOutstandingBalance - prevOutstanding == blksize);
+
+	/* A second allocation from the same block is free of charge */
+	MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == blksize);
+
+	/* Reset releases the accounting even though the keeper block stays */
+	MemoryContextReset(context);
+	assert_true(newActiveAccount->allocated == newActiveAccount->freed);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding);
+
+	MemoryAccounting_SwitchAccount(oldActiveAccount);
+	MemoryContextDelete(context);
+}
+
+/* Tests the exact containment check used for non-palloc'ed pointers */
+void
+test__BumpContextContainsPointer__ChecksBlockBounds(void **state)
+{
+	MemoryContext context = CreateTestBumpContext();
+	int onStack = 0;
+
+	void *chunk = MemoryContextAlloc(context, NEW_ALLOC_SIZE);
+
+	assert_true(MemoryContextContainsGenericAllocation(context, chunk));
+	assert_false(MemoryContextContainsGenericAllocation(context, &onStack));
+
+	MemoryContextReset(context);
+	assert_false(MemoryContextContainsGenericAllocation(context, chunk));
+
+	MemoryContextDelete(context);
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test_setup_teardown(test__BumpAlloc__BumpsPointer, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpReset__KeepsKeeperBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpAlloc__LargeAllocInDedicatedBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpFree__RollsBackLastChunk, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpRealloc__GrowsLastChunkInPlace, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpAlloc__ChargesActiveAccountPerBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__BumpContextContainsPointer__ChecksBlockBounds, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+	};
+
+	return run_tests(tests);
+}
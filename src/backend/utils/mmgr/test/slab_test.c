@@ -0,0 +1,283 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../slab.c"
+
+#define TEST_CHUNK_SIZE 100
+#define TEST_BLOCK_SIZE 8192
+
+extern MemoryAccount *MemoryAccountTreeLogicalRoot;
+extern MemoryAccount *TopMemoryAccount;
+extern MemoryAccount *MemoryAccountMemoryAccount;
+
+/*
+ * This method sets up MemoryContext tree as well as
+ * the basic MemoryAccount data structures.
+ */
+void SetupMemoryDataStructures(void **state)
+{
+	MemoryContextInit();
+}
+
+/*
+ * This method cleans up MemoryContext tree and
+ * the MemoryAccount data structures.
+ */
+void
+TeardownMemoryDataStructures(void **state)
+{
+	MemoryContextReset(TopMemoryContext); /* TopMemoryContext deletion is not supported */
+
+	/* These are needed to be NULL for calling MemoryContextInit() */
+	TopMemoryContext = NULL;
+	CurrentMemoryContext = NULL;
+
+	MemoryAccountTreeLogicalRoot = NULL;
+	TopMemoryAccount = NULL;
+	MemoryAccountMemoryAccount = NULL;
+	RolloverMemoryAccount = NULL;
+	SharedChunkHeadersMemoryAccount = NULL;
+	ActiveMemoryAccount = NULL;
+	AlienExecutorMemoryAccount = NULL;
+	MemoryAccountMemoryContext = NULL;
+}
+
+static MemoryContext
+CreateTestSlabContext(void)
+{
+	return SlabContextCreate(TopMemoryContext,
+							 "TestSlabContext",
+							 TEST_BLOCK_SIZE,
+							 TEST_CHUNK_SIZE);
+}
+
+/* Tests that the chunk layout fits in the block */
+void
+test__SlabContextCreate__FitsChunksInBlock(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+	SlabContext *set = (SlabContext *) context;
+
+	assert_true(set->chunksPerBlock > 1);
+	assert_true(set->blockHdrSize + set->chunksPerBlock * set->fullChunkSize <= set->blockSize);
+	assert_true(set->freemapWords * SLAB_BITS_PER_WORD >= set->chunksPerBlock);
+
+	MemoryContextDelete(context);
+
+	/* A chunk bigger than the block size still gets a block of its own */
+	context = SlabContextCreate(TopMemoryContext, "TestSlabContext", 1024, 4000);
+	set = (SlabContext *) context;
+
+	assert_true(set->chunksPerBlock == 1);
+	assert_true(set->blockSize >= set->blockHdrSize + set->fullChunkSize);
+	assert_true(MemoryContextAlloc(context, 4000) != NULL);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that SlabBlockSizeFor() gives blocks of exactly the requested chunks */
+void
+test__SlabBlockSizeFor__HoldsRequestedChunks(void **state)
+{
+	Size		chunkSize = 8192 + 64;
+	MemoryContext context;
+	SlabContext *set;
+
+	context = SlabContextCreate(TopMemoryContext, "TestSlabContext",
+								SlabBlockSizeFor(chunkSize, 8), chunkSize);
+	set = (SlabContext *) context;
+
+	assert_int_equal(set->chunksPerBlock, 8);
+	assert_true(set->blockSize == set->blockHdrSize + 8 * set->fullChunkSize);
+
+	MemoryContextDelete(context);
+
+	/* Without the headers accounted for, only 7 chunks fit */
+	context = SlabContextCreate(TopMemoryContext, "TestSlabContext",
+								8 * chunkSize, chunkSize);
+	set = (SlabContext *) context;
+
+	assert_int_equal(set->chunksPerBlock, 7);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that a freed chunk is handed out again by the next allocation */
+void
+test__SlabFree__ReusesChunk(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+
+	char *first = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	char *second = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	char *third = MemoryContextAlloc(context, 10);
+
+	assert_true(GetMemoryChunkContext(first) == context);
+	assert_true(GetMemoryChunkSpace(third) == GetMemoryChunkSpace(first));
+
+	pfree(second);
+	assert_true(MemoryContextAlloc(context, TEST_CHUNK_SIZE) == second);
+
+	MemoryContextDelete(context);
+}
+
+/* Tests that a block moves between the lists as it fills up and empties */
+void
+test__SlabAlloc__MovesFullBlocks(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+	SlabContext *set = (SlabContext *) context;
+	void **chunks = palloc(set->chunksPerBlock * sizeof(void *));
+
+	for (int i = 0; i < set->chunksPerBlock; i++)
+		chunks[i] = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+
+	SlabBlock block = SlabChunkGetBlock(SlabPointerGetChunk(chunks[0]));
+
+	assert_true(set->freeBlocks == NULL);
+	assert_true(set->fullBlocks == block);
+
+	/* The next allocation needs a new block */
+	void *extra = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	assert_true(SlabChunkGetBlock(SlabPointerGetChunk(extra)) != block);
+
+	pfree(chunks[3]);
+	assert_true(set->fullBlocks == NULL);
+	assert_true(block->nfree == 1);
+
+	/* Blocks with free space are served first */
+	assert_true(MemoryContextAlloc(context, TEST_CHUNK_SIZE) == chunks[3]);
+
+	MemoryContextDelete(context);
+	pfree(chunks);
+}
+
+/* Tests that a block is released once all its chunks have been freed */
+void
+test__SlabFree__ReleasesEmptyBlocks(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+	SlabContext *set = (SlabContext *) context;
+	int nchunks = 3 * set->chunksPerBlock;
+	void **chunks = palloc(nchunks * sizeof(void *));
+
+	for (int i = 0; i < nchunks; i++)
+		chunks[i] = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+
+	uint64 heldBefore = context->allBytesAlloc - context->allBytesFreed;
+
+	for (int i = 0; i < nchunks; i++)
+		pfree(chunks[i]);
+
+	/* One empty block is kept; the others go back to the host */
+	assert_true(MemoryContextIsEmpty(context));
+	assert_true(set->emptyBlock != NULL);
+	assert_true(context->allBytesAlloc - context->allBytesFreed < heldBefore);
+	assert_true(context->allBytesAlloc - context->allBytesFreed >= set->blockSize);
+
+	/* The cached block is reused */
+	SlabBlock cached = set->emptyBlock;
+	void *chunk = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	assert_true(SlabChunkGetBlock(SlabPointerGetChunk(chunk)) == cached);
+	assert_true(set->emptyBlock == NULL);
+
+	MemoryContextDelete(context);
+	pfree(chunks);
+}
+
+/* Tests that blocks, not chunks, are charged to the active memory account */
+void
+test__SlabAlloc__ChargesActiveAccountPerBlock(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+	SlabContext *set = (SlabContext *) context;
+
+	MemoryAccount *newActiveAccount = MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Exec_Hash);
+	MemoryAccount *oldActiveAccount = MemoryAccounting_SwitchAccount(newActiveAccount);
+
+	uint64 prevOutstanding = MemoryAccountingOutstandingBalance;
+
+	void *first = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == set->blockSize);
+	assert_true(MemoryAccountingOutstandingBalance - prevOutstanding == set->blockSize);
+
+	/* A second allocation from the same block is free of charge */
+	void *second = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	assert_true(newActiveAccount->allocated - newActiveAccount->freed == set->blockSize);
+
+	/* Emptying the block releases its accounting */
+	pfree(first);
+	pfree(second);
+	assert_true(newActiveAccount->allocated == newActiveAccount->freed);
+	assert_true(MemoryAccountingOutstandingBalance == prevOutstanding);
+
+	MemoryAccounting_SwitchAccount(oldActiveAccount);
+	MemoryContextDelete(context);
+}
+
+/* Tests that oversized requests are refused */
+void
+test__SlabAlloc__RejectsOversizedRequest(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+
+	void *chunk = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+
+	/* Growing within the chunk size stays in place */
+	assert_true(repalloc(chunk, TEST_CHUNK_SIZE) == chunk);
+
+	PG_TRY();
+	{
+		MemoryContextAlloc(context, TEST_CHUNK_SIZE + 1);
+		assert_true(false);
+	}
+	PG_CATCH();
+	{
+		FlushErrorState();
+	}
+	PG_END_TRY();
+
+	MemoryContextDelete(context);
+}
+
+/* Tests the exact containment check used for non-palloc'ed pointers */
+void
+test__SlabContextContainsPointer__ChecksLiveChunks(void **state)
+{
+	MemoryContext context = CreateTestSlabContext();
+	int onStack = 0;
+
+	void *chunk = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+	void *other = MemoryContextAlloc(context, TEST_CHUNK_SIZE);
+
+	assert_true(MemoryContextContainsGenericAllocation(context, chunk));
+	assert_false(MemoryContextContainsGenericAllocation(context, &onStack));
+
+	/* A freed chunk is no longer contained */
+	pfree(chunk);
+	assert_false(MemoryContextContainsGenericAllocation(context, chunk));
+	assert_true(MemoryContextContainsGenericAllocation(context, other));
+
+	MemoryContextDelete(context);
+}
+
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test_setup_teardown(test__SlabContextCreate__FitsChunksInBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabBlockSizeFor__HoldsRequestedChunks, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabFree__ReusesChunk, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabAlloc__MovesFullBlocks, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabFree__ReleasesEmptyBlocks, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabAlloc__ChargesActiveAccountPerBlock, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabAlloc__RejectsOversizedRequest, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+		unit_test_setup_teardown(test__SlabContextContainsPointer__ChecksLiveChunks, SetupMemoryDataStructures, TeardownMemoryDataStructures),
+	};
+
+	return run_tests(tests);
+}
@@ -72,6 +72,14 @@ static int32 waivedChunks = 0;
  */
 volatile int32 *segmentVmemChunks = NULL;
 
+/*
+ * Consumed vmem of the resource group the current process is running a
+ * statement for, or NULL if it is not in a group. The limit is 0 if the
+ * group has no memory limit.
+ */
+static volatile int32 *resGroupVmemChunks = NULL;
+static int32 resGroupVmemChunksQuota = 0;
+
 static void ReleaseAllVmemChunks(void);
 
 /*
@@ -220,6 +228,24 @@ VmemTracker_ReserveVmemChunks(int32 numChunksToReserve)
 		waiverUsed = true;
 	}
 
+	/* Then reserve it for the resource group, enforcing its limit the same way */
+	if (NULL != resGroupVmemChunks)
+	{
+		int32 groupTotal = pg_atomic_add_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, numChunksToReserve);
+
+		if (resGroupVmemChunksQuota != 0 && groupTotal > resGroupVmemChunksQuota &&
+				Gp_role == GP_ROLE_EXECUTE && CritSectionCount == 0)
+		{
+			if (groupTotal > resGroupVmemChunksQuota + waivedChunks)
+			{
+				pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, numChunksToReserve);
+				pg_atomic_sub_fetch_u32((pg_atomic_uint32 *)&MySessionState->sessionVmem, numChunksToReserve);
+				return MemoryFailure_ResourceGroupMemoryExhausted;
+			}
+			waiverUsed = true;
+		}
+	}
+
 	/* Now reserve vmem at segment level */
 	int32 new_vmem = pg_atomic_add_fetch_u32((pg_atomic_uint32 *)segmentVmemChunks, numChunksToReserve);
 
@@ -236,6 +262,12 @@ VmemTracker_ReserveVmemChunks(int32 numChunksToReserve)
 			/* Revert query memory reservation */
 			pg_atomic_sub_fetch_u32((pg_atomic_uint32 *)&MySessionState->sessionVmem, numChunksToReserve);
 
+			/* Revert resource group reservation */
+			if (NULL != resGroupVmemChunks)
+			{
+				pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, numChunksToReserve);
+			}
+
 			/* Revert vmem reservation */
 			pg_atomic_sub_fetch_u32((pg_atomic_uint32 *)segmentVmemChunks, numChunksToReserve);
 
@@ -277,9 +309,74 @@ VmemTracker_ReleaseVmemChunks(int reduction)
 	Assert(NULL != MySessionState);
 	pg_atomic_sub_fetch_u32((pg_atomic_uint32 *)&MySessionState->sessionVmem, reduction);
 	Assert(0 <= MySessionState->sessionVmem);
+
+	if (NULL != resGroupVmemChunks)
+	{
+		pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, reduction);
+		Assert(0 <= *resGroupVmemChunks);
+	}
+
 	trackedVmemChunks -= reduction;
 }
 
+/*
+ * Starts charging the vmem of the current process to a resource group.
+ * The vmem already reserved by the process is moved to the group's counter,
+ * and further reservations are validated against groupVmemLimitBytes
+ * (no limit if it is not positive).
+ */
+void
+VmemTracker_JoinResGroup(volatile int32 *groupVmemChunks, int64 groupVmemLimitBytes)
+{
+	Assert(NULL != groupVmemChunks);
+
+	VmemTracker_LeaveResGroup();
+
+	resGroupVmemChunksQuota = 0;
+	if (groupVmemLimitBytes > 0)
+	{
+		resGroupVmemChunksQuota = Max(BYTES_TO_CHUNKS(groupVmemLimitBytes), 1);
+	}
+
+	resGroupVmemChunks = groupVmemChunks;
+	if (trackedVmemChunks > 0)
+	{
+		pg_atomic_add_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, trackedVmemChunks);
+	}
+}
+
+/*
+ * Stops charging the vmem of the current process to its resource group,
+ * giving back to the group whatever the process still holds.
+ */
+void
+VmemTracker_LeaveResGroup(void)
+{
+	if (NULL == resGroupVmemChunks)
+	{
+		return;
+	}
+
+	if (trackedVmemChunks > 0)
+	{
+		pg_atomic_sub_fetch_u32((pg_atomic_uint32 *) resGroupVmemChunks, trackedVmemChunks);
+	}
+	Assert(0 <= *resGroupVmemChunks);
+
+	resGroupVmemChunks = NULL;
+	resGroupVmemChunksQuota = 0;
+}
+
+/*
+ * Returns the vmem limit of the current resource group in "MB" unit, or 0
+ * if there is none.
+ */
+int32
+VmemTracker_GetResGroupVmemLimitMB(void)
+{
+	return CHUNKS_TO_MB(resGroupVmemChunksQuota);
+}
+
 /*
  * Releases all vmem reserved by this process.
  */
@@ -0,0 +1,631 @@
+/*-------------------------------------------------------------------------
+ *
+ * resgroup.c
+ *	  POSTGRES resource group management code.
+ *
+ * A resource group is the set of backends, on the master and on the
+ * segments, that are running a transaction for a given resource queue.
+ * While a backend belongs to a group:
+ *
+ *	- it is moved into the cgroup "<gp_resgroup_cgroup_dir>/<queue oid>",
+ *	  whose cpu.shares follow the queue's priority and whose CFS quota
+ *	  follows its cpu_rate_limit, so the kernel enforces the queue's share
+ *	  of CPU instead of the backoff sweeper;
+ *
+ *	- its vmem is charged to the group by vmem_tracker.c, and reservations
+ *	  beyond the queue's memory_limit fail on the segments.
+ *
+ * The per-group usage is kept in a small shared array with one slot per
+ * group in use, and is exposed by pg_resgroup_get_status().
+ *
+ * The cgroup directory only needs to be writable by the database owner:
+ * it is normally a directory of a cgroup v1 hierarchy with the cpu and
+ * cpuacct controllers mounted, but any directory will do, which is how the
+ * code is exercised on hosts without cgroups.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "catalog/pg_resqueue.h"
+#include "catalog/pg_type.h"
+#include "cdb/cdbvars.h"
+#include "cdb/memquota.h"
+#include "commands/queue.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "postmaster/backoff.h"
+#include "storage/fd.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/guc_tables.h"
+#include "utils/resgroup.h"
+#include "utils/resscheduler.h"
+#include "utils/vmem_tracker.h"
+
+/*
+ * GUC variables.
+ */
+bool	gp_resgroup_enable = false;		/* Apply the queue settings to
+										 * the backends? */
+char   *gp_resgroup_cgroup_dir = NULL;	/* Parent cgroup of the groups, or
+										 * empty to leave CPU alone. */
+
+/* Priority weight that maps to RESGROUP_DEFAULT_CPU_SHARES (MEDIUM) */
+#define RESGROUP_DEFAULT_PRIORITY_WEIGHT 500
+
+/*
+ * Shared state of one resource group. All the fields but vmemChunks are
+ * protected by the spinlock of the array; vmemChunks is updated atomically
+ * by vmem_tracker.c.
+ */
+typedef struct ResGroupSlot
+{
+	Oid			groupId;		/* resource queue, InvalidOid if unused */
+	int			nprocs;			/* backends in the group */
+	int			cpuShares;		/* cgroup settings last applied, -1 if none */
+	int			cpuRateLimit;
+	int64		memoryLimitBytes;	/* -1 if no limit */
+	int64		cpuUsecs;		/* CPU used by the transactions that left */
+	volatile int32 vmemChunks;	/* vmem charged to the group */
+} ResGroupSlot;
+
+typedef struct ResGroupControl
+{
+	slock_t		mutex;
+	int			nslots;
+	ResGroupSlot slots[1];		/* VARIABLE LENGTH ARRAY */
+} ResGroupControl;
+
+static ResGroupControl *ResGroupCtl = NULL;
+
+/* The group this backend is in, and the CPU time it had used on joining */
+static ResGroupSlot *MyResGroupSlot = NULL;
+static int64 MyResGroupCpuStartUsecs = 0;
+
+/*
+ * On a segment, the resource queue of the statement the QD dispatched. The
+ * portals of a QE do not have a queue of their own.
+ */
+static Oid ResGroupDispatchedQueueId = InvalidOid;
+
+/* The cgroup this process was last moved into */
+static Oid MyResGroupCgroupId = InvalidOid;
+
+static bool resGroupExitRegistered = false;
+static bool resGroupCgroupWarned = false;
+
+static ResGroupSlot *ResGroupSlotAcquire(Oid groupId);
+static void ResGroupGetSettings(Oid queueId, int *cpuRateLimit, int64 *memoryLimitBytes);
+static void ResGroupCgroupAttach(Oid groupId, int cpuShares, int cpuRateLimit,
+								 bool applySettings);
+static bool ResGroupCgroupWrite(Oid groupId, const char *file, const char *value);
+static bool ResGroupCgroupReadUsage(Oid groupId, int64 *usageNsecs);
+static int64 ResGroupGetCpuUsecs(void);
+static void ResGroupProcExit(int code, Datum arg);
+
+/*
+ * ResGroupShmemSize -- estimate the shared memory needed by the groups.
+ */
+Size
+ResGroupShmemSize(void)
+{
+	Size		size;
+
+	size = offsetof(ResGroupControl, slots);
+	size = add_size(size, mul_size(Max(MaxResourceQueues, 1), sizeof(ResGroupSlot)));
+
+	return size;
+}
+
+/*
+ * ResGroupShmemInit -- set up the shared array of group slots.
+ */
+void
+ResGroupShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	ResGroupCtl = (ResGroupControl *)
+		ShmemInitStruct("Resource Group Control", ResGroupShmemSize(), &found);
+
+	if (found)
+		return;
+
+	SpinLockInit(&ResGroupCtl->mutex);
+	ResGroupCtl->nslots = Max(MaxResourceQueues, 1);
+
+	for (i = 0; i < ResGroupCtl->nslots; i++)
+	{
+		ResGroupSlot *slot = &ResGroupCtl->slots[i];
+
+		slot->groupId = InvalidOid;
+		slot->nprocs = 0;
+		slot->cpuShares = -1;
+		slot->cpuRateLimit = -1;
+		slot->memoryLimitBytes = -1;
+		slot->cpuUsecs = 0;
+		slot->vmemChunks = 0;
+	}
+}
+
+/*
+ * ResGroupStatementStart -- put this backend into the group of a resource
+ * queue for the rest of the transaction.
+ *
+ * Called at the start of each statement, on the master and the segments.
+ * On a segment, queueId is ignored in favour of the queue the QD sent with
+ * the statement. The queue settings are only looked up by the first
+ * statement of the transaction.
+ */
+void
+ResGroupStatementStart(Oid queueId)
+{
+	ResGroupSlot *slot;
+	int			cpuShares;
+	int			cpuRateLimit;
+	int64		memoryLimitBytes;
+	bool		applySettings;
+
+	if (Gp_role == GP_ROLE_EXECUTE)
+		queueId = ResGroupDispatchedQueueId;
+
+	if (!gp_resgroup_enable || ResGroupCtl == NULL || queueId == InvalidOid)
+		return;
+
+	if ((Gp_role != GP_ROLE_DISPATCH && Gp_role != GP_ROLE_EXECUTE) ||
+		gp_session_id <= -1)
+		return;
+
+	/* Like the resource queues, the groups do not hold back superusers */
+	if (MyResGroupSlot == NULL && superuser())
+		return;
+
+	if (MyResGroupSlot != NULL)
+	{
+		if (MyResGroupSlot->groupId == queueId)
+			return;
+
+		/* The role was given another queue half way through */
+		AtEOXact_ResGroup();
+	}
+
+	cpuShares = ResGroupPriorityWeightToShares(ResourceQueueGetPriorityWeight(queueId));
+	ResGroupGetSettings(queueId, &cpuRateLimit, &memoryLimitBytes);
+
+	slot = ResGroupSlotAcquire(queueId);
+	if (slot == NULL)
+	{
+		elog(DEBUG1, "no free resource group slot for resource queue %u", queueId);
+		return;
+	}
+
+	if (!resGroupExitRegistered)
+	{
+		on_shmem_exit(ResGroupProcExit, 0);
+		resGroupExitRegistered = true;
+	}
+
+	/* Only the first backend to see new settings rewrites the cgroup files */
+	SpinLockAcquire(&ResGroupCtl->mutex);
+	applySettings = (slot->cpuShares != cpuShares ||
+					 slot->cpuRateLimit != cpuRateLimit);
+	slot->cpuShares = cpuShares;
+	slot->cpuRateLimit = cpuRateLimit;
+	slot->memoryLimitBytes = memoryLimitBytes;
+	SpinLockRelease(&ResGroupCtl->mutex);
+
+	if (gp_resgroup_cgroup_dir != NULL && gp_resgroup_cgroup_dir[0] != '\0')
+		ResGroupCgroupAttach(queueId, cpuShares, cpuRateLimit, applySettings);
+
+	MyResGroupSlot = slot;
+	MyResGroupCpuStartUsecs = ResGroupGetCpuUsecs();
+	VmemTracker_JoinResGroup(&slot->vmemChunks, memoryLimitBytes);
+}
+
+/*
+ * ResGroupSetDispatchedQueueId -- remember the resource queue of the
+ * statement received from the QD, for ResGroupStatementStart().
+ */
+void
+ResGroupSetDispatchedQueueId(Oid queueId)
+{
+	ResGroupDispatchedQueueId = queueId;
+}
+
+/*
+ * AtEOXact_ResGroup -- take this backend out of its group at the end of
+ * the transaction.
+ *
+ * The process stays in the cgroup until it joins another group: an idle
+ * backend uses no CPU, and this saves moving it back and forth.
+ */
+void
+AtEOXact_ResGroup(void)
+{
+	ResGroupSlot *slot = MyResGroupSlot;
+	int64		cpuUsecs;
+
+	if (slot == NULL)
+		return;
+
+	MyResGroupSlot = NULL;
+
+	VmemTracker_LeaveResGroup();
+	cpuUsecs = ResGroupGetCpuUsecs() - MyResGroupCpuStartUsecs;
+
+	SpinLockAcquire(&ResGroupCtl->mutex);
+	Assert(slot->nprocs > 0);
+	slot->nprocs--;
+	slot->cpuUsecs += Max(cpuUsecs, 0);
+	SpinLockRelease(&ResGroupCtl->mutex);
+}
+
+/*
+ * ResGroupPriorityWeightToShares -- map a backoff priority weight to
+ * cpu.shares, MEDIUM getting the kernel's default.
+ */
+int
+ResGroupPriorityWeightToShares(int weight)
+{
+	int64		shares;
+
+	shares = (int64) weight * RESGROUP_DEFAULT_CPU_SHARES / RESGROUP_DEFAULT_PRIORITY_WEIGHT;
+
+	if (shares < RESGROUP_MIN_CPU_SHARES)
+		return RESGROUP_MIN_CPU_SHARES;
+	if (shares > RESGROUP_MAX_CPU_SHARES)
+		return RESGROUP_MAX_CPU_SHARES;
+
+	return (int) shares;
+}
+
+/*
+ * ResGroupCpuRateLimitToQuota -- compute cpu.cfs_quota_us for a cap of
+ * cpuRateLimit percent of ncores cores. Returns -1 (no quota) if there is
+ * no limit.
+ */
+int64
+ResGroupCpuRateLimitToQuota(int cpuRateLimit, int ncores)
+{
+	if (cpuRateLimit <= 0 || cpuRateLimit >= 100)
+		return -1;
+
+	return (int64) RESGROUP_CPU_PERIOD_USECS * Max(ncores, 1) * cpuRateLimit / 100;
+}
+
+/*
+ * ResGroupGetSettings -- look up the cpu_rate_limit and memory_limit of a
+ * resource queue, -1 meaning no limit.
+ */
+static void
+ResGroupGetSettings(Oid queueId, int *cpuRateLimit, int64 *memoryLimitBytes)
+{
+	List	   *capabilitiesList;
+	ListCell   *le;
+
+	*cpuRateLimit = -1;
+	*memoryLimitBytes = ResourceQueueGetMemoryLimitInCatalog(queueId);
+
+	capabilitiesList = GetResqueueCapabilityEntry(queueId); /* This is a list of lists */
+
+	foreach(le, capabilitiesList)
+	{
+		List	   *entry = (List *) lfirst(le);
+		Value	   *key = (Value *) linitial(entry);
+
+		Assert(key->type == T_Integer); /* This is resource type id */
+		if (intVal(key) == PG_RESRCTYPE_CPU_RATE_LIMIT)
+		{
+			Value	   *val = lsecond(entry);
+
+			Assert(val->type == T_String);
+			if (!parse_int(strVal(val), cpuRateLimit, 0, NULL))
+				*cpuRateLimit = -1;
+		}
+	}
+	list_free(capabilitiesList);
+}
+
+/*
+ * ResGroupSlotAcquire -- find the slot of a group and count this backend
+ * in it, taking a free slot if the group has none.
+ *
+ * Returns NULL if all the slots are used by groups with running backends.
+ */
+static ResGroupSlot *
+ResGroupSlotAcquire(Oid groupId)
+{
+	ResGroupSlot *result = NULL;
+	ResGroupSlot *idle = NULL;
+	int			i;
+
+	SpinLockAcquire(&ResGroupCtl->mutex);
+
+	for (i = 0; i < ResGroupCtl->nslots; i++)
+	{
+		ResGroupSlot *slot = &ResGroupCtl->slots[i];
+
+		if (slot->groupId == groupId)
+		{
+			result = slot;
+			break;
+		}
+
+		/* Prefer unused slots, so that idle groups keep their usage */
+		if (slot->groupId == InvalidOid)
+		{
+			if (idle == NULL || idle->groupId != InvalidOid)
+				idle = slot;
+		}
+		else if (idle == NULL && slot->nprocs == 0 && slot->vmemChunks == 0)
+			idle = slot;
+	}
+
+	if (result == NULL && idle != NULL)
+	{
+		result = idle;
+		result->groupId = groupId;
+		result->nprocs = 0;
+		result->cpuShares = -1;
+		result->cpuRateLimit = -1;
+		result->memoryLimitBytes = -1;
+		result->cpuUsecs = 0;
+		result->vmemChunks = 0;
+	}
+
+	if (result != NULL)
+		result->nprocs++;
+
+	SpinLockRelease(&ResGroupCtl->mutex);
+
+	return result;
+}
+
+/*
+ * ResGroupCgroupAttach -- move this process into the cgroup of a group,
+ * creating the cgroup and applying its CPU settings if needed.
+ *
+ * A misconfigured cgroup directory must not fail the queries, so problems
+ * are reported once per process as a warning.
+ */
+static void
+ResGroupCgroupAttach(Oid groupId, int cpuShares, int cpuRateLimit, bool applySettings)
+{
+	char		path[MAXPGPATH];
+	char		value[64];
+	bool		ok = true;
+
+	snprintf(path, sizeof(path), "%s/%u", gp_resgroup_cgroup_dir, groupId);
+	if (mkdir(path, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == 0)
+		applySettings = true;
+	else if (errno != EEXIST)
+	{
+		if (!resGroupCgroupWarned)
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not create resource group cgroup \"%s\": %m",
+							path)));
+		resGroupCgroupWarned = true;
+		return;
+	}
+
+	if (applySettings)
+	{
+		snprintf(value, sizeof(value), "%d", cpuShares);
+		ok = ResGroupCgroupWrite(groupId, "cpu.shares", value);
+
+		snprintf(value, sizeof(value), "%d", RESGROUP_CPU_PERIOD_USECS);
+		ok = ok && ResGroupCgroupWrite(groupId, "cpu.cfs_period_us", value);
+
+		snprintf(value, sizeof(value), INT64_FORMAT,
+				 ResGroupCpuRateLimitToQuota(cpuRateLimit,
+											 (int) sysconf(_SC_NPROCESSORS_ONLN)));
+		ok = ok && ResGroupCgroupWrite(groupId, "cpu.cfs_quota_us", value);
+	}
+
+	if (ok && MyResGroupCgroupId != groupId)
+	{
+		/* cgroup.procs moves all the threads of the process at once */
+		snprintf(value, sizeof(value), "%d", MyProcPid);
+		ok = ResGroupCgroupWrite(groupId, "cgroup.procs", value);
+		if (ok)
+			MyResGroupCgroupId = groupId;
+	}
+
+	if (!ok && !resGroupCgroupWarned)
+	{
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not apply resource group cgroup settings in \"%s\": %m",
+						path)));
+		resGroupCgroupWarned = true;
+	}
+}
+
+/*
+ * ResGroupCgroupWrite -- write a value to a control file of a group's
+ * cgroup. Returns false, with errno set, on failure.
+ */
+static bool
+ResGroupCgroupWrite(Oid groupId, const char *file, const char *value)
+{
+	char		path[MAXPGPATH];
+	FILE	   *fp;
+	bool		ok;
+
+	snprintf(path, sizeof(path), "%s/%u/%s", gp_resgroup_cgroup_dir, groupId, file);
+
+	fp = AllocateFile(path, "w");
+	if (fp == NULL)
+		return false;
+
+	ok = (fprintf(fp, "%s\n", value) >= 0);
+
+	/* The cgroup file system reports invalid values when flushing */
+	if (FreeFile(fp) != 0)
+		ok = false;
+
+	return ok;
+}
+
+/*
+ * ResGroupCgroupReadUsage -- read the CPU time used by all the processes of
+ * a group's cgroup, as accounted by the cpuacct controller.
+ */
+static bool
+ResGroupCgroupReadUsage(Oid groupId, int64 *usageNsecs)
+{
+	char		path[MAXPGPATH];
+	FILE	   *fp;
+	long long	usage;
+	bool		ok;
+
+	if (gp_resgroup_cgroup_dir == NULL || gp_resgroup_cgroup_dir[0] == '\0')
+		return false;
+
+	snprintf(path, sizeof(path), "%s/%u/cpuacct.usage", gp_resgroup_cgroup_dir, groupId);
+
+	fp = AllocateFile(path, "r");
+	if (fp == NULL)
+		return false;
+
+	ok = (fscanf(fp, "%lld", &usage) == 1);
+	FreeFile(fp);
+
+	if (ok)
+		*usageNsecs = (int64) usage;
+
+	return ok;
+}
+
+/*
+ * ResGroupGetCpuUsecs -- CPU time used by this process so far.
+ */
+static int64
+ResGroupGetCpuUsecs(void)
+{
+	struct rusage r;
+
+	if (getrusage(RUSAGE_SELF, &r) != 0)
+		return 0;
+
+	return (int64) (r.ru_utime.tv_sec + r.ru_stime.tv_sec) * USECS_PER_SEC +
+		r.ru_utime.tv_usec + r.ru_stime.tv_usec;
+}
+
+static void
+ResGroupProcExit(int code, Datum arg)
+{
+	AtEOXact_ResGroup();
+}
+
+/* Number of columns produced by pg_resgroup_get_status() */
+#define PG_RESGROUP_GET_STATUS_COLUMNS 8
+
+/*
+ * pg_resgroup_get_status - produce a view with one row per resource group
+ * in use on this node, showing its settings and its CPU and memory usage.
+ */
+Datum
+pg_resgroup_get_status(PG_FUNCTION_ARGS)
+{
+	FuncCallContext			*funcctx = NULL;
+	Datum					result;
+	MemoryContext			oldcontext = NULL;
+	ResGroupSlot			*slots = NULL;
+	HeapTuple				tuple = NULL;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		int					i;
+		int					n = 0;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch context when allocating stuff to be used in later calls */
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* Construct a tuple descriptor for the result rows. */
+		TupleDesc tupledesc = CreateTemplateTupleDesc(PG_RESGROUP_GET_STATUS_COLUMNS, false);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 1, "groupid", OIDOID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 2, "num_running", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 3, "cpu_shares", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 4, "cpu_rate_limit", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 5, "cpu_usage_secs", FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 6, "cgroup_cpu_usage_secs", FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 7, "memory_used_mb", INT4OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 8, "memory_limit_mb", INT4OID, -1, 0);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupledesc);
+
+		if (ResGroupCtl != NULL)
+		{
+			slots = (ResGroupSlot *) palloc(sizeof(ResGroupSlot) * ResGroupCtl->nslots);
+
+			SpinLockAcquire(&ResGroupCtl->mutex);
+			for (i = 0; i < ResGroupCtl->nslots; i++)
+			{
+				if (ResGroupCtl->slots[i].groupId != InvalidOid)
+					slots[n++] = ResGroupCtl->slots[i];
+			}
+			SpinLockRelease(&ResGroupCtl->mutex);
+		}
+
+		funcctx->user_fctx = slots;
+		funcctx->max_calls = n;
+
+		/* Return to original context when allocating transient memory */
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	/* Get the saved state. */
+	slots = (ResGroupSlot *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		ResGroupSlot *slot = &slots[funcctx->call_cntr];
+		Datum		values[PG_RESGROUP_GET_STATUS_COLUMNS];
+		bool		nulls[PG_RESGROUP_GET_STATUS_COLUMNS];
+		int64		usageNsecs;
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = ObjectIdGetDatum(slot->groupId);
+		values[1] = Int32GetDatum(slot->nprocs);
+		values[2] = Int32GetDatum(slot->cpuShares);
+		values[3] = Int32GetDatum(slot->cpuRateLimit);
+		values[4] = Float8GetDatum((double) slot->cpuUsecs / USECS_PER_SEC);
+
+		if (ResGroupCgroupReadUsage(slot->groupId, &usageNsecs))
+			values[5] = Float8GetDatum((double) usageNsecs / 1000000000.0);
+		else
+			nulls[5] = true;
+
+		values[6] = Int32GetDatum(VmemTracker_ConvertVmemChunksToMB(slot->vmemChunks));
+
+		if (slot->memoryLimitBytes > 0)
+			values[7] = Int32GetDatum((int32) (slot->memoryLimitBytes / (1024 * 1024)));
+		else
+			nulls[7] = true;
+
+		/* Build and return the tuple. */
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		result = HeapTupleGetDatum(tuple);
+
+		SRF_RETURN_NEXT(funcctx, result);
+	}
+	else
+		SRF_RETURN_DONE(funcctx);
+}
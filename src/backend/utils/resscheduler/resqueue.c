@@ -46,6 +46,7 @@ static void ResLockUpdateLimit(LOCK *lock, PROCLOCK *proclock, ResPortalIncremen
 
 static void				ResGrantLock(LOCK *lock, PROCLOCK *proclock);
 static bool				ResUnGrantLock(LOCK *lock, PROCLOCK *proclock);
+static void				ResQueueNoteAdmission(ResQueue queue, ResPortalIncrement *incrementSet);
 
 
 /*
@@ -87,6 +88,33 @@ typedef struct
 static void BuildQueueStatusContext(QueueStatusContext *fctx);
 
 
+/*
+ * A process waiting on a resource lock, as considered for wakeup by
+ * ResProcLockRemoveSelfAndWakeup().
+ */
+typedef struct
+{
+	PGPROC				*proc;
+	ResPortalIncrement	*incrementSet;
+	int					position;		/* Position in the wait queue. */
+	bool				starved;		/* Waited for longer than
+										 * gp_resqueue_starvation_timeout? */
+	bool				granted;
+}	ResWaiter;
+
+static int ResWaiterCompare(const void *a, const void *b);
+static void ResWaitersReserve(void);
+static bool ResWaitersAdmitNewcomer(LOCK *lock, ResPortalIncrement *incrementSet);
+
+/*
+ * Scratch array for ResProcLockRemoveSelfAndWakeup(), big enough for every
+ * backend to be waiting.  It runs while holding ResQueueLock and the lock
+ * partition lock, where running out of memory would leave the queue half
+ * updated, so the array is allocated up front by ResWaitersReserve().
+ */
+static ResWaiter *resWaiters = NULL;
+
+
 /*
  * ResLockAcquire -- acquire a resource lock.
  *
@@ -134,6 +162,9 @@ ResLockAcquire(LOCKTAG *locktag, ResPortalIncrement *incrementSet)
 	/* Provide a resource owner. */
 	owner = CurrentResourceOwner;
 
+	/* Before any locks are taken, as this may allocate. */
+	ResWaitersReserve();
+
 	/*
 	 * Find or create a LOCALLOCK entry for this lock and lockmode
 	 */
@@ -343,6 +374,19 @@ ResLockAcquire(LOCKTAG *locktag, ResPortalIncrement *incrementSet)
 	 * queue control is not exhausted). 
 	 */
 	status = ResLockCheckLimit(lock, proclock, incrementSet, true);
+
+	/*
+	 * When waiters are admitted cheapest first, a newcomer that fits may go
+	 * ahead of them only if it is no more expensive than any of them, which
+	 * is the order ResProcLockRemoveSelfAndWakeup() would have picked, and
+	 * nobody is starved. Otherwise it queues up behind them, and the next
+	 * release considers everybody together.
+	 */
+	if (status == STATUS_OK && gp_resqueue_admit_shortest_first &&
+		lock->waitProcs.size > 0 &&
+		!ResWaitersAdmitNewcomer(lock, incrementSet))
+		status = STATUS_FOUND;
+
 	if (status == STATUS_ERROR)
 	{
 		/*
@@ -383,6 +427,7 @@ ResLockAcquire(LOCKTAG *locktag, ResPortalIncrement *incrementSet)
 		 * queue, so record this in the local lock hash, and grant it.
 		 */
 		ResGrantLock(lock, proclock);
+		ResQueueNoteAdmission(queue, incrementSet);
 		ResLockUpdateLimit(lock, proclock, incrementSet, true, false);
 
 		LWLockRelease(ResQueueLock);
@@ -409,6 +454,9 @@ ResLockAcquire(LOCKTAG *locktag, ResPortalIncrement *incrementSet)
 		 */
 		MyProc->waitPortalId = incrementSet->portalId;
 
+		/* Note when we started queuing, for the admission policy. */
+		incrementSet->waitStart = GetCurrentTimestamp();
+
 		LWLockRelease(ResQueueLock);
 
 		/* Note count and wait time for queue statistics. */
@@ -477,6 +525,9 @@ ResLockRelease(LOCKTAG *locktag, uint32 resPortalId)
 	ResPortalIncrement	*incrementSet;
 	ResPortalTag		portalTag;
 
+	/* Before any locks are taken, as this may allocate. */
+	ResWaitersReserve();
+
 	/* Check the lock method bits. */
 	Assert(locktag->locktag_lockmethodid == RESOURCE_LOCKMETHOD);
 
@@ -662,14 +713,24 @@ ResLockCheckLimit(LOCK *lock, PROCLOCK *proclock, ResPortalIncrement *incrementS
 		{
 			case RES_COUNT_LIMIT:
 			{
+				Cost		threshold = limits[i].threshold_value;
+
 				Assert((limits[i].threshold_is_max));
 
+				/*
+				 * Short queries may use a few extra slots, so that they are
+				 * not stuck behind long running statements.
+				 */
+				if (gp_resqueue_short_query_cost > 0 &&
+					incrementSet->increments[RES_COST_LIMIT] < gp_resqueue_short_query_cost)
+					threshold += gp_resqueue_short_query_slots;
+
 				/* Setup whether to increment or decrement the # active. */
 				if (increment)
 				{
 					increment_amt = incrementSet->increments[i];
 
-					if (limits[i].current_value + increment_amt > limits[i].threshold_value)
+					if (limits[i].current_value + increment_amt > threshold)
 						over_limit = true;
 				}
 				else
@@ -838,6 +899,47 @@ ResLockUpdateLimit(LOCK *lock, PROCLOCK *proclock, ResPortalIncrement *increment
 	return;
 }
 
+/*
+ * ResQueueNoteAdmission -- update the admission statistics of a queue for
+ *	a statement that is about to be granted its resource lock.
+ *
+ * Warnings:
+ *	Must be called before ResLockUpdateLimit() adds the increments, and
+ *	with the resource queue lightweight lock (ResQueueLock) held.
+ */
+static void
+ResQueueNoteAdmission(ResQueue queue, ResPortalIncrement *incrementSet)
+{
+	ResLimit	countLimit = &queue->limits[RES_COUNT_LIMIT];
+
+	Assert(LWLockHeldExclusiveByMe(ResQueueLock));
+
+	queue->numAdmitted++;
+
+	/* Only short queries are let in beyond the count threshold. */
+	if (countLimit->threshold_value != INVALID_RES_LIMIT_THRESHOLD &&
+		countLimit->current_value + incrementSet->increments[RES_COUNT_LIMIT] >
+		countLimit->threshold_value)
+		queue->numAdmittedShort++;
+
+	if (incrementSet->waitStart != 0)
+	{
+		long		secs;
+		int			usecs;
+		double		waitSecs;
+
+		TimestampDifference(incrementSet->waitStart, GetCurrentTimestamp(),
+							&secs, &usecs);
+		waitSecs = secs + usecs / 1000000.0;
+
+		queue->numAdmittedAfterWait++;
+		queue->totalWaitSecs += waitSecs;
+		queue->maxWaitSecs = Max(queue->maxWaitSecs, waitSecs);
+
+		incrementSet->waitStart = 0;
+	}
+}
+
 /*
  * GetResQueueFromLock -- find the resource queue for a given lock;
  *
@@ -1060,6 +1162,14 @@ ResWaitOnLock(LOCALLOCK *locallock, ResourceOwner owner, ResPortalIncrement *inc
  *  It always remove itself from the waitlist.
  *	Need to only awaken enough as many waiters as the resource controlled by 
  *	the the lock should allow!
+ *
+ *	Waiters are considered in queue order, and every one that fits is
+ *	granted the lock.  With gp_resqueue_admit_shortest_first they are
+ *	considered cheapest first instead, which lets more statements through
+ *	under the same limits.  To keep expensive statements from starving, a
+ *	waiter that has queued for longer than gp_resqueue_starvation_timeout
+ *	goes ahead of all others, and nobody else is let in while it does not
+ *	fit.
  */
 void
 ResProcLockRemoveSelfAndWakeup(LOCK *lock)
@@ -1069,23 +1179,31 @@ ResProcLockRemoveSelfAndWakeup(LOCK *lock)
 	PGPROC		*proc;
 	uint32		hashcode;
 	LWLockId	partitionLock;
+	ResQueue	queue;
+	ResWaiter	*waiters;
+	int			numWaiters = 0;
+	int			firstWaiting;
+	TimestampTz	now = 0;
+	int			i;
 
 	int			status;
 
 	Assert(LWLockHeldExclusiveByMe(ResQueueLock));
 
-	/*
-	 * XXX: This code is ugly and hard to read -- it should be a lot
-	 * simpler, especially when there are some odd cases (process
-	 * sitting on its own wait-queue).
-	 */
-
 	Assert(queue_size >= 0);
 	if (queue_size == 0)
 	{
 		return;
 	}
 
+	queue = GetResQueueFromLock(lock);
+
+	Assert(resWaiters != NULL && queue_size <= MaxBackends);
+	waiters = resWaiters;
+
+	if (gp_resqueue_admit_shortest_first)
+		now = GetCurrentTimestamp();
+
 	proc = (PGPROC *) MAKE_PTR(waitQueue->links.next);
 
 	while (queue_size-- > 0)
@@ -1095,6 +1213,7 @@ ResProcLockRemoveSelfAndWakeup(LOCK *lock)
 		 */
 		ResPortalTag			portalTag;
 		ResPortalIncrement		*incrementSet;
+		ResWaiter				*waiter;
 
 		/* Our own process may be on our wait-queue! */
 		if (proc->pid == MyProc->pid)
@@ -1125,30 +1244,157 @@ ResProcLockRemoveSelfAndWakeup(LOCK *lock)
 			elog(ERROR, "no increment data for  portal id %u and pid %d", proc->waitPortalId, proc->pid);
 		}
 
+		waiter = &waiters[numWaiters];
+		waiter->proc = proc;
+		waiter->incrementSet = incrementSet;
+		waiter->position = numWaiters;
+		waiter->starved = (gp_resqueue_admit_shortest_first &&
+						   incrementSet->waitStart != 0 &&
+						   TimestampDifferenceExceeds(incrementSet->waitStart, now,
+													  gp_resqueue_starvation_timeout * 1000));
+		waiter->granted = false;
+		numWaiters++;
+
+		proc = (PGPROC *) MAKE_PTR(proc->links.next);
+	}
+
+	if (gp_resqueue_admit_shortest_first && numWaiters > 1)
+		qsort(waiters, numWaiters, sizeof(ResWaiter), ResWaiterCompare);
+
+	for (i = 0; i < numWaiters; i++)
+	{
+		ResWaiter	*waiter = &waiters[i];
+		PROCLOCK	*proclock = (PROCLOCK *) waiter->proc->waitProcLock;
+
 		/*
-		 * See if it is ok to wake this guy. (note that the wakeup
-		 * writes to the wait list, and gives back a *new* next proc).
+		 * See if it is ok to wake this guy.
 		 */
-		status = ResLockCheckLimit(lock, (PROCLOCK *) proc->waitProcLock, incrementSet, true);
+		status = ResLockCheckLimit(lock, proclock, waiter->incrementSet, true);
 		if (status == STATUS_OK)
 		{
-			ResGrantLock(lock, (PROCLOCK *) proc->waitProcLock);
-			ResLockUpdateLimit(lock, (PROCLOCK *) proc->waitProcLock, incrementSet, true, false);
+			ResGrantLock(lock, proclock);
+			ResQueueNoteAdmission(queue, waiter->incrementSet);
+			ResLockUpdateLimit(lock, proclock, waiter->incrementSet, true, false);
 
-			proc = ResProcWakeup(proc, STATUS_OK);
+			ResProcWakeup(waiter->proc, STATUS_OK);
+			waiter->granted = true;
 		}
-		else
+		else if (waiter->starved)
 		{
-			/* Otherwise move on to the next guy. */
-			proc = (PGPROC *) MAKE_PTR(proc->links.next);
+			/* Keep the freed resources for the starved waiter. */
+			break;
 		}
 	}
 
+	/* Count the admissions that overtook a statement that is still queued. */
+	firstWaiting = numWaiters;
+	for (i = 0; i < numWaiters; i++)
+	{
+		if (!waiters[i].granted)
+			firstWaiting = Min(firstWaiting, waiters[i].position);
+	}
+	for (i = 0; i < numWaiters; i++)
+	{
+		if (waiters[i].granted && waiters[i].position > firstWaiting)
+			queue->numAdmittedOutOfOrder++;
+	}
+
 	Assert(waitQueue->size >= 0);
 	
 	return;
 }
 
+/*
+ * ResWaitersReserve -- allocate the scratch array for
+ *	ResProcLockRemoveSelfAndWakeup(), if not done yet.
+ *
+ * Every path that can end up waking waiters goes through ResLockAcquire()
+ * or ResLockRelease() first, which call this before taking any lock.
+ */
+static void
+ResWaitersReserve(void)
+{
+	if (resWaiters == NULL)
+		resWaiters = (ResWaiter *) MemoryContextAlloc(TopMemoryContext,
+													  MaxBackends * sizeof(ResWaiter));
+}
+
+/*
+ * ResWaitersAdmitNewcomer -- may a statement that fits go ahead of the
+ *	waiters on the lock, with gp_resqueue_admit_shortest_first?
+ *
+ * Only if it costs no more than the cheapest of them, and none of them has
+ * waited for longer than gp_resqueue_starvation_timeout.
+ */
+static bool
+ResWaitersAdmitNewcomer(LOCK *lock, ResPortalIncrement *incrementSet)
+{
+	PROC_QUEUE	*waitQueue = &(lock->waitProcs);
+	int			queue_size = waitQueue->size;
+	Cost		cost = incrementSet->increments[RES_COST_LIMIT];
+	TimestampTz	now = GetCurrentTimestamp();
+	PGPROC		*proc;
+
+	Assert(LWLockHeldExclusiveByMe(ResQueueLock));
+
+	proc = (PGPROC *) MAKE_PTR(waitQueue->links.next);
+
+	while (queue_size-- > 0)
+	{
+		ResPortalTag			portalTag;
+		ResPortalIncrement		*waiterSet;
+
+		MemSet(&portalTag, 0, sizeof(ResPortalTag));
+		portalTag.pid = proc->pid;
+		portalTag.portalId = proc->waitPortalId;
+
+		waiterSet = ResIncrementFind(&portalTag);
+
+		/* Be conservative about a waiter we know nothing about */
+		if (!waiterSet)
+			return false;
+
+		if (waiterSet->increments[RES_COST_LIMIT] < cost)
+			return false;
+
+		if (waiterSet->waitStart != 0 &&
+			TimestampDifferenceExceeds(waiterSet->waitStart, now,
+									   gp_resqueue_starvation_timeout * 1000))
+			return false;
+
+		proc = (PGPROC *) MAKE_PTR(proc->links.next);
+	}
+
+	return true;
+}
+
+/*
+ * ResWaiterCompare -- qsort comparator putting starved waiters first, in
+ *	queue order, followed by the others cheapest first.
+ */
+static int
+ResWaiterCompare(const void *a, const void *b)
+{
+	const ResWaiter *wa = (const ResWaiter *) a;
+	const ResWaiter *wb = (const ResWaiter *) b;
+
+	if (wa->starved != wb->starved)
+		return wa->starved ? -1 : 1;
+
+	if (!wa->starved)
+	{
+		Cost		costa = wa->incrementSet->increments[RES_COST_LIMIT];
+		Cost		costb = wb->incrementSet->increments[RES_COST_LIMIT];
+
+		if (costa < costb)
+			return -1;
+		if (costa > costb)
+			return 1;
+	}
+
+	return wa->position - wb->position;
+}
+
 
 /*
  * ResProcWakeup -- wake a sleeping process.
@@ -1452,6 +1698,7 @@ ResIncrementAdd(ResPortalIncrement *incSet, PROCLOCK *proclock, ResourceOwner ow
 		{
 			incrementSet->increments[i] = incSet->increments[i];
 		}
+		incrementSet->waitStart = 0;
 		SHMQueueInsertBefore(&proclock->portalLinks, &incrementSet->portalLink);
 	}
 	else
@@ -2019,6 +2266,101 @@ pg_resqueue_status_kv(PG_FUNCTION_ARGS)
 }
 
 
+/* Number of columns produced by pg_resqueue_admission_stats() */
+#define PG_RESQUEUE_ADMISSION_STATS_COLUMNS 7
+
+/*
+ * pg_resqueue_admission_stats - produce a view with one row per resource
+ *	queue showing how statements were admitted and how long they queued.
+ */
+Datum
+pg_resqueue_admission_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext			*funcctx = NULL;
+	Datum					result;
+	MemoryContext			oldcontext = NULL;
+	ResQueueData			*queues = NULL;
+	HeapTuple				tuple = NULL;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		HASH_SEQ_STATUS		status;
+		ResQueueData		*queue;
+		int					i = 0;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		/* Switch context when allocating stuff to be used in later calls */
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* Overestimate, so that we need not allocate while holding the lock. */
+		queues = (ResQueueData *) palloc(sizeof(ResQueueData) * MaxResourceQueues);
+		funcctx->user_fctx = queues;
+
+		/* Construct a tuple descriptor for the result rows. */
+		TupleDesc tupledesc = CreateTemplateTupleDesc(PG_RESQUEUE_ADMISSION_STATS_COLUMNS, false);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 1, "queueid", OIDOID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 2, "admitted", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 3, "admitted_after_wait", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 4, "admitted_short", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 5, "admitted_out_of_order", INT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 6, "total_wait_secs", FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupledesc, (AttrNumber) 7, "max_wait_secs", FLOAT8OID, -1, 0);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupledesc);
+
+		/* Return to original context when allocating transient memory */
+		MemoryContextSwitchTo(oldcontext);
+
+		/*
+		 * The statistics are only ever updated with ResQueueLock held, so
+		 * there is no need for the partition locks here.
+		 */
+		LWLockAcquire(ResQueueLock, LW_SHARED);
+
+		hash_seq_init(&status, ResQueueHash);
+		while ((queue = (ResQueueData *) hash_seq_search(&status)) != NULL)
+		{
+			Assert(i < MaxResourceQueues);
+			queues[i++] = *queue;
+		}
+
+		LWLockRelease(ResQueueLock);
+
+		funcctx->max_calls = i;
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	/* Get the saved state. */
+	queues = (ResQueueData *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		ResQueueData	*queue = &queues[funcctx->call_cntr];
+		Datum		values[PG_RESQUEUE_ADMISSION_STATS_COLUMNS];
+		bool		nulls[PG_RESQUEUE_ADMISSION_STATS_COLUMNS];
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = ObjectIdGetDatum(queue->queueid);
+		values[1] = Int64GetDatum(queue->numAdmitted);
+		values[2] = Int64GetDatum(queue->numAdmittedAfterWait);
+		values[3] = Int64GetDatum(queue->numAdmittedShort);
+		values[4] = Int64GetDatum(queue->numAdmittedOutOfOrder);
+		values[5] = Float8GetDatum(queue->totalWaitSecs);
+		values[6] = Float8GetDatum(queue->maxWaitSecs);
+
+		/* Build and return the tuple. */
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		result = HeapTupleGetDatum(tuple);
+
+		SRF_RETURN_NEXT(funcctx, result);
+	}
+	else
+		SRF_RETURN_DONE(funcctx);
+}
+
 #ifdef USE_ASSERT_CHECKING
 /**
  * Checks that in-memory data-structures are consistent with the catalog table.
@@ -48,6 +48,14 @@ int		MaxResourcePortalsPerXact;				/* Max # tracked portals -
 												 * per backend . */
 bool	ResourceSelectOnly;						/* Only lock SELECT/DECLARE? */
 bool	ResourceCleanupIdleGangs;				/* Cleanup idle gangs? */
+double	gp_resqueue_short_query_cost = 0;		/* Cost below which a statement
+												 * may use the short query slots. */
+int		gp_resqueue_short_query_slots = 0;		/* Extra active statements allowed
+												 * for short queries. */
+bool	gp_resqueue_admit_shortest_first = false;	/* Wake waiters cheapest
+													 * first? */
+int		gp_resqueue_starvation_timeout = 60;	/* Secs after which a waiter is
+												 * admitted strictly first. */
 
 
 /*
@@ -331,6 +339,15 @@ ResCreateQueue(Oid queueid, Cost limits[NUM_RES_LIMIT_TYPES], bool overcommit,
 
 
 	}
+
+	/* No admissions yet. */
+	queue->numAdmitted = 0;
+	queue->numAdmittedAfterWait = 0;
+	queue->numAdmittedShort = 0;
+	queue->numAdmittedOutOfOrder = 0;
+	queue->totalWaitSecs = 0;
+	queue->maxWaitSecs = 0;
+
 	ResScheduler->num_queues++;
 	return true;
 }
@@ -0,0 +1,262 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../resgroup.c"
+#include "utils/memutils.h"
+
+#define TEST_QUEUE_MEMORY_LIMIT	(10 * 1024 * 1024)
+
+/*
+ * Stand-ins for the catalog lookups and the vmem tracker, so that a group
+ * can be joined without a database.
+ */
+static volatile int32 *joinedVmemChunks = NULL;
+static int64 joinedVmemLimitBytes = 0;
+
+bool
+__wrap_superuser(void)
+{
+	return false;
+}
+
+int
+__wrap_ResourceQueueGetPriorityWeight(Oid queueId)
+{
+	return RESGROUP_DEFAULT_PRIORITY_WEIGHT;
+}
+
+int64
+__wrap_ResourceQueueGetMemoryLimitInCatalog(Oid queueId)
+{
+	return TEST_QUEUE_MEMORY_LIMIT;
+}
+
+List *
+__wrap_GetResqueueCapabilityEntry(Oid queueId)
+{
+	return NIL;
+}
+
+void
+__wrap_VmemTracker_JoinResGroup(volatile int32 *groupVmemChunks,
+								int64 groupVmemLimitBytes)
+{
+	joinedVmemChunks = groupVmemChunks;
+	joinedVmemLimitBytes = groupVmemLimitBytes;
+}
+
+void
+__wrap_VmemTracker_LeaveResGroup(void)
+{
+	joinedVmemChunks = NULL;
+	joinedVmemLimitBytes = 0;
+}
+
+/*
+ * Sets up a private array of group slots, in place of the shared one.
+ */
+static void
+InitTestResGroupCtl(int nslots)
+{
+	int			i;
+
+	MaxResourceQueues = nslots;
+	ResGroupCtl = palloc0(ResGroupShmemSize());
+	SpinLockInit(&ResGroupCtl->mutex);
+	ResGroupCtl->nslots = nslots;
+
+	for (i = 0; i < nslots; i++)
+		ResGroupCtl->slots[i].groupId = InvalidOid;
+}
+
+static char *
+ReadTestCgroupFile(const char *dir, Oid groupId, const char *file)
+{
+	char		path[MAXPGPATH];
+	char	   *buf = palloc0(64);
+	FILE	   *fp;
+
+	snprintf(path, sizeof(path), "%s/%u/%s", dir, groupId, file);
+	fp = fopen(path, "r");
+	assert_true(fp != NULL);
+	assert_true(fgets(buf, 64, fp) != NULL);
+	fclose(fp);
+
+	return buf;
+}
+
+/* ==================== ResGroupPriorityWeightToShares ==================== */
+
+/*
+ * Tests that MEDIUM gets the kernel default, and that the others stay
+ * within what the cpu controller accepts.
+ */
+void
+test__ResGroupPriorityWeightToShares__ScalesAndClamps(void **state)
+{
+	assert_int_equal(ResGroupPriorityWeightToShares(500), RESGROUP_DEFAULT_CPU_SHARES);
+	assert_int_equal(ResGroupPriorityWeightToShares(1000), 2 * RESGROUP_DEFAULT_CPU_SHARES);
+	assert_int_equal(ResGroupPriorityWeightToShares(100), 204);
+	assert_int_equal(ResGroupPriorityWeightToShares(1000000), RESGROUP_MAX_CPU_SHARES);
+	assert_int_equal(ResGroupPriorityWeightToShares(0), RESGROUP_MIN_CPU_SHARES);
+}
+
+/* ==================== ResGroupCpuRateLimitToQuota ==================== */
+
+/*
+ * Tests that the cap is a share of all the cores, and that no limit means
+ * no quota.
+ */
+void
+test__ResGroupCpuRateLimitToQuota__SharesAllCores(void **state)
+{
+	assert_true(ResGroupCpuRateLimitToQuota(-1, 8) == -1);
+	assert_true(ResGroupCpuRateLimitToQuota(100, 8) == -1);
+	assert_true(ResGroupCpuRateLimitToQuota(50, 4) == 2 * RESGROUP_CPU_PERIOD_USECS);
+	assert_true(ResGroupCpuRateLimitToQuota(10, 1) == RESGROUP_CPU_PERIOD_USECS / 10);
+}
+
+/* ==================== ResGroupSlotAcquire ==================== */
+
+/*
+ * Tests that backends of a group share its slot, and that the slot of a
+ * group without backends is reused when the array is full.
+ */
+void
+test__ResGroupSlotAcquire__ReusesIdleSlots(void **state)
+{
+	ResGroupSlot *first;
+	ResGroupSlot *second;
+
+	InitTestResGroupCtl(2);
+
+	first = ResGroupSlotAcquire(100);
+	assert_true(first != NULL);
+	assert_true(ResGroupSlotAcquire(100) == first);
+	assert_int_equal(first->nprocs, 2);
+
+	second = ResGroupSlotAcquire(200);
+	assert_true(second != NULL && second != first);
+
+	/* Both groups are running */
+	assert_true(ResGroupSlotAcquire(300) == NULL);
+
+	/* Once the first group is idle, its slot goes to the new group */
+	MyResGroupSlot = first;
+	AtEOXact_ResGroup();
+	MyResGroupSlot = first;
+	AtEOXact_ResGroup();
+
+	assert_int_equal(first->nprocs, 0);
+	assert_true(MyResGroupSlot == NULL);
+	assert_true(ResGroupSlotAcquire(300) == first);
+	assert_int_equal(first->groupId, 300);
+	assert_int_equal(first->nprocs, 1);
+
+	pfree(ResGroupCtl);
+	ResGroupCtl = NULL;
+}
+
+/* ==================== ResGroupStatementStart ==================== */
+
+/*
+ * Tests that a QE joins the group of the queue sent by the QD, whatever its
+ * portal says, and that its vmem is then charged against the queue's
+ * memory_limit.
+ */
+void
+test__ResGroupStatementStart__SegmentJoinsDispatchedGroup(void **state)
+{
+	InitTestResGroupCtl(2);
+	gp_resgroup_enable = true;
+	gp_resgroup_cgroup_dir = NULL;
+	gp_session_id = 1;
+	resGroupExitRegistered = true;
+	Gp_role = GP_ROLE_EXECUTE;
+
+	/* Nothing is dispatched with a statement outside of any queue */
+	ResGroupSetDispatchedQueueId(InvalidOid);
+	ResGroupStatementStart(InvalidOid);
+	assert_true(MyResGroupSlot == NULL);
+
+	ResGroupSetDispatchedQueueId(700);
+	ResGroupStatementStart(InvalidOid);
+
+	assert_true(MyResGroupSlot != NULL);
+	assert_int_equal(MyResGroupSlot->groupId, 700);
+	assert_int_equal(MyResGroupSlot->nprocs, 1);
+	assert_true(joinedVmemChunks == &MyResGroupSlot->vmemChunks);
+	assert_true(joinedVmemLimitBytes == TEST_QUEUE_MEMORY_LIMIT);
+
+	AtEOXact_ResGroup();
+	assert_true(MyResGroupSlot == NULL);
+	assert_true(joinedVmemChunks == NULL);
+
+	Gp_role = GP_ROLE_UTILITY;
+	gp_resgroup_enable = false;
+	pfree(ResGroupCtl);
+	ResGroupCtl = NULL;
+}
+
+/* ==================== ResGroupCgroupAttach ==================== */
+
+/*
+ * Tests that the group's cgroup is created with its CPU settings, and that
+ * the process is moved into it. A plain directory stands in for the cgroup
+ * hierarchy.
+ */
+void
+test__ResGroupCgroupAttach__WritesControlFiles(void **state)
+{
+	char		dir[] = "/tmp/resgroup_test_XXXXXX";
+	char		expected[64];
+	char		cmd[MAXPGPATH];
+
+	assert_true(mkdtemp(dir) != NULL);
+	gp_resgroup_cgroup_dir = dir;
+	MyProcPid = getpid();
+	MyResGroupCgroupId = InvalidOid;
+
+	ResGroupCgroupAttach(6543, 2048, -1, false);
+
+	assert_string_equal(ReadTestCgroupFile(dir, 6543, "cpu.shares"), "2048\n");
+	assert_string_equal(ReadTestCgroupFile(dir, 6543, "cpu.cfs_quota_us"), "-1\n");
+
+	snprintf(expected, sizeof(expected), "%d\n", MyProcPid);
+	assert_string_equal(ReadTestCgroupFile(dir, 6543, "cgroup.procs"), expected);
+	assert_int_equal(MyResGroupCgroupId, 6543);
+
+	/* New settings are written to the existing cgroup */
+	ResGroupCgroupAttach(6543, 1024, 50, true);
+
+	assert_string_equal(ReadTestCgroupFile(dir, 6543, "cpu.shares"), "1024\n");
+	snprintf(expected, sizeof(expected), INT64_FORMAT "\n",
+			 ResGroupCpuRateLimitToQuota(50, (int) sysconf(_SC_NPROCESSORS_ONLN)));
+	assert_string_equal(ReadTestCgroupFile(dir, 6543, "cpu.cfs_quota_us"), expected);
+	assert_false(resGroupCgroupWarned);
+
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+	assert_int_equal(system(cmd), 0);
+	gp_resgroup_cgroup_dir = NULL;
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__ResGroupPriorityWeightToShares__ScalesAndClamps),
+		unit_test(test__ResGroupCpuRateLimitToQuota__SharesAllCores),
+		unit_test(test__ResGroupSlotAcquire__ReusesIdleSlots),
+		unit_test(test__ResGroupStatementStart__SegmentJoinsDispatchedGroup),
+		unit_test(test__ResGroupCgroupAttach__WritesControlFiles)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -0,0 +1,117 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../resqueue.c"
+
+static ResPortalIncrement *
+MakeIncrement(Cost cost, TimestampTz waitStart)
+{
+	ResPortalIncrement *incrementSet = palloc0(sizeof(ResPortalIncrement));
+
+	incrementSet->increments[RES_COUNT_LIMIT] = 1;
+	incrementSet->increments[RES_COST_LIMIT] = cost;
+	incrementSet->waitStart = waitStart;
+
+	return incrementSet;
+}
+
+static void
+ExpectResQueueLockHeld(void)
+{
+#ifdef USE_ASSERT_CHECKING
+	will_return(LWLockHeldExclusiveByMe, true);
+	expect_any(LWLockHeldExclusiveByMe, lockid);
+#endif
+}
+
+/* ==================== ResWaiterCompare ==================== */
+
+/*
+ * Tests that starved waiters go first in queue order, and the others
+ * cheapest first.
+ */
+void
+test__ResWaiterCompare__StarvedFirstThenCheapest(void **state)
+{
+	ResWaiter	waiters[4];
+	Cost		costs[4] = {500, 10, 1000, 10};
+	bool		starved[4] = {false, false, true, false};
+	int			i;
+
+	for (i = 0; i < 4; i++)
+	{
+		waiters[i].proc = NULL;
+		waiters[i].incrementSet = MakeIncrement(costs[i], 0);
+		waiters[i].position = i;
+		waiters[i].starved = starved[i];
+		waiters[i].granted = false;
+	}
+
+	qsort(waiters, 4, sizeof(ResWaiter), ResWaiterCompare);
+
+	/* The starved, most expensive one first */
+	assert_int_equal(waiters[0].position, 2);
+	/* Equal costs keep queue order */
+	assert_int_equal(waiters[1].position, 1);
+	assert_int_equal(waiters[2].position, 3);
+	assert_int_equal(waiters[3].position, 0);
+}
+
+/* ==================== ResQueueNoteAdmission ==================== */
+
+/*
+ * Tests that admissions over the count threshold are counted as short
+ * queries, and that queuing time is accumulated.
+ */
+void
+test__ResQueueNoteAdmission__CountsShortAndWaited(void **state)
+{
+	ResQueueData queue;
+	ResPortalIncrement *immediate = MakeIncrement(10, 0);
+	ResPortalIncrement *waited =
+		MakeIncrement(10, GetCurrentTimestamp() - 2 * USECS_PER_SEC);
+
+	MemSet(&queue, 0, sizeof(queue));
+	queue.limits[RES_COUNT_LIMIT].threshold_value = 2;
+	queue.limits[RES_COUNT_LIMIT].current_value = 1;
+
+	ExpectResQueueLockHeld();
+	ResQueueNoteAdmission(&queue, immediate);
+
+	assert_int_equal(queue.numAdmitted, 1);
+	assert_int_equal(queue.numAdmittedShort, 0);
+	assert_int_equal(queue.numAdmittedAfterWait, 0);
+
+	/* Admitting this one takes the queue beyond its limit */
+	queue.limits[RES_COUNT_LIMIT].current_value = 2;
+
+	ExpectResQueueLockHeld();
+	ResQueueNoteAdmission(&queue, waited);
+
+	assert_int_equal(queue.numAdmitted, 2);
+	assert_int_equal(queue.numAdmittedShort, 1);
+	assert_int_equal(queue.numAdmittedAfterWait, 1);
+	assert_true(queue.totalWaitSecs >= 2.0);
+	assert_true(queue.maxWaitSecs == queue.totalWaitSecs);
+
+	/* The wait is only counted once */
+	assert_true(waited->waitStart == 0);
+}
+
+/* ==================== main ==================== */
+int
+main(int argc, char* argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__ResWaiterCompare__StarvedFirstThenCheapest),
+		unit_test(test__ResQueueNoteAdmission__CountsShortAndWaited)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -62,6 +62,7 @@ volatile SharedSnapshotSlot *SharedLocalSnapshotSlot = NULL;
 static Size slotSize = 0;
 static Size slotCount = 0;
 static Size xipEntryCount = 0;
+static Size distribEntryCount = 0;
 
 
 /*
@@ -83,8 +84,16 @@ SharedSnapshotShmemSize(void)
 
 	xipEntryCount = MaxBackends + max_prepared_xacts;
 
+	/*
+	 * Room for the in-progress distributed transactions of the writer's
+	 * distributed snapshot, which there are at most as many as the master
+	 * has connections.
+	 */
+	distribEntryCount = max_prepared_xacts;
+
 	slotSize = sizeof(SharedSnapshotSlot);
 	slotSize += mul_size(sizeof(TransactionId), (xipEntryCount));
+	slotSize += mul_size(sizeof(DistributedSnapshotMapEntry), (distribEntryCount));
 	slotSize = MAXALIGN(slotSize);
 
 	/*
@@ -110,6 +119,7 @@ CreateSharedSnapshotArray(void)
 	bool	found;
 	int		i;
 	TransactionId *xip_base=NULL;
+	DistributedSnapshotMapEntry *distrib_base;
 
 	/* Create or attach to the SharedSnapshot shared structure */
 	sharedSnapshotArray = (SharedSnapshotStruct *)
@@ -145,6 +155,9 @@ CreateSharedSnapshotArray(void)
 		/* xips start just after the last slot structure */
 		xip_base = (TransactionId *)&sharedSnapshotArray->slots[sharedSnapshotArray->maxSlots];
 
+		/* and the distributed snapshot entries after the last xip array */
+		distrib_base = (DistributedSnapshotMapEntry *)&xip_base[xipEntryCount * sharedSnapshotArray->maxSlots];
+
 		for (i=0; i < sharedSnapshotArray->maxSlots; i++)
 		{
 			SharedSnapshotSlot *tmpSlot = &sharedSnapshotArray->slots[i];
@@ -158,8 +171,13 @@ CreateSharedSnapshotArray(void)
 			 * Note: xipEntryCount is initialized in SharedSnapshotShmemSize().
 			 * So each slot gets (MaxBackends + max_prepared_xacts) transaction-ids.
 			 */
-			tmpSlot->snapshot.xip = &xip_base[xipEntryCount];
+			tmpSlot->snapshot.xip = xip_base;
 			xip_base += xipEntryCount;
+
+			tmpSlot->snapshot.haveDistribSnapshot = false;
+			tmpSlot->snapshot.distribSnapshotWithLocalMapping.inProgressEntryArray = distrib_base;
+			tmpSlot->snapshot.distribSnapshotWithLocalMapping.header.maxCount = distribEntryCount;
+			distrib_base += distribEntryCount;
 		}
 	}
 
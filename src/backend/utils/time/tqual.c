@@ -1487,6 +1487,9 @@ CopySnapshot(Snapshot snapshot)
 		newsnap->distribSnapshotWithLocalMapping.inProgressEntryArray = NULL;
 	}
 
+	/* The copy's arrays are only as big as they need to be */
+	newsnap->snapXactCompletionCount = 0;
+
 	return newsnap;
 }
 
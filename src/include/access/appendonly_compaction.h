@@ -10,6 +10,7 @@
 #define APPENDONLY_COMPACTION_H
 
 #include "postgres.h"
+#include "fmgr.h"
 #include "nodes/pg_list.h"
 #include "access/appendonly_visimap.h"
 #include "utils/rel.h"
@@ -34,4 +35,12 @@ extern void AppendOnlyThrowAwayTuple(Relation rel, MemTuple tuple,
 extern void AppendOnlyTruncateToEOF(Relation aorel);
 extern bool HasLockForSegmentFileDrop(Relation aorel);
 extern bool AppendOnlyCompaction_IsRelationEmpty(Relation aorel);
+
+extern Size AppendOnlyCompactionShmemSize(void);
+extern void AppendOnlyCompactionShmemInit(void);
+extern void AppendOnlyCompaction_ReportStart(Relation aorel, int segno,
+		int64 totalTupcount, int64 eof);
+extern void AppendOnlyCompaction_ReportTuple(bool moved);
+extern void AppendOnlyCompaction_ReportDone(void);
+extern Datum pg_appendonly_compaction_progress(PG_FUNCTION_ARGS);
 #endif
@@ -23,6 +23,7 @@
 #include "access/appendonly_visimap_entry.h"
 #include "access/appendonly_visimap_store.h"
 #include "executor/execWorkfile.h"
+#include "utils/hsearch.h"
 #include "utils/tqual.h"
 
 /* 
@@ -32,6 +33,90 @@
 #define APPENDONLY_VISIMAP_MAX_RANGE 32768
 #define APPENDONLY_VISIMAP_MAX_BITMAP_SIZE 4096
 
+/*
+ * A visimap entry as stored in the visimap relation.
+ */
+typedef struct AppendOnlyVisimapCacheEntry
+{
+	int64 firstRowNum;
+
+	/*
+	 * The compressed bitmap. NULL if all rows of the range are
+	 * visible.
+	 */
+	AppendOnlyVisimapData *data;
+
+	/*
+	 * Tuple id of the entry in the visimap relation.
+	 */
+	ItemPointerData tupleTid;
+} AppendOnlyVisimapCacheEntry;
+
+/*
+ * All visimap entries of a segment file, loaded at once when a
+ * tuple of the segment file is checked for the first time, so that
+ * moving to another range does not need an index lookup.
+ * The entries are kept compressed.
+ */
+typedef struct AppendOnlyVisimapSegmentCache
+{
+	/*
+	 * Segment file whose entries are cached. Hash key.
+	 */
+	int32 segmentFileNum;
+
+	/*
+	 * false if the entries of the segment file did not fit into
+	 * work_mem, and have to be looked up one by one.
+	 */
+	bool complete;
+
+	/*
+	 * Entries of the segment file, sorted by firstRowNum.
+	 */
+	AppendOnlyVisimapCacheEntry *entries;
+	int entryCount;
+
+	/*
+	 * Memory used by the entries, in bytes.
+	 */
+	long size;
+
+	/*
+	 * Memory context of the cached entries. NULL if no
+	 * entries are cached.
+	 */
+	MemoryContext memoryContext;
+} AppendOnlyVisimapSegmentCache;
+
+/*
+ * The cached visimap entries of the segment files that have been
+ * checked, so that index scans and fetches that go back and forth
+ * between segment files do not reload them.
+ * Storing an entry only invalidates the cache of its segment file.
+ */
+typedef struct AppendOnlyVisimapCache
+{
+	/*
+	 * Maps segment file numbers to AppendOnlyVisimapSegmentCache.
+	 * NULL until the first segment file is cached.
+	 */
+	HTAB *segments;
+
+	/*
+	 * Segment file checked last, or NULL.
+	 */
+	AppendOnlyVisimapSegmentCache *current;
+
+	/*
+	 * Memory used by the entries of all segment files, in bytes.
+	 * Limited to work_mem.
+	 */
+	long size;
+
+	MemoryContext memoryContext;
+} AppendOnlyVisimapCache;
+
 /*
  * Data structure for the ao visibility map processing.
  *
@@ -57,6 +142,12 @@ typedef struct AppendOnlyVisimap
 	 */ 
 	AppendOnlyVisimapStore visimapStore;	
 
+	/*
+	 * Cached visibility map entries of the segment files
+	 * checked so far.
+	 */
+	AppendOnlyVisimapCache cache;
+
 } AppendOnlyVisimap;
 
 /*
@@ -109,6 +200,12 @@ bool AppendOnlyVisimap_IsVisible(
 	AppendOnlyVisimap *visiMap,
 	AOTupleId *tupleId);
 
+bool AppendOnlyVisimap_IsRangeVisible(
+	AppendOnlyVisimap *visiMap,
+	int32 segmentFileNum,
+	int64 firstRowNum,
+	int64 rowCount);
+
 void AppendOnlyVisimap_Finish(
 	AppendOnlyVisimap *visiMap,
 	LOCKMODE lockmode);
@@ -254,8 +254,17 @@ extern void heap_get_latest_tid(Relation relation, Snapshot snapshot,
 					ItemPointer tid);
 extern void setLastTid(const ItemPointer tid);
 
+/*
+ * Callers that accumulate tuples for heap_multi_insert() flush them once
+ * either of these limits is reached.
+ */
+#define HEAP_MULTI_INSERT_MAX_TUPLES	1000
+#define HEAP_MULTI_INSERT_MAX_BYTES		65535
+
 extern Oid heap_insert(Relation relation, HeapTuple tup, CommandId cid,
 			bool use_wal, bool use_fsm, TransactionId xid);
+extern void heap_multi_insert(Relation relation, HeapTuple *tuples,
+				  int ntuples, CommandId cid, bool use_wal, bool use_fsm);
 extern HTSU_Result heap_delete(Relation relation, ItemPointer tid,
 			ItemPointer ctid, TransactionId *update_xmax,
 			CommandId cid, Snapshot crosscheck, bool wait);
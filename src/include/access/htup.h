@@ -596,11 +596,12 @@ static inline uint32 heaptuple_get_size(HeapTuple htup)
  * We ran out of opcodes, so heapam.c now has a second RmgrId.	These opcodes
  * are associated with RM_HEAP2_ID, but are not logically different from
  * the ones above associated with RM_HEAP_ID.  We apply XLOG_HEAP_OPMASK,
- * although currently XLOG_HEAP_INIT_PAGE is not used for any of these.
+ * and XLOG_HEAP_INIT_PAGE is used only with XLOG_HEAP2_MULTI_INSERT.
  */
 #define XLOG_HEAP2_FREEZE		0x00
 #define XLOG_HEAP2_CLEAN		0x10
 #define XLOG_HEAP2_CLEAN_MOVE	0x20
+#define XLOG_HEAP2_MULTI_INSERT	0x30
 
 /*
  * All what we need to find changed tuple
@@ -661,6 +662,36 @@ typedef struct xl_heap_insert
 
 #define SizeOfHeapInsert	(offsetof(xl_heap_insert, target) + SizeOfHeapTid)
 
+/*
+ * This is what we need to know about a multi-insert.  The record consists
+ * of the fixed part, the offset numbers of the inserted tuples (omitted if
+ * XLOG_HEAP_INIT_PAGE is set, in which case the tuples occupy consecutive
+ * offsets starting at FirstOffsetNumber), and then one xl_multi_insert_tuple
+ * header plus tuple data for each tuple.  Each xl_multi_insert_tuple is
+ * SHORTALIGN'd within the record.
+ */
+typedef struct xl_heap_multi_insert
+{
+	xl_heapnode heapnode;
+	BlockNumber blkno;
+	uint16		ntuples;
+	OffsetNumber offsets[1];
+	/* TUPLE HEADERS AND DATA FOLLOW AT END OF STRUCT */
+} xl_heap_multi_insert;
+
+#define SizeOfHeapMultiInsert	offsetof(xl_heap_multi_insert, offsets)
+
+typedef struct xl_multi_insert_tuple
+{
+	uint16		datalen;		/* size of tuple data that follows */
+	uint16		t_infomask2;
+	uint16		t_infomask;
+	uint8		t_hoff;
+	/* TUPLE DATA FOLLOWS AT END OF STRUCT */
+} xl_multi_insert_tuple;
+
+#define SizeOfMultiInsertTuple	(offsetof(xl_multi_insert_tuple, t_hoff) + sizeof(uint8))
+
 /* This is what we need to know about update|move|hot_update */
 typedef struct xl_heap_update
 {
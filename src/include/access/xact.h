@@ -46,6 +46,10 @@ extern bool XactReadOnly;
 /* Asynchronous commits */
 extern bool XactSyncCommit;
 
+/* Group commit: delay of the flushing committer, see XLogFlush */
+extern int	CommitDelay;
+extern int	CommitSiblings;
+
 /* Kluge for 2PC support */
 extern bool MyXactAccessedTempRel;
 
@@ -88,6 +92,7 @@ typedef void (*SubXactCallback) (SubXactEvent event, SubTransactionId mySubid,
 #define XLOG_XACT_ABORT_PREPARED	0x40
 #define XLOG_XACT_DISTRIBUTED_COMMIT 0x50
 #define XLOG_XACT_DISTRIBUTED_FORGET 0x60
+#define XLOG_XACT_ONEPHASE_COMMIT	0x70
 
 typedef struct xl_xact_commit
 {
@@ -233,6 +238,7 @@ extern bool IsSubTransaction(void);
 extern bool IsTransactionBlock(void);
 extern bool IsTransactionOrTransactionBlock(void);
 extern void ExecutorMarkTransactionUsesSequences(void);
+extern bool TransactionDidWriteXLog(void);
 extern void ExecutorMarkTransactionDoesWrites(void);
 extern bool ExecutorSaysTransactionDoesWrites(void);
 extern char TransactionBlockStatusCode(void);
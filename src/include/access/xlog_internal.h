@@ -123,6 +123,10 @@ typedef XLogLongPageHeaderData *XLogLongPageHeader;
 #define XLogSegsPerFile (((uint32) 0xffffffff) / XLogSegSize)
 #define XLogFileSize	(XLogSegsPerFile * XLogSegSize)
 
+/* Byte position of an XLOG location, for computing distances */
+#define XLogRecPtrToBytePos(recptr) \
+		((uint64) (recptr).xlogid * XLogFileSize + (recptr).xrecoff)
+
 
 /*
  * Macros for manipulating XLOG pointers
@@ -282,6 +286,7 @@ extern Datum pg_stop_backup(PG_FUNCTION_ARGS __attribute__((unused)) );
 extern Datum pg_switch_xlog(PG_FUNCTION_ARGS __attribute__((unused)) );
 extern Datum pg_current_xlog_location(PG_FUNCTION_ARGS __attribute__((unused)) );
 extern Datum pg_current_xlog_insert_location(PG_FUNCTION_ARGS __attribute__((unused)) );
+extern Datum pg_stat_get_xlog_flush(PG_FUNCTION_ARGS __attribute__((unused)) );
 extern Datum pg_xlogfile_name_offset(PG_FUNCTION_ARGS);
 extern Datum pg_xlogfile_name(PG_FUNCTION_ARGS);
 
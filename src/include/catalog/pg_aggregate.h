@@ -100,6 +100,7 @@ typedef FormData_pg_aggregate *Form_pg_aggregate;
  */
 #define AGGFNOID_COUNT_ANY 2147 /* returns INT8OID */
 #define AGGFNOID_SUM_BIGINT 2107 /* returns NUMERICOID */
+#define AGGFNOID_APPROX_COUNT_DISTINCT 6130 /* returns INT8OID */
 
 /* ----------------
  * initial contents of pg_aggregate
@@ -288,6 +289,10 @@ DATA(insert ( 3538	string_agg_delim_transfn - - - string_agg_finalfn 0 2281 _nul
 
 DATA(insert ( 6112	pg_partition_oid_transfn      - - - pg_partition_oid_finalfn 0 2281 _null_ f));
 
+/* HyperLogLog sketch */
+DATA(insert ( 6127	gp_hll_accum	- gp_hll_merge - -	0	17	"" f));
+DATA(insert ( 6130	gp_hll_accum	- gp_hll_merge - gp_hll_count	0	17	"" f));
+
 
 
 /*
@@ -133,7 +133,7 @@
 
  CREATE FUNCTION pg_stat_get_activity(IN pid int4, OUT datid oid, OUT procpid int4, OUT usesysid oid, OUT application_name text, OUT current_query text, OUT waiting bool, OUT xact_start timestamptz, OUT query_start timestamptz, OUT backend_start timestamptz, OUT client_addr inet, OUT client_port int4, OUT sess_id int4, OUT waiting_reason text) RETURNS SETOF pg_catalog.record LANGUAGE internal VOLATILE AS 'pg_stat_get_activity' WITH (OID=6071, DESCRIPTION="statistics: information about currently active backends");
 
- CREATE FUNCTION pg_stat_get_wal_senders(OUT pid int4, OUT state text, OUT sent_location text, OUT write_location text, OUT flush_location text, OUT replay_location text, OUT sync_priority int4, OUT sync_state text) RETURNS SETOF pg_catalog.record LANGUAGE internal STABLE AS 'pg_stat_get_wal_senders' WITH (OID=3099, DESCRIPTION="statistics: information about currently active replication");
+ CREATE FUNCTION pg_stat_get_wal_senders(OUT pid int4, OUT state text, OUT sent_location text, OUT write_location text, OUT flush_location text, OUT replay_location text, OUT sync_priority int4, OUT sync_state text, OUT sent_bytes int8, OUT sent_wire_bytes int8, OUT replay_lag_bytes int8) RETURNS SETOF pg_catalog.record LANGUAGE internal STABLE AS 'pg_stat_get_wal_senders' WITH (OID=3099, DESCRIPTION="statistics: information about currently active replication");
 
  CREATE FUNCTION pg_terminate_backend(int4) RETURNS bool LANGUAGE internal VOLATILE STRICT AS 'pg_terminate_backend' WITH (OID=6118, DESCRIPTION="terminate a server process");
 
@@ -141,6 +141,14 @@
 
  CREATE FUNCTION pg_resqueue_status_kv() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_resqueue_status_kv' WITH (OID=6069, DESCRIPTION="Return resource queue information");
 
+ CREATE FUNCTION pg_resqueue_admission_stats() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_resqueue_admission_stats' WITH (OID=6036, DESCRIPTION="Return resource queue admission statistics");
+
+ CREATE FUNCTION pg_resgroup_get_status() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_resgroup_get_status' WITH (OID=6119, DESCRIPTION="Return resource group CPU and memory usage");
+
+ CREATE FUNCTION pg_appendonly_compaction_progress() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_appendonly_compaction_progress' WITH (OID=6120, DESCRIPTION="Return progress of append-only segment file compaction");
+
+ CREATE FUNCTION pg_stat_get_xlog_flush(OUT flush_requests int8, OUT flushes int8, OUT flushed_bytes int8) RETURNS pg_catalog.record LANGUAGE internal VOLATILE STRICT AS 'pg_stat_get_xlog_flush' WITH (OID=6121, DESCRIPTION="statistics: group commit batching of transaction log flushes");
+
  CREATE FUNCTION pg_file_read(text, int8, int8) RETURNS text LANGUAGE internal VOLATILE STRICT AS 'pg_read_file' WITH (OID=6045, DESCRIPTION="Read text from a file");
 
  CREATE FUNCTION pg_logfile_rotate() RETURNS bool LANGUAGE internal VOLATILE STRICT AS 'pg_rotate_logfile' WITH (OID=6046, DESCRIPTION="Rotate log file");
@@ -1594,6 +1602,8 @@
 -- Analyze related
  CREATE FUNCTION gp_statistics_estimate_reltuples_relpages_oid(oid) RETURNS _float4 LANGUAGE internal VOLATILE STRICT AS 'gp_statistics_estimate_reltuples_relpages_oid' WITH (OID=5032, DESCRIPTION="Return reltuples/relpages information for relation.");
 
+ CREATE FUNCTION gp_statistics_ao_appended_stats_oid(oid, _int2, bytea) RETURNS bytea LANGUAGE internal VOLATILE STRICT AS 'gp_statistics_ao_appended_stats_oid' WITH (OID=6128, DESCRIPTION="Return statistics of the rows appended to an append-only relation after a watermark.");
+
 -- Backoff related
  CREATE FUNCTION gp_adjust_priority(int4, int4, int4) RETURNS int4 LANGUAGE internal VOLATILE STRICT AS 'gp_adjust_priority_int' WITH (OID=5040, DESCRIPTION="change weight of all the backends for a given session id");
 
@@ -1765,6 +1775,23 @@ CREATE FUNCTION gp_nondbspecific_ptcat_verification() RETURNS bool LANGUAGE inte
  CREATE FUNCTION enable_xform(text) RETURNS text LANGUAGE internal IMMUTABLE STRICT AS 'enable_xform' WITH (OID=6088, DESCRIPTION="enables transformations in the optimizer");
 
  CREATE FUNCTION gp_opt_version() RETURNS text LANGUAGE internal IMMUTABLE STRICT AS 'gp_opt_version' WITH (OID=6089, DESCRIPTION="Returns the optimizer and gpos library versions");
+
+ CREATE FUNCTION gp_opt_mdcache_stats(OUT optimizations int8, OUT entries_loaded int8, OUT entries_invalidated int8, OUT full_resets int8, OUT invalidation_messages int8, OUT tracked_entries int8, OUT part_metadata_built int8, OUT part_metadata_reused int8) RETURNS pg_catalog.record LANGUAGE internal VOLATILE STRICT AS 'gp_opt_mdcache_stats' WITH (OID=6122, DESCRIPTION="statistics: optimizer metadata cache of this backend");
+
+ CREATE FUNCTION gp_opt_plan_cache_stats(OUT lookups int8, OUT hits int8, OUT inserts int8, OUT evictions int8, OUT invalidations int8, OUT entries int8, OUT used_bytes int8, OUT size_bytes int8, OUT saved_time_ms float8) RETURNS pg_catalog.record LANGUAGE internal VOLATILE STRICT AS 'gp_opt_plan_cache_stats' WITH (OID=6123, DESCRIPTION="statistics: shared optimizer plan cache");
+
+-- HyperLogLog sketches, used by ANALYZE to estimate the number of distinct values
+ CREATE FUNCTION gp_hll_accum(bytea, anyelement) RETURNS bytea LANGUAGE internal IMMUTABLE STRICT AS 'gp_hll_accum' WITH (OID=6124, DESCRIPTION="aggregate transition function");
+
+ CREATE FUNCTION gp_hll_merge(bytea, bytea) RETURNS bytea LANGUAGE internal IMMUTABLE STRICT AS 'gp_hll_merge' WITH (OID=6125, DESCRIPTION="aggregate preliminary function");
+
+ CREATE FUNCTION gp_hll_estimate(bytea) RETURNS float8 LANGUAGE internal IMMUTABLE STRICT AS 'gp_hll_estimate' WITH (OID=6126, DESCRIPTION="estimated number of distinct values of a HyperLogLog sketch");
+
+ CREATE FUNCTION gp_hll_sketch(anyelement) RETURNS bytea LANGUAGE internal IMMUTABLE AS 'aggregate_dummy' WITH (OID=6127, DESCRIPTION="HyperLogLog sketch of the distinct input values", proisagg="t");
+
+ CREATE FUNCTION gp_hll_count(bytea) RETURNS int8 LANGUAGE internal IMMUTABLE STRICT AS 'gp_hll_count' WITH (OID=6129, DESCRIPTION="aggregate final function");
+
+ CREATE FUNCTION gp_approx_count_distinct(anyelement) RETURNS int8 LANGUAGE internal IMMUTABLE AS 'aggregate_dummy' WITH (OID=6130, DESCRIPTION="approximate number of distinct input values", proisagg="t");
  
  
   -- functions for the complex data type
@@ -22,7 +22,7 @@
 
    WARNING: DO NOT MODIFY THE FOLLOWING SECTION: 
    Generated by catullus.pl version 8
-   on Thu Jul 28 00:41:12 2016
+   on Sun Oct 18 15:26:25 2026
 
    Please make your changes in pg_proc.sql
 */
@@ -290,8 +290,8 @@ DESCR("change priority of all the backends for a given session id");
 DATA(insert OID = 6071 ( pg_stat_get_activity  PGNSP PGUID 12 1 1000 0 f f f t v 1 0 2249 f "23" "{23,26,23,26,25,25,16,1184,1184,1184,869,23,23,25}" "{i,o,o,o,o,o,o,o,o,o,o,o,o,o}" "{pid,datid,procpid,usesysid,application_name,current_query,waiting,xact_start,query_start,backend_start,client_addr,client_port,sess_id,waiting_reason}" _null_ pg_stat_get_activity _null_ _null_ _null_ n ));
 DESCR("statistics: information about currently active backends");
 
-/* pg_stat_get_wal_senders(OUT pid int4, OUT state text, OUT sent_location text, OUT write_location text, OUT flush_location text, OUT replay_location text, OUT sync_priority int4, OUT sync_state text) => SETOF pg_catalog.record */ 
-DATA(insert OID = 3099 ( pg_stat_get_wal_senders  PGNSP PGUID 12 1 1000 0 f f f t s 0 0 2249 f "" "{23,25,25,25,25,25,23,25}" "{o,o,o,o,o,o,o,o}" "{pid,state,sent_location,write_location,flush_location,replay_location,sync_priority,sync_state}" _null_ pg_stat_get_wal_senders _null_ _null_ _null_ n ));
+/* pg_stat_get_wal_senders(OUT pid int4, OUT state text, OUT sent_location text, OUT write_location text, OUT flush_location text, OUT replay_location text, OUT sync_priority int4, OUT sync_state text, OUT sent_bytes int8, OUT sent_wire_bytes int8, OUT replay_lag_bytes int8) => SETOF pg_catalog.record */ 
+DATA(insert OID = 3099 ( pg_stat_get_wal_senders  PGNSP PGUID 12 1 1000 0 f f f t s 0 0 2249 f "" "{23,25,25,25,25,25,23,25,20,20,20}" "{o,o,o,o,o,o,o,o,o,o,o}" "{pid,state,sent_location,write_location,flush_location,replay_location,sync_priority,sync_state,sent_bytes,sent_wire_bytes,replay_lag_bytes}" _null_ pg_stat_get_wal_senders _null_ _null_ _null_ n ));
 DESCR("statistics: information about currently active replication");
 
 /* pg_terminate_backend(int4) => bool */ 
@@ -306,6 +306,22 @@ DESCR("Return resource queue information");
 DATA(insert OID = 6069 ( pg_resqueue_status_kv  PGNSP PGUID 12 1 1000 0 f f t t v 0 0 2249 f "" _null_ _null_ _null_ _null_ pg_resqueue_status_kv _null_ _null_ _null_ n ));
 DESCR("Return resource queue information");
 
+/* pg_resqueue_admission_stats() => SETOF record */ 
+DATA(insert OID = 6036 ( pg_resqueue_admission_stats  PGNSP PGUID 12 1 1000 0 f f t t v 0 0 2249 f "" _null_ _null_ _null_ _null_ pg_resqueue_admission_stats _null_ _null_ _null_ n ));
+DESCR("Return resource queue admission statistics");
+
+/* pg_resgroup_get_status() => SETOF record */ 
+DATA(insert OID = 6119 ( pg_resgroup_get_status  PGNSP PGUID 12 1 1000 0 f f t t v 0 0 2249 f "" _null_ _null_ _null_ _null_ pg_resgroup_get_status _null_ _null_ _null_ n ));
+DESCR("Return resource group CPU and memory usage");
+
+/* pg_appendonly_compaction_progress() => SETOF record */ 
+DATA(insert OID = 6120 ( pg_appendonly_compaction_progress  PGNSP PGUID 12 1 1000 0 f f t t v 0 0 2249 f "" _null_ _null_ _null_ _null_ pg_appendonly_compaction_progress _null_ _null_ _null_ n ));
+DESCR("Return progress of append-only segment file compaction");
+
+/* pg_stat_get_xlog_flush(OUT flush_requests int8, OUT flushes int8, OUT flushed_bytes int8) => pg_catalog.record */ 
+DATA(insert OID = 6121 ( pg_stat_get_xlog_flush  PGNSP PGUID 12 1 0 0 f f t f v 0 0 2249 f "" "{20,20,20}" "{o,o,o}" "{flush_requests,flushes,flushed_bytes}" _null_ pg_stat_get_xlog_flush _null_ _null_ _null_ n ));
+DESCR("statistics: group commit batching of transaction log flushes");
+
 /* pg_file_read(text, int8, int8) => text */ 
 DATA(insert OID = 6045 ( pg_file_read  PGNSP PGUID 12 1 0 0 f f t f v 3 0 25 f "25 20 20" _null_ _null_ _null_ _null_ pg_read_file _null_ _null_ _null_ n ));
 DESCR("Read text from a file");
@@ -2591,6 +2607,10 @@ DESCR("Greenplum fault testing only");
 DATA(insert OID = 5032 ( gp_statistics_estimate_reltuples_relpages_oid  PGNSP PGUID 12 1 0 0 f f t f v 1 0 1021 f "26" _null_ _null_ _null_ _null_ gp_statistics_estimate_reltuples_relpages_oid _null_ _null_ _null_ n ));
 DESCR("Return reltuples/relpages information for relation.");
 
+/* gp_statistics_ao_appended_stats_oid(oid, _int2, bytea) => bytea */ 
+DATA(insert OID = 6128 ( gp_statistics_ao_appended_stats_oid  PGNSP PGUID 12 1 0 0 f f t f v 3 0 17 f "26 1005 17" _null_ _null_ _null_ _null_ gp_statistics_ao_appended_stats_oid _null_ _null_ _null_ n ));
+DESCR("Return statistics of the rows appended to an append-only relation after a watermark.");
+
 
 /* Backoff related */
 /* gp_adjust_priority(int4, int4, int4) => int4 */ 
@@ -2925,6 +2945,40 @@ DESCR("enables transformations in the optimizer");
 DATA(insert OID = 6089 ( gp_opt_version  PGNSP PGUID 12 1 0 0 f f t f i 0 0 25 f "" _null_ _null_ _null_ _null_ gp_opt_version _null_ _null_ _null_ n ));
 DESCR("Returns the optimizer and gpos library versions");
 
+/* gp_opt_mdcache_stats(OUT optimizations int8, OUT entries_loaded int8, OUT entries_invalidated int8, OUT full_resets int8, OUT invalidation_messages int8, OUT tracked_entries int8, OUT part_metadata_built int8, OUT part_metadata_reused int8) => pg_catalog.record */ 
+DATA(insert OID = 6122 ( gp_opt_mdcache_stats  PGNSP PGUID 12 1 0 0 f f t f v 0 0 2249 f "" "{20,20,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o}" "{optimizations,entries_loaded,entries_invalidated,full_resets,invalidation_messages,tracked_entries,part_metadata_built,part_metadata_reused}" _null_ gp_opt_mdcache_stats _null_ _null_ _null_ n ));
+DESCR("statistics: optimizer metadata cache of this backend");
+
+/* gp_opt_plan_cache_stats(OUT lookups int8, OUT hits int8, OUT inserts int8, OUT evictions int8, OUT invalidations int8, OUT entries int8, OUT used_bytes int8, OUT size_bytes int8, OUT saved_time_ms float8) => pg_catalog.record */ 
+DATA(insert OID = 6123 ( gp_opt_plan_cache_stats  PGNSP PGUID 12 1 0 0 f f t f v 0 0 2249 f "" "{20,20,20,20,20,20,20,20,701}" "{o,o,o,o,o,o,o,o,o}" "{lookups,hits,inserts,evictions,invalidations,entries,used_bytes,size_bytes,saved_time_ms}" _null_ gp_opt_plan_cache_stats _null_ _null_ _null_ n ));
+DESCR("statistics: shared optimizer plan cache");
+
+
+/* HyperLogLog sketches, used by ANALYZE to estimate the number of distinct values */
+/* gp_hll_accum(bytea, anyelement) => bytea */ 
+DATA(insert OID = 6124 ( gp_hll_accum  PGNSP PGUID 12 1 0 0 f f t f i 2 0 17 f "17 2283" _null_ _null_ _null_ _null_ gp_hll_accum _null_ _null_ _null_ n ));
+DESCR("aggregate transition function");
+
+/* gp_hll_merge(bytea, bytea) => bytea */ 
+DATA(insert OID = 6125 ( gp_hll_merge  PGNSP PGUID 12 1 0 0 f f t f i 2 0 17 f "17 17" _null_ _null_ _null_ _null_ gp_hll_merge _null_ _null_ _null_ n ));
+DESCR("aggregate preliminary function");
+
+/* gp_hll_estimate(bytea) => float8 */ 
+DATA(insert OID = 6126 ( gp_hll_estimate  PGNSP PGUID 12 1 0 0 f f t f i 1 0 701 f "17" _null_ _null_ _null_ _null_ gp_hll_estimate _null_ _null_ _null_ n ));
+DESCR("estimated number of distinct values of a HyperLogLog sketch");
+
+/* gp_hll_sketch(anyelement) => bytea */ 
+DATA(insert OID = 6127 ( gp_hll_sketch  PGNSP PGUID 12 1 0 0 t f f f i 1 0 17 f "2283" _null_ _null_ _null_ _null_ aggregate_dummy _null_ _null_ _null_ n ));
+DESCR("HyperLogLog sketch of the distinct input values");
+
+/* gp_hll_count(bytea) => int8 */ 
+DATA(insert OID = 6129 ( gp_hll_count  PGNSP PGUID 12 1 0 0 f f t f i 1 0 20 f "17" _null_ _null_ _null_ _null_ gp_hll_count _null_ _null_ _null_ n ));
+DESCR("aggregate final function");
+
+/* gp_approx_count_distinct(anyelement) => int8 */ 
+DATA(insert OID = 6130 ( gp_approx_count_distinct  PGNSP PGUID 12 1 0 0 t f f f i 1 0 20 f "2283" _null_ _null_ _null_ _null_ aggregate_dummy _null_ _null_ _null_ n ));
+DESCR("approximate number of distinct input values");
+
 
   /* functions for the complex data type */
 /* complex_in(cstring) => complex */ 
@@ -144,6 +144,7 @@ DATA(insert OID = 6456  ( min_cost 3 f t t -1   0 ));
 DATA(insert OID = 6457  ( cost_overcommit 4 f t t -1  -1 )); 
 DATA(insert OID = 6458  ( priority 5 f t f medium _null_ ));
 DATA(insert OID = 6459  ( memory_limit 6 f t t -1 -1 ));
+DATA(insert OID = 6460  ( cpu_rate_limit 7 f f t -1 -1 ));
 
 /* 
    The first four entries of pg_resourcetype are special mappings for
@@ -168,6 +169,7 @@ DATA(insert OID = 6459  ( memory_limit 6 f t t -1 -1 ));
 /* start of "pg_resourcetype" entries... */
 #define PG_RESRCTYPE_PRIORITY			5	/* backoff.c: priority queue */
 #define PG_RESRCTYPE_MEMORY_LIMIT		6	/* memquota.c: memory quota */
+#define PG_RESRCTYPE_CPU_RATE_LIMIT		7	/* resgroup.c: cgroup cpu cap */
 
 
 /* ----------------
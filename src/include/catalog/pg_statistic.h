@@ -238,6 +238,16 @@ typedef FormData_pg_statistic *Form_pg_statistic;
  */
 #define STATISTIC_KIND_CORRELATION	3
 
+/*
+ * A "HyperLogLog" slot holds the sketch of the non-null values of the
+ * column, built by ANALYZE when gp_statistics_use_hll is on.  stavalues
+ * contains a single bytea, NOT a value of the column's type, and staop and
+ * stanumbers are not used.  The sketches of leaf partitions are merged to
+ * estimate the number of distinct values of their parents.  This is a GPDB
+ * addition; its code is taken from the top of the range reserved for core.
+ */
+#define STATISTIC_KIND_HLL	99
+
 /* quoting pg_authid and gp_configuration: */
 
 /*
@@ -172,6 +172,10 @@ typedef struct AppendOnlyScanDescData
 	int			aos_total_segfiles;	/* the relation file segment number */
 	int			aos_segfiles_processed; /* num of segfiles already processed */
 	FileSegInfo **aos_segfile_arr;	/* array of all segfiles information */
+	int64		*aos_segfile_startoffset;
+									/* offset to start reading each segfile
+									 * at, or NULL to read them from the
+									 * beginning */
 	bool		aos_need_new_segfile;
 	bool		aos_done_all_segfiles;
 	
@@ -184,6 +188,8 @@ typedef struct AppendOnlyScanDescData
 
 	/* current scan state */
 	bool		bufferDone;
+	bool		blockAllVisible;	/* no row of the current block is hidden
+									 * by the visibility map */
 
 	bool	initedStorageRoutines;
 
@@ -326,6 +332,11 @@ extern AppendOnlyScanDesc appendonly_beginrangescan(Relation relation,
 		Snapshot appendOnlyMetaDataSnapshot, 
 		int *segfile_no_arr, int segfile_count,
 		int nkeys, ScanKey keys);
+extern AppendOnlyScanDesc appendonly_beginscan_from_offsets(Relation relation,
+		Snapshot snapshot,
+		Snapshot appendOnlyMetaDataSnapshot,
+		FileSegInfo **seginfo, int segfile_count,
+		int64 *startOffsets);
 extern void appendonly_rescan(AppendOnlyScanDesc scan, ScanKey key);
 extern void appendonly_endscan(AppendOnlyScanDesc scan);
 extern MemTuple appendonly_getnext(AppendOnlyScanDesc scan, 
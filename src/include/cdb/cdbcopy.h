@@ -64,5 +64,6 @@ void		cdbCopyStart(CdbCopy *cdbCopy, char *copyCmd);
 void		cdbCopySendData(CdbCopy *c, int target_seg, const char *buffer, int nbytes);
 bool		cdbCopyGetData(CdbCopy *c, bool cancel, uint64 *rows_processed);
 int			cdbCopyEnd(CdbCopy *c);
+uint64		cdbCopyOnSegment(CdbCopy *c, CopyStmt *stmt, int *rows_rejected);
 
 #endif   /* CDBCOPY_H */
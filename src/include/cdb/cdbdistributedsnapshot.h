@@ -62,7 +62,7 @@ typedef struct DistributedSnapshotHeader
 										 */
 } DistributedSnapshotHeader;
 
-#define DistributedSnapshotWithLocalMapping_StaticInit {DistributedSnapshotHeader_StaticInit,NULL}
+#define DistributedSnapshotWithLocalMapping_StaticInit {DistributedSnapshotHeader_StaticInit,NULL,0,0,0,0}
 
 /*
  * GP: Global information about which transactions are visible for a distributed
@@ -79,7 +79,25 @@ typedef struct DistributedSnapshotWithLocalMapping
 										/* 
 										 * Array of distributed transactions
 										 * in progress, optionally with the
-										 * associated local xid.
+										 * associated local xid.  Sorted by
+										 * distribXid.
+										 */
+
+	TransactionId					minCachedLocalXid;
+	TransactionId					maxCachedLocalXid;
+										/*
+										 * Range of the local xids known in
+										 * inProgressEntryArray, or
+										 * InvalidTransactionId if none.
+										 */
+
+	TransactionId					epochXid;
+	uint32							epoch;
+										/*
+										 * Next local xid and its epoch, read
+										 * once per snapshot when the shared
+										 * commit cache is first used, or
+										 * InvalidTransactionId.
 										 */
 
 } DistributedSnapshotWithLocalMapping;
@@ -112,6 +130,9 @@ extern DistributedSnapshotCommitted DistributedSnapshotWithLocalMapping_Committe
 	TransactionId 							localXid,
 	bool									isXmax);
 
+extern void DistributedSnapshotWithLocalMapping_SetLocalXidRange(
+	DistributedSnapshotWithLocalMapping		*dslm);
+
 extern void DistributedSnapshot_Reset(
 	DistributedSnapshot *distributedSnapshot);
 
@@ -75,6 +75,8 @@ extern int file_rep_ack_buffer_size;
 extern int file_rep_retry;
 extern int file_rep_min_data_before_flush;
 extern int file_rep_socket_timeout;
+extern int file_rep_resync_workers;
+extern bool file_rep_compression;
 extern int file_rep_mirror_consumer_process_count;
 
 extern FileRepRole_e		fileRepRole;
@@ -179,6 +181,15 @@ typedef struct FileRepShmem_s {
 	uint32	consumeCount;
 	/* counter of consumed messages. It is used for testing code correctness. */
 
+	int64	messageBytesSent;
+	/* bytes of messages sent to the peer. It is updated by the sender only. */
+
+	int64	wireBytesSent;
+	/*
+	 * bytes put on the connection for them, less than messageBytesSent
+	 * when gp_filerep_compression is on. It is updated by the sender only.
+	 */
+
 	volatile sig_atomic_t state;
 
 } FileRepShmem_s;
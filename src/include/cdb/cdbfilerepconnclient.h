@@ -32,6 +32,16 @@ extern bool FileRepConnClient_SendMessage(
 			  char					*message, 
 			  uint32				messageLength);
 
+/*
+ * Issued by Sender thread of FileRep process.
+ */
+extern bool FileRepConnClient_SendCompressedMessage(
+			  FileRepConsumerProcIndex_e	messageType,
+			  bool					messageSynchronous,
+			  char					*message,
+			  uint32				messageLength,
+			  uint32				*sentLength);
+
 #endif /* CDBFILEREPCONNCLIENT_H */
 
 
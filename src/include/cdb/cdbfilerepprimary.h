@@ -249,6 +249,8 @@ extern XLogRecPtr FileRepPrimary_GetMirrorXLogEof(void);
 
 extern int FileRepPrimary_GetMirrorStatus(void);
 
+extern void FileRepPrimary_GetBytesSent(int64 *messageBytesSent, int64 *wireBytesSent);
+
 /*
  * Inform mirror that gracefull shutdown is performing o primary
  */
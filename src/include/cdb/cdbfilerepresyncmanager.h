@@ -101,6 +101,8 @@ extern void FileRepResync_SetTotalBlocksToSynchronize(int64 totalBlocksToSynchro
 
 extern void FileRepResync_AddToTotalBlocksToSynchronize(int64 moreBlocksToSynchronize);
 
+extern int64 FileRepResync_GetBlocksSynchronizedPerSecond(void);
+
 extern struct timeval FileRepResync_GetEstimateResyncCompletionTime(void);
 
 extern void FileRepResyncManager_ResyncFlatFiles(void);
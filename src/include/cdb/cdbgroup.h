@@ -68,4 +68,6 @@ extern List *augment_subplan_tlist(List *tlist, List *exprs, int *pnum, AttrNumb
 extern Plan *within_agg_planner(PlannerInfo *root, AggClauseCounts *agg_counts,
 								GroupContext *group_context);
 
+extern bool approximate_count_distinct(Node *node);
+
 #endif   /* CDBGROUP_H */
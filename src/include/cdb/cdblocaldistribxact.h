@@ -71,4 +71,27 @@ extern void LocalDistribXactCache_AddCommitted(
 
 extern void LocalDistribXactCache_ShowStats(char *nameStr);
 
+extern Size SharedDistribXactCache_ShmemSize(void);
+
+extern void SharedDistribXactCache_ShmemInit(void);
+
+extern bool SharedDistribXactCache_IsEnabled(void);
+
+extern uint32 SharedDistribXactCache_XidEpoch(
+	TransactionId						localXid,
+	TransactionId						epochXid,
+	uint32								epoch);
+
+extern bool SharedDistribXactCache_CommittedFind(
+	TransactionId						localXid,
+	uint32								localXidEpoch,
+	DistributedTransactionTimeStamp		distribTransactionTimeStamp,
+	DistributedTransactionId			*distribXid);
+
+extern void SharedDistribXactCache_AddCommitted(
+	TransactionId						localXid,
+	uint32								localXidEpoch,
+	DistributedTransactionTimeStamp		distribTransactionTimeStamp,
+	DistributedTransactionId			distribXid);
+
 #endif   /* CDBLOCALDISTRIBXACT_H */
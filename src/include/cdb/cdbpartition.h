@@ -217,11 +217,13 @@ extern void RemovePartitionEncodingByRelidAttribute(Oid relid, AttrNumber attnum
 extern Datum *get_partition_encoding_attoptions(Relation rel, Oid paroid);
 
 extern LogicalIndexes * BuildLogicalIndexInfo(Oid relid);
+extern LogicalIndexes * BuildLogicalIndexOids(Oid relid);
 extern Oid getPhysicalIndexRelid(Relation partRel, LogicalIndexInfo *iInfo);
 
 extern LogicalIndexInfo *logicalIndexInfoForIndexOid(Oid rootOid, Oid indexOid);
 
 extern void InsertPidIntoDynamicTableScanInfo(int32 index, Oid partOid, int32 selectorId);
+extern void RemovePidFromDynamicTableScanInfo(int32 index, Oid partOid, int32 selectorId);
 
 extern char *
 DebugPartitionOid(Datum *elements, int n);
@@ -108,7 +108,13 @@ typedef enum
 	DTX_PROTOCOL_COMMAND_SUBTRANSACTION_ROLLBACK_INTERNAL,
 	DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL,
 
-	DTX_PROTOCOL_COMMAND_LAST = DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL
+	/**
+	 * Commit a transaction that wrote on a single segment, without preparing
+	 *   it first.  Sent instead of PREPARE and COMMIT_PREPARED.
+	 */
+	DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE,
+
+	DTX_PROTOCOL_COMMAND_LAST = DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE
 } DtxProtocolCommand;
 
 /* DTX Context above xact.c */
@@ -301,6 +307,8 @@ extern void createDtx(DistributedTransactionId	*distribXid,
 extern bool createDtxSnapshot(DistributedSnapshotWithLocalMapping *distribSnapshotWithLocalMapping);
 extern void	prepareDtxTransaction(void);
 extern bool isPreparedDtxTransaction(void);
+extern bool isQEOnePhaseCommit(void);
+extern void getQEOnePhaseCommitLogInfo(TMGXACT_LOG *gxact_log);
 extern void getDtxLogInfo(TMGXACT_LOG *gxact_log);
 extern bool notifyCommittedDtxTransactionIsNeeded(void);
 extern void notifyCommittedDtxTransaction(void);
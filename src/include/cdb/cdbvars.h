@@ -558,6 +558,9 @@ extern bool gp_enable_fast_sri;
 /* Enable single-mirror pair dispatch. */
 extern bool gp_enable_direct_dispatch;
 
+/* Commit single-segment direct dispatch transactions in one phase. */
+extern bool gp_enable_onephase_commit;
+
 /* Name of pseudo-function to access any table as if it was randomly distributed. */
 #define GP_DIST_RANDOM_NAME "GP_DIST_RANDOM"
 
@@ -725,6 +728,18 @@ extern bool gp_enable_agg_distinct;
  */
 extern bool gp_enable_dqa_pruning;
 
+/*
+ * "gp_enable_approx_count_distinct"
+ *
+ * May Greenplum compute count(DISTINCT x) approximately, with a HyperLogLog
+ * sketch that each segment builds on its own rows and that the final stage
+ * merges?  The result is then within a couple of percent of the exact count,
+ * but the aggregate plans like any other 2-phase aggregate and the input
+ * need not be redistributed on x.  Only the legacy planner looks at this;
+ * ORCA always counts exactly.
+ */
+extern bool gp_enable_approx_count_distinct;
+
 /*
  * "gp_eager_agg_distinct_pruning"
  *
@@ -911,6 +926,8 @@ extern bool		gp_statistics_use_fkeys;
 extern int 		gp_statistics_blocks_target;
 extern double	gp_statistics_ndistinct_scaling_ratio_threshold;
 extern double	gp_statistics_sampling_threshold;
+extern bool		gp_statistics_use_hll;
+extern double	gp_statistics_incremental_threshold;
 
 /* Analyze tools */
 extern int gp_motion_slice_noop;
@@ -950,6 +967,7 @@ extern const char *gpvars_show_gp_gpperfmon_log_alert_level(void);
 extern int gp_hashagg_compress_spill_files;
 extern int gp_workfile_compress_algorithm;
 extern bool gp_workfile_checksumming;
+extern bool gp_workfile_write_behind;
 extern double gp_workfile_limit_per_segment;
 extern double gp_workfile_limit_per_query;
 extern int gp_workfile_limit_files_per_query;
@@ -964,6 +982,9 @@ extern int gp_workfile_type_hashjoin;
 extern bool gp_mapreduce_define;
 extern bool coredump_on_memerror;
 
+/* Use bump contexts for per-tuple and deserialized plan memory? */
+extern bool gp_enable_bump_context;
+
 /* Autostats feature for MPP-4082. */
 typedef enum
 {
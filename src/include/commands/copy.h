@@ -156,6 +156,8 @@ typedef struct CopyStateData
 	int64		cur_lineno;		/* line number for error messages.  Negative means it isn't available. */
 	int64       cur_byteno;     /* number of bytes processed from input */
 	const char *cur_attname;	/* current att for error messages */
+	bool		flushing_batch;	/* inserting buffered rows, so line_buf is
+								 * not the line cur_lineno refers to */
 	//const char *cur_attval;		 /* current att value for error messages */
 
 	/*
@@ -241,6 +243,8 @@ typedef struct CopyStateData
 	PartitionNode *partitions; /* partitioning meta data from dispatcher */
 	List		  *ao_segnos;  /* AO table meta data from dispatcher */
 	bool          skip_ext_partition;  /* skip external partition */
+	bool		on_segment;		/* ON SEGMENT: each segment uses its own file */
+	List	   *dist_attrs;		/* distribution key from dispatcher (ON SEGMENT) */
 	/* end Greenplum Database specific variables */
 
 } CopyStateData;
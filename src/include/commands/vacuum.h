@@ -20,6 +20,7 @@
 #include "nodes/parsenodes.h"
 #include "storage/buf.h"
 #include "storage/lock.h"
+#include "utils/hyperloglog.h"
 #include "utils/rel.h"
 #include "utils/tqual.h"
 
@@ -95,6 +96,15 @@ typedef struct VacAttrStats
 	int			numvalues[STATISTIC_NUM_SLOTS];
 	Datum	   *stavalues[STATISTIC_NUM_SLOTS];
 
+	/*
+	 * Type of the stavalues of each slot.  Left zero, the column's own type
+	 * is used, which is what all the standard slot kinds want.
+	 */
+	Oid			statypid[STATISTIC_NUM_SLOTS];
+	int2		statyplen[STATISTIC_NUM_SLOTS];
+	bool		statypbyval[STATISTIC_NUM_SLOTS];
+	char		statypalign[STATISTIC_NUM_SLOTS];
+
 	/*
 	 * These fields are private to the main ANALYZE code and should not be
 	 * looked at by type-specific functions.
@@ -128,6 +138,65 @@ typedef struct VPgClassStats
 	BlockNumber empty_end_pages;
 } VPgClassStats;
 
+/*
+ * Incremental ANALYZE of append-only tables.
+ *
+ * Next to the HyperLogLog sketch of each column of an append-only table,
+ * ANALYZE keeps the watermark the sketch was built up to: the EOF, modcount
+ * and hidden tuple count of each segment file on each segment. As long as
+ * the table has only been appended to since, the next ANALYZE scans only
+ * the data after the watermark, and merges it into the stored statistics.
+ */
+typedef struct AOStatsWatermarkEntry
+{
+	int32		contentid;		/* segment the segment file is on */
+	int32		segno;			/* segment file number */
+	int64		eof;
+	int64		hiddentupcount;	/* rows hidden by the visibility map */
+	int64		modcount;		/* pg_aoseg modcount */
+} AOStatsWatermarkEntry;
+
+typedef struct AOStatsWatermark
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	Oid			relfilenode;	/* of the table on the master */
+	int64		rowcount;		/* visible rows up to the watermark */
+	AOStatsWatermarkEntry entries[1];	/* VARIABLE LENGTH ARRAY */
+} AOStatsWatermark;
+
+#define AOStatsWatermarkSize(nentries) \
+	(offsetof(AOStatsWatermark, entries) + (nentries) * sizeof(AOStatsWatermarkEntry))
+#define AOStatsWatermarkNumEntries(watermark) \
+	((VARSIZE(watermark) - offsetof(AOStatsWatermark, entries)) / sizeof(AOStatsWatermarkEntry))
+
+/*
+ * What gp_statistics_ao_appended_stats_oid() returns from each segment: the
+ * statistics of the rows after the watermark, one AOAppendedColumnStats per
+ * column, followed by the new watermark entries of the segment.
+ */
+typedef struct AOAppendedColumnStats
+{
+	int64		nullcount;
+	int64		widthsum;		/* total width of the non-null values */
+	char		sketch[HLL_SKETCH_SIZE];	/* an HLLSketch */
+} AOAppendedColumnStats;
+
+typedef struct AOAppendedStats
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int32		natts;
+	int32		nentries;
+	int64		rowcount;		/* visible rows after the watermark */
+} AOAppendedStats;
+
+#define AOAppendedStatsSize(natts, nentries) \
+	(sizeof(AOAppendedStats) + (natts) * sizeof(AOAppendedColumnStats) + \
+	 (nentries) * sizeof(AOStatsWatermarkEntry))
+#define AOAppendedStatsColumn(stats, i) \
+	((AOAppendedColumnStats *) ((char *) (stats) + sizeof(AOAppendedStats)) + (i))
+#define AOAppendedStatsEntries(stats) \
+	((AOStatsWatermarkEntry *) AOAppendedStatsColumn(stats, (stats)->natts))
+
 /* GUC parameters */
 extern PGDLLIMPORT int default_statistics_target;		/* PGDLLIMPORT for
 														 * PostGIS */
@@ -22,6 +22,19 @@ typedef void (PartitionEndMethod)(ScanState *scanState);
 typedef void (PartitionReScanMethod)(ScanState *scanState);
 typedef TupleTableSlot * (PartitionScanTupleMethod)(ScanState *scanState);
 
+/*
+ * DynamicScanPartitionEntry
+ *   Per-partition state that DynamicTableScan and DynamicIndexScan keep
+ * open across partition switches and rescans, so that a rescan only pays
+ * for the partitions it has not visited before.
+ */
+typedef struct DynamicScanPartitionEntry
+{
+	Oid			partOid;		/* hash key; must be first */
+	Relation	relation;		/* the partition, open until the scan ends */
+	Relation	indexRelation;	/* physical index, for DynamicIndexScan */
+} DynamicScanPartitionEntry;
+
 extern void
 DynamicScan_Begin(ScanState *scanState, Plan *plan, EState *estate, int eflags);
 
@@ -45,6 +58,15 @@ DynamicScan_GetCurrentRelation(ScanState *scanState);
 extern Oid
 DynamicScan_GetTableOid(ScanState *scanState);
 
+extern HTAB *
+DynamicScan_CreatePartitionCache(const char *name);
+
+extern DynamicScanPartitionEntry *
+DynamicScan_LookupPartition(HTAB *partitionCache, Oid partOid);
+
+extern void
+DynamicScan_DestroyPartitionCache(HTAB *partitionCache);
+
 extern bool
 DynamicScan_RemapExpression(ScanState *scanState, AttrNumber *attMap, Node *expr);
 
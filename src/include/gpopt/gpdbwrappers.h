@@ -241,7 +241,8 @@ namespace gpdb {
 	// get the list of check constraints for a given relation
 	List *PlCheckConstraint(Oid oidRel);
 
-	// part constraint expression tree
+	// part constraint expression tree; the tree and the list of default
+	// levels are cached, and must not be modified or freed by the caller
 	Node *PnodePartConstraintRel(Oid oidRel, List **pplDefaultLevels);
 
 	// get the cast function for the specified source and destination types
@@ -505,8 +506,13 @@ namespace gpdb {
 	// close the given relation
 	void CloseRelation(Relation rel);
 
-	// return the logical indexes for a partitioned table
+	// return the logical indexes for a partitioned table; free the result
+	// with GPDBFree(), the index infos it points to may be cached and must
+	// not be modified
 	LogicalIndexes *Plgidx(Oid oid);
+
+	// return the oids of the logical indexes of a partitioned table
+	List *PlLogicalIndexOids(Oid oid);
 	
 	// return the logical info structure for a given logical index oid
 	LogicalIndexInfo *Plgidxinfo(Oid rootOid, Oid indexOid);
@@ -610,10 +616,69 @@ namespace gpdb {
 	// return the number of leaf partition for a given table oid
 	gpos::ULONG UlLeafPartitions(Oid oidRelation);
 
+	// kinds of metadata cache entries that can be invalidated on their own
+	enum EMDCacheEntryKind
+	{
+		MDCacheEntryObject,		// relation, index, type, function, trigger, ...
+		MDCacheEntryRelStats,	// statistics of a relation
+		MDCacheEntryColStats	// statistics of a column of a relation
+	};
+
+	// identifies an entry of the metadata cache, without depending on the
+	// optimizer's own metadata id classes
+	struct SMDCacheEntry
+	{
+		int m_iKind;			// one of EMDCacheEntryKind
+		Oid m_oid;				// object oid, or relation oid for statistics
+		gpos::ULONG m_ulPos;	// column position, for column statistics
+	};
+
+	// statistics of the metadata cache of this backend
+	struct SMDCacheStats
+	{
+		int64 m_lOptimizations;		// number of times the cache was used
+		int64 m_lLoads;				// entries loaded from the catalogs
+		int64 m_lInvalidations;		// entries dropped on their own
+		int64 m_lResets;			// full resets of the cache
+		int64 m_lInvalMessages;		// catalog invalidation messages received
+		int64 m_lTrackedEntries;	// entries currently tracked for invalidation
+		int64 m_lPartMetadataBuilt;	// partition metadata built from the catalogs
+		int64 m_lPartMetadataReused;	// partition metadata found cached
+	};
+
 	// Does the metadata cache need to be reset (because of a catalog
-	// table has been changed?)
+	// table has been changed in a way that can't be tracked to individual
+	// cache entries?)
 	bool FMDCacheNeedsReset(void);
 
+	// remember the catalog objects a metadata cache entry was loaded from;
+	// attno is the attribute number for column statistics
+	void MDCacheTrackEntry(const SMDCacheEntry *pentry, AttrNumber attno);
+
+	// metadata cache entries invalidated since the last call
+	SMDCacheEntry *PMDCacheInvalidEntries(gpos::ULONG *pulEntries);
+
+	// statistics of the metadata cache
+	void MDCacheGetStats(SMDCacheStats *pstats);
+
+	// statistics of the metadata translated in the current optimization
+	struct SMDTranslationStats
+	{
+		int64 m_lObjects;				// objects translated from the catalogs
+		double m_dObjectsMs;			// time spent translating them
+		int64 m_lPartMetadataBuilt;		// partition metadata built from the catalogs
+		int64 m_lPartMetadataReused;	// partition metadata found cached
+		double m_dPartMetadataMs;		// time spent building partition metadata
+		int64 m_lPartMetadataBytes;		// memory used by the cached partition metadata
+	};
+
+	// bracket the translation of a metadata object from the catalogs
+	void MDTranslationStart(void);
+	void MDTranslationEnd(void);
+
+	// statistics of the metadata translated in the current optimization
+	void MDTranslationGetStats(SMDTranslationStats *pstats);
+
 } //namespace gpdb
 
 #define ForEach(cell, l)	\
@@ -53,6 +53,10 @@ namespace gpmd
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// register a loaded object for fine-grained cache invalidation
+			static
+			void TrackObject(CMDAccessor *pmda, IMDId *pmdid);
+
 		public:
 			// ctor/dtor
 			explicit
@@ -203,6 +203,14 @@ class COptTasks
 		static
 		COptimizerConfig *PoconfCreate(IMemoryPool *pmp, ICostModel *pcm);
 
+		// drop the metadata cache entries invalidated by catalog changes
+		static
+		void InvalidateMDCacheEntries(IMemoryPool *pmp);
+
+		// log the metadata translated for the current query
+		static
+		void PrintMDTranslationStats();
+
 		// optimize a query to a physical DXL
 		static
 		void* PvOptimizeTask(void *pv);
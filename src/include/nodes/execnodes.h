@@ -375,6 +375,8 @@ typedef struct ResultRelInfo
 	struct AppendOnlyInsertDescData *ri_aoInsertDesc;
 	struct AOCSInsertDescData *ri_aocsInsertDesc;
 	struct ExternalInsertDescData *ri_extInsertDesc;
+	struct HeapInsertBuffer *ri_heapInsertBuffer;	/* rows not yet written,
+													 * see ExecInsert() */
 
 	RelationDeleteDesc ri_deleteDesc;
 	RelationUpdateDesc ri_updateDesc;
@@ -574,6 +576,11 @@ typedef struct EState
 
 	TupleTableSlot *es_trig_tuple_slot; /* for trigger output tuples */
 
+	/* Stuff used for batching INSERTs into heap tables, see ExecInsert(): */
+	bool		es_heap_insert_batch;	/* may rows be buffered at all? */
+	Size		es_heap_insert_bytes;	/* memory used by the buffers */
+	uint64		es_heap_insert_clock;	/* to find the least recently used */
+
 	/* Stuff used for SELECT INTO: */
 	Relation	es_into_relation_descriptor;
 	bool		es_into_relation_use_wal;
@@ -1763,6 +1770,13 @@ typedef struct DynamicIndexScanState
 
 	/* The partition oid for which the current varnos are mapped */
 	Oid columnLayoutOid;
+
+	/*
+	 * Partitions and their physical indexes opened by this scan, keyed by
+	 * partition oid (see DynamicScanPartitionEntry). They stay open until
+	 * the end of the scan, so rescans do not look them up again.
+	 */
+	HTAB *partitionCache;
 } DynamicIndexScanState;
 
 
@@ -2085,7 +2099,12 @@ typedef struct DynamicTableScanState
 	 */
 	MemoryContext partitionMemoryContext;
 
-
+	/*
+	 * Partitions opened by this scan, keyed by partition oid (see
+	 * DynamicScanPartitionEntry). They stay open until the end of the scan,
+	 * so rescans do not reopen them.
+	 */
+	HTAB *partitionCache;
 } DynamicTableScanState;
 
 /* ----------------------------------------------------------------
@@ -2680,7 +2699,8 @@ struct PartitionSelectorState
 	List *levelExprStates;                              /* ExprState for general expressions for all levels */
 	ExprState *residualPredicateExprState;              /* ExprState for evaluating residual predicate */
 	ExprState *propagationExprState;                    /* ExprState for evaluating propagation expression */
-
+	List *propagatedPartOids;                           /* part oids propagated by the last execution, */
+	List *propagatedScanIds;                            /* and their scan ids (selectors without child only) */
 };
 
 extern void initGpmonPktForResult(Plan *planNode, gpmon_packet_t *gpmon_pkt, EState *estate);
@@ -22,7 +22,9 @@
  *		A logical context in which memory allocations occur.
  *
  * MemoryContext itself is an abstract type that can have multiple
- * implementations, though for now we have only AllocSetContext.
+ * implementations: AllocSetContext is the general-purpose one,
+ * BumpContext serves allocations that are only ever released wholesale,
+ * and SlabContext serves many objects of one fixed size.
  * The function pointers in MemoryContextMethods define one specific
  * implementation of MemoryContext --- they are a virtual function table
  * in C++ terms.
@@ -86,7 +88,9 @@ typedef struct MemoryContextData
 	((context) != NULL && \
 	 ( IsA((context), AllocSetContext) || \
        IsA((context), AsetDirectContext) || \
-       IsA((context), MPoolContext) ))
+       IsA((context), MPoolContext) || \
+       IsA((context), BumpContext) || \
+       IsA((context), SlabContext) ))
 
 
 #endif   /* MEMNODES_H */
@@ -317,6 +317,8 @@ typedef enum NodeTag
 	T_SerializedMemoryAccount,
 
     T_AsetDirectContext = 610,                                      /*CDB*/
+	T_BumpContext,
+	T_SlabContext,
 
 	/*
 	 * TAGS FOR VALUE NODES (value.h)
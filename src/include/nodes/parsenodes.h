@@ -1405,6 +1405,7 @@ typedef struct CopyStmt
 	/* Convenient location for dispatch of misc meta data */
 	PartitionNode *partitions;
 	List		*ao_segnos;		/* AO segno map */
+	List		*dist_attrs;	/* distribution key attnums, for ON SEGMENT */
 } CopyStmt;
 
 /* ----------------------
@@ -48,6 +48,7 @@ typedef struct StartReplicationCmd
 	NodeTag		type;
 	XLogRecPtr	startpoint;
 	bool		sync;
+	bool		compress;		/* does the client accept 'z' messages? */
 } StartReplicationCmd;
 
 #endif   /* REPLNODES_H */
@@ -53,6 +53,21 @@ typedef struct
 	TimestampTz sendTime;
 } WalDataMessageHeader;
 
+/*
+ * Header for a compressed WAL data message (message type 'z'), sent instead
+ * of 'w' when wal_sender_compression is on, the client asked for it with
+ * START_REPLICATION ... COMPRESS, and the data compresses.  The
+ * header is followed by the WAL data, compressed with the "lz" codec of
+ * storage/bfz.h.
+ */
+typedef struct
+{
+	WalDataMessageHeader hdr;
+
+	/* Length of the WAL data before compression */
+	uint32		rawLen;
+} WalCompressedDataMessageHeader;
+
 /*
  * Keepalive message from primary (message type 'k'). (lowercase k)
  * This is wrapped within a CopyData message at the FE/BE protocol level.
@@ -26,6 +26,7 @@ extern volatile sig_atomic_t walsender_ready_to_stop;
 extern int	max_wal_senders;
 extern int	replication_timeout;
 extern int	repl_catchup_within_range;
+extern bool wal_sender_compression;
 
 extern void InitWalSender(void);
 extern void exec_replication_command(const char *query_string);
@@ -67,6 +67,13 @@ typedef struct WalSnd
 	 */
 	XLogRecPtr	xlogCleanUpTo;
 
+	/*
+	 * Bytes of WAL sent to the standby, and the bytes put on the wire for
+	 * them, which is less when wal_sender_compression is on.
+	 */
+	int64		sentBytes;
+	int64		sentWireBytes;
+
 	/* Protects shared variables shown above. */
 	slock_t		mutex;
 
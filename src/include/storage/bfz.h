@@ -31,14 +31,26 @@ struct bfz_freeable_stuff
  * determine the boundary of a buffer that a checksum is applied to.
  */
 	void (*write_ex) (struct bfz * thiz, const char *buffer, int size);
+
+/*
+ * Like write_ex, but returns false with errno set instead of throwing.
+ * It is called from the write-behind thread, so it must not elog or
+ * palloc. NULL if the algorithm cannot write outside the main thread.
+ */
+	bool (*try_write_ex) (struct bfz * thiz, const char *buffer, int size);
 	void (*close_ex) (struct bfz * thiz);
 
 	char buffer[BFZ_BUFFER_SIZE];
 };
 
+struct bfz_writebehind;
+
 typedef struct bfz
 {
 	struct bfz_freeable_stuff *freeable_stuff;
+
+	/* Block being written by the write-behind thread, NULL if not used */
+	struct bfz_writebehind *writebehind;
 	int			fd;
 	char        *filename;
 	unsigned char mode;
@@ -65,11 +77,13 @@ typedef struct bfz
 extern void bfz_nothing_init(bfz_t * thiz);
 extern void bfz_zlib_init(bfz_t * thiz);
 extern void bfz_lzop_init(bfz_t * thiz);
+extern void bfz_lz_init(bfz_t * thiz);
 extern void bfz_write_ex(bfz_t * thiz, const char *buffer, int size);
 extern int	bfz_read_ex(bfz_t * thiz, char *buffer, int size);
 
 /* These functions are interface to bfz. */
 extern int	bfz_string_to_compression(const char *string);
+extern Size bfz_append_buffer_size(void);
 
 extern bfz_t *bfz_create(const char *filePrefix, bool delOnClose, int compress);
 extern bfz_t *bfz_open(const char *fileName, bool delOnClose, int compress);
@@ -79,6 +93,17 @@ extern void bfz_close(bfz_t * thiz, bool unreg, bool error_on_unlink);
 extern ssize_t readAndRetry(int fd, void *buffer, size_t size);
 extern ssize_t writeAndRetry(int fd, const void *buffer, size_t size);
 
+/*
+ * The "lz" codec on its own. Replication uses it to compress what it sends
+ * over the network.
+ */
+
+/* Worst case length of a compressed block of 'size' bytes */
+#define LZ_COMPRESS_BOUND(size)	((size) + (size) / 255 + 16)
+
+extern int	bfz_lz_compress(const char *src, int srclen, char *dst, int dstlen);
+extern int	bfz_lz_decompress(const char *src, int srclen, char *dst, int dstlen);
+
 static inline int64
 bfz_totalbytes(bfz_t * bfz)
 {
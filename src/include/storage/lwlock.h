@@ -50,7 +50,7 @@
 typedef enum LWLockId
 {
 	NullLock = 0,		// Have 0 be no lock.
-	BufFreelistLock,
+	BufFreelistLock,		/* not used anymore, see freelist.c */
 	ShmemIndexLock,
 	OidGenLock,
 	XidGenLock,
@@ -92,6 +92,7 @@ typedef enum LWLockId
 	FileRepAppendOnlyCommitCountLock,
 	SyncRepLock,
 	ErrorLogLock,
+	OptPlanCacheLock,
 	FirstWorkfileMgrLock,
 	FirstWorkfileQuerySpaceLock = FirstWorkfileMgrLock + NUM_WORKFILEMGR_PARTITIONS,
 	FirstBufMappingLock = FirstWorkfileQuerySpaceLock + NUM_WORKFILE_QUERYSPACE_PARTITIONS,
@@ -109,7 +110,10 @@ typedef enum LWLockId
 typedef enum LWLockMode
 {
 	LW_EXCLUSIVE,
-	LW_SHARED
+	LW_SHARED,
+	LW_WAIT_UNTIL_FREE			/* A special mode used in PGPROC->lwWaitMode,
+								 * when waiting for lock to become free. Not
+								 * to be used as LWLockAcquire argument */
 } LWLockMode;
 
 
@@ -120,6 +124,7 @@ extern bool Trace_lwlocks;
 extern LWLockId LWLockAssign(void);
 extern void LWLockAcquire(LWLockId lockid, LWLockMode mode);
 extern bool LWLockConditionalAcquire(LWLockId lockid, LWLockMode mode);
+extern bool LWLockAcquireOrWait(LWLockId lockid, LWLockMode mode);
 extern void LWLockRelease(LWLockId lockid);
 extern void LWLockReleaseAll(void);
 extern void LWLockWaitCancel(void);
@@ -114,7 +114,7 @@ struct PGPROC
 
 	/* Info about LWLock the process is currently waiting for, if any. */
 	bool		lwWaiting;		/* true if waiting for an LW lock */
-	bool		lwExclusive;	/* true if waiting for exclusive access */
+	uint8		lwWaitMode;		/* lwlock mode being waited for */
 	struct PGPROC *lwWaitLink;	/* next waiter for same LW lock */
 
 	/* Info about lock the process is currently waiting for, if any. */
@@ -208,10 +208,8 @@ typedef struct PROC_HDR
  *					3) Consumer Ack 
  *					4) Recovery 
  *					5) Resync Manager 
- *					6) Resync Worker 1
- *					7) Resync Worker 2
- *					8) Resync Worker 3
- *					9) Resync Worker 4
+ *				  6-9) Resync Worker 1 to 4, of which filerep_resync_workers
+ *						are started
  *				   10) Verification
  * 
  *			b) 6 slots on Mirror 
@@ -40,6 +40,8 @@ extern bool HaveTransactionsInCommit(TransactionId *xids, int nxids);
 
 extern PGPROC *BackendPidGetProc(int pid);
 extern int	BackendXidGetPid(TransactionId xid);
+extern TransactionId DistributedXidGetBackendXid(DistributedTransactionTimeStamp distribTimeStamp,
+												 DistributedTransactionId distribXid);
 extern bool IsBackendPid(int pid);
 
 extern VirtualTransactionId *GetCurrentVirtualXIDs(TransactionId limitXmin,
@@ -432,6 +432,7 @@ extern Datum pg_total_relation_size_oid(PG_FUNCTION_ARGS);
 extern Datum pg_total_relation_size_name(PG_FUNCTION_ARGS);
 extern Datum pg_size_pretty(PG_FUNCTION_ARGS);
 extern Datum gp_statistics_estimate_reltuples_relpages_oid(PG_FUNCTION_ARGS);
+extern Datum gp_statistics_ao_appended_stats_oid(PG_FUNCTION_ARGS);
 
 /* genfile.c */
 extern Datum pg_stat_file(PG_FUNCTION_ARGS);
@@ -1121,6 +1122,7 @@ extern Datum mpp_global_xid_map(PG_FUNCTION_ARGS);
 /* utils/resscheduler/resqueue.c */
 extern Datum pg_resqueue_status(PG_FUNCTION_ARGS);
 extern Datum pg_resqueue_status_kv(PG_FUNCTION_ARGS);
+extern Datum pg_resqueue_admission_stats(PG_FUNCTION_ARGS);
 
 /* utils/adt/matrix.c */
 extern Datum matrix_transpose(PG_FUNCTION_ARGS);
@@ -1265,4 +1267,7 @@ extern Datum enable_xform(PG_FUNCTION_ARGS);
 /* Optimizer's version */
 extern Datum gp_opt_version(PG_FUNCTION_ARGS);
 
+/* Optimizer's metadata cache */
+extern Datum gp_opt_mdcache_stats(PG_FUNCTION_ARGS);
+
 #endif   /* BUILTINS_H */
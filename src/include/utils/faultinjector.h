@@ -145,6 +145,8 @@ typedef enum FaultInjectorIdentifier_e {
 	
 	DtmXLogDistributedCommit,
 
+	DtmQEOnePhaseCommit,
+
 	DtmInit,
 	
         EndPreparedTwoPhaseSleep,
@@ -169,6 +169,7 @@ extern int	Test_blocksize_override;
 extern int  Test_safefswritesize_override;
 extern bool Master_mirroring_administrator_disable;
 extern int  gp_max_local_distributed_cache;
+extern int  gp_max_shared_distributed_cache;
 extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
@@ -185,6 +186,8 @@ extern bool gp_appendonly_compaction;
  */ 
 extern int  gp_appendonly_compaction_threshold;
 extern bool gp_heap_require_relhasoids_match;
+extern bool gp_enable_heap_multi_insert;
+extern int	gp_copy_insert_desc_memory;
 extern bool	Debug_appendonly_rezero_quicklz_compress_scratch;
 extern bool	Debug_appendonly_rezero_quicklz_decompress_scratch;
 extern bool	Debug_appendonly_guard_end_quicklz_scratch;
@@ -389,6 +392,9 @@ extern bool optimizer_print_plan;
 extern bool optimizer_print_xform;
 extern bool optimizer_metadata_caching;
 extern int optimizer_mdcache_size;
+extern int optimizer_partition_metadata_cache_size;
+extern bool optimizer_enable_plan_cache;
+extern int optimizer_plan_cache_size;
 extern bool optimizer_disable_xform_result_printing;
 extern bool	optimizer_print_memo_after_exploration;
 extern bool	optimizer_print_memo_after_implementation;
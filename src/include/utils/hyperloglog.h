@@ -0,0 +1,45 @@
+/*-----------------------------------------------------------------------
+ * hyperloglog.h
+ *	  HyperLogLog sketches for estimating the number of distinct values.
+ *
+ * See hyperloglog.c for comments.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-----------------------------------------------------------------------
+ */
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include "fmgr.h"
+
+/*
+ * A sketch is a bytea holding one byte per register. With 2^12 registers
+ * the standard error of the estimate is about 1.6%.
+ */
+#define HLL_PRECISION		12
+#define HLL_NUM_REGISTERS	(1 << HLL_PRECISION)
+
+typedef struct HLLSketch
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint8		precision;		/* always HLL_PRECISION for now */
+	uint8		registers[1];	/* VARIABLE LENGTH ARRAY */
+} HLLSketch;
+
+#define HLL_SKETCH_SIZE		(offsetof(HLLSketch, registers) + HLL_NUM_REGISTERS)
+
+extern HLLSketch *hll_create(void);
+extern bool hll_is_valid(HLLSketch *sketch);
+extern Oid	hll_hash_proc(Oid typid);
+extern uint32 hll_hash_datum(FmgrInfo *hashproc, Datum value);
+extern void hll_add_hash(HLLSketch *sketch, uint32 hash);
+extern void hll_merge(HLLSketch *dst, HLLSketch *src);
+extern double hll_estimate(HLLSketch *sketch);
+
+extern Datum gp_hll_accum(PG_FUNCTION_ARGS);
+extern Datum gp_hll_merge(PG_FUNCTION_ARGS);
+extern Datum gp_hll_estimate(PG_FUNCTION_ARGS);
+extern Datum gp_hll_count(PG_FUNCTION_ARGS);
+
+#endif   /* HYPERLOGLOG_H */
@@ -285,6 +285,15 @@ MemoryAccounting_ToCSV(MemoryAccount *root, StringInfoData *str, char *prefix);
 
 extern void
 MemoryAccounting_PrettyPrint(void);
+
+/* Defined in aset.c; used by every memory context type */
+extern bool
+MemoryAccounting_Allocate(struct MemoryAccount* memoryAccount, Size allocatedSize);
+
+extern bool
+MemoryAccounting_Free(struct MemoryAccount* memoryAccount,
+		uint16 memoryAccountGeneration, Size allocatedSize);
+
 /*
  * MemoryAccountIsValid
  *		True iff memory account is valid.
@@ -259,6 +259,21 @@ extern MemoryContext AllocSetContextCreate(MemoryContext parent,
 					  Size initBlockSize,
 					  Size maxBlockSize);
 
+/* bump.c */
+extern MemoryContext BumpContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size initBlockSize,
+				  Size maxBlockSize);
+extern bool BumpContextContainsPointer(MemoryContext context, void *pointer);
+
+/* slab.c */
+extern MemoryContext SlabContextCreate(MemoryContext parent,
+				  const char *name,
+				  Size blockSize,
+				  Size chunkSize);
+extern Size SlabBlockSizeFor(Size chunkSize, int nchunks);
+extern bool SlabContextContainsPointer(MemoryContext context, void *pointer);
+
 /* mpool.c */
 typedef struct MPool MPool;
 extern MPool *mpool_create(MemoryContext parent,
@@ -0,0 +1,33 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.h
+ *	  Shared cache of plans produced by the GPORCA optimizer.
+ *
+ * See optplancache.c for comments.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTPLANCACHE_H
+#define OPTPLANCACHE_H
+
+#include "fmgr.h"
+#include "nodes/params.h"
+#include "nodes/parsenodes.h"
+#include "nodes/plannodes.h"
+
+extern Size OptPlanCacheShmemSize(void);
+extern void OptPlanCacheShmemInit(void);
+extern void InitOptPlanCache(void);
+
+extern char *OptPlanCacheBuildKey(Query *parse, ParamListInfo boundParams,
+					 int *keyLen);
+extern PlannedStmt *OptPlanCacheLookup(const char *key, int keyLen,
+				   uint64 *generation);
+extern void OptPlanCacheInsert(const char *key, int keyLen, PlannedStmt *plan,
+				   double optimizeMs, uint64 generation);
+
+extern Datum gp_opt_plan_cache_stats(PG_FUNCTION_ARGS);
+
+#endif   /* OPTPLANCACHE_H */
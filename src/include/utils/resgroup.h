@@ -0,0 +1,44 @@
+/*-------------------------------------------------------------------------
+ *
+ * resgroup.h
+ *	  POSTGRES resource group definitions.
+ *
+ * A resource group applies the CPU and memory settings of a resource queue
+ * to the backends that run its statements, on the master and the segments.
+ *
+ * Copyright (c) 2016, Pivotal Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef RESGROUP_H
+#define RESGROUP_H
+
+#include "fmgr.h"
+
+/* GUCs */
+extern bool gp_resgroup_enable;
+extern char *gp_resgroup_cgroup_dir;
+
+/* cpu.shares given to a group with the default (MEDIUM) priority */
+#define RESGROUP_DEFAULT_CPU_SHARES		1024
+
+/* Limits of cpu.shares accepted by the cgroup cpu controller */
+#define RESGROUP_MIN_CPU_SHARES			2
+#define RESGROUP_MAX_CPU_SHARES			262144
+
+/* CFS period used when a group has a cpu_rate_limit */
+#define RESGROUP_CPU_PERIOD_USECS		100000
+
+extern Size ResGroupShmemSize(void);
+extern void ResGroupShmemInit(void);
+
+extern void ResGroupStatementStart(Oid queueId);
+extern void ResGroupSetDispatchedQueueId(Oid queueId);
+extern void AtEOXact_ResGroup(void);
+
+extern int	ResGroupPriorityWeightToShares(int weight);
+extern int64 ResGroupCpuRateLimitToQuota(int cpuRateLimit, int ncores);
+
+extern Datum pg_resgroup_get_status(PG_FUNCTION_ARGS);
+
+#endif   /* RESGROUP_H */
@@ -19,6 +19,7 @@
 #include "nodes/plannodes.h"
 #include "storage/lock.h"
 #include "tcop/dest.h"
+#include "utils/timestamp.h"
 
 /*
  * GUC variables.
@@ -28,6 +29,10 @@ extern int	MaxResourceQueues;
 extern int	MaxResourcePortalsPerXact;
 extern bool	ResourceSelectOnly;
 extern bool	ResourceCleanupIdleGangs;
+extern double	gp_resqueue_short_query_cost;
+extern int	gp_resqueue_short_query_slots;
+extern bool	gp_resqueue_admit_shortest_first;
+extern int	gp_resqueue_starvation_timeout;
 
 extern Oid MyQueueId; /* resource queue for current role. */
 
@@ -71,6 +76,16 @@ typedef struct ResQueueData
 	bool			overcommit;			/* Does queue allow overcommit? */
 	float4			ignorecostlimit;	/* Ignore queries with cost less than.*/
 	ResLimitData	limits[NUM_RES_LIMIT_TYPES];	/* The limits */
+
+	/* Admission statistics, reported by pg_resqueue_admission_stats(). */
+	int64			numAdmitted;		/* # statements admitted */
+	int64			numAdmittedAfterWait;	/* # of those that had to wait */
+	int64			numAdmittedShort;	/* # admitted over the count limit
+										 * as short queries */
+	int64			numAdmittedOutOfOrder;	/* # admitted ahead of a
+											 * statement that queued earlier */
+	double			totalWaitSecs;		/* total queuing time */
+	double			maxWaitSecs;		/* longest queuing time */
 } ResQueueData;
 typedef ResQueueData	*ResQueue;
 
@@ -94,6 +109,7 @@ typedef struct ResPortalIncrement
 										   of ResPortalIncrements. */
 	/* The increments - use Cost as it has a suitably large range. */
 	Cost		increments[NUM_RES_LIMIT_TYPES];
+	TimestampTz	waitStart;				/* When we started queuing, or 0. */
 } ResPortalIncrement;
 
 typedef struct ResPortalTag
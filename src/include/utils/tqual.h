@@ -76,6 +76,14 @@ typedef struct SnapshotData
 								 * transactions are visible for a distributed
 								 * transaction, with cached local xids
 								 */
+
+	/*
+	 * GP: ProcArray's transaction completion count when GetSnapshotData last
+	 * computed the local part of this snapshot (0 if not), and the global
+	 * xmin computed with it.
+	 */
+	uint64		snapXactCompletionCount;
+	TransactionId snapGlobalXmin;
 } SnapshotData;
 
 #define InvalidSnapshot		((Snapshot) NULL)
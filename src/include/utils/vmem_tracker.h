@@ -24,7 +24,8 @@ typedef enum MemoryAllocationStatus
 	MemoryAllocation_Success,
 	MemoryFailure_VmemExhausted,
 	MemoryFailure_SystemMemoryExhausted,
-	MemoryFailure_QueryMemoryExhausted
+	MemoryFailure_QueryMemoryExhausted,
+	MemoryFailure_ResourceGroupMemoryExhausted
 } MemoryAllocationStatus;
 
 typedef int64 EventVersion;
@@ -52,6 +53,9 @@ extern MemoryAllocationStatus VmemTracker_ReserveVmem(int64 newly_requested);
 extern void VmemTracker_ReleaseVmem(int64 to_be_freed_requested);
 extern void VmemTracker_RequestWaiver(int64 waiver_bytes);
 extern int64 VmemTracker_Fault(int32 reason, int64 arg);
+extern void VmemTracker_JoinResGroup(volatile int32 *groupVmemChunks, int64 groupVmemLimitBytes);
+extern void VmemTracker_LeaveResGroup(void);
+extern int32 VmemTracker_GetResGroupVmemLimitMB(void);
 
 extern int32 RedZoneHandler_GetRedZoneLimitChunks(void);
 extern int32 RedZoneHandler_GetRedZoneLimitMB(void);
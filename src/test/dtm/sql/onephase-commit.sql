@@ -0,0 +1,34 @@
+--
+-- Test that a transaction committed in one phase on a segment survives a
+-- crash of that segment, before it could acknowledge the commit to the
+-- master. Crash recovery must put the transaction back in the segment's
+-- distributed log, or it would not be visible to distributed snapshots,
+-- and the master must find out that it committed.
+--
+CREATE TABLE dtm_onephase(id int4) DISTRIBUTED BY (id);
+
+SET gp_enable_onephase_commit = on;
+
+-- PANIC the segment that commits the next one-phase transaction, just
+-- after its commit record has been flushed.
+select distinct gp_inject_fault('dtm_qe_onephase_commit', 'panic', '', '', '', 1, 0)
+  from gp_dist_random('gp_id');
+
+-- The master asks the recovered segment again; the warnings name the
+-- segment, so ignore them.
+-- start_ignore
+insert into dtm_onephase values (1);
+-- end_ignore
+
+select * from dtm_onephase;
+
+-- The row must stay visible, and deletable, once the segment is up.
+insert into dtm_onephase values (2);
+delete from dtm_onephase where id = 1;
+select * from dtm_onephase order by id;
+
+select distinct gp_inject_fault('dtm_qe_onephase_commit', 'reset', '', '', '', 1, 0)
+  from gp_dist_random('gp_id');
+
+RESET gp_enable_onephase_commit;
+DROP TABLE dtm_onephase;
@@ -0,0 +1,36 @@
+# Test that a snapshot taken after a transaction ends sees its commit.
+#
+# GetSnapshotData() reuses the previous snapshot of the backend while no
+# transaction has ended since, and QE readers copy the distributed snapshot
+# the writer published instead of building their own. Both are invisible
+# when right, and silent visibility bugs when wrong, so check that each new
+# statement of a READ COMMITTED transaction sees what committed in between,
+# both in a single-slice query and in a join whose reader gang scans the
+# table too. A SERIALIZABLE transaction must keep seeing its first snapshot.
+
+setup
+{
+    create table snap_reuse (a int, b int) distributed by (a);
+    insert into snap_reuse select i, i from generate_series(1, 10) i;
+}
+
+teardown
+{
+    drop table if exists snap_reuse;
+}
+
+session "s1"
+step "s1begin"	{ BEGIN; }
+step "s1beginser"	{ BEGIN ISOLATION LEVEL SERIALIZABLE; }
+step "s1count"	{ select count(*) from snap_reuse; }
+step "s1join"	{ select count(*) from snap_reuse t1 join snap_reuse t2 on t1.a = t2.b; }
+step "s1commit"	{ COMMIT; }
+
+session "s2"
+step "s2insert"	{ insert into snap_reuse select i, i from generate_series(11, 20) i; }
+step "s2begin"	{ BEGIN; }
+step "s2insert2"	{ insert into snap_reuse select i, i from generate_series(21, 30) i; }
+step "s2commit"	{ COMMIT; }
+
+permutation "s1begin" "s1count" "s1join" "s2insert" "s1count" "s1join" "s2begin" "s2insert2" "s1count" "s1join" "s2commit" "s1count" "s1join" "s1commit"
+permutation "s1beginser" "s1count" "s1join" "s2insert" "s1count" "s1join" "s2begin" "s2insert2" "s2commit" "s1count" "s1join" "s1commit"
@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# Buffer allocation benchmark.
+#
+# Runs pgbench SELECT-only transactions with many clients against a table
+# much larger than shared_buffers, so that most reads have to allocate a
+# buffer: take one from the free list or run the clock sweep. Reports the
+# tps, and the buffers allocated per second by each segment, where the
+# reads happen, taken from their bgwriter statistics.
+#
+# Usage: bufalloc-contention.sh [dbname [scale [seconds [clients...]]]]
+#
+
+DEFAULT_SCALE=100
+DEFAULT_CLIENTS="64 96 128"
+. `dirname $0`/pgbench-common.sh
+
+STATS=/tmp/bufalloc-contention.$$
+trap 'rm -f $STATS.before $STATS.after' 0
+
+bufalloc()
+{
+	psql -At -F ' ' -d $DBNAME -c "SELECT gp_segment_id, pg_stat_get_buf_alloc() FROM gp_dist_random('gp_id') ORDER BY 1"
+}
+
+before_clients()
+{
+	bufalloc > $STATS.before
+}
+
+after_clients()
+{
+	bufalloc > $STATS.after
+	awk -v secs=$DURATION '
+		NR == FNR { before[$1] = $2; next }
+		{ printf "segment %d buffer allocs/s = %d\n", $1, ($2 - before[$1]) / secs }
+	' $STATS.before $STATS.after
+}
+
+run_clients
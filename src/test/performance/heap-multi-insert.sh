@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# Heap insert batching benchmark.
+#
+# Loads the same rows into an indexed heap table with COPY, INSERT ... SELECT
+# and CREATE TABLE AS, once with gp_enable_heap_multi_insert off and once
+# with it on, and reports the rows/s of each. INSERT ... SELECT is also run
+# into a table with many partitions, which keeps a buffer per partition.
+#
+# Usage: heap-multi-insert.sh [dbname [rows]]
+#
+
+DBNAME=${1:-perftest}
+ROWS=${2:-10000000}
+DATA=/tmp/heap-multi-insert.$$
+trap 'rm -f $DATA' 0
+
+run()
+{
+	# run <setting> <label> <sql>: print the rows/s of the last statement
+	ms=`printf 'SET gp_enable_heap_multi_insert = %s;\n\\timing\n%s;\n' "$1" "$3" |
+		psql -q -d $DBNAME | awk '/^Time:/ { t = $2 } END { print t }'`
+	echo "$2 gp_enable_heap_multi_insert=$1 rows/s = `echo "$ROWS * 1000 / $ms" | bc`"
+}
+
+createdb $DBNAME 2>/dev/null
+psql -q -d $DBNAME <<EOF || exit 1
+DROP TABLE IF EXISTS hmi_src, hmi_dst, hmi_part, hmi_ctas;
+CREATE TABLE hmi_src AS SELECT i AS a, 'row ' || i AS b FROM generate_series(1, $ROWS) i DISTRIBUTED BY (a);
+CREATE TABLE hmi_dst (a int, b text) DISTRIBUTED BY (a);
+CREATE INDEX hmi_dst_a ON hmi_dst (a);
+CREATE TABLE hmi_part (a int, b text) DISTRIBUTED BY (a)
+PARTITION BY RANGE (a) (START (1) END ($ROWS + 1) EVERY ($ROWS / 500 + 1));
+COPY hmi_src TO '$DATA';
+EOF
+
+for setting in off on
+do
+	psql -q -d $DBNAME -c "TRUNCATE hmi_dst"
+	run $setting "COPY" "COPY hmi_dst FROM '$DATA'"
+	psql -q -d $DBNAME -c "TRUNCATE hmi_dst"
+	run $setting "INSERT ... SELECT" "INSERT INTO hmi_dst SELECT * FROM hmi_src"
+	psql -q -d $DBNAME -c "TRUNCATE hmi_part"
+	run $setting "INSERT ... SELECT, 500 partitions" "INSERT INTO hmi_part SELECT * FROM hmi_src"
+	psql -q -d $DBNAME -c "DROP TABLE IF EXISTS hmi_ctas"
+	run $setting "CREATE TABLE AS" "CREATE TABLE hmi_ctas AS SELECT * FROM hmi_src DISTRIBUTED BY (a)"
+done
@@ -0,0 +1,19 @@
+#!/bin/sh
+#
+# LWLock contention benchmark.
+#
+# Runs pgbench SELECT-only transactions against a single-host cluster
+# (e.g. gpdemo) with a growing number of clients. Every transaction takes a
+# snapshot (ProcArrayLock), reads shared buffers (buffer mapping locks) and
+# checks visibility against the distributed log, all in shared mode, so the
+# tps should keep growing with the number of clients until the cores run
+# out.
+#
+# Usage: lwlock-contention.sh [dbname [scale [seconds [clients...]]]]
+#
+
+DEFAULT_SCALE=10
+DEFAULT_CLIENTS="1 4 16 32 64"
+. `dirname $0`/pgbench-common.sh
+
+run_clients
@@ -0,0 +1,40 @@
+#
+# Common part of the pgbench contention benchmarks, sourced by them.
+#
+# Takes the arguments [dbname [scale [seconds [clients...]]]], with the
+# defaults DEFAULT_SCALE and DEFAULT_CLIENTS set by the caller. Then
+# run_clients initializes the database, and runs pgbench SELECT-only
+# transactions for each number of clients, reporting the tps. A benchmark
+# may redefine before_clients and after_clients, which are called around
+# each run with the number of clients, to report more.
+#
+
+DBNAME=${1:-perftest}
+SCALE=${2:-$DEFAULT_SCALE}
+DURATION=${3:-60}
+[ $# -gt 3 ] && shift 3 || set --
+CLIENTS=${*:-$DEFAULT_CLIENTS}
+
+before_clients()
+{
+	:
+}
+
+after_clients()
+{
+	:
+}
+
+run_clients()
+{
+	createdb $DBNAME 2>/dev/null
+	pgbench -i -s $SCALE $DBNAME || exit 1
+
+	for c in $CLIENTS
+	do
+		echo "clients $c:"
+		before_clients $c
+		pgbench -n -S -M prepared -c $c -j $c -T $DURATION $DBNAME | grep tps
+		after_clients $c
+	done
+}
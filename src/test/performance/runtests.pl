@@ -45,6 +45,10 @@ $DBNAME = 'perftest';
 'crtsimple.ntm',	'Create SIMPLE table (no timing)',
 # 8192 inserts in 8192 xactions
 'inssimple',		'8192 INSERTs INTO SIMPLE (8192 xacts)',
+'drpsimple.ntm',	'Drop SIMPLE table (no timing)',
+'crtsimple.ntm',	'Create SIMPLE table (no timing)',
+# 8192 inserts in 8192 xactions, committed in one phase
+'inssimple1pc',		'8192 INSERTs INTO SIMPLE (8192 1PC xacts)',
 'vacuum.ntm',		'Vacuum (no timing)',
 # Fast (after table filled with data) index creation test
 'crtsimpleidx',		'Create INDEX on SIMPLE',
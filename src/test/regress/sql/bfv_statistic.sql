@@ -322,3 +322,93 @@ PARTITION BY RANGE(d) (START(1) END (100) EVERY(1));
 ANALYZE T25289_T4;
 
 DROP TABLE IF EXISTS T25289_T4;
+
+--
+-- ANALYZE with HyperLogLog estimates of the number of distinct values. The
+-- leaf partitions keep their sketches, and the root merges them. Column d
+-- is all nulls: the leaves keep an empty sketch for it, and its n_distinct
+-- stays 0 after the merge.
+--
+SELECT gp_hll_estimate(gp_hll_sketch(i)) BETWEEN 9500 AND 10500 AS estimate_ok
+FROM generate_series(1, 10000) i;
+
+-- Equal values count once, however they are stored
+SELECT gp_approx_count_distinct(n) AS numerics, gp_approx_count_distinct(f) AS floats,
+	   gp_approx_count_distinct(i) AS intervals
+FROM (VALUES (1.0::numeric, 0::float8, '1 day'::interval),
+			 (1.00, '-0', '24 hours')) t(n, f, i);
+
+SET gp_statistics_use_hll = on;
+SET optimizer_analyze_root_partition = on;
+
+DROP TABLE IF EXISTS hll_stats;
+
+CREATE TABLE hll_stats (a int, b int, c text, d int) DISTRIBUTED BY (a)
+PARTITION BY RANGE(b) (START(0) END (10) EVERY(5));
+INSERT INTO hll_stats SELECT i, i % 10, 'v' || (i % 1000) FROM generate_series(1, 20000) i;
+ANALYZE hll_stats;
+
+SELECT s.tablename, s.attname, s.n_distinct::float8 BETWEEN e.lo AND e.hi AS n_distinct_ok
+FROM pg_stats s JOIN (VALUES
+	('hll_stats', 'a', -1.0, -0.95),
+	('hll_stats', 'b', 10, 10),
+	('hll_stats', 'c', 950, 1050),
+	('hll_stats', 'd', 0, 0),
+	('hll_stats_1_prt_1', 'a', -1.0, -0.95),
+	('hll_stats_1_prt_1', 'b', 5, 5),
+	('hll_stats_1_prt_1', 'c', 475, 525),
+	('hll_stats_1_prt_1', 'd', 0, 0)) e(tablename, attname, lo, hi)
+	ON s.tablename = e.tablename AND s.attname = e.attname
+ORDER BY 1, 2;
+
+SELECT c.relname, count(*) AS sketches
+FROM pg_statistic s JOIN pg_class c ON s.starelid = c.oid
+WHERE c.relname LIKE 'hll_stats%' AND 99 IN (s.stakind1, s.stakind2, s.stakind3, s.stakind4)
+GROUP BY 1 ORDER BY 1;
+
+RESET optimizer_analyze_root_partition;
+RESET gp_statistics_use_hll;
+DROP TABLE hll_stats;
+
+--
+-- Incremental ANALYZE of an append-only table: the second ANALYZE only
+-- reads the rows appended after the first one. Deletes, compaction and
+-- appending too many rows make ANALYZE read the whole table again. Which
+-- way ANALYZE went shows in its VERBOSE output; the rest of it is ignored.
+--
+-- start_matchignore
+-- m/^INFO:  (?!analyzing "hll_ao" incrementally|"hll_ao" was changed|\d+ rows were appended)/
+-- end_matchignore
+SET gp_statistics_use_hll = on;
+
+DROP TABLE IF EXISTS hll_ao;
+
+CREATE TABLE hll_ao (a int, b int) WITH (APPENDONLY=true) DISTRIBUTED BY (a);
+INSERT INTO hll_ao SELECT i, i % 100 FROM generate_series(1, 10000) i;
+ANALYZE hll_ao;
+INSERT INTO hll_ao SELECT i, 100 + i % 50 FROM generate_series(10001, 10500) i;
+ANALYZE VERBOSE hll_ao;
+
+SELECT reltuples FROM pg_class WHERE relname = 'hll_ao';
+SELECT attname, n_distinct::float8 BETWEEN -1.0 AND -0.95 AS unique_ish,
+	   n_distinct::float8 BETWEEN 145 AND 155 AS n_distinct_150
+FROM pg_stats WHERE tablename = 'hll_ao' ORDER BY attname;
+
+-- Deleted rows are hidden in the segment files already analyzed
+DELETE FROM hll_ao WHERE a <= 100;
+ANALYZE VERBOSE hll_ao;
+SELECT reltuples FROM pg_class WHERE relname = 'hll_ao';
+
+-- Compaction moves the rows to another segment file
+SET gp_appendonly_compaction_threshold = 0;
+VACUUM hll_ao;
+RESET gp_appendonly_compaction_threshold;
+ANALYZE VERBOSE hll_ao;
+
+-- More than gp_statistics_incremental_threshold of the table is new
+INSERT INTO hll_ao SELECT i, i % 100 FROM generate_series(10501, 12500) i;
+ANALYZE VERBOSE hll_ao;
+SELECT reltuples FROM pg_class WHERE relname = 'hll_ao';
+
+RESET gp_statistics_use_hll;
+DROP TABLE hll_ao;
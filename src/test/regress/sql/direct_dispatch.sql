@@ -256,6 +256,18 @@ execute test_update(2);
 
 select * from direct_test;
 
+-------------------------
+-- One-phase commit
+--
+-- With one-phase commit turned on, a transaction that wrote on one segment
+-- only is committed there without a distributed prepare
+create table direct_test_onephase (key int) distributed by (key);
+insert into direct_test_onephase values (1);
+set gp_enable_onephase_commit=on;
+insert into direct_test_onephase values (2);
+reset gp_enable_onephase_commit;
+drop table direct_test_onephase;
+
 ------------------------
 -- A subquery
 --
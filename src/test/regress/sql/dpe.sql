@@ -362,3 +362,44 @@ explain select * from (select count(*) over (order by a rows between 1 preceding
 
 select * from (select count(*) over (order by a rows between 1 preceding and 1 following), a, b from jpat)jpat inner join pat using(b);
 
+-- Nested loop rescans of a dynamic scan must only scan the partitions
+-- selected for the current outer row, also after the inner side has
+-- been rescanned for outer rows that selected other partitions. The
+-- partition selector on the inner side of a nested loop, in front of an
+-- index scan of the partitions, is a GPORCA plan.
+set optimizer=on;
+create table pat_nl(a int, b date) distributed by (a) partition by range (b) (start ('2010-01-01') end ('2010-01-05') every (1), default partition other);
+create index pat_nl_b on pat_nl(b);
+insert into pat_nl select i, date '2010-01-01' + i % 10 from generate_series(1, 1000) i;
+analyze pat_nl;
+create table jpat_nl(a int, b date) distributed by (a);
+insert into jpat_nl values (1, '2010-01-02'), (2, '2010-01-03'), (3, '2010-01-08'), (4, '2010-01-02');
+analyze jpat_nl;
+select jpat_nl.a, jpat_nl.b, count(*) from jpat_nl inner join pat_nl on (jpat_nl.b = pat_nl.b) group by 1, 2 order by 1;
+-- EXPLAIN ANALYZE reports the partitions scanned per rescan of the
+-- dynamic scan: one, the partition of the current outer row.
+create function jpat_nl_parts(out rescanned_scans int, out one_part_per_rescan bool) as $$
+declare
+  line text;
+  parts numeric;
+begin
+  rescanned_scans := 0;
+  one_part_per_rescan := true;
+  for line in execute 'explain analyze select jpat_nl.a, jpat_nl.b, count(*) from jpat_nl inner join pat_nl on (jpat_nl.b = pat_nl.b) group by 1, 2' loop
+    if line ~ 'Partitions scanned:.* scans\\.' then
+      rescanned_scans := rescanned_scans + 1;
+      parts := substring(line from E'Partitions scanned:\\s+(?:Avg )?([0-9.]+)')::numeric;
+      if parts > 1 then
+        one_part_per_rescan := false;
+      end if;
+      parts := substring(line from E'Max ([0-9.]+) parts')::numeric;
+      if parts > 1 then
+        one_part_per_rescan := false;
+      end if;
+    end if;
+  end loop;
+end;
+$$ language plpgsql;
+select * from jpat_nl_parts();
+drop function jpat_nl_parts();
+reset optimizer;
@@ -210,3 +210,32 @@ SELECT distinct C.z, count(distinct FS.x), count(distinct FS.y) FROM (SELECT i A
 
 
 drop table foo_mdqa;
+
+-- Approximate count(DISTINCT), computed from HyperLogLog sketches with
+-- 2-phase aggregation along with the other aggregates.
+set gp_enable_approx_count_distinct = on;
+
+create table approx_dqa (a int, b int, c int) distributed by (a);
+insert into approx_dqa select i, i % 1000, i % 7 from generate_series(1, 20000) i;
+
+select count(distinct b) between 940 and 1060 as approx_ok, count(*), sum(c) from approx_dqa;
+
+-- The plan is a plain 2-phase aggregate: the rows are not redistributed
+-- on b, and there are no DQA coplans to join.
+set optimizer = off;
+explain select count(distinct b), count(*), sum(c) from approx_dqa;
+reset optimizer;
+
+select c, count(distinct b) between 940 and 1060 as approx_ok, count(*) from approx_dqa
+group by c having count(distinct b) > 500 order by c;
+select count(distinct nullif(c, 0)) between 5 and 6 as approx_ok from approx_dqa;
+select count(distinct b) from approx_dqa where a < 0;
+
+-- ORCA does not look at gp_enable_approx_count_distinct, and counts
+-- exactly.
+set optimizer = on;
+select count(distinct a) = 20000 as exact_a, count(distinct b) = 1000 as exact_b from approx_dqa;
+reset optimizer;
+
+reset gp_enable_approx_count_distinct;
+drop table approx_dqa;
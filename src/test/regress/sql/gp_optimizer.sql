@@ -1379,6 +1379,118 @@ reset client_min_messages;
 drop table foo;
 -- end_ignore
 
+-- The metadata cache statistics of this backend move: the first
+-- optimization of a query on a new table loads its metadata from the
+-- catalogs, the second one finds it in the cache.  Dynamic queries, so
+-- that PL/pgSQL does not reuse the first plan.
+create table orca.mdcache_t (a int, b int) distributed by (a);
+create function orca.mdcache_stats_move(out optimized bool,
+	out first_run_loads bool, out second_run_cached bool) as $$
+declare
+	s0 record;
+	s1 record;
+	s2 record;
+	cnt int8;
+begin
+	select * into s0 from gp_opt_mdcache_stats();
+	execute 'select count(*) from orca.mdcache_t' into cnt;
+	select * into s1 from gp_opt_mdcache_stats();
+	execute 'select count(*) from orca.mdcache_t' into cnt;
+	select * into s2 from gp_opt_mdcache_stats();
+	optimized := s2.optimizations >= s0.optimizations + 2;
+	first_run_loads := s1.entries_loaded > s0.entries_loaded;
+	-- a concurrent change to pg_operator or the like resets the cache
+	second_run_cached := s2.entries_loaded = s1.entries_loaded
+		or s2.full_resets > s1.full_resets;
+end;
+$$ language plpgsql volatile;
+select * from orca.mdcache_stats_move();
+drop function orca.mdcache_stats_move();
+drop table orca.mdcache_t;
+
+-- The partition metadata of a partitioned table is cached across queries.
+-- Creating and dropping an operator resets the rest of the metadata cache,
+-- so that the table is translated again. A change to another table keeps
+-- the partition metadata, a change to one of the parts drops it.
+create table orca.pmd_p (a int, b int) distributed by (a)
+partition by range (b) (partition p1 start (0) end (2), partition p2 start (2) end (4));
+create index pmd_p_a on orca.pmd_p (a);
+create table orca.pmd_other (a int) distributed by (a);
+create function orca.pmd_reset_mdcache() returns void as $$
+begin
+	execute 'create operator orca.### (procedure = int4eq, leftarg = int4, rightarg = int4)';
+	execute 'drop operator orca.### (int4, int4)';
+end;
+$$ language plpgsql volatile;
+create function orca.pmd_cache_check(out built_first bool,
+	out kept_on_other_change bool, out rebuilt_on_part_change bool) as $$
+declare
+	s0 record;
+	s1 record;
+	s2 record;
+	s3 record;
+	cnt int8;
+begin
+	select * into s0 from gp_opt_mdcache_stats();
+	execute 'select count(*) from orca.pmd_p where a = 1' into cnt;
+	select * into s1 from gp_opt_mdcache_stats();
+	execute 'alter table orca.pmd_other add column b int';
+	perform orca.pmd_reset_mdcache();
+	execute 'select count(*) from orca.pmd_p where a = 1' into cnt;
+	select * into s2 from gp_opt_mdcache_stats();
+	execute 'create index pmd_p_p2_b on orca.pmd_p_1_prt_p2 (b)';
+	perform orca.pmd_reset_mdcache();
+	execute 'select count(*) from orca.pmd_p where a = 1' into cnt;
+	select * into s3 from gp_opt_mdcache_stats();
+	built_first := s1.part_metadata_built > s0.part_metadata_built;
+	kept_on_other_change := s2.part_metadata_built = s1.part_metadata_built
+		and s2.part_metadata_reused > s1.part_metadata_reused;
+	rebuilt_on_part_change := s3.part_metadata_built > s2.part_metadata_built;
+end;
+$$ language plpgsql volatile;
+select * from orca.pmd_cache_check();
+drop function orca.pmd_cache_check();
+drop function orca.pmd_reset_mdcache();
+drop table orca.pmd_other;
+drop table orca.pmd_p;
+
+-- The shared plan cache reuses the plan of a repeated query, but a
+-- transaction that changed the catalogs must neither use nor add plans.
+-- The cache only exists if optimizer_plan_cache_size is set; without it, the
+-- checks pass trivially.
+create table orca.plan_cache_t (a int, b int) distributed by (a);
+insert into orca.plan_cache_t values (1, 2);
+create temp table plan_cache_before as select * from gp_opt_plan_cache_stats() distributed randomly;
+select * from orca.plan_cache_t;
+select * from orca.plan_cache_t;
+select s.size_bytes = 0 or s.hits > (select hits from plan_cache_before) as second_run_hit from gp_opt_plan_cache_stats() s;
+begin;
+alter table orca.plan_cache_t drop column b;
+select * from orca.plan_cache_t;
+select * from orca.plan_cache_t;
+rollback;
+select * from orca.plan_cache_t;
+-- Stable functions are folded to constants when a plan is made, so the plans
+-- of queries that call them are not cached: a later run must see its own
+-- now() and current_user, not those of the run that made the plan.
+create temp table plan_cache_times (t timestamptz) distributed randomly;
+insert into plan_cache_times select now();
+select a, now() >= (select max(t) from plan_cache_times) as fresh_now from orca.plan_cache_t;
+insert into plan_cache_times select now();
+select a, now() >= (select max(t) from plan_cache_times) as fresh_now from orca.plan_cache_t;
+create role plan_cache_role;
+grant usage on schema orca to plan_cache_role;
+grant select on orca.plan_cache_t to plan_cache_role;
+select a, current_user = 'plan_cache_role' as is_role from orca.plan_cache_t;
+set role plan_cache_role;
+select a, current_user = 'plan_cache_role' as is_role from orca.plan_cache_t;
+reset role;
+select a, current_user = 'plan_cache_role' as is_role from orca.plan_cache_t;
+drop table plan_cache_times;
+drop table plan_cache_before;
+drop table orca.plan_cache_t;
+revoke usage on schema orca from plan_cache_role;
+drop role plan_cache_role;
 -- clean up
 drop schema orca cascade;
 reset optimizer_segments;
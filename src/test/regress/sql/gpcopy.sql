@@ -693,3 +693,48 @@ error3
 7|7_number
 \.
 SELECT COUNT(*) FROM test_first_segment_reject_limit;
+
+-- COPY ... ON SEGMENT: every segment unloads to and reloads from its own file
+CREATE TABLE copy_onseg (a int, b text) DISTRIBUTED BY (a);
+INSERT INTO copy_onseg SELECT i, 'row ' || i FROM generate_series(1, 100) i;
+COPY copy_onseg TO '/tmp/copy_onseg_<SEGID>.txt' ON SEGMENT;
+TRUNCATE copy_onseg;
+COPY copy_onseg FROM '/tmp/copy_onseg_<SEGID>.txt' ON SEGMENT;
+SELECT count(*), sum(a) FROM copy_onseg;
+-- the file name must contain <SEGID>
+COPY copy_onseg TO '/tmp/copy_onseg.txt' ON SEGMENT;
+DROP TABLE copy_onseg;
+
+-- Rows are copied into heap tables in batches; make sure the index entries
+-- made afterwards find them.
+CREATE TABLE copy_batch (a int, b text) DISTRIBUTED BY (a);
+CREATE INDEX copy_batch_b ON copy_batch (b);
+INSERT INTO copy_batch SELECT i, 'row ' || i FROM generate_series(1, 5000) i;
+COPY copy_batch TO '/tmp/copy_batch.txt';
+TRUNCATE copy_batch;
+COPY copy_batch FROM '/tmp/copy_batch.txt';
+SELECT count(*), sum(a) FROM copy_batch;
+SET enable_seqscan = off;
+SELECT a FROM copy_batch WHERE b = 'row 4321';
+RESET enable_seqscan;
+DROP TABLE copy_batch;
+
+-- COPY into many append-only partitions with a tiny descriptor budget, so
+-- that partition insert descriptors get closed and reopened as rows arrive.
+-- All the rows go to one segment, in an order that switches partitions on
+-- every row, so that the number of closes it logs is known.
+-- start_matchignore
+-- m/^LOG:  (?!COPY closed)/
+-- end_matchignore
+CREATE TABLE copy_aoparts (a int, b int, c text)
+WITH (appendonly=true, orientation=column) DISTRIBUTED BY (a)
+PARTITION BY RANGE (b) (START (0) END (10) EVERY (1));
+COPY (SELECT 1, i % 10, 'row ' || i FROM generate_series(1, 2000) i) TO '/tmp/copy_aoparts.txt';
+SET gp_copy_insert_desc_memory = 1;
+SET client_min_messages = log;
+COPY copy_aoparts FROM '/tmp/copy_aoparts.txt';
+COPY copy_aoparts FROM '/tmp/copy_aoparts.txt';
+RESET client_min_messages;
+RESET gp_copy_insert_desc_memory;
+SELECT b, count(*), sum(a) FROM copy_aoparts GROUP BY b ORDER BY b;
+DROP TABLE copy_aoparts;
@@ -0,0 +1,39 @@
+--
+-- Rows inserted into heap tables are buffered, and written out a page at a
+-- time. Make sure the index entries made afterwards find them.
+--
+SET gp_enable_heap_multi_insert = on;
+CREATE TABLE hmi (a int, b text) DISTRIBUTED BY (a);
+CREATE INDEX hmi_b ON hmi (b);
+INSERT INTO hmi SELECT i, 'row ' || i FROM generate_series(1, 5000) i;
+SELECT count(*), sum(a) FROM hmi;
+CREATE TABLE hmi_ctas AS SELECT * FROM hmi DISTRIBUTED BY (a);
+SELECT count(*), sum(a) FROM hmi_ctas;
+SET enable_seqscan = off;
+SELECT a FROM hmi WHERE b = 'row 4321';
+-- A query that calls volatile functions inserts its rows one at a time,
+-- as they might look for the rows inserted before.
+INSERT INTO hmi SELECT i, 'volatile ' || i FROM generate_series(1, 1000) i WHERE random() >= 0;
+SELECT count(*) FROM hmi WHERE b LIKE 'volatile %';
+SELECT a FROM hmi WHERE b = 'volatile 999';
+-- An INSERT into many partitions keeps more rows than it may buffer; the
+-- least recently used partitions are written out early.
+SET client_min_messages = warning;
+CREATE TABLE hmi_part (a int, b text) DISTRIBUTED BY (a)
+PARTITION BY RANGE (a) (START (0) END (20000) EVERY (100));
+CREATE INDEX hmi_part_b ON hmi_part (b);
+RESET client_min_messages;
+INSERT INTO hmi_part SELECT i, 'row ' || i FROM generate_series(0, 19999) i;
+SELECT count(*), sum(a) FROM hmi_part;
+SELECT a FROM hmi_part WHERE b = 'row 12345';
+RESET enable_seqscan;
+-- Unique indexes are checked when the buffered rows are written out, so the
+-- violation is raised then, and the whole statement is still rolled back.
+CREATE TABLE hmi_uniq (a int UNIQUE) DISTRIBUTED BY (a);
+INSERT INTO hmi_uniq SELECT i % 3 FROM generate_series(1, 4) i;
+SELECT count(*) FROM hmi_uniq;
+DROP TABLE hmi_uniq;
+RESET gp_enable_heap_multi_insert;
+DROP TABLE hmi_part;
+DROP TABLE hmi_ctas;
+DROP TABLE hmi;
@@ -0,0 +1,37 @@
+-- @Description Tests that the progress of the compaction of a segment
+-- file is reported by pg_appendonly_compaction_progress().
+
+CREATE TABLE uao_progress (a INT, b INT, c CHAR(128)) WITH (appendonly=true) DISTRIBUTED BY (a);
+INSERT INTO uao_progress SELECT i as a, i as b, 'hello world' as c FROM generate_series(1, 100) AS i;
+
+-- The progress is kept per QE backend, so sum it up on the segments.
+CREATE FUNCTION uao_progress_counts(rel regclass, OUT finished bool,
+	OUT total bigint, OUT scanned bigint, OUT moved bigint, OUT removed bigint,
+	OUT reclaimed bool) AS
+$$
+	SELECT bool_and(finished), sum(total_tupcount)::bigint,
+		   sum(scanned_tupcount)::bigint, sum(moved_tupcount)::bigint,
+		   sum(removed_tupcount)::bigint, bool_and(reclaimed_bytes > 0)
+	FROM pg_stat_appendonly_compaction WHERE relid = $1
+$$ LANGUAGE sql VOLATILE;
+
+-- Nothing has been compacted yet
+SELECT count(*) FROM pg_appendonly_compaction_progress() AS s
+	(pid int4, relid oid, segno int4, finished bool, total_tupcount int8,
+	 scanned_tupcount int8, moved_tupcount int8, removed_tupcount int8,
+	 eof int8, reclaimed_bytes int8)
+WHERE relid = 'uao_progress'::regclass;
+
+DELETE FROM uao_progress WHERE a <= 50;
+VACUUM uao_progress;
+
+SELECT bool_and((p).finished) AS finished, sum((p).total) AS total,
+	   sum((p).scanned) AS scanned, sum((p).moved) AS moved,
+	   sum((p).removed) AS removed, bool_and((p).reclaimed) AS reclaimed
+FROM (SELECT uao_progress_counts('uao_progress') AS p
+	  FROM gp_dist_random('gp_id')) s;
+-- The master holds no tuples and compacts nothing
+SELECT relname, segno FROM pg_stat_appendonly_compaction WHERE relid = 'uao_progress'::regclass;
+
+DROP FUNCTION uao_progress_counts(regclass);
+DROP TABLE uao_progress;
@@ -0,0 +1,22 @@
+--
+-- Group commit statistics of XLogFlush, shown in pg_stat_xlog_flush.
+--
+CREATE TABLE xlog_flush_before AS
+	SELECT flush_requests, flushes, flushed_bytes FROM pg_stat_xlog_flush
+	DISTRIBUTED RANDOMLY;
+
+-- Committing a transaction flushes its commit record on the master.
+CREATE TABLE xlog_flush_t (a int) DISTRIBUTED BY (a);
+BEGIN;
+INSERT INTO xlog_flush_t SELECT generate_series(1, 10);
+COMMIT;
+
+SELECT s.flush_requests > b.flush_requests AS requested,
+	   s.flushes > b.flushes AS flushed,
+	   s.flushed_bytes > b.flushed_bytes AS bytes,
+	   s.flushes <= s.flush_requests AS batched,
+	   s.avg_flush_batch >= 1 AS avg_batch
+FROM pg_stat_xlog_flush s, xlog_flush_before b;
+
+DROP TABLE xlog_flush_t;
+DROP TABLE xlog_flush_before;
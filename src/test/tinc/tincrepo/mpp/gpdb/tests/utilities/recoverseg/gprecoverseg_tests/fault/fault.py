@@ -27,6 +27,8 @@ from mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.fault.genFault impor
 from mpp.lib.config import GPDBConfig
 
 from mpp.lib.gprecoverseg import GpRecoverseg
+from mpp.lib.gpConfig import GpConfig
+from mpp.lib.gpstop import GpStop
 from utilities.gppersistentrebuild import PTTestCase
 
 # Environmental variable to be set priror to the gprecoverseg run.
@@ -350,6 +352,16 @@ class GPDBdbOps(TINCTestCase):
         result = newfault.check_if_not_in_preferred_role()
         if result == True:
            self.fail("Segments are not in preferred roles!!!")
+
+    def set_two_resync_workers(self):
+        ''' Resynchronizes with two resync worker processes from now on '''
+        GpConfig().setParameter('filerep_resync_workers', '2', '2')
+        GpStop().run_gpstop_cmd(reload = True)
+
+    def reset_resync_workers(self):
+        ''' Resynchronizes with the default number of resync workers again '''
+        GpConfig().removeParameter('filerep_resync_workers')
+        GpStop().run_gpstop_cmd(reload = True)
     
          
 class SegmentConfigurations(TINCTestCase):
@@ -290,6 +290,42 @@ class GprecoversegTest(ScenarioTestCase):
         test_case_list6.append("mpp.gpdb.tests.storage.lib.dbstate.DbStateClass.check_mirrorintegrity")
         self.test_case_scenario.append(test_case_list6)
 
+    def test_failover_to_primary_two_resync_workers(self):
+        """
+        [feature]:  System failover to Primary and incremental recovery, resynchronizing with two resync workers
+        
+        """
+
+        test_case_list0 = []
+        test_case_list0.append('mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.fault.fault.GPDBdbOps.set_two_resync_workers')
+        self.test_case_scenario.append(test_case_list0)
+
+        test_case_list1 = []
+        test_case_list1.append('mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.fault.fault.FaultInjectorTestCase.test_kill_mirror')
+        self.test_case_scenario.append(test_case_list1)
+
+        # Changes made while the mirror is down give the workers files to share
+        test_case_list2 = []
+        test_case_list2.append('mpp.gpdb.tests.catalog.schema_topology.test_ST_AllSQLsTest.AllSQLsTest')
+        self.test_case_scenario.append(test_case_list2)
+
+        test_case_list3 = []
+        test_case_list3.append('mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.fault.fault.GprecoversegClass.test_do_incremental_recovery')
+        self.test_case_scenario.append(test_case_list3)
+
+        # Check the Sate of DB and Cluster
+        test_case_list4 = []
+        test_case_list4.append("mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.test_gprecoverseg.GprecoversegTest.wait_till_insync_transition")
+        self.test_case_scenario.append(test_case_list4)
+
+        test_case_list5 = []
+        test_case_list5.append("mpp.gpdb.tests.storage.lib.dbstate.DbStateClass.check_mirrorintegrity")
+        self.test_case_scenario.append(test_case_list5)
+
+        test_case_list6 = []
+        test_case_list6.append('mpp.gpdb.tests.utilities.recoverseg.gprecoverseg_tests.fault.fault.GPDBdbOps.reset_resync_workers')
+        self.test_case_scenario.append(test_case_list6)
+
     def test_drop_pg_dirs_on_primary(self):
         """
         [feature]:   System Failover to Mirror due to Drop pg_* dir on Primary